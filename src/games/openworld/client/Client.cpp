@@ -12,6 +12,7 @@
 #include "voxelrender/CachedMeshRenderer.h"
 #include "command/Command.h"
 #include "core/GLM.h"
+#include "core/Trace.h"
 #include "io/Filesystem.h"
 #include "core/Color.h"
 #include "core/Password.h"
@@ -20,6 +21,7 @@
 #include "network/EntityRemoveHandler.h"
 #include "network/EntitySpawnHandler.h"
 #include "network/EntityUpdateHandler.h"
+#include "network/EntitySnapshotHandler.h"
 #include "network/UserSpawnHandler.h"
 #include "network/UserInfoHandler.h"
 #include "network/VarUpdateHandler.h"
@@ -97,6 +99,7 @@ void Client::sendMovement() {
 
 void Client::onEvent(const network::DisconnectEvent& event) {
 	_network->destroy();
+	_snapshots.clear();
 	rootWindow("main");
 	pushWindow("disconnect_info");
 }
@@ -160,6 +163,7 @@ app::AppState Client::onInit() {
 	r->registerHandler(network::ServerMsgType::EntitySpawn, std::make_shared<EntitySpawnHandler>());
 	r->registerHandler(network::ServerMsgType::EntityRemove, std::make_shared<EntityRemoveHandler>());
 	r->registerHandler(network::ServerMsgType::EntityUpdate, std::make_shared<EntityUpdateHandler>());
+	r->registerHandler(network::ServerMsgType::EntitySnapshot, std::make_shared<EntitySnapshotHandler>());
 	r->registerHandler(network::ServerMsgType::UserSpawn, std::make_shared<UserSpawnHandler>());
 	r->registerHandler(network::ServerMsgType::AuthFailed, std::make_shared<AuthFailedHandler>());
 	r->registerHandler(network::ServerMsgType::StartCooldown, std::make_shared<StartCooldownHandler>());
@@ -402,6 +406,35 @@ void Client::entityRemove(frontend::ClientEntityId id) {
 	_worldRenderer.entityMgr().removeEntity(id);
 }
 
+void Client::entitySnapshot(uint32_t sequence, uint32_t baseline, const uint8_t* data, size_t size) {
+	core_trace_scoped(EntitySnapshot);
+	const shared::EntitySnapshotEntries* baselineEntries = nullptr;
+	if (baseline != 0u) {
+		baselineEntries = _snapshots.get(baseline);
+		if (baselineEntries == nullptr) {
+			Log::debug("Baseline %u for entity snapshot %u is unknown", baseline, sequence);
+			return;
+		}
+	}
+	if (!shared::EntitySnapshotCodec::decode(baselineEntries, data, size, _snapshotEntries, &_snapshotChanges)) {
+		Log::warn("Failed to decode entity snapshot %u", sequence);
+		return;
+	}
+	std::swap(_snapshots.store(sequence), _snapshotEntries);
+
+	for (const shared::EntitySnapshotEntry& entry : _snapshotChanges) {
+		const frontend::ClientEntityPtr& entity = getEntity(entry.id);
+		if (!entity) {
+			continue;
+		}
+		entity->setPosition(shared::dequantizePosition(entry.state.pos));
+		entity->setOrientation(shared::dequantizeOrientation(entry.state.orientation));
+		entity->setAnimation(entry.state.animation, true);
+	}
+	_messageSender->sendClientMessage(_snapshotAckFbb, network::ClientMsgType::EntitySnapshotAck,
+			network::CreateEntitySnapshotAck(_snapshotAckFbb, sequence).Union(), 0u);
+}
+
 void Client::spawn(frontend::ClientEntityId id, const char *name, const glm::vec3& pos, float orientation) {
 	Log::info("User %li (%s) logged in at pos %f:%f:%f with orientation: %f", id, name, pos.x, pos.y, pos.z, orientation);
 	_camera.setTarget(pos);
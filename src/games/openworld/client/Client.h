@@ -26,6 +26,7 @@
 #include "stock/StockDataProvider.h"
 #include "voxel/ClientPager.h"
 #include "cooldown/CooldownHandler.h"
+#include "shared/EntitySnapshot.h"
 
 class Client: public ui::nuklear::LUAUIApp, public core::IEventBusHandler<network::NewConnectionEvent>, public core::IEventBusHandler<
 		network::DisconnectEvent>, public core::IEventBusHandler<voxelworld::WorldCreatedEvent> {
@@ -55,6 +56,11 @@ protected:
 	frontend::PlayerCamera _camera;
 	audio::SoundManagerPtr _soundManager;
 	voxelworldrender::AssetVolumeCachePtr _assetVolumeCache;
+	// the received entity snapshots that the server might use as baseline
+	shared::EntitySnapshotHistory _snapshots;
+	shared::EntitySnapshotEntries _snapshotEntries;
+	shared::EntitySnapshotEntries _snapshotChanges;
+	flatbuffers::FlatBufferBuilder _snapshotAckFbb;
 
 	frontend::ClientEntityId id() const;
 
@@ -115,6 +121,10 @@ public:
 
 	void entitySpawn(frontend::ClientEntityId id, network::EntityType type, float orientation, const glm::vec3& pos, animation::Animation animation);
 	void entityRemove(frontend::ClientEntityId id);
+	/**
+	 * @brief Applies the delta encoded entity states of the given snapshot and acknowledges it
+	 */
+	void entitySnapshot(uint32_t sequence, uint32_t baseline, const uint8_t* data, size_t size);
 	frontend::ClientEntityPtr getEntity(frontend::ClientEntityId id) const;
 };
 
@@ -0,0 +1,16 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "IClientProtocolHandler.h"
+
+/**
+ * Applies the delta encoded entity states of the snapshot to the @c frontend::ClientEntity instances
+ * @see shared::EntitySnapshotCodec
+ */
+CLIENTPROTOHANDLERIMPL(EntitySnapshot) {
+	const flatbuffers::Vector<uint8_t>* data = message->data();
+	client->entitySnapshot(message->sequence(), message->baseline(), data->data(), data->size());
+}
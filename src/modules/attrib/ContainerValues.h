@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "core/collection/Map.h"
+#include "core/collection/Array.h"
 #include "AttributeType.h"
 
 namespace attrib {
@@ -0,0 +1,177 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/zone/Zone.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/AIRegistry.h"
+#include "backend/entity/ai/tree/ITask.h"
+#include "backend/entity/ai/tree/loaders/lua/LUATreeLoader.h"
+#include "backend/entity/ai/condition/ICondition.h"
+#include "backend/entity/ai/filter/IFilter.h"
+#include "backend/entity/ai/movement/Wander.h"
+#include "core/ArrayLength.h"
+#include "core/Log.h"
+
+namespace {
+
+/**
+ * The trees of the openworld server behaviourtrees.lua - the lua modules of the game are not available
+ * for the benchmark, that's why they are inlined here.
+ */
+const char *TREES = R"lua(
+local function increasePopulation(parentnode)
+	local parallel = parentnode:addNode("Parallel", "increasepopulation")
+	parallel:setCondition("And(Not(IsOnCooldown{INCREASE}),Filter(SelectIncreasePartner{INCREASE}))")
+	parallel:addNode("Steer(SelectionSeek)", "followincreasepartner")
+	local spawn = parallel:addNode("Parallel", "spawn")
+	spawn:setCondition("IsCloseToSelection{1}")
+	spawn:addNode("Spawn", "spawn")
+	spawn:addNode("TriggerCooldown{INCREASE}", "increasecooldown")
+	spawn:addNode("TriggerCooldownOnSelection{INCREASE}", "increasecooldownonpartner")
+end
+
+local function hunt(parentnode)
+	local parallel = parentnode:addNode("Parallel", "hunt")
+	parallel:setCondition("And(Not(IsOnCooldown{HUNT}),Filter(SelectEntitiesOfTypes{ANIMAL_RABBIT}))")
+	parallel:addNode("Steer(SelectionSeek)", "follow")
+	parallel:addNode("AttackOnSelection", "attack"):setCondition("IsCloseToSelection{1}")
+	parallel:addNode("SetPointOfInterest", "setpoi"):setCondition("IsCloseToSelection{1}")
+	parallel:addNode("TriggerCooldown{HUNT}", "increasecooldown"):setCondition("Not(IsSelectionAlive)")
+end
+
+local function idle(parentnode)
+	local prio = parentnode:addNode("PrioritySelector", "walkuncrowded")
+	prio:addNode("Steer(Wander)", "wanderfreely")
+end
+
+local function idlehome(parentnode)
+	local prio = parentnode:addNode("PrioritySelector", "walkuncrowded")
+	prio:addNode("Steer(WanderAroundHome{100})", "wanderaroundhome")
+	prio:addNode("Steer(Wander)", "wanderfreely")
+end
+
+function init()
+	local rabbit = AI.createTree("ANIMAL_RABBIT"):createRoot("PrioritySelector", "ANIMAL_RABBIT")
+	rabbit:addNode("Steer(SelectionFlee)", "fleefromhunter"):setCondition("And(Filter(SelectEntitiesOfTypes{ANIMAL_WOLF}),IsCloseToSelection{10})")
+	increasePopulation(rabbit)
+	idle(rabbit)
+
+	local wolf = AI.createTree("ANIMAL_WOLF"):createRoot("PrioritySelector", "ANIMAL_WOLF")
+	hunt(wolf)
+	increasePopulation(wolf)
+	idle(wolf)
+
+	idlehome(AI.createTree("HUMAN_MALE_WORKER"):createRoot("PrioritySelector", "HUMAN_MALE_WORKER"))
+end
+)lua";
+
+const char *TREE_NAMES[] = {"ANIMAL_RABBIT", "ANIMAL_WOLF", "HUMAN_MALE_WORKER"};
+
+}
+
+namespace backend {
+
+/**
+ * The tasks, conditions and filters that need a real npc are replaced by these cheap stand-ins. They
+ * alternate their results over time to let the selectors switch between their children.
+ */
+AI_TASK(BenchmarkTask) {
+	return ai::TreeNodeStatus::FINISHED;
+}
+
+class BenchmarkCondition: public ICondition {
+public:
+	CONDITION_CLASS(BenchmarkCondition)
+	CONDITION_FACTORY(BenchmarkCondition)
+
+	bool evaluate(const AIPtr& entity) override {
+		return state((entity->getTime() / 100 + entity->getId()) % 3 == 0);
+	}
+};
+
+class BenchmarkFilter: public IFilter {
+public:
+	FILTER_CLASS(BenchmarkFilter)
+	FILTER_FACTORY(BenchmarkFilter)
+
+	void filter(const AIPtr& entity) override {
+		const ai::CharacterId id = entity->getId();
+		if ((entity->getTime() / 50 + id) % 2 == 0) {
+			getFilteredEntities(entity).push_back((ai::CharacterId)((id + 1) % entity->getZone()->size()));
+		}
+	}
+};
+
+}
+
+/**
+ * @brief Measures the behaviour tree execution of a zone with the trees of the openworld server.
+ */
+class BehaviourTreeBenchmark : public app::AbstractBenchmark {
+protected:
+	class BenchmarkCharacter : public backend::ICharacter {
+	public:
+		BenchmarkCharacter(const ai::CharacterId& id) :
+				backend::ICharacter(id) {
+		}
+	};
+
+	backend::AIRegistry _registry;
+
+	bool onInitApp() override {
+		for (const char *type : {"AttackOnSelection", "SetPointOfInterest", "Spawn", "TriggerCooldown", "TriggerCooldownOnSelection"}) {
+			_registry.unregisterNodeFactory(type);
+			_registry.registerNodeFactory(type, backend::BenchmarkTask::getFactory());
+		}
+		for (const char *type : {"IsOnCooldown", "IsCloseToSelection", "IsSelectionAlive"}) {
+			_registry.unregisterConditionFactory(type);
+			_registry.registerConditionFactory(type, backend::BenchmarkCondition::getFactory());
+		}
+		for (const char *type : {"SelectEntitiesOfTypes", "SelectIncreasePartner"}) {
+			_registry.unregisterFilterFactory(type);
+			_registry.registerFilterFactory(type, backend::BenchmarkFilter::getFactory());
+		}
+		_registry.unregisterSteeringFactory("WanderAroundHome");
+		_registry.registerSteeringFactory("WanderAroundHome", backend::movement::Wander::getFactory());
+		return true;
+	}
+
+	bool fill(backend::Zone& zone, int n) {
+		backend::LUATreeLoader loader(_registry);
+		if (!loader.init(TREES)) {
+			Log::error("Failed to load the trees: %s", loader.getError().c_str());
+			return false;
+		}
+		for (int i = 0; i < n; ++i) {
+			const backend::TreeNodePtr& root = loader.load(TREE_NAMES[i % lengthof(TREE_NAMES)]);
+			if (!root) {
+				return false;
+			}
+			backend::ICharacterPtr character = core::make_shared<BenchmarkCharacter>(i);
+			backend::AIPtr ai = std::make_shared<backend::AI>(root);
+			ai->setCharacter(character);
+			zone.addAI(ai);
+		}
+		// perform the scheduled adds
+		zone.update(0l);
+		return true;
+	}
+};
+
+BENCHMARK_DEFINE_F(BehaviourTreeBenchmark, Update)(benchmark::State &state) {
+	const int npcs = (int)state.range(0);
+	// a single thread to measure the tree execution and not the scheduling
+	backend::Zone zone("benchmark", 1);
+	if (!fill(zone, npcs)) {
+		state.SkipWithError("Failed to create the npcs");
+		return;
+	}
+	for (auto _ : state) {
+		zone.update(10l);
+	}
+	state.SetItemsProcessed(state.iterations() * npcs);
+}
+
+BENCHMARK_REGISTER_F(BehaviourTreeBenchmark, Update)->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
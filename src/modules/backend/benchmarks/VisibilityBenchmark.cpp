@@ -0,0 +1,155 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/world/SpatialGrid.h"
+#include "math/QuadTree.h"
+#include "math/Rect.h"
+#include "math/Random.h"
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Measures the visibility part of a map tick for a lot of moving entities.
+ * Every tick each entity is moved a bit, re-indexed and queries the entities in its view distance.
+ */
+class VisibilityBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr float WorldSize = 4000.0f;
+	static constexpr float ViewDistance = 100.0f;
+	static constexpr float Speed = 2.0f;
+
+	struct BenchmarkEntity;
+	typedef std::shared_ptr<BenchmarkEntity> BenchmarkEntityPtr;
+	typedef std::unordered_set<BenchmarkEntityPtr> Set;
+
+	struct BenchmarkEntity {
+		int _id;
+		glm::vec3 _pos;
+		glm::vec3 _dir;
+		Set _visible;
+
+		int id() const {
+			return _id;
+		}
+		glm::vec3 pos() const {
+			return _pos;
+		}
+	};
+
+	std::vector<BenchmarkEntityPtr> _entities;
+
+	void fill(int n) {
+		math::Random random(n);
+		_entities.clear();
+		_entities.reserve(n);
+		for (int i = 0; i < n; ++i) {
+			BenchmarkEntityPtr e = std::make_shared<BenchmarkEntity>();
+			e->_id = i;
+			e->_pos = glm::vec3(random.randomf(0.0f, WorldSize), 0.0f, random.randomf(0.0f, WorldSize));
+			e->_dir = glm::vec3(random.randomf(-Speed, Speed), 0.0f, random.randomf(-Speed, Speed));
+			_entities.push_back(e);
+		}
+	}
+
+	static void move(BenchmarkEntity& e) {
+		e._pos += e._dir;
+		if (e._pos.x < 0.0f || e._pos.x > WorldSize) {
+			e._dir.x = -e._dir.x;
+		}
+		if (e._pos.z < 0.0f || e._pos.z > WorldSize) {
+			e._dir.z = -e._dir.z;
+		}
+	}
+
+	struct QuadTreeNode {
+		BenchmarkEntityPtr entity;
+
+		math::RectFloat getRect() const {
+			return math::RectFloat(entity->_pos.x, entity->_pos.z, entity->_pos.x, entity->_pos.z);
+		}
+		bool operator==(const QuadTreeNode& rhs) const {
+			return rhs.entity == entity;
+		}
+	};
+
+public:
+	void TearDown(::benchmark::State& state) override {
+		// break the reference cycles of the visible sets
+		for (const BenchmarkEntityPtr& e : _entities) {
+			e->_visible.clear();
+		}
+		_entities.clear();
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(VisibilityBenchmark, SpatialGrid)(benchmark::State &state) {
+	const int n = (int)state.range(0);
+	fill(n);
+	backend::SpatialGrid<BenchmarkEntityPtr, int> grid(64.0f);
+	for (const BenchmarkEntityPtr& e : _entities) {
+		grid.insert(e);
+	}
+	int64_t visible = 0;
+	for (auto _ : state) {
+		for (const BenchmarkEntityPtr& e : _entities) {
+			move(*e);
+			grid.update(e);
+		}
+		for (const BenchmarkEntityPtr& e : _entities) {
+			Set& set = e->_visible;
+			set.clear();
+			grid.visit(e->_pos, ViewDistance, [&] (const BenchmarkEntityPtr& other) {
+				if (other != e) {
+					set.insert(other);
+				}
+			});
+			visible += (int64_t)set.size();
+		}
+	}
+	state.counters["visible"] = benchmark::Counter((double)visible / (double)n, benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+/**
+ * @brief The former implementation: a quad tree that needs a remove and insert for each move and only checks
+ * against the rect of the view distance.
+ */
+BENCHMARK_DEFINE_F(VisibilityBenchmark, QuadTree)(benchmark::State &state) {
+	const int n = (int)state.range(0);
+	fill(n);
+	math::QuadTree<QuadTreeNode, float> quadTree(math::RectFloat(0.0f, 0.0f, WorldSize, WorldSize));
+	for (const BenchmarkEntityPtr& e : _entities) {
+		quadTree.insert(QuadTreeNode { e });
+	}
+	int64_t visible = 0;
+	math::QuadTree<QuadTreeNode, float>::Contents contents;
+	for (auto _ : state) {
+		for (const BenchmarkEntityPtr& e : _entities) {
+			quadTree.remove(QuadTreeNode { e });
+			move(*e);
+			quadTree.insert(QuadTreeNode { e });
+		}
+		for (const BenchmarkEntityPtr& e : _entities) {
+			const math::RectFloat rect(e->_pos.x - ViewDistance, e->_pos.z - ViewDistance, e->_pos.x + ViewDistance, e->_pos.z + ViewDistance);
+			contents.clear();
+			quadTree.query(rect, contents);
+			Set& set = e->_visible;
+			set.clear();
+			for (const QuadTreeNode& node : contents) {
+				if (node.entity != e) {
+					set.insert(node.entity);
+				}
+			}
+			visible += (int64_t)set.size();
+		}
+	}
+	state.counters["visible"] = benchmark::Counter((double)visible / (double)n, benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_REGISTER_F(VisibilityBenchmark, SpatialGrid)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VisibilityBenchmark, QuadTree)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
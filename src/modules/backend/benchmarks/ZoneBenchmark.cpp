@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "backend/entity/ai/zone/Zone.h"
+#include "backend/entity/ai/AI.h"
+#include "backend/entity/ai/tree/PrioritySelector.h"
+#include "backend/entity/ai/condition/True.h"
+#include "core/concurrent/Concurrency.h"
+
+/**
+ * @brief Measures the tick of a zone with a lot of npcs that are executing a trivial behaviour tree.
+ * This is mostly measuring the scheduling overhead of the zone update.
+ */
+class ZoneBenchmark : public app::AbstractBenchmark {
+protected:
+	class BenchmarkCharacter : public backend::ICharacter {
+	public:
+		BenchmarkCharacter(const ai::CharacterId& id) :
+				backend::ICharacter(id) {
+		}
+	};
+
+	void fill(backend::Zone& zone, int n) const {
+		const backend::TreeNodePtr root = std::make_shared<backend::PrioritySelector>("root", "", backend::True::get());
+		for (int i = 0; i < n; ++i) {
+			backend::ICharacterPtr character = core::make_shared<BenchmarkCharacter>(i);
+			backend::AIPtr ai = std::make_shared<backend::AI>(root);
+			ai->setCharacter(character);
+			zone.addAI(ai);
+		}
+		// perform the scheduled adds
+		zone.update(0l);
+	}
+};
+
+BENCHMARK_DEFINE_F(ZoneBenchmark, Update)(benchmark::State &state) {
+	const int npcs = (int)state.range(0);
+	backend::Zone zone("benchmark", (int)core::halfcpus());
+	fill(zone, npcs);
+	for (auto _ : state) {
+		zone.update(1l);
+	}
+	state.SetItemsProcessed(state.iterations() * npcs);
+}
+
+BENCHMARK_REGISTER_F(ZoneBenchmark, Update)->Arg(10000)->Arg(50000)->Arg(100000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
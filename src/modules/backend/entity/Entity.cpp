@@ -3,7 +3,6 @@
  */
 
 #include "Entity.h"
-#include "core/collection/SetUtil.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Log.h"
@@ -195,18 +194,24 @@ bool Entity::update(long dt) {
 
 void Entity::updateVisible(const EntitySet& set) {
 	core_trace_scoped(UpdateVisible);
+	EntitySet add;
+	EntitySet remove;
 	_visibleLock.lockWrite();
-	const auto& stillVisible = core::setIntersection(set, _visible);
-	const EntitySet& remove = core::setDifference(stillVisible, _visible);
-	const EntitySet& add = core::setDifference(set, stillVisible);
-	_visible = core::setUnion(stillVisible, add);
+	for (const EntityPtr& e : set) {
+		if (_visible.find(e) == _visible.end()) {
+			add.insert(e);
+		}
+	}
+	for (const EntityPtr& e : _visible) {
+		if (set.find(e) == set.end()) {
+			remove.insert(e);
+		}
+	}
+	// assigning reuses the already allocated nodes of the set
+	_visible = set;
 	_visibleLock.unlockWrite();
 
-	_visibleLock.lockRead();
-	for (const auto& e : _visible) {
-		sendEntityUpdate(e);
-	}
-	_visibleLock.unlockRead();
+	sendVisibleUpdates();
 
 	if (!add.empty()) {
 		visibleAdd(add);
@@ -216,17 +221,6 @@ void Entity::updateVisible(const EntitySet& set) {
 	}
 }
 
-void Entity::sendEntityUpdate(const EntityPtr& entity) const {
-	if (_peer == nullptr) {
-		return;
-	}
-	const glm::vec3& _pos = entity->pos();
-	const network::Vec3 pos { _pos.x, _pos.y, _pos.z };
-	_entityUpdateFBB.Clear();
-	_messageSender->sendServerMessage(_peer, _entityUpdateFBB, network::ServerMsgType::EntityUpdate,
-			network::CreateEntityUpdate(_entityUpdateFBB, entity->id(), &pos, entity->orientation(), entity->animation()).Union());
-}
-
 void Entity::sendEntitySpawn(const EntityPtr& entity) const {
 	if (_peer == nullptr) {
 		return;
@@ -263,10 +257,15 @@ math::RectFloat Entity::rect() const {
 	return math::RectFloat(p.x - halfSize, p.z - halfSize, p.x + halfSize, p.z + halfSize);
 }
 
-math::RectFloat Entity::viewRect() const {
-	const glm::vec3 p = pos();
+float Entity::viewDistance() const {
 	const float viewDistance = (float)current(attrib::Type::VIEWDISTANCE);
 	core_assert_msg(viewDistance > 0.0f, "Expected to get a view distance > 0.0f, but got %f (EntityType: %i)", viewDistance, (int)entityType());
+	return viewDistance;
+}
+
+math::RectFloat Entity::viewRect() const {
+	const glm::vec3 p = pos();
+	const float viewDistance = this->viewDistance();
 	return math::RectFloat(p.x - viewDistance, p.z - viewDistance, p.x + viewDistance, p.z + viewDistance);
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/GLM.h"
+#include "core/collection/Array.h"
 #include "core/collection/Set.h"
 #include "core/concurrent/Concurrency.h"
 #include "math/Rect.h"
@@ -35,9 +36,10 @@ class Entity {
 private:
 	core::ReadWriteLock _visibleLock {"Entity"};
 	EntitySet _visible core_thread_guarded_by(_visibleLock);
+	// filled by the map with the entities in the view distance - reused every tick
+	EntitySet _visibleScratch;
 	// they are stored as members to reduce memory allocations
 	mutable flatbuffers::FlatBufferBuilder _attribUpdateFBB;
-	mutable flatbuffers::FlatBufferBuilder _entityUpdateFBB;
 	mutable flatbuffers::FlatBufferBuilder _entitySpawnFBB;
 	mutable flatbuffers::FlatBufferBuilder _entityRemoveFBB;
 
@@ -71,8 +73,13 @@ protected:
 	 */
 	void visibleRemove(const EntitySet& entities);
 
+	/**
+	 * @brief Called once per tick after the visible set was updated to send the states of the
+	 * visible entities to the client. Entities without a client don't have to do anything here.
+	 */
+	virtual void sendVisibleUpdates() {}
+
 	void broadcastAttribUpdate();
-	void sendEntityUpdate(const EntityPtr& entity) const;
 	void sendEntitySpawn(const EntityPtr& entity) const;
 	void sendEntityRemove(const EntityPtr& entity) const;
 
@@ -152,6 +159,12 @@ public:
 	 */
 	void updateVisible(const EntitySet& set);
 
+	/**
+	 * @brief Scratch set that is filled by the map with the currently visible entities before
+	 * @c updateVisible() is called. This is kept as member to not allocate the set for every tick.
+	 */
+	EntitySet& visibleScratch();
+
 	/**
 	 * @brief The tick of the entity
 	 * @param[in] dt The delta time (in millis) since the last tick was executed
@@ -186,6 +199,11 @@ public:
 	 */
 	math::RectFloat viewRect() const;
 
+	/**
+	 * @brief The radius around the entity position that defines which other entities are visible
+	 */
+	float viewDistance() const;
+
 	/**
 	 * @brief Check whether the given position can be seen by the entity.
 	 * @param[in] position The position to check
@@ -247,6 +265,10 @@ inline void Entity::setOrientation(float orientation) {
 	_orientation = orientation;
 }
 
+inline EntitySet& Entity::visibleScratch() {
+	return _visibleScratch;
+}
+
 inline EntityId Entity::id() const {
 	return _entityId;
 }
@@ -3,9 +3,6 @@
  */
 
 #include "attrib/ShadowAttributes.h"
-#if 0
-#include "voxelutil/AStarPathfinder.h"
-#endif
 #include "Npc.h"
 #include "ai/AICharacter.h"
 #include "ai/AI.h"
@@ -121,17 +118,44 @@ void Npc::updateAIState() {
 }
 
 bool Npc::route(const glm::vec3& target) {
-#if 0
-	std::list<glm::ivec3> result;
-	const glm::vec3& pos = _aiChr->getPosition();
-	const glm::ivec3 start(pos);
-	const glm::ivec3 end(target.x, target.y, target.z);
-	if (!_map->findPath(start, end, result)) {
+	const glm::ivec3 end(glm::floor(target));
+	if (_routeEnd != end) {
+		// the target changed - the current path and a pending request are dropped
+		_routeEnd = end;
+		_route = voxelworld::WorldPathfinder::PathPtr();
+		_routeRequest = std::future<voxelworld::WorldPathfinder::PathPtr>();
+		_routeFailed = false;
+	}
+	// the path is only requested again if the voxels along the remaining path were modified - the current
+	// path is followed until the new one is available
+	const int generation = _map->pathGeneration();
+	if (_route && _routeGeneration != generation && !_routeRequest.valid()
+			&& !_map->pathModified(*_route, _routeIndex, _routeGeneration)) {
+		_routeGeneration = generation;
+	}
+	if (!_routeRequest.valid() && ((!_route && !_routeFailed) || _routeGeneration != generation)) {
+		_routeGeneration = generation;
+		_routeRequest = _map->findPath(glm::ivec3(glm::floor(_aiChr->getPosition())), end);
+	}
+	if (_routeRequest.valid() && _routeRequest.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		_route = _routeRequest.get();
+		_routeIndex = 0u;
+		_routeFailed = !_route;
+	}
+	if (_routeFailed) {
 		return false;
 	}
-	// TODO: use the route
-	setTargetPosition(target);
-#endif
+	if (!_route) {
+		// still waiting for the first path
+		return true;
+	}
+	const voxelworld::WorldPathfinder::Path& path = *_route;
+	const glm::ivec3 current(glm::floor(_aiChr->getPosition()));
+	while (_routeIndex + 1 < path.size() && path[_routeIndex].x == current.x && path[_routeIndex].z == current.z) {
+		++_routeIndex;
+	}
+	const glm::ivec3& waypoint = path[_routeIndex];
+	setTargetPosition(glm::vec3((float)waypoint.x + 0.5f, (float)waypoint.y, (float)waypoint.z + 0.5f));
 	return true;
 }
 
@@ -12,8 +12,10 @@
 #include "backend/entity/EntityId.h"
 #include "backend/network/ServerMessageSender.h"
 #include "math/Random.h"
+#include "voxelworld/WorldPathfinder.h"
 
 #include <atomic>
+#include <future>
 
 namespace backend {
 
@@ -33,6 +35,18 @@ private:
 	// cooldowns
 	cooldown::CooldownMgr _cooldowns;
 
+	// the path request that is computed by the pathfinder of the map
+	std::future<voxelworld::WorldPathfinder::PathPtr> _routeRequest;
+	glm::ivec3 _routeEnd { 0 };
+	// the pathfinder generation the path was checked against - the path is requested again once one of its
+	// clusters was modified after this generation
+	int _routeGeneration = 0;
+	// the last request for @c _routeEnd didn't find a path
+	bool _routeFailed = false;
+	// the path that is currently followed and the index of the waypoint the npc walks to
+	voxelworld::WorldPathfinder::PathPtr _route;
+	size_t _routeIndex = 0u;
+
 	void moveToGround();
 
 	// transfer from ai to npc state
@@ -59,6 +73,10 @@ public:
 	const glm::vec3& homePosition() const;
 	void setTargetPosition(const glm::vec3& pos);
 	const glm::vec3& targetPosition() const;
+	/**
+	 * @brief Walks along a path to the given target - the path is computed asynchronously
+	 * @return @c false if there is no path to the target
+	 */
 	bool route(const glm::vec3& target);
 	const AIPtr& ai();
 
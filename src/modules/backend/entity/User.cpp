@@ -29,7 +29,8 @@ User::User(ENetPeer* peer, EntityId id,
 		_cooldownMgr(this, timeProvider, cooldownProvider, dbHandler, persistenceMgr),
 		_attribMgr(id, _attribs, dbHandler, persistenceMgr),
 		_logoutMgr(_cooldownMgr),
-		_movementMgr(this) {
+		_movementMgr(this),
+		_snapshotMgr(this, messageSender) {
 	setPeer(peer);
 	_entityType = network::EntityType::PLAYER;
 }
@@ -44,6 +45,7 @@ void User::init() {
 	_attribMgr.init();
 	_logoutMgr.init();
 	_movementMgr.init();
+	_snapshotMgr.init();
 }
 
 void User::sendVars() const {
@@ -73,12 +75,15 @@ void User::shutdown() {
 	_attribMgr.shutdown();
 	_logoutMgr.shutdown();
 	_movementMgr.shutdown();
+	_snapshotMgr.shutdown();
 	Super::shutdown();
 }
 
 ENetPeer* User::setPeer(ENetPeer* peer) {
 	ENetPeer* old = _peer;
 	_peer = peer;
+	// a new connection doesn't know any of the previous snapshots
+	_snapshotMgr.reset();
 	if (_peer) {
 		_peer->data = this;
 	}
@@ -139,6 +144,10 @@ void User::broadcastUserSpawn() const {
 	sendToVisible(fbb, network::ServerMsgType::UserSpawn, network::CreateUserSpawn(fbb, id(), fbb.CreateString(_name.c_str(), _name.size()), &pos).Union(), true);
 }
 
+void User::sendVisibleUpdates() {
+	_snapshotMgr.update();
+}
+
 bool User::sendMessage(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type, flatbuffers::Offset<void> msg) const {
 	if (_peer == nullptr) {
 		return false;
@@ -7,6 +7,49 @@
 
 namespace backend {
 
+AI::AI(const TreeNodePtr& behaviour) :
+		_behaviour(behaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
+	resetNodeStates();
+}
+
+void AI::resetNodeStates() {
+	if (_behaviour) {
+		_compiledTree = _behaviour->compile();
+	} else {
+		_compiledTree = CompiledTreePtr();
+	}
+	_nodeStates.clear();
+	if (_compiledTree) {
+		_nodeStates.resize(_compiledTree->size());
+	}
+	_detachedNodeStates.clear();
+}
+
+const AI::NodeState* AI::findNodeState(const TreeNode* node) const {
+	const int slot = node->getSlot();
+	if (slot >= 0 && slot < (int)_nodeStates.size() && _compiledTree->node(slot).node == node) {
+		return &_nodeStates[slot];
+	}
+	auto i = _detachedNodeStates.find(node->getId());
+	if (i == _detachedNodeStates.end()) {
+		return nullptr;
+	}
+	return &i->value;
+}
+
+AI::NodeState& AI::nodeState(const TreeNode* node) {
+	const int slot = node->getSlot();
+	if (slot >= 0 && slot < (int)_nodeStates.size() && _compiledTree->node(slot).node == node) {
+		return _nodeStates[slot];
+	}
+	auto i = _detachedNodeStates.find(node->getId());
+	if (i == _detachedNodeStates.end()) {
+		_detachedNodeStates.put(node->getId(), NodeState());
+		i = _detachedNodeStates.find(node->getId());
+	}
+	return i->value;
+}
+
 ai::CharacterId AI::getId() const {
 	if (!_character) {
 		return AI_NOTHING_SELECTED;
@@ -33,10 +76,11 @@ void AI::update(int64_t dt, bool debuggingActive) {
 	if (_reset) {
 		// safe to do it like this, because update is not called from multiple threads
 		_reset = false;
-		_lastStatus.clear();
-		_lastExecMillis.clear();
 		_filteredEntities.clear();
-		_selectorStates.clear();
+		resetNodeStates();
+	} else if (_behaviour && _behaviour->getCompiledTree() != _compiledTree) {
+		// the tree was modified and recompiled - the slots might have changed
+		resetNodeStates();
 	}
 
 	_debuggingActive = debuggingActive;
@@ -11,9 +11,12 @@
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/Atomic.h"
 #include "core/NonCopyable.h"
+#include "core/collection/Map.h"
+#include "tree/CompiledTree.h"
 #include "AIMessages_generated.h"
 
 #include <memory>
+#include <vector>
 #include <glm/vec3.hpp>
 
 namespace backend {
@@ -45,18 +48,30 @@ class AI : public core::NonCopyable {
 	friend class IFilter;
 	friend class Filter;
 	friend class Server;
-protected:
-	/**
-	 * This map is only filled if we are in debugging mode for this entity
-	 */
-	typedef core::Map<int, ai::TreeNodeStatus> NodeStates;
-	NodeStates _lastStatus;
+public:
 	/**
-	 * This map is only filled if we are in debugging mode for this entity
+	 * @brief The state of a @ai{TreeNode} for this entity
 	 */
-	typedef core::Map<int, uint64_t> LastExecMap;
-	LastExecMap _lastExecMillis;
-
+	struct NodeState {
+		/**
+		 * Often @ai{Selector} states must be stored to continue in the next step at a particular
+		 * position in the behaviour tree.
+		 */
+		int selectorState = AI_NOTHING_SELECTED;
+		/**
+		 * The amount of executions for the @ai{Limit} node
+		 */
+		int limitState = 0;
+		/**
+		 * Only updated if we are in debugging mode for this entity
+		 */
+		int64_t lastExecMillis = -1L;
+		/**
+		 * Only updated if we are in debugging mode for this entity
+		 */
+		ai::TreeNodeStatus lastStatus = ai::TreeNodeStatus::UNKNOWN;
+	};
+protected:
 	/**
 	 * @note The filtered entities are kept even over several ticks. The caller should decide
 	 * whether he still needs an old/previous filtered selection
@@ -65,17 +80,17 @@ protected:
 	mutable FilteredEntities _filteredEntities;
 
 	/**
-	 * Often @ai{Selector} states must be stored to continue in the next step at a particular
-	 * position in the behaviour tree. This map is doing exactly this.
+	 * The states of the nodes of the behaviour tree - indexed by the slot of the node in the compiled tree
+	 * @sa @ai{CompiledTree}
 	 */
-	typedef core::Map<int, int> SelectorStates;
-	SelectorStates _selectorStates;
-
+	std::vector<NodeState> _nodeStates;
+	CompiledTreePtr _compiledTree;
 	/**
-	 * This map stores the amount of execution for the @ai{Limit} node. The key is the node id
+	 * The states of the nodes that are not part of the compiled behaviour tree of this entity - the key is the
+	 * node id. This is only used if nodes are executed directly.
 	 */
-	typedef core::Map<int, int> LimitStates;
-	LimitStates _limitStates;
+	typedef core::Map<int, NodeState> DetachedNodeStates;
+	DetachedNodeStates _detachedNodeStates;
 
 	TreeNodePtr _behaviour;
 	AggroMgr _aggroMgr;
@@ -90,13 +105,24 @@ protected:
 	Zone* _zone;
 
 	core::AtomicBool _reset;
+
+	/**
+	 * @brief Compiles the behaviour tree if needed and resets all node states
+	 */
+	void resetNodeStates();
+	/**
+	 * @return The state of the given node or @c nullptr if there is no state for the node yet
+	 */
+	const NodeState* findNodeState(const TreeNode* node) const;
+	/**
+	 * @return The state of the given node - it is created if it doesn't exist yet
+	 */
+	NodeState& nodeState(const TreeNode* node);
 public:
 	/**
 	 * @param behaviour The behaviour tree node that is applied to this ai entity
 	 */
-	explicit AI(const TreeNodePtr& behaviour) :
-			_behaviour(behaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
-	}
+	explicit AI(const TreeNodePtr& behaviour);
 	virtual ~AI() {
 	}
 
@@ -19,6 +19,19 @@
 
 namespace backend {
 
+namespace {
+/**
+ * @brief Caches the lua state of the last registry that was used by this thread
+ */
+struct ThreadLuaState {
+	int registryId = -1;
+	int scripts = -1;
+	lua_State* state = nullptr;
+};
+thread_local ThreadLuaState _threadLuaState;
+core::AtomicInt _registryIds;
+}
+
 static void luaAI_setupmetatable(lua_State* s, const core::String& type, const luaL_Reg *funcs, const core::String& name) {
 	const core::String& metaFull = "__meta_" + name + "_" + type;
 	// make global
@@ -130,13 +143,24 @@ static int luaAI_nodetostring(lua_State* s) {
 static int luaAI_createnode(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUATreeNodeFactoryPtr& factory = std::make_shared<LuaNodeFactory>(s, type);
-	const bool inserted = r->registerNodeFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "tree node %s is already registered", type.c_str());
+	LuaNodeFactory* factory = nullptr;
+	if (r->isMainState(s)) {
+		const LUATreeNodeFactoryPtr& newFactory = std::make_shared<LuaNodeFactory>(r, type);
+		const bool inserted = r->registerNodeFactory(type, *newFactory);
+		if (!inserted) {
+			return clua_error(s, "tree node %s is already registered", type.c_str());
+		}
+		r->addTreeNodeFactory(type, newFactory);
+		factory = newFactory.get();
+	} else {
+		// the worker states replay the scripts of the main state - the factory was already registered there
+		factory = r->treeNodeFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "tree node %s is not registered in the main state", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaNodeFactory*>(s, factory.get());
+	clua_newuserdata<LuaNodeFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"execute", luaAI_nodeemptyexecute},
 		{"__tostring", luaAI_nodetostring},
@@ -144,7 +168,6 @@ static int luaAI_createnode(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "node");
-	r->addTreeNodeFactory(type, factory);
 	return 1;
 }
 
@@ -171,13 +194,24 @@ static int luaAI_conditiontostring(lua_State* s) {
 static int luaAI_createcondition(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAConditionFactoryPtr& factory = std::make_shared<LuaConditionFactory>(s, type);
-	const bool inserted = r->registerConditionFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "condition %s is already registered", type.c_str());
+	LuaConditionFactory* factory = nullptr;
+	if (r->isMainState(s)) {
+		const LUAConditionFactoryPtr& newFactory = std::make_shared<LuaConditionFactory>(r, type);
+		const bool inserted = r->registerConditionFactory(type, *newFactory);
+		if (!inserted) {
+			return clua_error(s, "condition %s is already registered", type.c_str());
+		}
+		r->addConditionFactory(type, newFactory);
+		factory = newFactory.get();
+	} else {
+		// the worker states replay the scripts of the main state - the factory was already registered there
+		factory = r->conditionFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "condition %s is not registered in the main state", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaConditionFactory*>(s, factory.get());
+	clua_newuserdata<LuaConditionFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"evaluate", luaAI_conditionemptyevaluate},
 		{"__tostring", luaAI_conditiontostring},
@@ -185,7 +219,6 @@ static int luaAI_createcondition(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "condition");
-	r->addConditionFactory(type, factory);
 	return 1;
 }
 
@@ -208,13 +241,24 @@ static int luaAI_filtertostring(lua_State* s) {
 static int luaAI_createfilter(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAFilterFactoryPtr& factory = std::make_shared<LuaFilterFactory>(s, type);
-	const bool inserted = r->registerFilterFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "filter %s is already registered", type.c_str());
+	LuaFilterFactory* factory = nullptr;
+	if (r->isMainState(s)) {
+		const LUAFilterFactoryPtr& newFactory = std::make_shared<LuaFilterFactory>(r, type);
+		const bool inserted = r->registerFilterFactory(type, *newFactory);
+		if (!inserted) {
+			return clua_error(s, "filter %s is already registered", type.c_str());
+		}
+		r->addFilterFactory(type, newFactory);
+		factory = newFactory.get();
+	} else {
+		// the worker states replay the scripts of the main state - the factory was already registered there
+		factory = r->filterFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "filter %s is not registered in the main state", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaFilterFactory*>(s, factory.get());
+	clua_newuserdata<LuaFilterFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"filter", luaAI_filteremptyfilter},
 		{"__tostring", luaAI_filtertostring},
@@ -222,7 +266,6 @@ static int luaAI_createfilter(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "filter");
-	r->addFilterFactory(type, factory);
 	return 1;
 }
 
@@ -240,13 +283,24 @@ static int luaAI_steeringtostring(lua_State* s) {
 static int luaAI_createsteering(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUASteeringFactoryPtr& factory = std::make_shared<LuaSteeringFactory>(s, type);
-	const bool inserted = r->registerSteeringFactory(type, *factory);
-	if (!inserted) {
-		return clua_error(s, "steering %s is already registered", type.c_str());
+	LuaSteeringFactory* factory = nullptr;
+	if (r->isMainState(s)) {
+		const LUASteeringFactoryPtr& newFactory = std::make_shared<LuaSteeringFactory>(r, type);
+		const bool inserted = r->registerSteeringFactory(type, *newFactory);
+		if (!inserted) {
+			return clua_error(s, "steering %s is already registered", type.c_str());
+		}
+		r->addSteeringFactory(type, newFactory);
+		factory = newFactory.get();
+	} else {
+		// the worker states replay the scripts of the main state - the factory was already registered there
+		factory = r->steeringFactory(type);
+		if (factory == nullptr) {
+			return clua_error(s, "steering %s is not registered in the main state", type.c_str());
+		}
 	}
 
-	clua_newuserdata<LuaSteeringFactory*>(s, factory.get());
+	clua_newuserdata<LuaSteeringFactory*>(s, factory);
 	const luaL_Reg nodes[] = {
 		{"filter", luaAI_steeringemptyexecute},
 		{"__tostring", luaAI_steeringtostring},
@@ -254,33 +308,209 @@ static int luaAI_createsteering(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "steering");
-	r->addSteeringFactory(type, factory);
 	return 1;
 }
 
-LUAAIRegistry::LUAAIRegistry() {
+/***
+ * Stores a value that is visible in the lua states of all threads
+ * @par string key
+ * @par value nil, boolean, number or string
+ * @function REGISTRY.setShared
+ */
+static int luaAI_setshared(lua_State* s) {
+	LUAAIRegistry* r = luaAI_toregistry(s);
+	const char* key = luaL_checkstring(s, 1);
+	LUAAIRegistry::SharedValue value;
+	value.type = lua_type(s, 2);
+	switch (value.type) {
+	case LUA_TNIL:
+	case LUA_TNONE:
+		value.type = LUA_TNIL;
+		break;
+	case LUA_TBOOLEAN:
+		value.number = lua_toboolean(s, 2);
+		break;
+	case LUA_TNUMBER:
+		value.number = lua_tonumber(s, 2);
+		break;
+	case LUA_TSTRING:
+		value.string = lua_tostring(s, 2);
+		break;
+	default:
+		return clua_error(s, "Only nil, boolean, number and string values can be shared - got %s for %s", luaL_typename(s, 2), key);
+	}
+	r->setSharedValue(key, value);
+	return 0;
+}
+
+/***
+ * Get a value that was stored with @c REGISTRY.setShared
+ * @par string key
+ * @return the shared value or nil
+ * @function REGISTRY.shared
+ */
+static int luaAI_shared(lua_State* s) {
+	LUAAIRegistry* r = luaAI_toregistry(s);
+	const char* key = luaL_checkstring(s, 1);
+	LUAAIRegistry::SharedValue value;
+	if (!r->sharedValue(key, value)) {
+		lua_pushnil(s);
+		return 1;
+	}
+	switch (value.type) {
+	case LUA_TBOOLEAN:
+		lua_pushboolean(s, value.number != 0);
+		break;
+	case LUA_TNUMBER:
+		lua_pushnumber(s, value.number);
+		break;
+	case LUA_TSTRING:
+		lua_pushstring(s, value.string.c_str());
+		break;
+	default:
+		lua_pushnil(s);
+		break;
+	}
+	return 1;
+}
+
+LUAAIRegistry::LUAAIRegistry() :
+		_mainThread(std::this_thread::get_id()), _id(_registryIds.increment()) {
 	_s = _lua.state();
 	// TODO: random module
 
 	lua_gc(_s, LUA_GCSTOP, 0);
+	setupState(_s);
+}
 
+void LUAAIRegistry::setupState(lua_State* s) {
 	static const luaL_Reg registryFuncs[] = {
 		{"createNode", luaAI_createnode},
 		{"createCondition", luaAI_createcondition},
 		{"createFilter", luaAI_createfilter},
 		{"createSteering", luaAI_createsteering},
+		{"setShared", luaAI_setshared},
+		{"shared", luaAI_shared},
 		{nullptr, nullptr}
 	};
-	clua_registerfuncsglobal(_s, registryFuncs, "META_REGISTRY", "REGISTRY");
+	clua_registerfuncsglobal(s, registryFuncs, "META_REGISTRY", "REGISTRY");
 
-	luaAI_globalpointer(_s, this, luaAI_metaregistry());
-	luaAI_registerAll(_s);
+	luaAI_globalpointer(s, this, luaAI_metaregistry());
+	luaAI_registerAll(s);
 }
 
 lua_State* LUAAIRegistry::getLuaState() {
 	return _s;
 }
 
+lua_State* LUAAIRegistry::threadLuaState() {
+	if (std::this_thread::get_id() == _mainThread) {
+		return _s;
+	}
+	if (_threadLuaState.registryId == _id && _threadLuaState.scripts == _scriptCount) {
+		return _threadLuaState.state;
+	}
+	return workerLuaState();
+}
+
+lua_State* LUAAIRegistry::workerLuaState() {
+	core_trace_scoped(LUAAIRegistryWorkerState);
+	WorkerState* worker;
+	core::DynamicArray<core::String> scripts;
+	{
+		core::ScopedLock scopedLock(_lock);
+		const std::thread::id threadId = std::this_thread::get_id();
+		auto i = _workerStates.find(threadId);
+		if (i == _workerStates.end()) {
+			Log::debug("Create lua state for a new worker thread");
+			worker = new WorkerState();
+			_workerStates.emplace(threadId, std::unique_ptr<WorkerState>(worker));
+			setupState(worker->lua.state());
+		} else {
+			worker = i->second.get();
+		}
+		for (int n = worker->scripts; n < (int)_scripts.size(); ++n) {
+			scripts.push_back(_scripts[n]);
+		}
+	}
+
+	// the scripts are executed without holding the lock - they register their definitions by
+	// looking up the factories of the main state
+	lua_State* s = worker->lua.state();
+	for (const core::String& script : scripts) {
+		if (luaL_loadbufferx(s, script.c_str(), script.size(), "", nullptr) || lua_pcall(s, 0, 0, 0)) {
+			Log::error("%s", lua_tostring(s, -1));
+			lua_pop(s, 1);
+		}
+	}
+	worker->scripts += (int)scripts.size();
+
+	_threadLuaState.registryId = _id;
+	_threadLuaState.scripts = worker->scripts;
+	_threadLuaState.state = s;
+	return s;
+}
+
+LuaNodeFactory* LUAAIRegistry::treeNodeFactory(const core::String& type) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _treeNodeFactories.find(type);
+	if (i == _treeNodeFactories.end()) {
+		return nullptr;
+	}
+	return i->second.get();
+}
+
+LuaConditionFactory* LUAAIRegistry::conditionFactory(const core::String& type) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _conditionFactories.find(type);
+	if (i == _conditionFactories.end()) {
+		return nullptr;
+	}
+	return i->second.get();
+}
+
+LuaFilterFactory* LUAAIRegistry::filterFactory(const core::String& type) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _filterFactories.find(type);
+	if (i == _filterFactories.end()) {
+		return nullptr;
+	}
+	return i->second.get();
+}
+
+LuaSteeringFactory* LUAAIRegistry::steeringFactory(const core::String& type) {
+	core::ScopedLock scopedLock(_lock);
+	auto i = _steeringFactories.find(type);
+	if (i == _steeringFactories.end()) {
+		return nullptr;
+	}
+	return i->second.get();
+}
+
+void LUAAIRegistry::setSharedValue(const core::String& key, const SharedValue& value) {
+	core::ScopedLock scopedLock(_lock);
+	if (value.type == LUA_TNIL) {
+		_sharedValues.remove(key);
+		return;
+	}
+	_sharedValues.put(key, value);
+}
+
+bool LUAAIRegistry::sharedValue(const core::String& key, SharedValue& value) {
+	core::ScopedLock scopedLock(_lock);
+	return _sharedValues.get(key, value);
+}
+
+void LUAAIRegistry::collectGarbage() {
+	if (_s != nullptr) {
+		lua_gc(_s, LUA_GCCOLLECT, 0);
+	}
+	core::ScopedLock scopedLock(_lock);
+	for (auto& e : _workerStates) {
+		lua_gc(e.second->lua.state(), LUA_GCCOLLECT, 0);
+	}
+}
+
 int LUAAIRegistry::pushAIMetatable() {
 	core_assert_msg(_s != nullptr, "LUA state is not yet initialized");
 	return luaL_getmetatable(_s, luaAI_metaai());
@@ -295,9 +525,7 @@ bool LUAAIRegistry::init(const core::String& file) {
 	const char* script = ""
 		"UNKNOWN, CANNOTEXECUTE, RUNNING, FINISHED, FAILED, EXCEPTION = 0, 1, 2, 3, 4, 5\n";
 
-	if (luaL_loadbufferx(_s, script, SDL_strlen(script), "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-		Log::error("%s", lua_tostring(_s, -1));
-		lua_pop(_s, 1);
+	if (!evaluate(script, SDL_strlen(script))) {
 		return false;
 	}
 	const core::String& btScript = io::filesystem()->load(file);
@@ -316,7 +544,13 @@ void LUAAIRegistry::shutdown() {
 		_conditionFactories.clear();
 		_filterFactories.clear();
 		_steeringFactories.clear();
+		_workerStates.clear();
+		_scripts.clear();
+		_sharedValues.clear();
 	}
+	_scriptCount = 0;
+	// invalidate the states that are cached by the worker threads
+	_id = _registryIds.increment();
 	_s = nullptr;
 }
 
@@ -334,6 +568,11 @@ bool LUAAIRegistry::evaluate(const char* luaBuffer, size_t size) {
 		lua_pop(_s, 1);
 		return false;
 	}
+	{
+		core::ScopedLock scopedLock(_lock);
+		_scripts.push_back(core::String(luaBuffer, size));
+	}
+	_scriptCount.increment();
 	return true;
 }
 
@@ -9,12 +9,18 @@
 #include "core/Trace.h"
 #include "core/concurrent/Concurrency.h"
 #include "core/concurrent/Lock.h"
+#include "core/concurrent/Atomic.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
 #include "commonlua/LUA.h"
 #include "backend/entity/ai/tree/LUATreeNode.h"
 #include "backend/entity/ai/condition/LUACondition.h"
 #include "backend/entity/ai/filter/LUAFilter.h"
 #include "backend/entity/ai/movement/LUASteering.h"
 #include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 
 namespace backend {
 
@@ -86,17 +92,57 @@ typedef std::map<core::String, LUASteeringFactoryPtr> SteeringFactoryMap;
  * @par AI metatable
  * There is a metatable that you can modify by calling @ai{LUAAIRegistry::pushAIMetatable()}.
  * This metatable is applied to all @ai{AI} pointers that are forwarded to the lua functions.
+ *
+ * @par Threading
+ * The nodes, conditions, filters and steerings are executed in the lua state of the calling thread
+ * (see @ai{LUAAIRegistry::threadLuaState()}). The thread that created the registry uses the main state,
+ * every other thread gets its own state on first use. All scripts that were loaded with evaluate() are
+ * executed in each of these states - so they share the definitions, but not the lua globals. Values that
+ * must be visible to all states have to be shared explicitly:
+ * @code
+ * REGISTRY.setShared("alarm", true)
+ * local alarm = REGISTRY.shared("alarm")
+ * @endcode
+ * Only @c nil, booleans, numbers and strings can be shared.
  */
 class LUAAIRegistry : public AIRegistry {
+public:
+	/**
+	 * @brief A value that is shared between the lua states of all threads
+	 */
+	struct SharedValue {
+		// LUA_TNIL, LUA_TBOOLEAN, LUA_TNUMBER or LUA_TSTRING
+		int type = LUA_TNIL;
+		lua_Number number = 0;
+		core::String string;
+	};
 protected:
+	// the state of the thread that created the registry - the factories are registered by this state
 	lua::LUA _lua;
 	lua_State* _s = nullptr;
+	const std::thread::id _mainThread;
+	// identifies this registry in the per-thread state cache
+	int _id;
+
+	struct WorkerState {
+		lua::LUA lua;
+		// the amount of scripts that were already evaluated in this state
+		int scripts = 0;
+	};
 
 	core_trace_mutex(core::Lock, _lock, "LUAAIRegistry");
 	TreeNodeFactoryMap _treeNodeFactories core_thread_guarded_by(_lock);
 	ConditionFactoryMap _conditionFactories core_thread_guarded_by(_lock);
 	FilterFactoryMap _filterFactories core_thread_guarded_by(_lock);
 	SteeringFactoryMap _steeringFactories core_thread_guarded_by(_lock);
+	std::unordered_map<std::thread::id, std::unique_ptr<WorkerState>> _workerStates core_thread_guarded_by(_lock);
+	// the scripts that were evaluated in the main state - they are replayed in each worker state
+	core::DynamicArray<core::String> _scripts core_thread_guarded_by(_lock);
+	core::AtomicInt _scriptCount;
+	core::StringMap<SharedValue> _sharedValues core_thread_guarded_by(_lock);
+
+	void setupState(lua_State* s);
+	lua_State* workerLuaState();
 public:
 	LUAAIRegistry();
 
@@ -106,15 +152,50 @@ public:
 	void addSteeringFactory(const core::String& type, const LUASteeringFactoryPtr& factory);
 
 	/**
-	 * @brief Access to the lua state.
+	 * @brief Access to the main lua state.
 	 * @see pushAIMetatable()
+	 * @see threadLuaState()
 	 */
 	lua_State* getLuaState();
 
+	/**
+	 * @brief The lua state of the calling thread. This is the main state for the thread that created the
+	 * registry. All other threads get their own state - it is created on first use and brought up to date
+	 * with the scripts that were evaluated in the meantime.
+	 * @note This doesn't lock once the state of the calling thread is up to date
+	 */
+	lua_State* threadLuaState();
+
+	/**
+	 * @return @c true if the given state is the main state that registers the factories
+	 */
+	inline bool isMainState(const lua_State* s) const {
+		return s == _s;
+	}
+
+	LuaNodeFactory* treeNodeFactory(const core::String& type);
+	LuaConditionFactory* conditionFactory(const core::String& type);
+	LuaFilterFactory* filterFactory(const core::String& type);
+	LuaSteeringFactory* steeringFactory(const core::String& type);
+
+	void setSharedValue(const core::String& key, const SharedValue& value);
+	/**
+	 * @return @c false if there is no shared value for the given key
+	 */
+	bool sharedValue(const core::String& key, SharedValue& value);
+
+	/**
+	 * @brief Performs a full garbage collection cycle in the main state and all worker states
+	 * @note Must not be called while lua nodes, conditions, filters or steerings are executed
+	 */
+	void collectGarbage();
+
 	/**
 	 * @brief Pushes the AI metatable onto the stack. This allows anyone to modify it
 	 * to provide own functions and data that is applied to the @c ai parameters of the
 	 * lua functions.
+	 * @note This is the metatable of the main state - use evaluate() for changes that should be
+	 * applied to the worker states, too.
 	 * @note lua_ctxai() can be used in your lua c callbacks to get access to the
 	 * @ai{AI} pointer: @code const AI* ai = lua_ctxai(s, 1); @endcode
 	 */
@@ -144,9 +225,11 @@ public:
 
 	/**
 	 * @brief Load your lua scripts into the lua state of the registry.
-	 * This can be called multiple times to e.g. load multiple files.
+	 * This can be called multiple times to e.g. load multiple files. The script is evaluated in the main
+	 * state and replayed in the worker states the next time they are used.
 	 * @return @c true if the lua script was loaded, @c false otherwise
 	 * @note you have to call init() before
+	 * @note must be called from the thread that created the registry
 	 */
 	bool evaluate(const char* luaBuffer, size_t size);
 };
@@ -7,6 +7,7 @@
 #include "Complement.h"
 #include "core/Algorithm.h"
 #include "core/Common.h"
+#include "core/collection/Array.h"
 #include "FilteredEntities.h"
 #include "FilterUtil.h"
 
@@ -6,6 +6,7 @@
 #include "ai-shared/common/CharacterId.h"
 #include "core/Algorithm.h"
 #include "core/Common.h"
+#include "core/collection/Array.h"
 #include "FilteredEntities.h"
 #include "FilterUtil.h"
 
@@ -8,6 +8,9 @@
 #include "commonlua/LUA.h"
 
 namespace backend {
+
+class LUAAIRegistry;
+
 namespace movement {
 
 /**
@@ -15,7 +18,7 @@ namespace movement {
  */
 class LUASteering : public ISteering {
 protected:
-	mutable lua_State* _s;
+	LUAAIRegistry* _registry;
 	core::String _type;
 
 	MoveVector executeLUA(const AIPtr& entity, float speed) const;
@@ -23,11 +26,11 @@ protected:
 public:
 	class LUASteeringFactory : public ISteeringFactory {
 	private:
-		lua_State* _s;
+		LUAAIRegistry* _registry;
 		core::String _type;
 	public:
-		LUASteeringFactory(lua_State* s, const core::String& typeStr) :
-				_s(s), _type(typeStr) {
+		LUASteeringFactory(LUAAIRegistry* registry, const core::String& typeStr) :
+				_registry(registry), _type(typeStr) {
 		}
 
 		inline const core::String& type() const {
@@ -35,11 +38,11 @@ public:
 		}
 
 		SteeringPtr create(const SteeringFactoryContext* ctx) const override {
-			return std::make_shared<LUASteering>(_s, _type);
+			return std::make_shared<LUASteering>(_registry, _type);
 		}
 	};
 
-	LUASteering(lua_State* s, const core::String& type);
+	LUASteering(LUAAIRegistry* registry, const core::String& type);
 
 	~LUASteering() {
 	}
@@ -442,6 +442,8 @@ bool Server::updateNode(const ai::CharacterId& characterId, int32_t nodeId, cons
 			return false;
 		}
 		parent->replaceChild(nodeId, newNode);
+		// the ai instances with this behaviour pick up the new slots with their next update
+		root->compile(true);
 	}
 
 	Event event;
@@ -480,6 +482,7 @@ bool Server::addNode(const ai::CharacterId& characterId, int32_t parentNodeId, c
 	if (!node->addChild(newNode)) {
 		return false;
 	}
+	ai->getBehaviour()->compile(true);
 
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
@@ -506,6 +509,7 @@ bool Server::deleteNode(const ai::CharacterId& characterId, int32_t nodeId) {
 		return false;
 	}
 	parent->replaceChild(nodeId, TreeNodePtr());
+	root->compile(true);
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
 	event.data.zone = zone;
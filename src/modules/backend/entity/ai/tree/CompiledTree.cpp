@@ -0,0 +1,38 @@
+/**
+ * @file
+ */
+
+#include "CompiledTree.h"
+#include "TreeNode.h"
+
+namespace backend {
+
+CompiledTree::CompiledTree(TreeNode* root) {
+	add(root, -1);
+	addChildren(0);
+}
+
+int CompiledTree::add(TreeNode* node, int parent) {
+	const int slot = (int)_nodes.size();
+	node->_slot = slot;
+	_nodes.push_back(Node{node, parent});
+	return slot;
+}
+
+void CompiledTree::addChildren(int slot) {
+	const TreeNodes& children = _nodes[slot].node->getChildren();
+	if (children.empty()) {
+		return;
+	}
+	// reserve the slots for all children first to get a contiguous range
+	const int firstChild = (int)_nodes.size();
+	for (const TreeNodePtr& child : children) {
+		add(child.get(), slot);
+	}
+	const int childCount = (int)children.size();
+	for (int i = 0; i < childCount; ++i) {
+		addChildren(firstChild + i);
+	}
+}
+
+}
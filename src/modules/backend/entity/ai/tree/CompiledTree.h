@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace backend {
+
+class TreeNode;
+class CompiledTree;
+typedef std::shared_ptr<const CompiledTree> CompiledTreePtr;
+
+/**
+ * @brief The flattened representation of a behaviour tree.
+ *
+ * All nodes of the tree are stored in one contiguous array. The children of a node are stored next to each
+ * other. The slot of a node is its index in this array and is
+ * also assigned to the @c TreeNode itself. The @c AI instances are storing their node states in a dense array
+ * that is indexed by these slots instead of looking them up by node id.
+ *
+ * @note A @c TreeNode instance can only be part of one compiled tree at a time.
+ * @sa TreeNode::compile()
+ */
+class CompiledTree {
+public:
+	struct Node {
+		TreeNode* node;
+		/**
+		 * @brief The slot of the parent node or @c -1 for the root node
+		 */
+		int parent;
+	};
+private:
+	std::vector<Node> _nodes;
+
+	int add(TreeNode* node, int parent);
+	void addChildren(int slot);
+public:
+	/**
+	 * @brief Assigns the slots to all nodes of the tree with the given root node
+	 */
+	explicit CompiledTree(TreeNode* root);
+
+	/**
+	 * @return The amount of nodes in the tree
+	 */
+	int size() const;
+	const Node& node(int slot) const;
+	const Node* begin() const;
+	const Node* end() const;
+};
+
+inline int CompiledTree::size() const {
+	return (int)_nodes.size();
+}
+
+inline const CompiledTree::Node& CompiledTree::node(int slot) const {
+	return _nodes[slot];
+}
+
+inline const CompiledTree::Node* CompiledTree::begin() const {
+	return _nodes.data();
+}
+
+inline const CompiledTree::Node* CompiledTree::end() const {
+	return _nodes.data() + _nodes.size();
+}
+
+}
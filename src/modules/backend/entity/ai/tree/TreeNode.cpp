@@ -7,13 +7,35 @@
 #include "backend/entity/ai/condition/ICondition.h"
 #include "core/Assert.h"
 #include "core/Algorithm.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
 
 namespace backend {
 
+static core_trace_mutex(core::Lock, _compileLock, "CompiledTree");
+
 int TreeNode::getId() const {
 	return _id;
 }
 
+int TreeNode::getSlot() const {
+	return _slot;
+}
+
+CompiledTreePtr TreeNode::compile(bool force) {
+	// the same tree is usually shared by a lot of ai instances that might be created concurrently
+	core::ScopedLock lock(_compileLock);
+	if (force || !_compiledTree) {
+		// the ai instances are checking for a new tree without taking the lock
+		std::atomic_store(&_compiledTree, std::make_shared<const CompiledTree>(this));
+	}
+	return _compiledTree;
+}
+
+CompiledTreePtr TreeNode::getCompiledTree() const {
+	return std::atomic_load(&_compiledTree);
+}
+
 void TreeNode::setName(const core::String& name) {
 	if (name.empty()) {
 		return;
@@ -71,38 +93,38 @@ void TreeNode::setLastExecMillis(const AIPtr& entity) {
 	if (!entity->_debuggingActive) {
 		return;
 	}
-	entity->_lastExecMillis.put(getId(), entity->_time);
+	entity->nodeState(this).lastExecMillis = entity->_time;
 }
 
 int TreeNode::getSelectorState(const AIPtr& entity) const {
-	auto i = entity->_selectorStates.find(getId());
-	if (i == entity->_selectorStates.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(this);
+	if (nodeState == nullptr) {
 		return AI_NOTHING_SELECTED;
 	}
-	return i->second;
+	return nodeState->selectorState;
 }
 
 void TreeNode::setSelectorState(const AIPtr& entity, int selected) {
-	entity->_selectorStates.put(getId(), selected);
+	entity->nodeState(this).selectorState = selected;
 }
 
 int TreeNode::getLimitState(const AIPtr& entity) const {
-	auto i = entity->_limitStates.find(getId());
-	if (i == entity->_limitStates.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(this);
+	if (nodeState == nullptr) {
 		return 0;
 	}
-	return i->second;
+	return nodeState->limitState;
 }
 
 void TreeNode::setLimitState(const AIPtr& entity, int amount) {
-	entity->_limitStates.put(getId(), amount);
+	entity->nodeState(this).limitState = amount;
 }
 
 ai::TreeNodeStatus TreeNode::state(const AIPtr& entity, ai::TreeNodeStatus treeNodeState) {
 	if (!entity->_debuggingActive) {
 		return treeNodeState;
 	}
-	entity->_lastStatus.put(getId(), treeNodeState);
+	entity->nodeState(this).lastStatus = treeNodeState;
 	return treeNodeState;
 }
 
@@ -110,22 +132,22 @@ int64_t TreeNode::getLastExecMillis(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return -1L;
 	}
-	auto i = entity->_lastExecMillis.find(getId());
-	if (i == entity->_lastExecMillis.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(this);
+	if (nodeState == nullptr) {
 		return -1L;
 	}
-	return i->second;
+	return nodeState->lastExecMillis;
 }
 
 ai::TreeNodeStatus TreeNode::getLastStatus(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return ai::TreeNodeStatus::UNKNOWN;
 	}
-	auto i = entity->_lastStatus.find(getId());
-	if (i == entity->_lastStatus.end()) {
+	const AI::NodeState* nodeState = entity->findNodeState(this);
+	if (nodeState == nullptr) {
 		return ai::TreeNodeStatus::UNKNOWN;
 	}
-	return i->second;
+	return nodeState->lastStatus;
 }
 
 TreeNodePtr TreeNode::getChild(int id) const {
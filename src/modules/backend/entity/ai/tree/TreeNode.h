@@ -5,6 +5,7 @@
 
 #include "backend/entity/ai/AIFactories.h"
 #include "backend/entity/ai/common/MemoryAllocator.h"
+#include "CompiledTree.h"
 #include "AIMessages_generated.h"
 #include "core/String.h"
 
@@ -61,6 +62,7 @@ public: \
  * to store your state!
  */
 class TreeNode : public MemObject {
+	friend class CompiledTree;
 protected:
 	static int getNextId() {
 		static int _nextId;
@@ -76,6 +78,16 @@ protected:
 	core::String _type;
 	core::String _parameters;
 	ConditionPtr _condition;
+	/**
+	 * @brief The index of this node in the @c CompiledTree it is part of - or @c -1 if the node
+	 * was not yet compiled.
+	 */
+	int _slot = -1;
+	/**
+	 * @brief Only set for the root nodes of a behaviour tree - this is published with the atomic
+	 * @c std::shared_ptr functions, as the ai instances are reading it without the compile lock
+	 */
+	CompiledTreePtr _compiledTree;
 
 	ai::TreeNodeStatus state(const AIPtr& entity, ai::TreeNodeStatus treeNodeState);
 	int getSelectorState(const AIPtr& entity) const;
@@ -104,6 +116,25 @@ public:
 	 */
 	int getId() const;
 
+	/**
+	 * @brief The index of the node in the flattened tree that is used to address the per @c AI node states.
+	 * @return @c -1 if the node is not part of a compiled tree.
+	 * @sa compile()
+	 */
+	int getSlot() const;
+
+	/**
+	 * @brief Flattens the behaviour tree with this node as root and assigns the slots to all of its nodes.
+	 * @param[in] force The compiled tree is cached - if the tree was modified afterwards (e.g. with
+	 * @c addChild() or @c replaceChild()), you have to force a recompilation.
+	 */
+	CompiledTreePtr compile(bool force = false);
+	/**
+	 * @return The compiled tree if this is the root node of a compiled behaviour tree
+	 * @note This is safe to call while another thread recompiles the tree
+	 */
+	CompiledTreePtr getCompiledTree() const;
+
 	/**
 	 * @brief Each node can have a user defines name that can be retrieved with this method.
 	 */
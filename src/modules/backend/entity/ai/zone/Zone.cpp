@@ -10,9 +10,9 @@ namespace backend {
 
 Zone::~Zone() {
 	_threadPool.shutdown();
-	for (const auto& e : _ais) {
-		e.second->setZone(nullptr);
-		_groupManager.removeFromAllGroups(e.second);
+	for (const AIPtr& ai : *_ais) {
+		ai->setZone(nullptr);
+		_groupManager.removeFromAllGroups(ai);
 	}
 	for (const auto& ai : _scheduledAdd) {
 		ai->setZone(nullptr);
@@ -21,22 +21,46 @@ Zone::~Zone() {
 	for (const auto& ai : _scheduledRemove) {
 		doRemoveAI(ai);
 	}
-	_ais.clear();
+	_aiIndices.clear();
+	_ais = std::shared_ptr<AIScheduleList>();
 }
 
 AIPtr Zone::getAI(ai::CharacterId id) const {
 	core::ScopedLock scopedLock(_lock);
-	auto i = _ais.find(id);
-	if (i == _ais.end()) {
+	auto i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return AIPtr();
 	}
-	const AIPtr& ai = i->second;
+	const AIPtr& ai = (*_ais)[i->second];
 	return ai;
 }
 
+Zone::AIListPtr Zone::aiList() const {
+	core::ScopedLock scopedLock(_lock);
+	return _ais;
+}
+
 size_t Zone::size() const {
 	core::ScopedLock scopedLock(_lock);
-	return _ais.size();
+	return _ais->size();
+}
+
+Zone::AIScheduleList& Zone::mutableAIs() {
+	if (_ais.use_count() > 1) {
+		_ais = std::make_shared<AIScheduleList>(*_ais);
+	}
+	return *_ais;
+}
+
+void Zone::eraseAI(AIIndexMap::iterator i) {
+	AIScheduleList& ais = mutableAIs();
+	const size_t index = i->second;
+	_aiIndices.erase(i);
+	if (index != ais.size() - 1) {
+		ais[index] = core::move(ais.back());
+		_aiIndices[ais[index]->getId()] = index;
+	}
+	ais.pop_back();
 }
 
 bool Zone::doAddAI(const AIPtr& ai) {
@@ -44,31 +68,34 @@ bool Zone::doAddAI(const AIPtr& ai) {
 		return false;
 	}
 	const ai::CharacterId& id = ai->getCharacter()->getId();
-	if (_ais.find(id) != _ais.end()) {
+	if (_aiIndices.find(id) != _aiIndices.end()) {
 		return false;
 	}
-	_ais.insert(std::make_pair(id, ai));
+	AIScheduleList& ais = mutableAIs();
+	_aiIndices.insert(std::make_pair(id, ais.size()));
+	ais.push_back(ai);
 	ai->setZone(this);
 	return true;
 }
 
 bool Zone::doRemoveAI(const ai::CharacterId& id) {
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMap::iterator i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return false;
 	}
-	i->second->setZone(nullptr);
-	_groupManager.removeFromAllGroups(i->second);
-	_ais.erase(i);
+	const AIPtr& ai = (*_ais)[i->second];
+	ai->setZone(nullptr);
+	_groupManager.removeFromAllGroups(ai);
+	eraseAI(i);
 	return true;
 }
 
 bool Zone::doDestroyAI(const ai::CharacterId& id) {
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMap::iterator i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return false;
 	}
-	_ais.erase(i);
+	eraseAI(i);
 	return true;
 }
 
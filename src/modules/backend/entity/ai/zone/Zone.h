@@ -40,15 +40,27 @@ typedef std::shared_ptr<AI> AIPtr;
  */
 class Zone {
 public:
-	typedef std::unordered_map<ai::CharacterId, AIPtr> AIMap;
 	typedef std::vector<AIPtr> AIScheduleList;
 	typedef std::vector<ai::CharacterId> CharacterIdList;
-	typedef AIMap::const_iterator AIMapConstIter;
-	typedef AIMap::iterator AIMapIter;
+	/**
+	 * @brief Flat list of the zone members. A running tick keeps a reference to the list it is
+	 * iterating - modifications in @c Zone::update are performed on a copy in that case.
+	 */
+	typedef std::shared_ptr<const AIScheduleList> AIListPtr;
+	/**
+	 * @brief Maps the character id to the index in the flat member list
+	 */
+	typedef std::unordered_map<ai::CharacterId, size_t> AIIndexMap;
 
 protected:
+	/**
+	 * @brief The amount of contiguous @c AI instances a worker takes at once in @c executeParallel
+	 */
+	static constexpr int ParallelBatchSize = 64;
+
 	const core::String _name;
-	AIMap _ais core_thread_guarded_by(_lock);
+	std::shared_ptr<AIScheduleList> _ais core_thread_guarded_by(_lock);
+	AIIndexMap _aiIndices core_thread_guarded_by(_lock);
 	AIScheduleList _scheduledAdd core_thread_guarded_by(_scheduleLock);
 	CharacterIdList _scheduledRemove core_thread_guarded_by(_scheduleLock);
 	CharacterIdList _scheduledDestroy core_thread_guarded_by(_scheduleLock);
@@ -77,10 +89,41 @@ protected:
 	 * @note This doesn't lock the zone - because @c Zone::update already does it
 	 */
 	bool doDestroyAI(const ai::CharacterId& id);
+	/**
+	 * @brief Removes the list entry by moving the last entry into its slot
+	 * @note This doesn't lock the zone - because @c Zone::update already does it
+	 */
+	void eraseAI(AIIndexMap::iterator i);
+	/**
+	 * @return The member list for modification. If a tick is currently iterating the list, a
+	 * copy is made before.
+	 * @note This doesn't lock the zone - because @c Zone::update already does it
+	 */
+	AIScheduleList& mutableAIs();
+
+	/**
+	 * @return The current zone members without copying them
+	 * @note This locks the zone for reading
+	 */
+	AIListPtr aiList() const;
+
+	/**
+	 * @brief Splits the given list into batches of @c ParallelBatchSize and let the workers
+	 * of the thread pool and the calling thread process them. Returns once all @c AI instances
+	 * were handled.
+	 */
+	template<typename Func>
+	void parallelFor(const AIScheduleList& ais, Func& func) const {
+		_threadPool.parallelFor(0, (int)ais.size(), ParallelBatchSize, [&] (int start, int end) {
+			for (int i = start; i < end; ++i) {
+				func(ais[i]);
+			}
+		});
+	}
 
 public:
 	Zone(const core::String& name, int threadCount = 1) :
-			_name(name), _debug(false), _threadPool(threadCount) {
+			_name(name), _ais(std::make_shared<AIScheduleList>()), _debug(false), _threadPool(threadCount) {
 		_threadPool.init();
 	}
 
@@ -244,47 +287,29 @@ public:
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone
 	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
-	 * We are waiting for the execution of this.
+	 * We are waiting for the execution of this. The calling thread is executing batches, too.
 	 *
 	 * @note This locks the zone for reading
 	 */
 	template<typename Func>
 	void executeParallel(Func& func) {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr ais = aiList();
+		parallelFor(*ais, func);
 	}
 
 	/**
 	 * @brief Executes a lambda or functor for all the @c AI instances in this zone.
 	 * @note This is executed in a thread pool - so make sure to synchronize your lambda or functor.
-	 * We are waiting for the execution of this.
+	 * We are waiting for the execution of this. The calling thread is executing batches, too.
 	 *
 	 * @note This locks the zone for reading
 	 */
 	template<typename Func>
 	void executeParallel(const Func& func) const {
 		core_trace_scoped(ZoneExecuteParallel);
-		std::vector<std::future<void> > results;
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		const AIListPtr ais = aiList();
+		parallelFor(*ais, func);
 	}
 
 	/**
@@ -296,11 +321,8 @@ public:
 	template<typename Func>
 	void execute(const Func& func) const {
 		core_trace_scoped(ZoneExecute);
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr ais = aiList();
+		for (const AIPtr& ai : *ais) {
 			func(ai);
 		}
 	}
@@ -314,11 +336,8 @@ public:
 	template<typename Func>
 	void execute(Func& func) {
 		core_trace_scoped(ZoneExecute);
-		_lock.lock();
-		AIMap copy(_ais);
-		_lock.unlock();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		const AIListPtr ais = aiList();
+		for (const AIPtr& ai : *ais) {
 			func(ai);
 		}
 	}
@@ -8,7 +8,6 @@
 #include "core/Trace.h"
 #include "core/GLM.h"
 #include <glm/gtc/constants.hpp>
-#include <glm/gtc/epsilon.hpp>
 
 namespace backend {
 
@@ -16,7 +15,6 @@ UserMovementMgr::UserMovementMgr(User* user) : _user(user) {
 }
 
 void UserMovementMgr::changeMovement(network::MoveDirection bitmask, float pitch, float yaw) {
-	_sendUpdate |= _movement.moveMask() != bitmask || !glm::epsilonEqual(_user->orientation(), yaw, glm::epsilon<float>());
 	_movement.setMoveMask(bitmask);
 	_user->setOrientation(yaw);
 }
@@ -29,20 +27,12 @@ void UserMovementMgr::update(long dt) {
 	const MapPtr& map = _user->map();
 	const glm::vec3 oldPos = _user->pos();
 	glm_assert_vec3(oldPos);
-	const network::Animation oldAnimation = _user->animation();
 	const glm::vec3& newPos = _movement.update(deltaSeconds, orientation, speed, oldPos, [&] (const glm::ivec3& pos, int maxWalkHeight) {
 		return map->findFloor(pos, maxWalkHeight);
 	});
 	_user->setPos(newPos);
 	_user->setAnimation(_movement.animation());
-
-	if (_sendUpdate || _movement.animation() != oldAnimation || !glm::all(glm::epsilonEqual(oldPos, newPos, glm::epsilon<float>()))) {
-		const network::Vec3 netPos { newPos.x, newPos.y, newPos.z };
-		_user->sendToVisible(_entityUpdateFBB,
-				network::ServerMsgType::EntityUpdate,
-				network::CreateEntityUpdate(_entityUpdateFBB, _user->id(), &netPos, orientation, _movement.animation()).Union(), true, 0u);
-		_sendUpdate = false;
-	}
+	// the new state is sent to the visible users with the next entity snapshot - see UserSnapshotMgr
 
 	if (_movement.moveMask() != network::MoveDirection::NONE) {
 		_user->logoutMgr().updateLastActionTime();
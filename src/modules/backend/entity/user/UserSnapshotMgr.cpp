@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include "UserSnapshotMgr.h"
+#include "backend/entity/User.h"
+#include "core/Trace.h"
+#include <algorithm>
+
+namespace backend {
+
+UserSnapshotMgr::UserSnapshotMgr(User* user, const network::ServerMessageSenderPtr& messageSender) :
+		_user(user), _messageSender(messageSender) {
+}
+
+void UserSnapshotMgr::ack(uint32_t sequence) {
+	if (sequence > _sequence) {
+		Log::debug("Ignore ack for unknown snapshot %u", sequence);
+		return;
+	}
+	// only move forward - unreliable acks might arrive out of order
+	for (;;) {
+		const int current = _acked;
+		if ((uint32_t)current >= sequence) {
+			return;
+		}
+		if (_acked.compare_exchange(current, (int)sequence)) {
+			return;
+		}
+	}
+}
+
+void UserSnapshotMgr::reset() {
+	_history.clear();
+	_acked = 0;
+}
+
+void UserSnapshotMgr::update() {
+	core_trace_scoped(UserSnapshotMgrUpdate);
+	ENetPeer* peer = _user->peer();
+	if (peer == nullptr) {
+		return;
+	}
+	_entries.clear();
+	_entries.push_back({_user->id(), shared::quantize(_user->pos(), _user->orientation(), _user->animation())});
+	_user->visitVisible([this] (const EntityPtr& e) {
+		_entries.push_back({e->id(), shared::quantize(e->pos(), e->orientation(), e->animation())});
+	});
+	std::sort(_entries.begin(), _entries.end());
+
+	uint32_t baselineSequence = (uint32_t)(int)_acked;
+	const shared::EntitySnapshotEntries* baseline = _history.get(baselineSequence);
+	if (baseline == nullptr) {
+		baselineSequence = 0u;
+	}
+	const int written = shared::EntitySnapshotCodec::encode(baseline, _entries, _data);
+	if (written == 0 && baseline != nullptr) {
+		// the client already knows this state
+		return;
+	}
+
+	++_sequence;
+	_fbb.Clear();
+	auto data = _fbb.CreateVector(_data);
+	_messageSender->sendServerMessage(peer, _fbb, network::ServerMsgType::EntitySnapshot,
+			network::CreateEntitySnapshot(_fbb, _sequence, baselineSequence, data).Union(), 0u);
+	std::swap(_history.store(_sequence), _entries);
+}
+
+bool UserSnapshotMgr::init() {
+	reset();
+	return true;
+}
+
+void UserSnapshotMgr::shutdown() {
+	reset();
+}
+
+}
@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/IComponent.h"
+#include "core/concurrent/Atomic.h"
+#include "shared/EntitySnapshot.h"
+#include "backend/network/ServerMessageSender.h"
+#include <vector>
+
+namespace backend {
+
+class User;
+
+/**
+ * @brief Packs the states of all visible entities (and the user itself) into one @c network::EntitySnapshot
+ * message per tick. The states are delta encoded against the last snapshot the client acknowledged.
+ *
+ * @see EntitySnapshotAckHandler
+ * @see shared::EntitySnapshotCodec
+ */
+class UserSnapshotMgr : public core::IComponent {
+private:
+	User* _user;
+	network::ServerMessageSenderPtr _messageSender;
+	shared::EntitySnapshotHistory _history;
+	// they are stored as members to reduce memory allocations
+	shared::EntitySnapshotEntries _entries;
+	std::vector<uint8_t> _data;
+	flatbuffers::FlatBufferBuilder _fbb;
+	uint32_t _sequence = 0u;
+	core::AtomicInt _acked { 0 };
+
+public:
+	UserSnapshotMgr(User* user, const network::ServerMessageSenderPtr& messageSender);
+
+	/**
+	 * @brief The client received the snapshot with the given sequence number
+	 */
+	void ack(uint32_t sequence);
+
+	/**
+	 * @brief Forget about all the snapshots that were sent - e.g. because the client reconnected
+	 */
+	void reset();
+
+	/**
+	 * @brief Builds and sends the snapshot for the current tick. Nothing is sent if no visible
+	 * entity changed since the acknowledged snapshot.
+	 */
+	void update();
+
+	uint32_t sequence() const;
+
+	bool init() override;
+	void shutdown() override;
+};
+
+inline uint32_t UserSnapshotMgr::sequence() const {
+	return _sequence;
+}
+
+}
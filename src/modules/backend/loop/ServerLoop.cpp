@@ -25,6 +25,7 @@
 #include "backend/network/TriggerActionHandler.h"
 #include "backend/network/VarUpdateHandler.h"
 #include "backend/network/MoveHandler.h"
+#include "backend/network/EntitySnapshotAckHandler.h"
 #include "backend/network/SignupHandler.h"
 #include "backend/network/SignupValidateHandler.h"
 #include "persistence/PersistenceMgr.h"
@@ -332,6 +333,7 @@ bool ServerLoop::init() {
 	r->registerHandler(network::ClientMsgType::UserDisconnect, std::make_shared<UserDisconnectHandler>());
 	r->registerHandler(network::ClientMsgType::TriggerAction, std::make_shared<TriggerActionHandler>());
 	r->registerHandler(network::ClientMsgType::Move, std::make_shared<MoveHandler>());
+	r->registerHandler(network::ClientMsgType::EntitySnapshotAck, std::make_shared<EntitySnapshotAckHandler>());
 	r->registerHandler(network::ClientMsgType::VarUpdate, std::make_shared<VarUpdateHandler>());
 
 	Log::info("Init material");
@@ -0,0 +1,16 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "network/Network.h"
+#include "IUserProtocolHandler.h"
+
+namespace backend {
+
+USERPROTOHANDLERIMPL(EntitySnapshotAck) {
+	user->snapshotMgr().ack(message->sequence());
+}
+
+}
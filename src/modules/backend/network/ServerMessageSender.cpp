@@ -44,7 +44,7 @@ bool ServerMessageSender::sendServerMessage(ENetPeer** peers, int numPeers, Flat
 	auto packet = createServerPacket(fbb, type, data, flags);
 	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
 	{
-		// TODO: lock
+		core::ScopedLock lock(_lock);
 		for (int i = 0; i < numPeers; ++i) {
 			if (!_network->sendMessage(peers[i], packet)) {
 				++notsent;
@@ -69,7 +69,7 @@ bool ServerMessageSender::broadcastServerMessage(FlatBufferBuilder& fbb, ServerM
 	Log::debug(logid, "Broadcast %s on channel %i", msgType, channel);
 	bool success = false;
 	{
-		// TODO: lock
+		core::ScopedLock lock(_lock);
 		success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
 		const metric::TagMap& tags {{"direction", "broadcast"}, {"type", msgType}};
 		_metric->count("network_sent", 1, tags);
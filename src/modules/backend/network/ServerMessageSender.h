@@ -8,6 +8,7 @@
 #include "ServerNetwork.h"
 #include "metric/Metric.h"
 #include "core/Log.h"
+#include "core/concurrent/Lock.h"
 #include <memory>
 
 namespace network {
@@ -16,12 +17,14 @@ using namespace flatbuffers;
 
 /**
  * @brief Send messages from the server to the client(s)
+ * @note The messages can be sent from multiple threads - the access to the network layer is serialized
  */
 class ServerMessageSender {
 private:
 	static constexpr auto logid = Log::logid("ServerMessageSender");
 	ServerNetworkPtr _network;
 	metric::MetricPtr _metric;
+	core_trace_mutex(core::Lock, _lock, "ServerMessageSender");
 
 public:
 	ENetPacket* createServerPacket(ServerMsgType type, const void * data, size_t dataLength, uint32_t flags);
@@ -162,6 +162,24 @@ TEST_F(AITest, testActionDie) {
 	EXPECT_TRUE(npc->dead()) << "NPC should be dead";
 }
 
+TEST_F(AITest, testMapUpdateVisibility) {
+	const NpcPtr& npc1 = create();
+	const NpcPtr& npc2 = create();
+	const NpcPtr& npc3 = create();
+	npc1->ai()->getCharacter()->setPosition(glm::vec3(0.0f));
+	npc2->ai()->getCharacter()->setPosition(glm::vec3(1.0f, 0.0f, 1.0f));
+	npc3->ai()->getCharacter()->setPosition(glm::vec3(10000.0f, 0.0f, 10000.0f));
+	map->update(1L);
+	// the spawn manager might have added further npcs to the map
+	EXPECT_EQ(1u, npc1->visibleCopy().count(npc2));
+	EXPECT_EQ(1u, npc2->visibleCopy().count(npc1));
+	EXPECT_EQ(0u, npc1->visibleCopy().count(npc3));
+	EXPECT_EQ(0u, npc3->visibleCopy().count(npc1));
+	// the scratch sets don't keep references that would form cycles between the npcs
+	EXPECT_TRUE(npc1->visibleScratch().empty());
+	EXPECT_TRUE(npc2->visibleScratch().empty());
+}
+
 TEST_F(AITest, testActionAttackOnSelection) {
 	const NpcPtr& npc = create();
 	const backend::TreeNodeFactoryContext ctx("foo", "", backend::True::get());
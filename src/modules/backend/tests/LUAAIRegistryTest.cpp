@@ -7,8 +7,12 @@
 #include "io/Filesystem.h"
 #include "backend/entity/ai/zone/Zone.h"
 #include "backend/entity/ai/condition/True.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include <fstream>
 #include <streambuf>
+#include <thread>
+#include <vector>
 
 namespace backend {
 
@@ -158,4 +162,76 @@ TEST_F(LUAAIRegistryTest, testSteeringEmpty) {
 	testSteering("LuaSteeringTest");
 }
 
+TEST_F(LUAAIRegistryTest, testWorkerStates) {
+	const TreeNodeFactoryContext ctx = TreeNodeFactoryContext("TreeNodeName", "", True::get());
+	const TreeNodePtr& node = _registry.createNode("LuaTest2", ctx);
+	ASSERT_TRUE((bool)node);
+	const ConditionPtr& condition = _registry.createCondition("LuaTestTrue", ctxCondition);
+	ASSERT_TRUE((bool)condition);
+	const int threadCount = 4;
+	lua_State* states[threadCount] = {};
+	core::AtomicInt failures;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t] () {
+			const AIPtr& ai = std::make_shared<AI>(node);
+			ai->setCharacter(core::make_shared<TestEntity>(_id + t));
+			states[t] = _registry.threadLuaState();
+			for (int i = 0; i < 100; ++i) {
+				if (node->execute(ai, 1L) != ai::TreeNodeStatus::RUNNING) {
+					failures.increment();
+				}
+				if (!condition->evaluate(ai)) {
+					failures.increment();
+				}
+			}
+			ai->setBehaviour(TreeNodePtr());
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(0, (int)failures);
+	EXPECT_EQ(_registry.getLuaState(), _registry.threadLuaState());
+	for (int t = 0; t < threadCount; ++t) {
+		EXPECT_NE(_registry.getLuaState(), states[t]);
+		for (int u = 0; u < t; ++u) {
+			EXPECT_NE(states[u], states[t]);
+		}
+	}
+	_registry.collectGarbage();
+}
+
+TEST_F(LUAAIRegistryTest, testSharedValues) {
+	core::ThreadPool worker(1, "LUAAIRegistryTest");
+	worker.init();
+	// create the worker state before the script is evaluated - it must be replayed there
+	lua_State* workerState = worker.enqueue([this] () { return _registry.threadLuaState(); }).get();
+	ASSERT_NE(nullptr, workerState);
+	ASSERT_TRUE(_registry.evaluate(R"(
+		local shared = REGISTRY.createCondition("LuaSharedTest")
+		function shared:evaluate(ai)
+			REGISTRY.setShared("count", (REGISTRY.shared("count") or 0) + 1)
+			globalCount = (globalCount or 0) + 1
+			return globalCount == 1
+		end
+	)"));
+	const ConditionPtr& condition = _registry.createCondition("LuaSharedTest", ctxCondition);
+	ASSERT_TRUE((bool)condition);
+	const AIPtr& ai = std::make_shared<AI>(TreeNodePtr());
+	ai->setCharacter(_chr);
+	// the globals are per state - each state sees its first evaluation
+	EXPECT_TRUE(worker.enqueue([&] () { return condition->evaluate(ai); }).get());
+	EXPECT_EQ(workerState, worker.enqueue([this] () { return _registry.threadLuaState(); }).get());
+	EXPECT_TRUE(condition->evaluate(ai));
+	EXPECT_FALSE(condition->evaluate(ai));
+	// the shared values are visible in all states
+	LUAAIRegistry::SharedValue value;
+	ASSERT_TRUE(_registry.sharedValue("count", value));
+	EXPECT_EQ(LUA_TNUMBER, value.type);
+	EXPECT_DOUBLE_EQ(3.0, value.number);
+	worker.shutdown();
+	_registry.collectGarbage();
+}
+
 }
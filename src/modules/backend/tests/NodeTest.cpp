@@ -178,4 +178,72 @@ TEST_F(NodeTest, testPrioritySelectorWithCondition) {
 	ASSERT_EQ(ai::TreeNodeStatus::FINISHED, idle2->getLastStatus(e));
 }
 
+TEST_F(NodeTest, testCompiledTree) {
+	backend::PrioritySelector::Factory f;
+	backend::TreeNodeFactoryContext ctx("root", "", backend::True::get());
+	TreeNodePtr root = f.create(&ctx);
+	backend::Sequence::Factory sequenceFac;
+	backend::TreeNodeFactoryContext sequenceCtx("sequence", "", backend::True::get());
+	TreeNodePtr sequence = sequenceFac.create(&sequenceCtx);
+	backend::Idle::Factory idleFac;
+	backend::TreeNodeFactoryContext idleCtx1("idle1", "2", backend::True::get());
+	TreeNodePtr idle1 = idleFac.create(&idleCtx1);
+	backend::TreeNodeFactoryContext idleCtx2("idle2", "2", backend::True::get());
+	TreeNodePtr idle2 = idleFac.create(&idleCtx2);
+	backend::TreeNodeFactoryContext idleCtx3("idle3", "2", backend::True::get());
+	TreeNodePtr idle3 = idleFac.create(&idleCtx3);
+
+	sequence->addChild(idle1);
+	sequence->addChild(idle2);
+	root->addChild(sequence);
+	root->addChild(idle3);
+
+	const CompiledTreePtr& tree = root->compile();
+	ASSERT_EQ(5, tree->size());
+	EXPECT_EQ(0, root->getSlot());
+	// the children of a node are stored next to each other
+	EXPECT_EQ(-1, tree->node(root->getSlot()).parent);
+	EXPECT_EQ(1, sequence->getSlot());
+	EXPECT_EQ(2, idle3->getSlot());
+	EXPECT_EQ(3, idle1->getSlot());
+	EXPECT_EQ(4, idle2->getSlot());
+	EXPECT_EQ(root->getSlot(), tree->node(sequence->getSlot()).parent);
+	EXPECT_EQ(root->getSlot(), tree->node(idle3->getSlot()).parent);
+	EXPECT_EQ(sequence->getSlot(), tree->node(idle1->getSlot()).parent);
+	EXPECT_EQ(sequence->getSlot(), tree->node(idle2->getSlot()).parent);
+	for (const CompiledTree::Node& node : *tree) {
+		EXPECT_EQ(node.node, tree->node(node.node->getSlot()).node);
+	}
+	EXPECT_FALSE(idle3->getCompiledTree()) << "Only the root node should hold the compiled tree";
+	EXPECT_EQ(tree, root->compile()) << "The compiled tree should be cached";
+
+	// the node states are stored per ai
+	AIPtr e1 = std::make_shared<AI>(root);
+	e1->setCharacter(core::make_shared<ICharacter>(1));
+	AIPtr e2 = std::make_shared<AI>(root);
+	e2->setCharacter(core::make_shared<ICharacter>(2));
+	e1->update(1, true);
+	root->execute(e1, 1);
+	root->execute(e1, 1);
+	root->execute(e1, 1);
+	e2->update(1, true);
+	root->execute(e2, 1);
+	EXPECT_EQ(ai::TreeNodeStatus::FINISHED, idle1->getLastStatus(e1));
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, idle2->getLastStatus(e1));
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, idle1->getLastStatus(e2));
+	EXPECT_EQ(ai::TreeNodeStatus::UNKNOWN, idle2->getLastStatus(e2));
+
+	// modifying the tree needs a recompilation - the states are reset with the next update
+	backend::TreeNodeFactoryContext idleCtx4("idle4", "2", backend::True::get());
+	TreeNodePtr idle4 = idleFac.create(&idleCtx4);
+	root->addChild(idle4);
+	const CompiledTreePtr& recompiled = root->compile(true);
+	ASSERT_EQ(6, recompiled->size());
+	EXPECT_EQ(root->getSlot(), recompiled->node(idle4->getSlot()).parent);
+	e1->update(1, true);
+	EXPECT_EQ(ai::TreeNodeStatus::UNKNOWN, idle2->getLastStatus(e1));
+	root->execute(e1, 1);
+	EXPECT_EQ(ai::TreeNodeStatus::RUNNING, idle1->getLastStatus(e1));
+}
+
 }
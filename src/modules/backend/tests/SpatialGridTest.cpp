@@ -0,0 +1,90 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "backend/world/SpatialGrid.h"
+#include <memory>
+#include <algorithm>
+
+namespace backend {
+
+class SpatialGridTest: public app::AbstractTest {
+protected:
+	struct Object {
+		int _id;
+		glm::vec3 _pos;
+
+		int id() const {
+			return _id;
+		}
+		glm::vec3 pos() const {
+			return _pos;
+		}
+	};
+	typedef std::shared_ptr<Object> ObjectPtr;
+
+	std::vector<int> visit(const SpatialGrid<ObjectPtr, int>& grid, const glm::vec3& center, float radius) const {
+		std::vector<int> ids;
+		grid.visit(center, radius, [&] (const ObjectPtr& obj) {
+			ids.push_back(obj->id());
+		});
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+};
+
+TEST_F(SpatialGridTest, testInsertRemove) {
+	SpatialGrid<ObjectPtr, int> grid(10.0f);
+	const ObjectPtr a = std::make_shared<Object>(Object{1, glm::vec3(1.0f, 0.0f, 1.0f)});
+	const ObjectPtr b = std::make_shared<Object>(Object{2, glm::vec3(-1.0f, 0.0f, -1.0f)});
+	EXPECT_TRUE(grid.insert(a));
+	EXPECT_FALSE(grid.insert(a));
+	EXPECT_TRUE(grid.insert(b));
+	EXPECT_EQ(2, grid.size());
+	EXPECT_EQ(2, grid.cells()) << "Negative coordinates should end up in their own cell";
+	EXPECT_EQ(std::vector<int>({1, 2}), visit(grid, glm::vec3(0.0f), 5.0f));
+	EXPECT_TRUE(grid.remove(a));
+	EXPECT_FALSE(grid.remove(a));
+	EXPECT_EQ(std::vector<int>({2}), visit(grid, glm::vec3(0.0f), 5.0f));
+	EXPECT_TRUE(grid.remove(2));
+	EXPECT_EQ(0, grid.cells());
+}
+
+TEST_F(SpatialGridTest, testRadius) {
+	SpatialGrid<ObjectPtr, int> grid(10.0f);
+	// inside of the bounding rect of the circle - but not inside the circle
+	ASSERT_TRUE(grid.insert(std::make_shared<Object>(Object{1, glm::vec3(9.0f, 0.0f, 9.0f)})));
+	ASSERT_TRUE(grid.insert(std::make_shared<Object>(Object{2, glm::vec3(0.0f, 100.0f, 9.0f)})));
+	EXPECT_EQ(std::vector<int>({2}), visit(grid, glm::vec3(0.0f), 10.0f));
+}
+
+TEST_F(SpatialGridTest, testMove) {
+	SpatialGrid<ObjectPtr, int> grid(10.0f);
+	const ObjectPtr a = std::make_shared<Object>(Object{1, glm::vec3(1.0f, 0.0f, 1.0f)});
+	const ObjectPtr b = std::make_shared<Object>(Object{2, glm::vec3(2.0f, 0.0f, 2.0f)});
+	const ObjectPtr c = std::make_shared<Object>(Object{3, glm::vec3(3.0f, 0.0f, 3.0f)});
+	ASSERT_TRUE(grid.insert(a));
+	ASSERT_TRUE(grid.insert(b));
+	ASSERT_TRUE(grid.insert(c));
+
+	a->_pos = glm::vec3(9.0f, 0.0f, 9.0f);
+	EXPECT_FALSE(grid.update(a)) << "Moving inside the cell should not change the cell";
+
+	a->_pos = glm::vec3(105.0f, 0.0f, 105.0f);
+	EXPECT_TRUE(grid.update(a));
+	EXPECT_EQ(2, grid.cells());
+	EXPECT_EQ(std::vector<int>({2, 3}), visit(grid, glm::vec3(0.0f), 10.0f));
+	EXPECT_EQ(std::vector<int>({1}), visit(grid, glm::vec3(100.0f, 0.0f, 100.0f), 10.0f));
+
+	// the swap remove must keep the location of the moved object intact
+	b->_pos = glm::vec3(-50.0f, 0.0f, 0.0f);
+	EXPECT_TRUE(grid.update(b));
+	EXPECT_TRUE(grid.remove(c));
+	EXPECT_EQ(std::vector<int>({2}), visit(grid, glm::vec3(-50.0f, 0.0f, 0.0f), 1.0f));
+	EXPECT_TRUE(grid.remove(a));
+	EXPECT_TRUE(grid.remove(b));
+	EXPECT_EQ(0, grid.cells());
+}
+
+}
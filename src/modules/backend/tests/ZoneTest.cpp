@@ -52,4 +52,31 @@ TEST_F(ZoneTest, testAdd100) {
 	ASSERT_EQ(n, (int)zone.size());
 }
 
+TEST_F(ZoneTest, testExecuteParallel) {
+	Zone zone("test1", 4);
+	TreeNodePtr root = std::make_shared<PrioritySelector>("test", "", True::get());
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		ICharacterPtr character = core::make_shared<TestEntity>(i);
+		AIPtr ai = std::make_shared<AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+	}
+	zone.update(0l);
+	core::AtomicInt visited[n];
+	auto func = [&] (const AIPtr& ai) {
+		visited[ai->getId()].increment();
+	};
+	zone.executeParallel(func);
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(1, (int)visited[i]) << "AI " << i << " was not executed exactly once";
+	}
+
+	ASSERT_TRUE(zone.removeAI(0));
+	zone.update(0l);
+	zone.executeParallel(func);
+	EXPECT_EQ(1, (int)visited[0]) << "Removed AI was still executed";
+	EXPECT_EQ(2, (int)visited[n - 1]);
+}
+
 }
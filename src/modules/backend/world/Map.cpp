@@ -9,7 +9,8 @@
 #include "core/EventBus.h"
 #include "app/App.h"
 #include "core/Trace.h"
-#include "math/QuadTree.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/Filesystem.h"
 #include "backend/entity/Npc.h"
 #include "backend/entity/User.h"
@@ -22,14 +23,6 @@
 
 namespace backend {
 
-math::RectFloat Map::QuadTreeNode::getRect() const {
-	return entity->rect();
-}
-
-bool Map::QuadTreeNode::operator==(const QuadTreeNode& rhs) const {
-	return rhs.entity == entity;
-}
-
 Map::Map(MapId mapId,
 		const core::EventBusPtr& eventBus,
 		const core::TimeProviderPtr& timeProvider,
@@ -46,7 +39,7 @@ Map::Map(MapId mapId,
 		_eventBus(eventBus), _filesystem(filesystem), _persistenceMgr(persistenceMgr),
 		_volumeCache(volumeCache), _attackMgr(this), _poiProvider(timeProvider), _spawnMgr(this, filesystem, entityStorage, messageSender,
 			timeProvider, loader, containerProvider, cooldownProvider),
-		_quadTree(math::RectFloat::getMaxRect(), 100.0f), _chunkPersister(chunkPersister) {
+		_chunkPersister(chunkPersister) {
 }
 
 Map::~Map() {
@@ -59,23 +52,37 @@ bool Map::getDirtyModels(Models& models) {
 
 bool Map::updateEntity(const EntityPtr& entity, long dt) {
 	core_trace_scoped(EntityUpdate);
-	if (!entity->update(dt)) {
-		return false;
-	}
-	const math::RectFloat& rect = entity->viewRect();
-	// TODO: maybe move into the entity instance to reduce memory allocations.
-	math::QuadTree<QuadTreeNode, float>::Contents contents;
-	_quadTree.query(rect, contents);
-	EntitySet set;
-	set.reserve(contents.size());
-	for (const QuadTreeNode& node : contents) {
-		// TODO: check the distance - the rect might contain more than the circle would...
-		if (node.entity->id() != entity->id()) {
-			set.insert(node.entity);
+	return entity->update(dt);
+}
+
+void Map::updateVisibility(const EntityPtr& entity) {
+	core_trace_scoped(EntityVisibility);
+	EntitySet& set = entity->visibleScratch();
+	set.clear();
+	const EntityId id = entity->id();
+	_grid.visit(entity->pos(), entity->viewDistance(), [&] (const EntityPtr& other) {
+		if (other->id() != id) {
+			set.insert(other);
 		}
-	}
+	});
 	entity->updateVisible(set);
-	return true;
+	// the scratch set must not keep the other entities alive
+	set.clear();
+}
+
+void Map::removeUserFromTick(const EntityPtr& user) {
+	Log::debug("remove user " PRIEntId, user->id());
+	_grid.remove(user->id());
+	_users.erase(user->id());
+	_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(user->id(), user->entityType()));
+}
+
+void Map::removeNpcFromTick(const EntityPtr& npc) {
+	Log::debug("remove npc " PRIEntId, npc->id());
+	_grid.remove(npc->id());
+	_npcs.erase(npc->id());
+	_zone->removeAI(npc->id());
+	_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
 }
 
 void Map::update(long dt) {
@@ -85,29 +92,65 @@ void Map::update(long dt) {
 	_zone->update(dt);
 	_attackMgr.update(dt);
 
-	for (auto i = _users.begin(); i != _users.end();) {
-		UserPtr user = i->second;
-		if (updateEntity(user, dt)) {
-			++i;
-			continue;
-		}
-		Log::debug("remove user " PRIEntId, user->id());
-		_quadTree.remove(QuadTreeNode { user });
-		i = _users.erase(i);
-		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(user->id(), user->entityType()));
-	}
-	for (auto i = _npcs.begin(); i != _npcs.end();) {
-		NpcPtr npc = i->second;
-		if (updateEntity(npc, dt)) {
-			++i;
-			continue;
+	const int users = (int)_users.size();
+	_tickEntities.clear();
+	_tickEntities.reserve(_users.size() + _npcs.size());
+	_tickUserPositions.clear();
+	for (const auto& e : _users) {
+		_tickEntities.push_back(e.second);
+		_tickUserPositions.push_back(e.second->pos());
+	}
+	for (const auto& e : _npcs) {
+		_tickEntities.push_back(e.second);
+	}
+	const int n = (int)_tickEntities.size();
+	_tickAlive.resize(n);
+
+	{
+		// the entities only modify their own state here
+		core_trace_scoped(MapEntityUpdatePhase);
+		_threadPool->parallelFor(0, n, ParallelBatchSize, [this, dt] (int start, int end) {
+			for (int i = start; i < end; ++i) {
+				_tickAlive[i] = updateEntity(_tickEntities[i], dt) ? 1u : 0u;
+			}
+		});
+	}
+
+	int alive = 0;
+	{
+		core_trace_scoped(MapEntityCommitPhase);
+		for (int i = 0; i < n; ++i) {
+			if (_tickAlive[i] == 0u) {
+				if (i < users) {
+					removeUserFromTick(_tickEntities[i]);
+				} else {
+					removeNpcFromTick(_tickEntities[i]);
+				}
+				continue;
+			}
+			_grid.update(_tickEntities[i]);
+			if (_prefetch && i < users && dt > 0) {
+				const glm::vec3& pos = _tickEntities[i]->pos();
+				_prefetcher.prefetch(pos, (pos - _tickUserPositions[i]) * (1000.0f / (float)dt));
+			}
+			if (alive != i) {
+				_tickEntities[alive] = std::move(_tickEntities[i]);
+			}
+			++alive;
 		}
-		Log::debug("remove npc " PRIEntId, npc->id());
-		_quadTree.remove(QuadTreeNode { npc });
-		i = _npcs.erase(i);
-		_zone->removeAI(npc->id());
-		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
+		_tickEntities.resize(alive);
+	}
+
+	{
+		// all entities are at their new positions now - the visibility can be resolved
+		core_trace_scoped(MapEntityVisibilityPhase);
+		_threadPool->parallelFor(0, alive, ParallelBatchSize, [this] (int start, int end) {
+			for (int i = start; i < end; ++i) {
+				updateVisibility(_tickEntities[i]);
+			}
+		});
 	}
+	_tickEntities.clear();
 }
 
 bool Map::init() {
@@ -123,7 +166,8 @@ bool Map::init() {
 
 	_pager = core::make_shared<voxelworld::WorldPager>(_volumeCache, _chunkPersister);
 	_voxelWorldMgr = new voxelworld::WorldMgr(_pager);
-	if (!_voxelWorldMgr->init()) {
+	const core::VarPtr& compressedChunkMemory = core::Var::get(cfg::ServerCompressedChunkMemory, "256");
+	if (!_voxelWorldMgr->init(1024, 256, compressedChunkMemory->intVal())) {
 		Log::error("Failed to init map with id %i", _mapId);
 		return false;
 	}
@@ -138,6 +182,19 @@ bool Map::init() {
 	_voxelWorldMgr->setSeed(seed->uintVal());
 	_zone = new Zone(core::string::format("Zone %i", _mapId));
 
+	const core::VarPtr& mapThreads = core::Var::get(cfg::ServerMapThreads, (int)core::halfcpus());
+	_threadPool = new core::ThreadPool(core_max(1, mapThreads->intVal()), "Map");
+	_threadPool->init();
+
+	const core::VarPtr& prefetchThreads = core::Var::get(cfg::ServerPrefetchThreads, "2");
+	_prefetch = prefetchThreads->intVal() > 0 && _prefetcher.init(_voxelWorldMgr->volumeData(), prefetchThreads->intVal());
+
+	const core::VarPtr& pathfinderThreads = core::Var::get(cfg::ServerPathfinderThreads, "1");
+	if (!_pathfinder.init(_voxelWorldMgr->volumeData(), core_max(1, pathfinderThreads->intVal()))) {
+		Log::error("Failed to init the pathfinder");
+		return false;
+	}
+
 	if (!_spawnMgr.init()) {
 		Log::error("Failed to init the spawn manager");
 		return false;
@@ -148,6 +205,11 @@ bool Map::init() {
 void Map::shutdown() {
 	_attackMgr.shutdown();
 	_spawnMgr.shutdown();
+	// the prefetcher must not page in chunks anymore when the pager is shut down
+	_prefetcher.shutdown();
+	_prefetch = false;
+	// the pathfinder is registered at the volume
+	_pathfinder.shutdown();
 	if (_pager != nullptr) {
 		_pager->shutdown();
 		_pager = voxelworld::WorldPagerPtr();
@@ -159,7 +221,12 @@ void Map::shutdown() {
 	}
 	delete _zone;
 	_zone = nullptr;
-	_quadTree.clear();
+	if (_threadPool != nullptr) {
+		_threadPool->shutdown();
+		delete _threadPool;
+		_threadPool = nullptr;
+	}
+	_grid.clear();
 	_npcs.clear();
 	_users.clear();
 	_persistenceMgr->unregisterSavable(FOURCC, this);
@@ -180,7 +247,7 @@ void Map::addUser(const UserPtr& user) {
 	}
 	const glm::vec3& pos = findStartPosition(user);
 	user->setMap(ptr(), pos);
-	_quadTree.insert(QuadTreeNode { user });
+	_grid.insert(user);
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(user));
 	_poiProvider.add(pos, poi::Type::SPAWN);
 }
@@ -191,7 +258,7 @@ bool Map::removeUser(EntityId id) {
 		return false;
 	}
 	UserPtr user = i->second;
-	_quadTree.remove(QuadTreeNode { user });
+	_grid.remove(user->id());
 	_users.erase(i);
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(user));
 	return true;
@@ -214,7 +281,7 @@ bool Map::addNpc(const NpcPtr& npc) {
 	const glm::vec3& pos = findStartPosition(npc);
 	npc->setMap(ptr(), pos);
 	_zone->addAI(npc->ai());
-	_quadTree.insert(QuadTreeNode { npc });
+	_grid.insert(npc);
 	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(npc));
 	_poiProvider.add(pos, poi::Type::SPAWN);
 	return true;
@@ -226,7 +293,7 @@ bool Map::removeNpc(EntityId id) {
 		return false;
 	}
 	NpcPtr npc = i->second;
-	_quadTree.remove(QuadTreeNode { npc });
+	_grid.remove(npc->id());
 	_npcs.erase(i);
 	_zone->removeAI(npc->id());
 	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(npc));
@@ -250,4 +317,8 @@ glm::ivec3 Map::randomPos() const {
 	return _voxelWorldMgr->randomPos();
 }
 
+std::future<voxelworld::WorldPathfinder::PathPtr> Map::findPath(const glm::ivec3& start, const glm::ivec3& end) {
+	return _pathfinder.findPathAsync(start, end);
+}
+
 }
@@ -5,8 +5,6 @@
 #pragma once
 
 #include "backend/ForwardDecl.h"
-#include "math/QuadTree.h"
-#include "math/Rect.h"
 #include "core/Common.h"
 #include "core/FourCC.h"
 #include "ai-shared/common/CharacterId.h"
@@ -19,12 +17,20 @@
 #include "backend/spawn/SpawnMgr.h"
 #include "voxel/Constants.h"
 #include "DBChunkPersister.h"
+#include "voxelworld/WorldPrefetcher.h"
+#include "voxelworld/WorldPathfinder.h"
+#include "SpatialGrid.h"
 #include "MapId.h"
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace backend {
 
 /**
@@ -57,19 +63,47 @@ private:
 	poi::PoiProvider _poiProvider;
 	SpawnMgr _spawnMgr;
 
-	struct QuadTreeNode {
-		EntityPtr entity;
+	/**
+	 * The edge length of the visibility grid cells in world units
+	 */
+	static constexpr float VisibilityCellSize = 64.0f;
+	SpatialGrid<EntityPtr, EntityId> _grid { VisibilityCellSize };
+	DBChunkPersisterPtr _chunkPersister;
+	core::ThreadPool* _threadPool = nullptr;
 
-		math::RectFloat getRect() const;
-		bool operator==(const QuadTreeNode& rhs) const;
-	};
+	/**
+	 * The amount of entities a worker handles in one go in the parallel phases of the tick
+	 */
+	static constexpr int ParallelBatchSize = 32;
+	// the users followed by the npcs - filled every tick, kept as member to reduce memory allocations
+	std::vector<EntityPtr> _tickEntities;
+	std::vector<uint8_t> _tickAlive;
+	// the positions of the users before they were updated - used to predict the chunks they need next
+	std::vector<glm::vec3> _tickUserPositions;
+
+	/**
+	 * The chunks around the users are paged in ahead of time - otherwise the tick would stall whenever a user
+	 * walks into a chunk that wasn't paged in yet.
+	 */
+	voxelworld::WorldPrefetcher _prefetcher;
+	bool _prefetch = false;
+
+	voxelworld::WorldPathfinder _pathfinder;
 
-	math::QuadTree<QuadTreeNode, float> _quadTree;
-	DBChunkPersisterPtr _chunkPersister;
 	/**
+	 * @brief Ticks the entity
+	 * @note This is called from the workers of the thread pool
 	 * @return @c false if the entity should be removed from the server.
 	 */
 	bool updateEntity(const EntityPtr& entity, long dt);
+	/**
+	 * @brief Collects the entities within the view distance and hands them over to the entity.
+	 * @note All entities must already be at their new grid cells.
+	 * @note This is called from the workers of the thread pool
+	 */
+	void updateVisibility(const EntityPtr& entity);
+	void removeUserFromTick(const EntityPtr& user);
+	void removeNpcFromTick(const EntityPtr& npc);
 
 	glm::vec3 findStartPosition(const EntityPtr& entity, poi::Type type = poi::Type::GENERIC) const;
 
@@ -88,6 +122,12 @@ public:
 			const DBChunkPersisterPtr& chunkPersister);
 	~Map();
 
+	/**
+	 * @brief Ticks the map and all of its entities.
+	 *
+	 * The entities are updated in parallel, the removal of the dead entities is committed
+	 * serially, and then the visibility is computed in parallel again.
+	 */
 	void update(long dt);
 
 	bool init() override;
@@ -133,6 +173,19 @@ public:
 
 	voxelutil::FloorTraceResult findFloor(const glm::ivec3& pos, int maxDistanceY = voxel::MAX_HEIGHT) const;
 	glm::ivec3 randomPos() const;
+	/**
+	 * @brief Queues a path request - the path is computed by the threads of the pathfinder
+	 * @sa voxelworld::WorldPathfinder::findPathAsync()
+	 */
+	std::future<voxelworld::WorldPathfinder::PathPtr> findPath(const glm::ivec3& start, const glm::ivec3& end);
+	/**
+	 * @sa voxelworld::WorldPathfinder::generation()
+	 */
+	int pathGeneration() const;
+	/**
+	 * @sa voxelworld::WorldPathfinder::pathModified()
+	 */
+	bool pathModified(const voxelworld::WorldPathfinder::Path& path, size_t start, int generation) const;
 
 	const DBChunkPersisterPtr& chunkPersister();
 
@@ -146,6 +199,14 @@ public:
 	poi::PoiProvider& poiProvider();
 };
 
+inline int Map::pathGeneration() const {
+	return _pathfinder.generation();
+}
+
+inline bool Map::pathModified(const voxelworld::WorldPathfinder::Path& path, size_t start, int generation) const {
+	return _pathfinder.pathModified(path, start, generation);
+}
+
 inline const DBChunkPersisterPtr& Map::chunkPersister() {
 	return _chunkPersister;
 }
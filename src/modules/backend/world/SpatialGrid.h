@@ -0,0 +1,184 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+namespace backend {
+
+/**
+ * @brief Uniform spatial hash grid on the x/z plane that is used for the visibility queries of the entities on a map.
+ *
+ * The objects are pointer like types that provide @c id() (of type @c ID) and @c pos(). The cell of an object is only
+ * touched if the object crossed a cell boundary since the last @c update() call - moving inside a cell
+ * is just a hash lookup.
+ *
+ * @note This is not thread safe
+ */
+template<class T, class ID>
+class SpatialGrid {
+private:
+	typedef std::vector<T> Cell;
+	typedef std::unordered_map<uint64_t, Cell> Cells;
+
+	struct Location {
+		uint64_t cell;
+		size_t index;
+	};
+	typedef std::unordered_map<ID, Location> Locations;
+
+	Cells _cells;
+	Locations _locations;
+	const float _cellSize;
+	const float _invCellSize;
+
+	inline int cellCoord(float v) const {
+		return (int)glm::floor(v * _invCellSize);
+	}
+
+	static inline uint64_t cellKey(int x, int z) {
+		return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)z;
+	}
+
+	inline uint64_t cellKey(const glm::vec3& pos) const {
+		return cellKey(cellCoord(pos.x), cellCoord(pos.z));
+	}
+
+	void add(const T& obj, uint64_t key, Location& location) {
+		Cell& cell = _cells[key];
+		location.cell = key;
+		location.index = cell.size();
+		cell.push_back(obj);
+	}
+
+	/**
+	 * @brief Swap remove the object at the given location and fix the location of the object that was moved
+	 */
+	void erase(const Location& location) {
+		auto i = _cells.find(location.cell);
+		core_assert(i != _cells.end());
+		Cell& cell = i->second;
+		core_assert(location.index < cell.size());
+		if (location.index != cell.size() - 1) {
+			cell[location.index] = std::move(cell.back());
+			_locations[cell[location.index]->id()].index = location.index;
+		}
+		cell.pop_back();
+		if (cell.empty()) {
+			_cells.erase(i);
+		}
+	}
+
+public:
+	/**
+	 * @param[in] cellSize The edge length of a cell in world units. A good value is in the magnitude of the
+	 * typical view distance.
+	 */
+	SpatialGrid(float cellSize) :
+			_cellSize(cellSize), _invCellSize(1.0f / cellSize) {
+		core_assert(cellSize > 0.0f);
+	}
+
+	/**
+	 * @return @c false if an object with the same id is already part of the grid
+	 */
+	bool insert(const T& obj) {
+		auto i = _locations.emplace(obj->id(), Location());
+		if (!i.second) {
+			return false;
+		}
+		add(obj, cellKey(obj->pos()), i.first->second);
+		return true;
+	}
+
+	bool remove(const ID& id) {
+		auto i = _locations.find(id);
+		if (i == _locations.end()) {
+			return false;
+		}
+		const Location location = i->second;
+		_locations.erase(i);
+		erase(location);
+		return true;
+	}
+
+	inline bool remove(const T& obj) {
+		return remove(obj->id());
+	}
+
+	/**
+	 * @brief Call this after the object moved. Only re-assigns the cell if the object crossed a cell boundary.
+	 * @return @c true if the object changed its cell
+	 */
+	bool update(const T& obj) {
+		auto i = _locations.find(obj->id());
+		if (i == _locations.end()) {
+			return false;
+		}
+		const uint64_t key = cellKey(obj->pos());
+		if (i->second.cell == key) {
+			return false;
+		}
+		erase(i->second);
+		add(obj, key, i->second);
+		return true;
+	}
+
+	/**
+	 * @brief Calls the given functor for every object that is within the given radius of the center
+	 * @note This is a true radius test on the x/z plane - not only the bounding rect of the circle
+	 */
+	template<class FUNC>
+	void visit(const glm::vec3& center, float radius, FUNC&& func) const {
+		core_trace_scoped(SpatialGridVisit);
+		const float radiusSquared = radius * radius;
+		const int minX = cellCoord(center.x - radius);
+		const int maxX = cellCoord(center.x + radius);
+		const int minZ = cellCoord(center.z - radius);
+		const int maxZ = cellCoord(center.z + radius);
+		for (int x = minX; x <= maxX; ++x) {
+			for (int z = minZ; z <= maxZ; ++z) {
+				auto i = _cells.find(cellKey(x, z));
+				if (i == _cells.end()) {
+					continue;
+				}
+				for (const T& obj : i->second) {
+					const glm::vec3& pos = obj->pos();
+					const float dx = pos.x - center.x;
+					const float dz = pos.z - center.z;
+					if (dx * dx + dz * dz <= radiusSquared) {
+						func(obj);
+					}
+				}
+			}
+		}
+	}
+
+	void clear() {
+		_cells.clear();
+		_locations.clear();
+	}
+
+	inline int size() const {
+		return (int)_locations.size();
+	}
+
+	inline int cells() const {
+		return (int)_cells.size();
+	}
+
+	inline float cellSize() const {
+		return _cellSize;
+	}
+};
+
+}
@@ -8,6 +8,7 @@
 #include "backend/spawn/SpawnMgr.h"
 #include "backend/world/MapProvider.h"
 #include "backend/world/Map.h"
+#include "voxelworld/WorldMgr.h"
 #include "backend/entity/ai/LUAAIRegistry.h"
 #include "io/Filesystem.h"
 #include "core/Log.h"
@@ -81,6 +82,17 @@ void World::construct() {
 		}
 	}).setHelp("Truncate chunks for all maps");
 
+	command::Command::registerCommand("sv_chunkstats", [this] (const command::CmdArgs& args) {
+		for (const auto& e : _maps) {
+			const MapPtr& map = e->value;
+			const voxel::PagedVolume::Statistics& stats = map->worldMgr()->volumeData()->statistics();
+			Log::info("Map %i: %i chunks, %i hits, %i misses, %i evictions, %i page outs",
+					map->id(), stats.chunks, stats.hits, stats.misses, stats.evictions, stats.pageOuts);
+			Log::info("Map %i: %i compressed chunks (%" SDL_PRIu64 "kb), %i compressed hits",
+					map->id(), stats.compressedChunks, stats.compressedBytes / 1024, stats.compressedHits);
+		}
+	}).setHelp("Print the chunk cache statistics for all maps");
+
 	_mapProvider->construct();
 }
 
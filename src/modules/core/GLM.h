@@ -73,6 +73,35 @@ constexpr uint32_t operator()(const glm::vec<3, T, Q>& v) const {
 }
 };
 
+/**
+ * @brief Integer vectors are mostly chunk or voxel positions - they are small and clustered. Instead of hashing
+ * every component on its own, the components are multiplied with large odd constants and the result is mixed.
+ */
+template<glm::qualifier Q>
+struct hash<glm::vec<3, int, Q>> {
+constexpr uint32_t operator()(const glm::vec<3, int, Q>& v) const {
+	uint64_t h = (uint64_t)(uint32_t)v.x * UINT64_C(0x9E3779B97F4A7C15);
+	h ^= (uint64_t)(uint32_t)v.y * UINT64_C(0xC2B2AE3D27D4EB4F);
+	h ^= (uint64_t)(uint32_t)v.z * UINT64_C(0x165667B19E3779F9);
+	h ^= h >> 32;
+	h *= UINT64_C(0xFF51AFD7ED558CCD);
+	h ^= h >> 29;
+	return (uint32_t)h;
+}
+};
+
+template<glm::qualifier Q>
+struct hash<glm::vec<2, int, Q>> {
+constexpr uint32_t operator()(const glm::vec<2, int, Q>& v) const {
+	uint64_t h = (uint64_t)(uint32_t)v.x * UINT64_C(0x9E3779B97F4A7C15);
+	h ^= (uint64_t)(uint32_t)v.y * UINT64_C(0xC2B2AE3D27D4EB4F);
+	h ^= h >> 32;
+	h *= UINT64_C(0xFF51AFD7ED558CCD);
+	h ^= h >> 29;
+	return (uint32_t)h;
+}
+};
+
 template<typename T, glm::qualifier Q>
 struct hash<glm::vec<4, T, Q>> {
 constexpr uint32_t operator()(const glm::vec<4, T, Q>& v) const {
@@ -58,8 +58,16 @@ constexpr const char *ServerPort = "sv_port";
 constexpr const char *ServerMaxClients = "sv_maxclients";
 constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
+// the memory in megabytes that is used to keep evicted chunks compressed
+constexpr const char *ServerCompressedChunkMemory = "sv_compressedchunkmemory";
 // the download urls for the chunks
 constexpr const char *ServerChunkBaseUrl = "sv_httpchunkurl";
+// the amount of threads that are used to tick the entities of a map
+constexpr const char *ServerMapThreads = "sv_mapthreads";
+// the amount of threads that are used to page in the chunks around the users of a map - 0 disables the prefetching
+constexpr const char *ServerPrefetchThreads = "sv_prefetchthreads";
+// the amount of threads that compute the paths of the npcs of a map
+constexpr const char *ServerPathfinderThreads = "sv_pathfinderthreads";
 
 constexpr const char *ConsoleCurses = "con_curses";
 
@@ -70,6 +78,9 @@ constexpr const char *CorePath = "core_path";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// The distance in voxels up to which the world is meshed with the full resolution - the resolution is halved
+// each time the distance doubles. 0 disables the level of detail meshes.
+constexpr const char *VoxelLodDistance = "voxel_loddistance";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
@@ -1,5 +1,6 @@
 #include "app/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/GLM.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
@@ -53,8 +54,73 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+/**
+ * @brief Chunk positions as they are used in the volume chunk maps - one lookup per put plus a lookup
+ * of a key that is not part of the map.
+ */
+template<class MAP>
+static void chunkPositionLookups(benchmark::State& state, MAP& map) {
+	const int side = (int)state.range(0);
+	for (auto _ : state) {
+		map.clear();
+		for (int z = 0; z < side; ++z) {
+			for (int y = 0; y < 8; ++y) {
+				for (int x = 0; x < side; ++x) {
+					const glm::ivec3 pos(x * 32, y * 32, z * 32);
+					map.put(pos, x);
+				}
+			}
+		}
+		int found = 0;
+		for (int z = 0; z < side; ++z) {
+			for (int y = 0; y < 8; ++y) {
+				for (int x = 0; x < side; ++x) {
+					if (map.hasKey(glm::ivec3(x * 32, y * 32, z * 32))) {
+						++found;
+					}
+					if (map.hasKey(glm::ivec3(x * 32, y * 32 + 1, z * 32))) {
+						--found;
+					}
+				}
+			}
+		}
+		if (found != side * side * 8) {
+			state.SkipWithError("Failed!");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * side * side * 8);
+}
+
+class StdChunkMap {
+private:
+	std::unordered_map<glm::ivec3, int, glm::hash<glm::ivec3>> _map;
+public:
+	void clear() {
+		_map.clear();
+	}
+	void put(const glm::ivec3& pos, int value) {
+		_map[pos] = value;
+	}
+	bool hasKey(const glm::ivec3& pos) const {
+		return _map.find(pos) != _map.end();
+	}
+};
+
+BENCHMARK_DEFINE_F(MapBenchmark, chunkPositionsMapCore) (benchmark::State& state) {
+	core::Map<glm::ivec3, int, 64, glm::hash<glm::ivec3>> map;
+	chunkPositionLookups(state, map);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, chunkPositionsUnorderedMapStd) (benchmark::State& state) {
+	StdChunkMap map;
+	chunkPositionLookups(state, map);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, chunkPositionsMapCore)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK_REGISTER_F(MapBenchmark, chunkPositionsUnorderedMapStd)->RangeMultiplier(4)->Range(4, 64);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/Atomic.h"
+
+/**
+ * @brief Measures the throughput of tiny tasks that are put into the thread pool queues
+ */
+class ThreadPoolBenchmark: public app::AbstractBenchmark {
+protected:
+	static constexpr int Tasks = 10000;
+};
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, enqueue) (benchmark::State& state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt count;
+	std::future<void> last;
+	for (auto _ : state) {
+		for (int i = 0; i < Tasks; ++i) {
+			last = pool.enqueue([&count] () {
+				count.increment();
+			});
+		}
+		last.wait();
+	}
+	pool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, schedule) (benchmark::State& state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt count;
+	for (auto _ : state) {
+		const int target = count + Tasks;
+		for (int i = 0; i < Tasks; ++i) {
+			pool.schedule([&count] () {
+				count.increment();
+			});
+		}
+		while (count < target) {
+			std::this_thread::yield();
+		}
+	}
+	pool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, enqueueBulk) (benchmark::State& state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt count;
+	for (auto _ : state) {
+		const int target = count + Tasks;
+		pool.enqueueBulk(Tasks, [&count] (int) {
+			count.increment();
+		});
+		while (count < target) {
+			std::this_thread::yield();
+		}
+	}
+	pool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, parallelFor) (benchmark::State& state) {
+	core::ThreadPool pool((size_t)state.range(0), "Benchmark");
+	pool.init();
+	core::AtomicInt count;
+	for (auto _ : state) {
+		pool.parallelFor(0, Tasks, 64, [&count] (int start, int end) {
+			count.increment(end - start);
+		});
+	}
+	pool.shutdown(true);
+	state.SetItemsProcessed(state.iterations() * Tasks);
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, enqueue)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, schedule)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, enqueueBulk)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, parallelFor)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
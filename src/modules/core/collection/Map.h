@@ -4,9 +4,11 @@
 
 #pragma once
 
-#include "core/collection/Array.h"
-#include "core/PoolAllocator.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <new>
 #include <initializer_list>
 #include <SDL_stdinc.h>
 
@@ -38,9 +40,16 @@ struct SharedPtrHasher {
 }
 
 /**
- * @brief Hash map with a max size given as constructor parameter.
+ * @brief Growable hash map with open addressing
  *
- * @note The allocations are performed with the @c PoolAllocator
+ * Collisions are resolved with linear probing and robin hood hashing - an entry that is further away from
+ * its home slot takes over the slot of an entry that is closer to its own home slot. This keeps the probe
+ * sequences short and allows to stop a lookup early. Removing uses backward shifting - so there are no
+ * tombstones.
+ *
+ * @note The entries are stored inline in the slots. Inserting and removing may move other entries - pointers
+ * and iterators are only valid until the map is modified.
+ * @note The memory is allocated with the first insert - @c BUCKETSIZE is the initial amount of slots.
  *
  * @ingroup Collections
  */
@@ -52,75 +61,238 @@ public:
 
 	struct KeyValue {
 		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
-				key(_key), value(_value), next(nullptr), first(key), second(value) {
+				key(_key), value(_value), first(key), second(value) {
 		}
 
 		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
-				key(_key), value(_value), next(nullptr), first(key), second(value) {
+				key(_key), value(core::move(_value)), first(key), second(value) {
 		}
 
 		inline KeyValue(KeyValue &&other) noexcept :
-				key(core::move(other.key)), value(core::move(other.value)), next(
-						nullptr), first(key), second(value) {
+				key(core::move(other.key)), value(core::move(other.value)), first(key), second(value) {
 		}
 
 		KEYTYPE key;
 		VALUETYPE value;
-		KeyValue *next;
 		const KEYTYPE &first;
 		const VALUETYPE &second;
 	};
 private:
-	core::PoolAllocator<KeyValue> _allocator;
-	core::Array<KeyValue *, BUCKETSIZE> _buckets;
+	/**
+	 * @brief Probe distance of an empty slot - occupied slots store the distance to their home slot plus one
+	 */
+	static constexpr uint8_t EmptySlot = 0u;
+	static constexpr uint8_t MaxDistance = 255u;
+
+	static constexpr size_t initialCapacity() {
+		size_t capacity = 8u;
+		while (capacity < BUCKETSIZE) {
+			capacity <<= 1;
+		}
+		return capacity;
+	}
+
+	KeyValue *_entries = nullptr;
+	uint8_t *_distances = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	/**
+	 * @brief 64 minus the log2 of the capacity - used to take the upper bits of the mixed hash
+	 */
+	int _shift = 64;
 	HASHER _hasher;
-public:
-	Map(std::initializer_list<KeyValue> other, int maxSize = 4096) {
-		_allocator.init(maxSize);
-		_buckets.fill(nullptr);
+
+	inline size_t homeSlot(const KEYTYPE& key) const {
+		// fibonacci hashing - spreads identity hashes of integers over the whole table
+		const uint64_t hashValue = (uint64_t)_hasher(key) * UINT64_C(0x9E3779B97F4A7C15);
+		return (size_t)(hashValue >> _shift);
+	}
+
+	inline size_t mask() const {
+		return _capacity - 1u;
+	}
+
+	size_t findSlot(const KEYTYPE& key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		size_t idx = homeSlot(key);
+		for (uint32_t distance = 1u;; ++distance) {
+			const uint8_t slotDistance = _distances[idx];
+			// the entry would have taken over this slot
+			if (slotDistance < distance) {
+				return _capacity;
+			}
+			if (COMPARE()(_entries[idx].key, key)) {
+				return idx;
+			}
+			idx = (idx + 1u) & mask();
+		}
+	}
+
+	void allocate(size_t capacity) {
+		_capacity = capacity;
+		_shift = 64;
+		while (capacity > 1u) {
+			capacity >>= 1;
+			--_shift;
+		}
+		_entries = (KeyValue *)core_malloc(_capacity * sizeof(KeyValue));
+		_distances = (uint8_t *)core_malloc(_capacity);
+		core_memset(_distances, EmptySlot, _capacity);
+	}
+
+	void rehash(size_t capacity) {
+		KeyValue *oldEntries = _entries;
+		uint8_t *oldDistances = _distances;
+		const size_t oldCapacity = _capacity;
+		allocate(capacity);
+		_size = 0u;
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (oldDistances[i] == EmptySlot) {
+				continue;
+			}
+			insertNew(core::move(oldEntries[i]));
+			oldEntries[i].~KeyValue();
+		}
+		core_free(oldEntries);
+		core_free(oldDistances);
+	}
+
+	inline bool needsGrow() const {
+		// max load factor of 7/8
+		return _capacity == 0u || (_size + 1u) * 8u > _capacity * 7u;
+	}
+
+	/**
+	 * @note The key must not be part of the map yet
+	 */
+	void insertNew(KeyValue &&entry) {
+		if (needsGrow()) {
+			rehash(_capacity == 0u ? initialCapacity() : _capacity * 2u);
+		}
+		alignas(KeyValue) uint8_t buf[sizeof(KeyValue)];
+		KeyValue *current = new (buf) KeyValue(core::move(entry));
+		size_t idx = homeSlot(current->key);
+		uint32_t distance = 1u;
+		for (;;) {
+			const uint8_t slotDistance = _distances[idx];
+			if (slotDistance == EmptySlot) {
+				new (&_entries[idx]) KeyValue(core::move(*current));
+				current->~KeyValue();
+				_distances[idx] = (uint8_t)distance;
+				++_size;
+				return;
+			}
+			if (slotDistance < distance) {
+				// rob the rich - swap with the entry that is closer to its home slot
+				alignas(KeyValue) uint8_t tmpBuf[sizeof(KeyValue)];
+				KeyValue *tmp = new (tmpBuf) KeyValue(core::move(_entries[idx]));
+				_entries[idx].~KeyValue();
+				new (&_entries[idx]) KeyValue(core::move(*current));
+				current->~KeyValue();
+				current = new (buf) KeyValue(core::move(*tmp));
+				tmp->~KeyValue();
+				_distances[idx] = (uint8_t)distance;
+				distance = slotDistance;
+			}
+			idx = (idx + 1u) & mask();
+			++distance;
+			if (distance >= MaxDistance) {
+				// the probe distance doesn't fit into the metadata anymore
+				rehash(_capacity * 2u);
+				idx = homeSlot(current->key);
+				distance = 1u;
+			}
+		}
+	}
+
+	void release() {
+		clear();
+		core_free(_entries);
+		core_free(_distances);
+		_entries = nullptr;
+		_distances = nullptr;
+		_capacity = 0u;
+		_shift = 64;
+	}
+
+	void copyFrom(const Map& other) {
+		reserve(other._size);
 		for (auto i = other.begin(); i != other.end(); ++i) {
 			put(i->key, i->value);
 		}
 	}
-	Map(int maxSize = 4096) {
-		_allocator.init(maxSize);
-		_buckets.fill(nullptr);
-	}
-	Map(const Map& other) {
-		_allocator.init((other._allocator.max)());
-		_buckets.fill(nullptr);
+
+public:
+	Map(std::initializer_list<KeyValue> other, int initialSize = 0) {
+		reserve(core_max((size_t)initialSize, other.size()));
 		for (auto i = other.begin(); i != other.end(); ++i) {
 			put(i->key, i->value);
 		}
 	}
+	/**
+	 * @param[in] initialSize The amount of entries to reserve memory for. The map is growing if needed.
+	 */
+	Map(int initialSize = 0) {
+		if (initialSize > 0) {
+			reserve((size_t)initialSize);
+		}
+	}
+	Map(const Map& other) {
+		copyFrom(other);
+	}
+	Map(Map&& other) noexcept :
+			_entries(other._entries), _distances(other._distances), _capacity(other._capacity), _size(other._size), _shift(other._shift) {
+		other._entries = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._shift = 64;
+	}
 	~Map() {
-		clear();
-		_allocator.shutdown();
+		release();
 	}
 
 	Map& operator=(const Map& other) {
+		if (this == &other) {
+			return *this;
+		}
 		clear();
-		_allocator.shutdown(); // TODO: not needed init() will handle this
-		_allocator.init((other._allocator.max)());
-		_buckets.fill(nullptr);
-		for (auto i = other.begin(); i != other.end(); ++i) {
-			put(i->key, i->value);
+		copyFrom(other);
+		return *this;
+	}
+
+	Map& operator=(Map&& other) noexcept {
+		if (this == &other) {
+			return *this;
 		}
+		release();
+		_entries = other._entries;
+		_distances = other._distances;
+		_capacity = other._capacity;
+		_size = other._size;
+		_shift = other._shift;
+		other._entries = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._shift = 64;
 		return *this;
 	}
 
 	class iterator {
 	private:
 		const Map* _map;
-		size_t _bucket;
+		size_t _slot;
 		KeyValue* _ptr;
 	public:
 		constexpr iterator() :
-			_map(nullptr), _bucket(0), _ptr(nullptr) {
+			_map(nullptr), _slot(0), _ptr(nullptr) {
 		}
 
-		iterator(const Map* map, size_t bucket, KeyValue *ptr) :
-				_map(map), _bucket(bucket), _ptr(ptr) {
+		iterator(const Map* map, size_t slot) :
+				_map(map), _slot(slot), _ptr(&map->_entries[slot]) {
 		}
 
 		inline KeyValue* operator*() const {
@@ -128,21 +300,14 @@ public:
 		}
 
 		iterator& operator++() {
-			if (_ptr->next != nullptr) {
-				_ptr = _ptr->next;
-				return *this;
-			}
-			size_t bucket = _bucket;
-			for (++bucket; bucket < BUCKETSIZE; ++bucket) {
-				KeyValue* ptr = _map->_buckets[bucket];
-				if (ptr != nullptr) {
-					_ptr = ptr;
-					_bucket = bucket;
+			for (++_slot; _slot < _map->_capacity; ++_slot) {
+				if (_map->_distances[_slot] != EmptySlot) {
+					_ptr = &_map->_entries[_slot];
 					return *this;
 				}
 			}
 			_ptr = nullptr;
-			_bucket = 0;
+			_slot = 0;
 			return *this;
 		}
 
@@ -160,97 +325,79 @@ public:
 	};
 
 	inline size_t size() const {
-		return _allocator.allocated();
+		return _size;
 	}
 
 	inline bool empty() const {
-		return size() == 0;
+		return _size == 0u;
 	}
 
+	/**
+	 * @return The amount of slots - the map grows before they are all in use
+	 */
 	inline size_t capacity() const {
-		return (_allocator.max)();
+		return _capacity;
+	}
+
+	/**
+	 * @brief Make sure that the given amount of entries fit into the map without growing
+	 */
+	void reserve(size_t entries) {
+		size_t capacity = _capacity == 0u ? initialCapacity() : _capacity;
+		while (entries * 8u > capacity * 7u) {
+			capacity <<= 1;
+		}
+		if (capacity != _capacity) {
+			rehash(capacity);
+		}
 	}
 
 	bool get(const KEYTYPE& key, VALUETYPE& value) const {
-		const size_t hashValue = (size_t)_hasher(key);
-		KeyValue *entry = _buckets[hashValue % BUCKETSIZE];
-		while (entry != nullptr) {
-			if (COMPARE()(entry->key, key)) {
-				value = entry->value;
-				return true;
-			}
-			entry = entry->next;
+		const size_t idx = findSlot(key);
+		if (idx >= _capacity) {
+			return false;
 		}
-		return false;
+		value = _entries[idx].value;
+		return true;
 	}
 
 	bool hasKey(const KEYTYPE& key) const {
-		return find(key) != end();
+		return findSlot(key) < _capacity;
 	}
 
 	iterator find(const KEYTYPE& key) const {
-		const size_t hashValue = (size_t)_hasher(key);
-		KeyValue *entry = _buckets[hashValue % BUCKETSIZE];
-		while (entry != nullptr) {
-			if (COMPARE()(entry->key, key)) {
-				return iterator(this, hashValue % BUCKETSIZE, entry);
-			}
-			entry = entry->next;
+		const size_t idx = findSlot(key);
+		if (idx >= _capacity) {
+			return end();
 		}
-		return end();
+		return iterator(this, idx);
 	}
 
 	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
-		const size_t hashValue = (size_t)_hasher(key);
-		KeyValue *prev = nullptr;
-		KeyValue *entry = _buckets[hashValue % BUCKETSIZE];
-
-		while (entry != nullptr && !COMPARE()(entry->key, key)) {
-			prev = entry;
-			entry = entry->next;
-		}
-
-		if (entry == nullptr) {
-			entry = _allocator.alloc(key, value);
-			core_assert_msg(entry != nullptr, "Failed to allocate for hash: %i", (int)hashValue);
-			if (prev == nullptr) {
-				_buckets[hashValue % BUCKETSIZE] = entry;
-			} else {
-				prev->next = entry;
-			}
-		} else {
-			entry->value = std::forward(value);
+		const size_t idx = findSlot(key);
+		if (idx < _capacity) {
+			_entries[idx].value = core::move(value);
+			return;
 		}
+		insertNew(KeyValue(key, core::move(value)));
 	}
 
 	void put(const KEYTYPE& key, const VALUETYPE& value) {
-		const size_t hashValue = (size_t)_hasher(key);
-		KeyValue *prev = nullptr;
-		KeyValue *entry = _buckets[hashValue % BUCKETSIZE];
-
-		while (entry != nullptr && !COMPARE()(entry->key, key)) {
-			prev = entry;
-			entry = entry->next;
-		}
-
-		if (entry == nullptr) {
-			entry = _allocator.alloc(key, value);
-			core_assert_msg(entry != nullptr, "Failed to allocate for hash: %i", (int)hashValue);
-			if (prev == nullptr) {
-				_buckets[hashValue % BUCKETSIZE] = entry;
-			} else {
-				prev->next = entry;
-			}
-		} else {
-			entry->value = value;
+		const size_t idx = findSlot(key);
+		if (idx < _capacity) {
+			_entries[idx].value = value;
+			return;
 		}
+		insertNew(KeyValue(key, value));
 	}
 
 	iterator begin() const {
-		for (size_t i = 0u; i < BUCKETSIZE; ++i) {
-			KeyValue *entry = _buckets[i];
-			if (entry != nullptr) {
-				return iterator(this, i, entry);
+		if (_size == 0u) {
+			return end();
+		}
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != EmptySlot) {
+				return iterator(this, i);
 			}
 		}
 		return end();
@@ -261,15 +408,16 @@ public:
 	}
 
 	void clear() {
-		for (size_t i = 0u; i < BUCKETSIZE; ++i) {
-			KeyValue *entry = _buckets[i];
-			while (entry != nullptr) {
-				KeyValue *prev = entry;
-				entry = entry->next;
-				_allocator.free(prev);
+		if (_size == 0u) {
+			return;
+		}
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != EmptySlot) {
+				_entries[i].~KeyValue();
+				_distances[i] = EmptySlot;
 			}
-			_buckets[i] = nullptr;
 		}
+		_size = 0u;
 	}
 
 	inline void erase(const iterator& iter) {
@@ -277,28 +425,22 @@ public:
 	}
 
 	bool remove(const KEYTYPE& key) {
-		const size_t hashValue = (size_t)_hasher(key);
-		KeyValue *entry = _buckets[hashValue % BUCKETSIZE];
-		KeyValue *prev = nullptr;
-
-		while (entry != nullptr) {
-			if (COMPARE()(entry->key, key)) {
-				break;
-			}
-			prev = entry;
-			entry = entry->next;
-		}
-		if (entry == nullptr) {
+		size_t idx = findSlot(key);
+		if (idx >= _capacity) {
 			return false;
 		}
-
-		if (prev == nullptr) {
-			_buckets[hashValue % BUCKETSIZE] = entry->next;
-		} else {
-			prev->next = entry->next;
+		_entries[idx].~KeyValue();
+		// shift the following entries back until one is in its home slot or the slot is empty
+		size_t next = (idx + 1u) & mask();
+		while (_distances[next] > 1u) {
+			new (&_entries[idx]) KeyValue(core::move(_entries[next]));
+			_entries[next].~KeyValue();
+			_distances[idx] = _distances[next] - 1u;
+			idx = next;
+			next = (next + 1u) & mask();
 		}
-
-		_allocator.free(entry);
+		_distances[idx] = EmptySlot;
+		--_size;
 		return true;
 	}
 };
@@ -28,11 +28,15 @@ public:
 	void unlockWrite() core_thread_release();
 };
 
+/**
+ * @brief Scoped shared lock for @c ReadWriteLock or @c ReadWriteSpinLock
+ */
+template<class LOCK = ReadWriteLock>
 class core_thread_scoped_capability ScopedReadLock {
 private:
-	const ReadWriteLock& _lock;
+	const LOCK& _lock;
 public:
-	inline ScopedReadLock(const ReadWriteLock& lock) core_thread_acquire_shared(lock) : _lock(lock) {
+	inline ScopedReadLock(const LOCK& lock) core_thread_acquire_shared(lock) : _lock(lock) {
 		_lock.lockRead();
 	}
 	inline ~ScopedReadLock() core_thread_release() {
@@ -40,11 +44,15 @@ public:
 	}
 };
 
+/**
+ * @brief Scoped exclusive lock for @c ReadWriteLock or @c ReadWriteSpinLock
+ */
+template<class LOCK = ReadWriteLock>
 class core_thread_scoped_capability ScopedWriteLock {
 private:
-	ReadWriteLock& _lock;
+	LOCK& _lock;
 public:
-	inline ScopedWriteLock(ReadWriteLock& lock) core_thread_acquire(lock): _lock(lock) {
+	inline ScopedWriteLock(LOCK& lock) core_thread_acquire(lock): _lock(lock) {
 		_lock.lockWrite();
 	}
 	inline ~ScopedWriteLock() core_thread_release() {
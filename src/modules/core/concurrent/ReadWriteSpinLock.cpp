@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#include "ReadWriteSpinLock.h"
+#include <thread>
+
+namespace core {
+
+ReadWriteSpinLock::ReadWriteSpinLock() {
+	SDL_AtomicSet(&_state, 0);
+	SDL_AtomicSet(&_writersWaiting, 0);
+}
+
+void ReadWriteSpinLock::lockRead() const {
+	for (;;) {
+		if (SDL_AtomicGet(&_writersWaiting) == 0) {
+			const int readers = SDL_AtomicGet(&_state);
+			if (readers >= 0 && SDL_AtomicCAS(&_state, readers, readers + 1)) {
+				return;
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+void ReadWriteSpinLock::unlockRead() const {
+	SDL_AtomicAdd(&_state, -1);
+}
+
+void ReadWriteSpinLock::lockWrite() {
+	SDL_AtomicAdd(&_writersWaiting, 1);
+	while (!SDL_AtomicCAS(&_state, 0, -1)) {
+		std::this_thread::yield();
+	}
+	SDL_AtomicAdd(&_writersWaiting, -1);
+}
+
+void ReadWriteSpinLock::unlockWrite() {
+	SDL_AtomicSet(&_state, 0);
+}
+
+}
@@ -0,0 +1,45 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Concurrency.h"
+#include <SDL_atomic.h>
+
+namespace core {
+
+/**
+ * @brief Reader/writer lock where any amount of readers can hold the lock at the same time.
+ *
+ * Other than @c ReadWriteLock the read lock is really shared - only the write lock is exclusive. Waiting is done
+ * by spinning, so this should only be used for very short critical sections, like lookups in a map. Writers are
+ * preferred - as soon as a writer is waiting, no new readers are let in.
+ *
+ * @note This lock is not recursive.
+ * @sa ScopedReadLock
+ * @sa ScopedWriteLock
+ */
+class core_thread_capability("mutex") ReadWriteSpinLock {
+private:
+	/**
+	 * @c -1 if a writer holds the lock, otherwise the amount of readers
+	 */
+	mutable SDL_atomic_t _state;
+	mutable SDL_atomic_t _writersWaiting;
+public:
+	ReadWriteSpinLock();
+
+	ReadWriteSpinLock(const ReadWriteSpinLock &) = delete;
+	ReadWriteSpinLock &operator=(const ReadWriteSpinLock &) = delete;
+
+	void lockRead() const core_thread_acquire_shared();
+
+	void unlockRead() const core_thread_release();
+
+	void lockWrite() core_thread_acquire();
+
+	void unlockWrite() core_thread_release();
+};
+
+}
@@ -6,21 +6,169 @@
 #include "core/StringUtil.h"
 #include "core/Trace.h"
 #include "core/concurrent/Concurrency.h"
+#include <SDL_thread.h>
 
 namespace core {
 
+/**
+ * The pool and the queue index of the current thread if it is a worker of a pool
+ */
+static thread_local ThreadPool* _currentPool = nullptr;
+static thread_local int _currentWorker = -1;
+
+void ThreadPool::TaskDeque::push(Task &&task) {
+	_tasks.emplace_back(core::move(task));
+}
+
+bool ThreadPool::TaskDeque::popBack(Task &task) {
+	if (empty()) {
+		return false;
+	}
+	task = core::move(_tasks.back());
+	_tasks.pop();
+	if (empty()) {
+		clear();
+	}
+	return true;
+}
+
+bool ThreadPool::TaskDeque::popFront(Task &task) {
+	if (empty()) {
+		return false;
+	}
+	task = core::move(_tasks[_front++]);
+	if (empty()) {
+		clear();
+	} else if (_front >= 64u && _front * 2u >= _tasks.size()) {
+		// don't let the consumed slots grow without bounds
+		_tasks.erase(0, _front);
+		_front = 0u;
+	}
+	return true;
+}
+
+void ThreadPool::TaskDeque::clear() {
+	_tasks.clear();
+	_front = 0u;
+}
+
 ThreadPool::ThreadPool(size_t threads, const char *name) :
-		_threads(threads), _name(name) {
+		_threads(core_max(threads, (size_t)1)), _name(name) {
 	if (_name == nullptr) {
 		_name = "ThreadPool";
 	}
+	_queues = new WorkerQueue[_threads];
 }
 
 void ThreadPool::abort() {
-	core::ScopedLock lock(_queueMutex);
-	while (!_tasks.empty()) {
-		_tasks.pop();
+	for (size_t i = 0; i < _threads; ++i) {
+		WorkerQueue &queue = _queues[i];
+		core::ScopedLock lock(queue.lock);
+		for (int p = 0; p < (int)Priority::Max; ++p) {
+			TaskDeque &lane = queue.lanes[p];
+			_pending.decrement((int)lane.size());
+			lane.clear();
+		}
+	}
+}
+
+int ThreadPool::queueIndex() {
+	if (_currentPool == this) {
+		return _currentWorker;
+	}
+	return (int)((uint32_t)_nextQueue.increment() % (uint32_t)_threads);
+}
+
+bool ThreadPool::push(Task &&task, Priority priority) {
+	WorkerQueue &queue = _queues[queueIndex()];
+	{
+		core::ScopedLock lock(queue.lock);
+		if (_stop) {
+			return false;
+		}
+		queue.lanes[(int)priority].push(core::move(task));
+		_pending.increment();
 	}
+	wakeup(1);
+	return true;
+}
+
+void ThreadPool::wakeup(int tasks) {
+	// the sleeping counter is modified while holding the sleep mutex - if we see zero here, any
+	// worker that is about to sleep will see the pending tasks in its predicate
+	if (tasks <= 0 || _sleeping == 0) {
+		return;
+	}
+	core::ScopedLock lock(_sleepMutex);
+	if (tasks == 1) {
+		_sleepCondition.notify_one();
+	} else {
+		_sleepCondition.notify_all();
+	}
+}
+
+bool ThreadPool::pop(int worker, Task &task) {
+	if (_pending <= 0) {
+		return false;
+	}
+	for (int p = 0; p < (int)Priority::Max; ++p) {
+		{
+			WorkerQueue &own = _queues[worker];
+			core::ScopedLock lock(own.lock);
+			if (own.lanes[p].popBack(task)) {
+				_pending.decrement();
+				return true;
+			}
+		}
+		for (size_t i = 1; i < _threads; ++i) {
+			WorkerQueue &victim = _queues[(worker + i) % _threads];
+			core::ScopedLock lock(victim.lock);
+			if (victim.lanes[p].popFront(task)) {
+				_pending.decrement();
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void ThreadPool::yield() {
+	std::this_thread::yield();
+}
+
+void ThreadPool::workerLoop(int worker) {
+	const core::String n = core::string::format("%s-%i", _name, worker);
+	if (!setThreadName(n.c_str())) {
+		Log::error("Failed to set thread name for pool thread %i", worker);
+	}
+	core_trace_thread(n.c_str());
+	_currentPool = this;
+	_currentWorker = worker;
+	for (;;) {
+		Task task;
+		if (!(_stop && _force) && pop(worker, task)) {
+			core_trace_begin_frame(n.c_str());
+			core_trace_scoped(ThreadPoolWorker);
+			Log::trace(logid, "Execute task in %i", (int)getThreadId());
+			task();
+			Log::trace(logid, "End of task in %i", (int)getThreadId());
+			core_trace_end_frame(n.c_str());
+			continue;
+		}
+		core::ScopedLock lock(_sleepMutex);
+		_sleeping.increment();
+		_sleepCondition.wait(_sleepMutex, [this] {
+			// predicate must return false if the waiting should continue
+			return _stop || _pending > 0;
+		});
+		_sleeping.decrement();
+		if (_stop && (_force || _pending <= 0)) {
+			Log::debug(logid, "Shutdown worker thread for %i", (int)getThreadId());
+			break;
+		}
+	}
+	_currentPool = nullptr;
+	_currentWorker = -1;
 }
 
 void ThreadPool::init() {
@@ -29,48 +177,16 @@ void ThreadPool::init() {
 	_workers.reserve(_threads);
 	for (size_t i = 0; i < _threads; ++i) {
 		_workers.emplace_back([this, i] {
-			const core::String n = core::string::format("%s-%i", this->_name, (int)i);
-			if (!setThreadName(n.c_str())) {
-				Log::error("Failed to set thread name for pool thread %i", (int)i);
-			}
-			core_trace_thread(n.c_str());
-			for (;;) {
-				std::function<void()> task;
-				{
-					core::ScopedLock lock(this->_queueMutex);
-					if (!this->_stop) {
-						this->_queueCondition.wait(this->_queueMutex, [this] {
-							// predicate must return false if the waiting should continue
-							if (this->_stop) {
-								return true;
-							}
-							if (!this->_tasks.empty()) {
-								return true;
-							}
-							return false;
-						});
-					}
-					if (this->_stop && (this->_force || this->_tasks.empty())) {
-						Log::debug(logid, "Shutdown worker thread for %i", (int)getThreadId());
-						break;
-					}
-					task = core::move(this->_tasks.front());
-					this->_tasks.pop();
-				}
-
-				core_trace_begin_frame(n.c_str());
-				core_trace_scoped(ThreadPoolWorker);
-				Log::trace(logid, "Execute task in %i", (int)getThreadId());
-				task();
-				Log::trace(logid, "End of task in %i", (int)getThreadId());
-				core_trace_end_frame(n.c_str());
-			}
+			workerLoop((int)i);
+			// the workers are no SDL threads - SDL doesn't free their thread local storage (e.g. the error buffer)
+			SDL_TLSCleanup();
 		});
 	}
 }
 
 ThreadPool::~ThreadPool() {
 	shutdown();
+	delete[] _queues;
 }
 
 void ThreadPool::shutdown(bool wait) {
@@ -78,12 +194,18 @@ void ThreadPool::shutdown(bool wait) {
 		return;
 	}
 	_force = !wait;
-	_stop = true;
-	_queueCondition.notify_all();
+	{
+		core::ScopedLock lock(_sleepMutex);
+		_stop = true;
+		_sleepCondition.notify_all();
+	}
 	for (std::thread &worker : _workers) {
 		worker.join();
 	}
 	_workers.clear();
+	if (_force) {
+		abort();
+	}
 }
 
 }
@@ -30,21 +30,146 @@
 #include <thread>
 #include <future>
 #include <functional>
+#include <new>
+#include <stddef.h>
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Queue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
+#include "core/Common.h"
 #include "core/Trace.h"
 #include "core/SharedPtr.h"
 #include "core/Log.h"
 
 namespace core {
 
+/**
+ * @brief Work stealing thread pool
+ *
+ * Every worker has its own task queue with one lane per @c Priority. Tasks that are scheduled from
+ * within a worker are put into the queue of that worker, tasks from other threads are distributed
+ * over all worker queues. An idle worker takes the tasks of its own queue first and steals from
+ * the other queues afterwards. Tasks with a higher priority are always picked before any task of a
+ * lower priority - no matter which queue they are in.
+ */
 class ThreadPool final {
 private:
 	static constexpr auto logid = Log::logid("ThreadPool");
 public:
+	enum class Priority : uint8_t {
+		High, Normal, Low, Max
+	};
+
+	/**
+	 * @brief Move only wrapper for a callable with small buffer storage. Only functors that don't fit
+	 * into the buffer are allocated on the heap.
+	 */
+	class Task {
+	private:
+		static constexpr size_t BufferSize = 48u;
+		typedef void (*InvokeFunc)(void *);
+		/**
+		 * @brief Move constructs the functor in @c dst from @c src and destroys @c src. If @c dst is
+		 * @c nullptr, the functor in @c src is only destroyed.
+		 */
+		typedef void (*ManageFunc)(void *dst, void *src);
+
+		alignas(alignof(max_align_t)) uint8_t _buffer[BufferSize];
+		InvokeFunc _invoke = nullptr;
+		ManageFunc _manage = nullptr;
+
+		template<class F>
+		struct InlineStorage {
+			static void invoke(void *buf) {
+				(*(F *)buf)();
+			}
+			static void manage(void *dst, void *src) {
+				if (dst != nullptr) {
+					new (dst) F(core::move(*(F *)src));
+				}
+				((F *)src)->~F();
+			}
+		};
+
+		template<class F>
+		struct HeapStorage {
+			static void invoke(void *buf) {
+				(**(F **)buf)();
+			}
+			static void manage(void *dst, void *src) {
+				if (dst != nullptr) {
+					*(F **)dst = *(F **)src;
+				} else {
+					delete *(F **)src;
+				}
+			}
+		};
+
+		void release() {
+			if (_manage != nullptr) {
+				_manage(nullptr, _buffer);
+			}
+			_invoke = nullptr;
+			_manage = nullptr;
+		}
+
+	public:
+		Task() {
+		}
+
+		template<class F, class FT = typename std::decay<F>::type,
+				class = typename std::enable_if<!std::is_same<FT, Task>::value>::type>
+		Task(F &&f) {
+			if (sizeof(FT) <= BufferSize && alignof(FT) <= alignof(max_align_t)) {
+				new (_buffer) FT(core::forward<F>(f));
+				_invoke = &InlineStorage<FT>::invoke;
+				_manage = &InlineStorage<FT>::manage;
+			} else {
+				*(FT **)_buffer = new FT(core::forward<F>(f));
+				_invoke = &HeapStorage<FT>::invoke;
+				_manage = &HeapStorage<FT>::manage;
+			}
+		}
+
+		Task(Task &&other) noexcept : _invoke(other._invoke), _manage(other._manage) {
+			if (_manage != nullptr) {
+				_manage(_buffer, other._buffer);
+			}
+			other._invoke = nullptr;
+			other._manage = nullptr;
+		}
+
+		Task &operator=(Task &&other) noexcept {
+			if (this == &other) {
+				return *this;
+			}
+			release();
+			_invoke = other._invoke;
+			_manage = other._manage;
+			if (_manage != nullptr) {
+				_manage(_buffer, other._buffer);
+			}
+			other._invoke = nullptr;
+			other._manage = nullptr;
+			return *this;
+		}
+
+		Task(const Task &) = delete;
+		Task &operator=(const Task &) = delete;
+
+		~Task() {
+			release();
+		}
+
+		inline bool valid() const {
+			return _invoke != nullptr;
+		}
+
+		inline void operator()() {
+			_invoke(_buffer);
+		}
+	};
+
 	explicit ThreadPool(size_t, const char *name = nullptr);
 	~ThreadPool();
 
@@ -54,6 +179,36 @@ public:
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
 
+	/**
+	 * Enqueue functors or lambdas into the thread pool with the given priority
+	 */
+	template<class F, class ... Args>
+	auto enqueue(Priority priority, F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
+
+	/**
+	 * @brief Fire and forget variant of @c enqueue(). There is no future and small functors don't need
+	 * any heap allocation.
+	 * @return @c false if the pool was already shut down
+	 */
+	template<class F>
+	bool schedule(F&& f, Priority priority = Priority::Normal);
+
+	/**
+	 * @brief Schedules @c n tasks that call @c func with the task index @c [0,n). The tasks are
+	 * distributed over the worker queues and every queue is only locked once.
+	 * @return @c false if the pool was already shut down
+	 */
+	template<class F>
+	bool enqueueBulk(int n, const F& func, Priority priority = Priority::Normal);
+
+	/**
+	 * @brief Calls @c func(begin, end) for contiguous batches of @c batchSize of the range @c [start,end)
+	 * and returns once all batches were executed. The calling thread is executing batches, too - so
+	 * this is also working if all workers are busy or this is called from within a worker.
+	 */
+	template<class F>
+	void parallelFor(int start, int end, int batchSize, const F& func, Priority priority = Priority::High);
+
 	size_t size() const;
 	void init();
 	/**
@@ -63,41 +218,190 @@ public:
 	void abort();
 	void shutdown(bool wait = false);
 private:
+	/**
+	 * @brief Double ended task queue. The owning worker is taking tasks from the back, other
+	 * workers are stealing from the front.
+	 */
+	class TaskDeque {
+	private:
+		core::DynamicArray<Task> _tasks;
+		size_t _front = 0u;
+	public:
+		inline bool empty() const {
+			return _front >= _tasks.size();
+		}
+		inline size_t size() const {
+			return _tasks.size() - _front;
+		}
+		void push(Task &&task);
+		bool popBack(Task &task);
+		bool popFront(Task &task);
+		void clear();
+	};
+
+	struct WorkerQueue {
+		core_trace_mutex(core::Lock, lock, "ThreadPoolQueue");
+		TaskDeque lanes[(int)Priority::Max] core_thread_guarded_by(lock);
+	};
+
+	/**
+	 * @brief Shared state of a @c parallelFor() call. Helper tasks might still be queued when the
+	 * call returns - they are only touching this state then.
+	 */
+	struct ParallelForState {
+		core::AtomicInt next;
+		core::AtomicInt done;
+		int end = 0;
+		int batchSize = 0;
+	};
+
 	const size_t _threads;
 	const char *_name;
 	// need to keep track of threads so we can join them
 	core::DynamicArray<std::thread> _workers;
-	// the task queue
-	core::Queue<std::function<void()> > _tasks core_thread_guarded_by(_queueMutex);
+	WorkerQueue *_queues;
+	/**
+	 * @brief The amount of tasks in all worker queues
+	 */
+	core::AtomicInt _pending { 0 };
+	core::AtomicInt _sleeping { 0 };
+	core::AtomicInt _nextQueue { 0 };
 
-	// synchronization
-	core_trace_mutex(core::Lock, _queueMutex, "ThreadPoolQueue");
-	core::ConditionVariable _queueCondition;
+	// synchronization for idle workers
+	core_trace_mutex(core::Lock, _sleepMutex, "ThreadPoolSleep");
+	core::ConditionVariable _sleepCondition;
 	core::AtomicBool _stop { false };
 	core::AtomicBool _force { false };
+
+	/**
+	 * @return The index of the queue that new tasks from the current thread are put into
+	 */
+	int queueIndex();
+	bool push(Task &&task, Priority priority);
+	void wakeup(int tasks);
+	/**
+	 * @brief Takes the task with the highest priority - own queue first, then steal from the others
+	 */
+	bool pop(int worker, Task &task);
+	void workerLoop(int worker);
+	/**
+	 * @brief Executes batches of the given parallel for state until none is left
+	 */
+	template<class F>
+	static void executeBatches(ParallelForState &state, const F &func);
+	static void yield();
 };
 
 // add new work item to the pool
 template<class F, class ... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args)
+-> std::future<typename std::result_of<F(Args...)>::type> {
+	return enqueue(Priority::Normal, core::forward<F>(f), core::forward<Args>(args)...);
+}
+
+template<class F, class ... Args>
+auto ThreadPool::enqueue(Priority priority, F&& f, Args&&... args)
 -> std::future<typename std::result_of<F(Args...)>::type> {
 	using return_type = typename std::result_of<F(Args...)>::type;
 	if (_stop) {
 		return std::future<return_type>();
 	}
 
-	core::SharedPtr<std::packaged_task<return_type()> > task = core::make_shared<std::packaged_task<return_type()> >(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::packaged_task<return_type()> task(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::future<return_type> res = task.get_future();
+	// the packaged task itself fits into the small buffer of the task
+	if (!push(Task([t = core::move(task)] () mutable {t();}), priority)) {
+		return std::future<return_type>();
+	}
+	return res;
+}
+
+template<class F>
+bool ThreadPool::schedule(F&& f, Priority priority) {
+	if (_stop) {
+		return false;
+	}
+	return push(Task(core::forward<F>(f)), priority);
+}
 
-	std::future<return_type> res = task->get_future();
-	{
-		core::ScopedLock lock(_queueMutex);
-		if (_stop) {
-			return std::future<return_type>();
+template<class F>
+bool ThreadPool::enqueueBulk(int n, const F& func, Priority priority) {
+	if (_stop) {
+		return false;
+	}
+	if (n <= 0) {
+		return true;
+	}
+	const int queues = (int)_threads;
+	const int perQueue = (n + queues - 1) / queues;
+	const int first = _nextQueue.increment();
+	int scheduled = 0;
+	for (int q = 0; q < queues && scheduled < n; ++q) {
+		WorkerQueue &queue = _queues[(first + q) % queues];
+		const int amount = core_min(perQueue, n - scheduled);
+		{
+			core::ScopedLock lock(queue.lock);
+			if (_stop) {
+				break;
+			}
+			TaskDeque &lane = queue.lanes[(int)priority];
+			for (int i = scheduled; i < scheduled + amount; ++i) {
+				lane.push(Task([func, i] () {func(i);}));
+			}
+			_pending.increment(amount);
 		}
-		_tasks.emplace([task]() {(*task.get())();});
+		scheduled += amount;
+	}
+	wakeup(scheduled);
+	return scheduled == n;
+}
+
+template<class F>
+void ThreadPool::executeBatches(ParallelForState &state, const F &func) {
+	for (;;) {
+		const int start = state.next.increment(state.batchSize);
+		if (start >= state.end) {
+			break;
+		}
+		func(start, core_min(start + state.batchSize, state.end));
+		state.done.increment(core_min(state.batchSize, state.end - start));
+	}
+}
+
+template<class F>
+void ThreadPool::parallelFor(int start, int end, int batchSize, const F& func, Priority priority) {
+	const int n = end - start;
+	if (n <= 0) {
+		return;
+	}
+	if (batchSize <= 0) {
+		batchSize = 1;
+	}
+	const int batches = (n + batchSize - 1) / batchSize;
+	if (batches == 1 || _stop) {
+		func(start, end);
+		return;
+	}
+	// the state is shared with the helper tasks that might only run after we returned
+	core::SharedPtr<ParallelForState> state = core::make_shared<ParallelForState>();
+	state->next = 0;
+	state->done = 0;
+	state->end = n;
+	state->batchSize = batchSize;
+	auto batchFunc = [&func, start] (int b, int e) {
+		func(start + b, start + e);
+	};
+	// the calling thread is executing batches, too
+	const int helpers = core_min((int)_threads, batches - 1);
+	for (int i = 0; i < helpers; ++i) {
+		schedule([state, batchFunc] () {
+			executeBatches(*state.get(), batchFunc);
+		}, priority);
+	}
+	executeBatches(*state.get(), batchFunc);
+	while (state->done < n) {
+		yield();
 	}
-	_queueCondition.notify_one();
-	return res;
 }
 
 inline size_t ThreadPool::size() const {
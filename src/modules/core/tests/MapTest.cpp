@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 #include "core/collection/StringMap.h"
 #include "core/SharedPtr.h"
+#include "core/GLM.h"
 
 namespace core {
 
@@ -157,4 +158,72 @@ TEST(HashMapTest, testAssign) {
 	EXPECT_EQ(0u, map2.size());
 }
 
+TEST(HashMapTest, testRemove) {
+	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	for (int64_t i = 0; i < 1024; i += 3) {
+		EXPECT_TRUE(map.remove(i));
+		EXPECT_FALSE(map.remove(i));
+	}
+	int64_t value;
+	for (int64_t i = 0; i < 1024; ++i) {
+		if (i % 3 == 0) {
+			EXPECT_FALSE(map.hasKey(i)) << "Removed key " << i << " is still in the map";
+		} else {
+			EXPECT_TRUE(map.get(i, value)) << "Key " << i << " got lost while removing other keys";
+			EXPECT_EQ(i, value);
+		}
+	}
+	EXPECT_EQ(1024u - 342u, map.size());
+}
+
+TEST(HashMapTest, testGrow) {
+	// more entries than the old fixed size pool could hold
+	core::Map<int64_t, int64_t, 11, std::hash<int64_t>> map;
+	const int64_t n = 100000;
+	for (int64_t i = 0; i < n; ++i) {
+		map.put(i * 4096, i);
+	}
+	EXPECT_EQ((size_t)n, map.size());
+	EXPECT_GE(map.capacity(), map.size());
+	int64_t value;
+	for (int64_t i = 0; i < n; ++i) {
+		ASSERT_TRUE(map.get(i * 4096, value));
+		ASSERT_EQ(i, value);
+	}
+}
+
+TEST(HashMapTest, testIVec3) {
+	core::Map<glm::ivec3, int, 64, glm::hash<glm::ivec3>> map;
+	for (int z = -16; z < 16; ++z) {
+		for (int x = -16; x < 16; ++x) {
+			map.put(glm::ivec3(x * 32, 0, z * 32), x + z);
+		}
+	}
+	EXPECT_EQ(1024u, map.size());
+	int value;
+	EXPECT_TRUE(map.get(glm::ivec3(-512, 0, 480), value));
+	EXPECT_EQ(-16 + 15, value);
+	EXPECT_FALSE(map.hasKey(glm::ivec3(-512, 32, 480)));
+}
+
+TEST(HashMapTest, testCopyAndMove) {
+	core::StringMap<core::String> map;
+	map.put("foo", "bar");
+	map.put("bar", "foo");
+	core::StringMap<core::String> copy(map);
+	core::String value;
+	EXPECT_TRUE(copy.get("foo", value));
+	EXPECT_EQ("bar", value);
+	core::StringMap<core::String> moved(core::move(copy));
+	EXPECT_TRUE(copy.empty());
+	EXPECT_EQ(2u, moved.size());
+	EXPECT_TRUE(moved.get("bar", value));
+	EXPECT_EQ("foo", value);
+	copy = moved;
+	EXPECT_EQ(2u, copy.size());
+}
+
 }
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include "core/concurrent/ReadWriteLock.h"
+#include "core/concurrent/ReadWriteSpinLock.h"
 #include <future>
 
 namespace core {
@@ -77,4 +78,51 @@ TEST_F(ReadWriteLockTest, testMoreWritersThanReaders) {
 	EXPECT_EQ(n1, limit);
 }
 
+class ReadWriteSpinLockTest: public testing::Test {
+protected:
+	core::ReadWriteSpinLock _rwLock;
+	int _value = 0;
+	const int limit { 100000 };
+
+	int read(int loopLimit) {
+		int n = 0;
+		for (int i = 0; i < loopLimit; ++i) {
+			core::ScopedReadLock scoped(_rwLock);
+			if (_value >= 0) {
+				++n;
+			}
+		}
+		return n;
+	}
+
+	void write(int limit) {
+		for (int i = 0; i < limit; ++i) {
+			core::ScopedWriteLock scoped(_rwLock);
+			++_value;
+		}
+	}
+};
+
+TEST_F(ReadWriteSpinLockTest, testSameReadersThanWriters) {
+	int n1 = 0, n2 = 0;
+	auto futureRead1 = std::async(std::launch::async, [&] {n1 += read(limit);});
+	auto futureRead2 = std::async(std::launch::async, [&] {n2 += read(limit);});
+	auto futureWrite1 = std::async(std::launch::async, [=] {write(limit);});
+	auto futureWrite2 = std::async(std::launch::async, [=] {write(limit);});
+	futureRead1.wait();
+	futureRead2.wait();
+	futureWrite1.wait();
+	futureWrite2.wait();
+	EXPECT_EQ(_value, limit * 2);
+	EXPECT_EQ(n1, limit);
+	EXPECT_EQ(n2, limit);
+}
+
+TEST_F(ReadWriteSpinLockTest, testSharedRead) {
+	core::ScopedReadLock scoped(_rwLock);
+	// would dead lock if the read lock was exclusive
+	auto futureRead = std::async(std::launch::async, [&] {return read(1);});
+	EXPECT_EQ(1, futureRead.get());
+}
+
 }
@@ -42,4 +42,133 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testSchedule) {
+	const int x = 1000;
+	core::ThreadPool pool(4);
+	pool.init();
+	for (int i = 0; i < x; ++i) {
+		ASSERT_TRUE(pool.schedule([this] () {
+			++_count;
+		}));
+	}
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+	ASSERT_FALSE(pool.schedule([] () {})) << "Scheduling after shutdown should fail";
+}
+
+TEST_F(ThreadPoolTest, testLargeFunctor) {
+	core::ThreadPool pool(1);
+	pool.init();
+	int values[64];
+	for (int i = 0; i < 64; ++i) {
+		values[i] = i;
+	}
+	// doesn't fit into the small buffer of the task
+	auto future = pool.enqueue([this, values] () {
+		int sum = 0;
+		for (int i = 0; i < 64; ++i) {
+			sum += values[i];
+		}
+		_count = sum;
+	});
+	future.get();
+	ASSERT_EQ(63 * 64 / 2, _count);
+}
+
+TEST_F(ThreadPoolTest, testEnqueueBulk) {
+	const int x = 1000;
+	core::AtomicInt visited[x];
+	core::ThreadPool pool(3);
+	pool.init();
+	ASSERT_TRUE(pool.enqueueBulk(x, [&] (int i) {
+		visited[i].increment();
+	}));
+	pool.shutdown(true);
+	for (int i = 0; i < x; ++i) {
+		ASSERT_EQ(1, (int)visited[i]) << "Task " << i << " was not executed exactly once";
+	}
+}
+
+TEST_F(ThreadPoolTest, testParallelFor) {
+	const int x = 1000;
+	core::AtomicInt visited[x];
+	core::ThreadPool pool(3);
+	pool.init();
+	pool.parallelFor(0, x, 7, [&] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			visited[i].increment();
+		}
+	});
+	for (int i = 0; i < x; ++i) {
+		ASSERT_EQ(1, (int)visited[i]) << "Index " << i << " was not executed exactly once";
+	}
+}
+
+TEST_F(ThreadPoolTest, testNestedParallelFor) {
+	core::ThreadPool pool(2);
+	pool.init();
+	// every worker is blocked in the outer loop - the inner loops must still finish
+	pool.parallelFor(0, 8, 1, [&] (int, int) {
+		pool.parallelFor(0, 100, 10, [&] (int start, int end) {
+			_count.increment(end - start);
+		});
+	});
+	ASSERT_EQ(800, _count);
+}
+
+TEST_F(ThreadPoolTest, testPriority) {
+	core::ThreadPool pool(1);
+	pool.init();
+	core::AtomicBool block { true };
+	core::AtomicInt started { 0 };
+	// keep the only worker busy until all tasks are queued
+	pool.schedule([&] () {
+		started = 1;
+		while (block) {
+			std::this_thread::yield();
+		}
+	});
+	while (started == 0) {
+		std::this_thread::yield();
+	}
+	core::AtomicInt order { 0 };
+	int lowOrder = -1;
+	int highOrder = -1;
+	pool.schedule([&] () {
+		lowOrder = order.increment();
+	}, core::ThreadPool::Priority::Low);
+	pool.schedule([&] () {
+		highOrder = order.increment();
+	}, core::ThreadPool::Priority::High);
+	block = false;
+	pool.shutdown(true);
+	EXPECT_EQ(0, highOrder);
+	EXPECT_EQ(1, lowOrder);
+}
+
+TEST_F(ThreadPoolTest, testAbort) {
+	core::ThreadPool pool(1);
+	pool.init();
+	core::AtomicBool block { true };
+	core::AtomicInt started { 0 };
+	pool.schedule([&] () {
+		started = 1;
+		while (block) {
+			std::this_thread::yield();
+		}
+	});
+	while (started == 0) {
+		std::this_thread::yield();
+	}
+	for (int i = 0; i < 10; ++i) {
+		pool.schedule([this] () {
+			++_count;
+		});
+	}
+	pool.abort();
+	block = false;
+	pool.shutdown(true);
+	ASSERT_EQ(0, _count) << "Aborted tasks were executed";
+}
+
 }
@@ -11,17 +11,51 @@
 
 namespace io {
 
-FileStream::FileStream(File* file) :
-		FileStream(file->_file) {
+FileStream::FileStream(File* file, size_t readBufferSize) :
+		FileStream(file->_file, readBufferSize) {
 }
 
-FileStream::FileStream(SDL_RWops* rwops) :
-		_rwops(rwops) {
+FileStream::FileStream(SDL_RWops* rwops, size_t readBufferSize) :
+		_rwops(rwops), _readBufferSize(readBufferSize) {
 	core_assert(rwops != nullptr);
 	_size = SDL_RWsize(_rwops);
 }
 
 FileStream::~FileStream() {
+	core_free(_readBuffer);
+}
+
+bool FileStream::readDirect(uint8_t *buf, size_t size) const {
+	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
+	size_t completeBytesRead = 0;
+	size_t bytesRead = 1;
+	while (completeBytesRead < size && bytesRead != 0) {
+		bytesRead = SDL_RWread(_rwops, buf + completeBytesRead, 1, size - completeBytesRead);
+		completeBytesRead += bytesRead;
+	}
+	return completeBytesRead == size;
+}
+
+const uint8_t* FileStream::fillReadBuffer(size_t size) const {
+	// without buffering we still need space for the largest primitive
+	const size_t capacity = core_max(_readBufferSize, sizeof(uint64_t));
+	if (size > capacity) {
+		return nullptr;
+	}
+	if (_readBuffer == nullptr) {
+		_readBuffer = (uint8_t*)core_malloc(capacity);
+	}
+	_readBufferPos = _pos;
+	_readBufferFill = 0;
+	const int64_t amount = core_min((int64_t)core_max(size, _readBufferSize), remaining());
+	if (amount < (int64_t)size) {
+		return nullptr;
+	}
+	if (!readDirect(_readBuffer, amount)) {
+		return nullptr;
+	}
+	_readBufferFill = amount;
+	return _readBuffer;
 }
 
 int FileStream::peekInt(uint32_t& val) const {
@@ -283,11 +317,44 @@ int FileStream::readIntBE(uint32_t& val) {
 }
 
 int FileStream::readBuf(uint8_t *buf, size_t bufSize) {
-	for (size_t i = 0; i < bufSize; ++i) {
-		if (readByte(buf[i]) != 0) {
+	if (remaining() < (int64_t)bufSize) {
+		return -1;
+	}
+	if (bufSize <= _readBufferSize) {
+		const uint8_t *data = readBuffer(bufSize);
+		if (data == nullptr) {
 			return -1;
 		}
+		core_memcpy(buf, data, bufSize);
+	} else if (!readDirect(buf, bufSize)) {
+		// bypass the read buffer for large reads
+		return -1;
+	}
+	_pos += bufSize;
+	return 0;
+}
+
+int FileStream::readShorts(uint16_t *buf, size_t amount) {
+	if (readBuf((uint8_t*)buf, amount * sizeof(uint16_t)) != 0) {
+		return -1;
+	}
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (size_t i = 0; i < amount; ++i) {
+		buf[i] = SDL_SwapLE16(buf[i]);
+	}
+#endif
+	return 0;
+}
+
+int FileStream::readInts(uint32_t *buf, size_t amount) {
+	if (readBuf((uint8_t*)buf, amount * sizeof(uint32_t)) != 0) {
+		return -1;
+	}
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (size_t i = 0; i < amount; ++i) {
+		buf[i] = SDL_SwapLE32(buf[i]);
 	}
+#endif
 	return 0;
 }
 
@@ -312,6 +379,7 @@ int FileStream::readLongBE(uint64_t& val) {
 }
 
 bool FileStream::addByte(uint8_t val) {
+	invalidateReadBuffer();
 	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 	if (SDL_RWwrite(_rwops, &val, 1, 1) != 1) {
 		return false;
@@ -324,6 +392,7 @@ bool FileStream::addByte(uint8_t val) {
 }
 
 bool FileStream::append(const uint8_t *buf, size_t size) {
+	invalidateReadBuffer();
 	SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 	size_t completeBytesWritten = 0;
 	int32_t bytesWritten = 1;
@@ -10,6 +10,8 @@
 #include <SDL_rwops.h>
 #include "core/Common.h"
 #include "core/SharedPtr.h"
+#include "core/NonCopyable.h"
+#include "core/StandardLib.h"
 #include <limits.h>
 
 namespace io {
@@ -19,17 +21,43 @@ typedef core::SharedPtr<File> FilePtr;
 
 /**
  * @brief Little endian file stream
+ *
+ * Reads are served from an internal buffer that is filled with large chunks of the file. This avoids a seek
+ * and read call into the @c SDL_RWops for every primitive that is read. Writing to the stream invalidates
+ * the buffer.
  */
-class FileStream {
+class FileStream : public core::NonCopyable {
+public:
+	static constexpr size_t DefaultReadBufferSize = 64 * 1024;
 private:
 	int64_t _pos = 0;
 	int64_t _size = 0;
 	mutable SDL_RWops *_rwops;
 
+	const size_t _readBufferSize;
+	mutable uint8_t *_readBuffer = nullptr;
+	// the stream position of the first byte in the read buffer
+	mutable int64_t _readBufferPos = 0;
+	// the amount of valid bytes in the read buffer
+	mutable int64_t _readBufferFill = 0;
+
+	/**
+	 * @return Pointer to @c size bytes at the current stream position or @c nullptr on error
+	 */
+	const uint8_t* readBuffer(size_t size) const;
+	const uint8_t* fillReadBuffer(size_t size) const;
+	bool readDirect(uint8_t *buf, size_t size) const;
+	inline void invalidateReadBuffer() {
+		_readBufferFill = 0;
+	}
+
 public:
-	FileStream(File* file);
-	FileStream(const FilePtr& file) : FileStream(file.get()) {}
-	FileStream(SDL_RWops* rwops);
+	/**
+	 * @param readBufferSize The size of the read buffer - @c 0 disables the buffering
+	 */
+	FileStream(File* file, size_t readBufferSize = DefaultReadBufferSize);
+	FileStream(const FilePtr& file, size_t readBufferSize = DefaultReadBufferSize) : FileStream(file.get(), readBufferSize) {}
+	FileStream(SDL_RWops* rwops, size_t readBufferSize = DefaultReadBufferSize);
 	virtual ~FileStream();
 
 	inline int64_t remaining() const {
@@ -65,27 +93,17 @@ public:
 		if (remaining() < (int64_t)bufSize) {
 			return -1;
 		}
-		uint8_t buf[bufSize];
-		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
-		uint8_t *b = buf;
-
-		size_t completeBytesRead = 0;
-		size_t bytesRead = 1;
-		while (completeBytesRead < bufSize && bytesRead != 0) {
-			bytesRead = SDL_RWread(_rwops, b, 1, (bufSize - completeBytesRead));
-			b += bytesRead;
-			completeBytesRead += bytesRead;
-		}
-		if (completeBytesRead != bufSize) {
+		const uint8_t *buf = readBuffer(bufSize);
+		if (buf == nullptr) {
 			return -1;
 		}
-		const Ret *word = (const Ret*) (void*) buf;
-		val = *word;
+		core_memcpy((void*)&val, (const void*)buf, bufSize);
 		return 0;
 	}
 
 	template<class Type>
 	inline bool write(Type val) {
+		invalidateReadBuffer();
 		SDL_RWseek(_rwops, _pos, RW_SEEK_SET);
 		const size_t bufSize = sizeof(Type);
 		uint8_t buf[bufSize];
@@ -121,6 +139,12 @@ public:
 	}
 
 	int readBuf(uint8_t *buf, size_t bufSize);
+	/**
+	 * @brief Bulk read of little endian values - e.g. for voxel payloads or offset tables
+	 * @return A value of @c 0 indicates no error
+	 */
+	int readShorts(uint16_t *buf, size_t amount);
+	int readInts(uint32_t *buf, size_t amount);
 
 	bool readBool();
 	int readByte(uint8_t& val);
@@ -192,6 +216,13 @@ public:
 	}
 };
 
+inline const uint8_t* FileStream::readBuffer(size_t size) const {
+	if (_pos >= _readBufferPos && _pos + (int64_t)size <= _readBufferPos + _readBufferFill) {
+		return _readBuffer + (_pos - _readBufferPos);
+	}
+	return fillReadBuffer(size);
+}
+
 inline bool FileStream::empty() const {
 	return _size <= 0;
 }
@@ -73,4 +73,57 @@ TEST_F(FileStreamTest, testFileStreamWrite) {
 	EXPECT_EQ(8l, file->length());
 }
 
+TEST_F(FileStreamTest, testFileStreamReadBufferBoundaries) {
+	uint8_t data[64];
+	for (int i = 0; i < (int)sizeof(data); ++i) {
+		data[i] = (uint8_t)i;
+	}
+	SDL_RWops* rwops = SDL_RWFromConstMem(data, sizeof(data));
+	// a tiny buffer to let the values cross the buffer boundaries
+	FileStream stream(rwops, 5);
+	uint8_t byte;
+	EXPECT_EQ(0, stream.readByte(byte));
+	EXPECT_EQ(0u, byte);
+	uint32_t dword;
+	EXPECT_EQ(0, stream.readInt(dword));
+	EXPECT_EQ(0x04030201u, dword);
+	uint16_t word;
+	EXPECT_EQ(0, stream.readShortBE(word));
+	EXPECT_EQ(0x0506u, word);
+	uint64_t qword;
+	EXPECT_EQ(0, stream.readLong(qword));
+	EXPECT_EQ(0x0e0d0c0b0a090807u, qword);
+	uint8_t buf[20];
+	EXPECT_EQ(0, stream.readBuf(buf, sizeof(buf)));
+	EXPECT_EQ(15u, buf[0]);
+	EXPECT_EQ(34u, buf[19]);
+	uint16_t words[4];
+	EXPECT_EQ(0, stream.readShorts(words, 4));
+	EXPECT_EQ(0x2423u, words[0]);
+	EXPECT_EQ(0x2a29u, words[3]);
+	EXPECT_EQ(0, stream.seek(4));
+	EXPECT_EQ(0, stream.peekShort(word));
+	EXPECT_EQ(0x0504u, word);
+	uint32_t dwords[15];
+	EXPECT_EQ(0, stream.readInts(dwords, 15));
+	EXPECT_EQ(0x3f3e3d3cu, dwords[14]);
+	EXPECT_EQ(0, stream.remaining());
+	EXPECT_NE(0, stream.readByte(byte));
+	SDL_RWclose(rwops);
+}
+
+TEST_F(FileStreamTest, testFileStreamReadAfterWrite) {
+	uint8_t data[16] {};
+	SDL_RWops* rwops = SDL_RWFromMem(data, sizeof(data));
+	FileStream stream(rwops);
+	uint32_t dword;
+	EXPECT_EQ(0, stream.peekInt(dword));
+	EXPECT_EQ(0u, dword);
+	EXPECT_TRUE(stream.addInt(42u));
+	EXPECT_EQ(0, stream.seek(0));
+	EXPECT_EQ(0, stream.readInt(dword));
+	EXPECT_EQ(42u, dword);
+	SDL_RWclose(rwops);
+}
+
 }
@@ -0,0 +1,233 @@
+/**
+ * @file
+ */
+
+#define NOISE_BATCH_IMPLEMENTATION
+#include "SimplexBatch.h"
+#include "SimplexBatchImpl.h"
+#include "Simplex.h"
+#include <SDL_cpuinfo.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace noise {
+
+namespace batch {
+
+namespace {
+
+struct ScalarTraits {
+	typedef float F;
+	typedef int32_t I;
+	typedef bool M;
+	static constexpr int Width = 1;
+
+	static inline F load(const float* p) { return *p; }
+	static inline void store(float* p, F v) { *p = v; }
+	static inline F set(float v) { return v; }
+	static inline I seti(int32_t v) { return v; }
+	static inline F add(F a, F b) { return a + b; }
+	static inline F sub(F a, F b) { return a - b; }
+	static inline F mul(F a, F b) { return a * b; }
+	static inline M gt(F a, F b) { return a > b; }
+	static inline M ge(F a, F b) { return a >= b; }
+	static inline M lti(I a, int32_t b) { return a < b; }
+	static inline M eqi(I a, int32_t b) { return a == b; }
+	static inline M nonzero(I a) { return a != 0; }
+	static inline M mand(M a, M b) { return a && b; }
+	static inline M mor(M a, M b) { return a || b; }
+	static inline M mnot(M a) { return !a; }
+	static inline F select(M m, F a, F b) { return m ? a : b; }
+	static inline I selecti(M m, I a, I b) { return m ? a : b; }
+	static inline F negateIf(M m, F v) { return m ? -v : v; }
+	static inline I trunc(F v) { return (I)v; }
+	static inline F tofloat(I v) { return (F)v; }
+	static inline I addi(I a, I b) { return a + b; }
+	static inline I andi(I a, int32_t b) { return a & b; }
+	static inline I gather(const int32_t* table, I idx) { return table[idx]; }
+};
+
+#ifdef NOISE_HAVE_SSE2
+struct SSE2Traits {
+	typedef __m128 F;
+	typedef __m128i I;
+	typedef __m128 M;
+	static constexpr int Width = 4;
+
+	static inline F load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void store(float* p, F v) { _mm_storeu_ps(p, v); }
+	static inline F set(float v) { return _mm_set1_ps(v); }
+	static inline I seti(int32_t v) { return _mm_set1_epi32(v); }
+	static inline F add(F a, F b) { return _mm_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm_mul_ps(a, b); }
+	static inline M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+	static inline M ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+	static inline M lti(I a, int32_t b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, _mm_set1_epi32(b))); }
+	static inline M eqi(I a, int32_t b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_set1_epi32(b))); }
+	static inline M nonzero(I a) { return mnot(eqi(a, 0)); }
+	static inline M mand(M a, M b) { return _mm_and_ps(a, b); }
+	static inline M mor(M a, M b) { return _mm_or_ps(a, b); }
+	static inline M mnot(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	static inline F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+	static inline I selecti(M m, I a, I b) {
+		const I mi = _mm_castps_si128(m);
+		return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+	}
+	static inline F negateIf(M m, F v) { return _mm_xor_ps(v, _mm_and_ps(m, _mm_set1_ps(-0.0f))); }
+	static inline I trunc(F v) { return _mm_cvttps_epi32(v); }
+	static inline F tofloat(I v) { return _mm_cvtepi32_ps(v); }
+	static inline I addi(I a, I b) { return _mm_add_epi32(a, b); }
+	static inline I andi(I a, int32_t b) { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+	static inline I gather(const int32_t* table, I idx) {
+		alignas(16) int32_t i[4];
+		_mm_store_si128((__m128i*)i, idx);
+		return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+	}
+};
+#endif
+
+}
+
+void fBm2Scalar(const Params& params, const float* x, const float* y, int count, float* out) {
+	fBm2<ScalarTraits>(params, x, y, count, out);
+}
+
+void fBm3Scalar(const Params& params, const float* x, const float* y, const float* z, int count, float* out) {
+	fBm3<ScalarTraits>(params, x, y, z, count, out);
+}
+
+#ifdef NOISE_HAVE_SSE2
+void fBm2SSE2(const Params& params, const float* x, const float* y, int count, float* out) {
+	fBm2<SSE2Traits>(params, x, y, count, out);
+}
+
+void fBm3SSE2(const Params& params, const float* x, const float* y, const float* z, int count, float* out) {
+	fBm3<SSE2Traits>(params, x, y, z, count, out);
+}
+#endif
+
+}
+
+namespace {
+
+struct PermTable {
+	int32_t values[512];
+	PermTable() {
+		for (int i = 0; i < 512; ++i) {
+			values[i] = details::perm[i];
+		}
+	}
+};
+
+const PermTable& permTable() {
+	static const PermTable table;
+	return table;
+}
+
+batch::Params params(uint8_t octaves, float lacunarity, float gain) {
+	return batch::Params{permTable().values, octaves, lacunarity, gain};
+}
+
+}
+
+bool batchLevelSupported(BatchLevel level) {
+	switch (level) {
+	case BatchLevel::Scalar:
+		return true;
+	case BatchLevel::SSE2:
+#ifdef NOISE_HAVE_SSE2
+		return true;
+#else
+		return false;
+#endif
+	case BatchLevel::AVX2:
+#ifdef NOISE_HAVE_AVX2
+		return SDL_HasAVX2() == SDL_TRUE;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+BatchLevel batchLevel() {
+	static const BatchLevel level = [] () {
+		if (batchLevelSupported(BatchLevel::AVX2)) {
+			return BatchLevel::AVX2;
+		}
+		if (batchLevelSupported(BatchLevel::SSE2)) {
+			return BatchLevel::SSE2;
+		}
+		return BatchLevel::Scalar;
+	}();
+	return level;
+}
+
+void fBmBatch(BatchLevel level, const float* x, const float* y, int count, float* out, uint8_t octaves,
+		float lacunarity, float gain) {
+	if (count <= 0) {
+		return;
+	}
+	if (!batchLevelSupported(level)) {
+		level = BatchLevel::Scalar;
+	}
+	const batch::Params& p = params(octaves, lacunarity, gain);
+	switch (level) {
+#ifdef NOISE_HAVE_AVX2
+	case BatchLevel::AVX2:
+		batch::fBm2AVX2(p, x, y, count, out);
+		break;
+#endif
+#ifdef NOISE_HAVE_SSE2
+	case BatchLevel::SSE2:
+		batch::fBm2SSE2(p, x, y, count, out);
+		break;
+#endif
+	default:
+		batch::fBm2Scalar(p, x, y, count, out);
+		break;
+	}
+}
+
+void fBmBatch(BatchLevel level, const float* x, const float* y, const float* z, int count, float* out,
+		uint8_t octaves, float lacunarity, float gain) {
+	if (count <= 0) {
+		return;
+	}
+	if (!batchLevelSupported(level)) {
+		level = BatchLevel::Scalar;
+	}
+	const batch::Params& p = params(octaves, lacunarity, gain);
+	switch (level) {
+#ifdef NOISE_HAVE_AVX2
+	case BatchLevel::AVX2:
+		batch::fBm3AVX2(p, x, y, z, count, out);
+		break;
+#endif
+#ifdef NOISE_HAVE_SSE2
+	case BatchLevel::SSE2:
+		batch::fBm3SSE2(p, x, y, z, count, out);
+		break;
+#endif
+	default:
+		batch::fBm3Scalar(p, x, y, z, count, out);
+		break;
+	}
+}
+
+void fBmBatch(const float* x, const float* y, int count, float* out, uint8_t octaves, float lacunarity,
+		float gain) {
+	fBmBatch(batchLevel(), x, y, count, out, octaves, lacunarity, gain);
+}
+
+void fBmBatch(const float* x, const float* y, const float* z, int count, float* out, uint8_t octaves,
+		float lacunarity, float gain) {
+	fBmBatch(batchLevel(), x, y, z, count, out, octaves, lacunarity, gain);
+}
+
+}
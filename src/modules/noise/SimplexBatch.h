@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace noise {
+
+/**
+ * @brief The instruction set that is used to evaluate the batches
+ */
+enum class BatchLevel : uint8_t {
+	Scalar,
+	SSE2,
+	AVX2,
+
+	Max
+};
+
+/**
+ * @return The best instruction set that is supported by the cpu and the build
+ */
+BatchLevel batchLevel();
+
+/**
+ * @return @c true if the given instruction set is supported by the cpu and the build
+ */
+bool batchLevelSupported(BatchLevel level);
+
+/**
+ * @brief Evaluates the 2d simplex @c fBm() for @c count positions at once. The components of the positions are
+ * given in separate arrays.
+ *
+ * The lanes of the vector registers are filled with consecutive positions - the results don't depend on the
+ * instruction set or on the position of a value in the batch. They match @c noise::fBm() up to some rounding
+ * differences, as the skew factors are applied in single precision.
+ *
+ * @note Uses the default permutation table of the simplex noise - @c noise::seed() is not taken into account
+ */
+void fBmBatch(const float* x, const float* y, int count, float* out, uint8_t octaves = 4, float lacunarity = 2.0f,
+		float gain = 0.5f);
+
+/**
+ * @brief Evaluates the 3d simplex @c fBm() for @c count positions at once.
+ * @sa fBmBatch()
+ */
+void fBmBatch(const float* x, const float* y, const float* z, int count, float* out, uint8_t octaves = 4,
+		float lacunarity = 2.0f, float gain = 0.5f);
+
+/**
+ * @brief Same as @c fBmBatch() but with an explicit instruction set
+ * @note Falls back to @c BatchLevel::Scalar if the given level is not supported
+ */
+void fBmBatch(BatchLevel level, const float* x, const float* y, int count, float* out, uint8_t octaves = 4,
+		float lacunarity = 2.0f, float gain = 0.5f);
+void fBmBatch(BatchLevel level, const float* x, const float* y, const float* z, int count, float* out,
+		uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+
+}
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * @brief Compiled with AVX2 enabled - only called if the cpu supports it.
+ * @note Don't include headers here that might emit inline functions that are shared with other translation units.
+ */
+
+#define NOISE_BATCH_IMPLEMENTATION
+#include "SimplexBatchImpl.h"
+#include <immintrin.h>
+
+namespace noise {
+namespace batch {
+
+namespace {
+
+struct AVX2Traits {
+	typedef __m256 F;
+	typedef __m256i I;
+	typedef __m256 M;
+	static constexpr int Width = 8;
+
+	static inline F load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+	static inline F set(float v) { return _mm256_set1_ps(v); }
+	static inline I seti(int32_t v) { return _mm256_set1_epi32(v); }
+	static inline F add(F a, F b) { return _mm256_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+	static inline M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static inline M ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline M lti(I a, int32_t b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(b), a)); }
+	static inline M eqi(I a, int32_t b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(b))); }
+	static inline M nonzero(I a) { return mnot(eqi(a, 0)); }
+	static inline M mand(M a, M b) { return _mm256_and_ps(a, b); }
+	static inline M mor(M a, M b) { return _mm256_or_ps(a, b); }
+	static inline M mnot(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+	static inline F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+	static inline I selecti(M m, I a, I b) { return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m)); }
+	static inline F negateIf(M m, F v) { return _mm256_xor_ps(v, _mm256_and_ps(m, _mm256_set1_ps(-0.0f))); }
+	static inline I trunc(F v) { return _mm256_cvttps_epi32(v); }
+	static inline F tofloat(I v) { return _mm256_cvtepi32_ps(v); }
+	static inline I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+	static inline I andi(I a, int32_t b) { return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+	static inline I gather(const int32_t* table, I idx) { return _mm256_i32gather_epi32(table, idx, 4); }
+};
+
+}
+
+void fBm2AVX2(const Params& params, const float* x, const float* y, int count, float* out) {
+	fBm2<AVX2Traits>(params, x, y, count, out);
+}
+
+void fBm3AVX2(const Params& params, const float* x, const float* y, const float* z, int count, float* out) {
+	fBm3<AVX2Traits>(params, x, y, z, count, out);
+}
+
+}
+}
@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @brief The batch simplex noise implementation for the different instruction sets.
+ *
+ * This is included by every translation unit that implements an instruction set. The templates are put into
+ * an anonymous namespace - each translation unit is compiled with different compiler flags and the instantiations
+ * must not be merged by the linker.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace noise {
+namespace batch {
+
+struct Params {
+	// the permutation table of the simplex noise widened to 32 bit to allow gathering the values
+	const int32_t* perm;
+	uint8_t octaves;
+	float lacunarity;
+	float gain;
+};
+
+void fBm2Scalar(const Params& params, const float* x, const float* y, int count, float* out);
+void fBm3Scalar(const Params& params, const float* x, const float* y, const float* z, int count, float* out);
+void fBm2SSE2(const Params& params, const float* x, const float* y, int count, float* out);
+void fBm3SSE2(const Params& params, const float* x, const float* y, const float* z, int count, float* out);
+void fBm2AVX2(const Params& params, const float* x, const float* y, int count, float* out);
+void fBm3AVX2(const Params& params, const float* x, const float* y, const float* z, int count, float* out);
+
+}
+}
+
+#ifdef NOISE_BATCH_IMPLEMENTATION
+
+namespace noise {
+namespace batch {
+namespace {
+
+// the skew factors of the scalar simplex noise - see Simplex.h
+constexpr float F2 = 0.366025403f;
+constexpr float G2 = 0.211324865f;
+constexpr float F3 = 0.333333333f;
+constexpr float G3 = 0.166666667f;
+
+/**
+ * @brief Same as @c FASTFLOOR() of the scalar noise - this is @c (int)v-1 for all values <= 0
+ */
+template<class T>
+inline typename T::I fastFloor(typename T::F v) {
+	return T::addi(T::trunc(v), T::selecti(T::gt(v, T::set(0.0f)), T::seti(0), T::seti(-1)));
+}
+
+template<class T>
+inline typename T::F grad(typename T::I hash, typename T::F x, typename T::F y) {
+	const typename T::I h = T::andi(hash, 7);
+	const typename T::M low = T::lti(h, 4);
+	const typename T::F u = T::select(low, x, y);
+	const typename T::F v = T::select(low, y, x);
+	return T::add(T::negateIf(T::nonzero(T::andi(h, 1)), u), T::negateIf(T::nonzero(T::andi(h, 2)), T::mul(T::set(2.0f), v)));
+}
+
+template<class T>
+inline typename T::F grad(typename T::I hash, typename T::F x, typename T::F y, typename T::F z) {
+	const typename T::I h = T::andi(hash, 15);
+	const typename T::F u = T::select(T::lti(h, 8), x, y);
+	const typename T::F v = T::select(T::lti(h, 4), y, T::select(T::mor(T::eqi(h, 12), T::eqi(h, 14)), x, z));
+	return T::add(T::negateIf(T::nonzero(T::andi(h, 1)), u), T::negateIf(T::nonzero(T::andi(h, 2)), v));
+}
+
+/**
+ * @return The contribution of a corner - zero if the corner is too far away
+ */
+template<class T>
+inline typename T::F corner(typename T::F t, typename T::F g) {
+	const typename T::F t2 = T::mul(t, t);
+	return T::select(T::gt(T::set(0.0f), t), T::set(0.0f), T::mul(T::mul(t2, t2), g));
+}
+
+template<class T>
+inline typename T::I perm(const Params& params, typename T::I idx) {
+	return T::gather(params.perm, idx);
+}
+
+template<class T>
+typename T::F noise(const Params& params, typename T::F x, typename T::F y) {
+	typedef typename T::F F;
+	typedef typename T::I I;
+	const F s = T::mul(T::add(x, y), T::set(F2));
+	const I i = fastFloor<T>(T::add(x, s));
+	const I j = fastFloor<T>(T::add(y, s));
+	const F t = T::mul(T::tofloat(T::addi(i, j)), T::set(G2));
+	const F x0 = T::sub(x, T::sub(T::tofloat(i), t));
+	const F y0 = T::sub(y, T::sub(T::tofloat(j), t));
+
+	const typename T::M lower = T::gt(x0, y0);
+	const I i1 = T::selecti(lower, T::seti(1), T::seti(0));
+	const I j1 = T::selecti(lower, T::seti(0), T::seti(1));
+
+	const F x1 = T::add(T::sub(x0, T::tofloat(i1)), T::set(G2));
+	const F y1 = T::add(T::sub(y0, T::tofloat(j1)), T::set(G2));
+	const F x2 = T::add(T::sub(x0, T::set(1.0f)), T::set(2.0f * G2));
+	const F y2 = T::add(T::sub(y0, T::set(1.0f)), T::set(2.0f * G2));
+
+	const I ii = T::andi(i, 0xff);
+	const I jj = T::andi(j, 0xff);
+	const I one = T::seti(1);
+	const I gi0 = perm<T>(params, T::addi(ii, perm<T>(params, jj)));
+	const I gi1 = perm<T>(params, T::addi(T::addi(ii, i1), perm<T>(params, T::addi(jj, j1))));
+	const I gi2 = perm<T>(params, T::addi(T::addi(ii, one), perm<T>(params, T::addi(jj, one))));
+
+	const F half = T::set(0.5f);
+	const F n0 = corner<T>(T::sub(T::sub(half, T::mul(x0, x0)), T::mul(y0, y0)), grad<T>(gi0, x0, y0));
+	const F n1 = corner<T>(T::sub(T::sub(half, T::mul(x1, x1)), T::mul(y1, y1)), grad<T>(gi1, x1, y1));
+	const F n2 = corner<T>(T::sub(T::sub(half, T::mul(x2, x2)), T::mul(y2, y2)), grad<T>(gi2, x2, y2));
+	return T::mul(T::set(40.0f), T::add(T::add(n0, n1), n2));
+}
+
+template<class T>
+typename T::F noise(const Params& params, typename T::F x, typename T::F y, typename T::F z) {
+	typedef typename T::F F;
+	typedef typename T::I I;
+	typedef typename T::M M;
+	const F s = T::mul(T::add(T::add(x, y), z), T::set(F3));
+	const I i = fastFloor<T>(T::add(x, s));
+	const I j = fastFloor<T>(T::add(y, s));
+	const I k = fastFloor<T>(T::add(z, s));
+	const F t = T::mul(T::tofloat(T::addi(T::addi(i, j), k)), T::set(G3));
+	const F x0 = T::sub(x, T::sub(T::tofloat(i), t));
+	const F y0 = T::sub(y, T::sub(T::tofloat(j), t));
+	const F z0 = T::sub(z, T::sub(T::tofloat(k), t));
+
+	// the branches of the scalar noise that determine the simplex expressed as masks
+	const M xy = T::ge(x0, y0);
+	const M yz = T::ge(y0, z0);
+	const M xz = T::ge(x0, z0);
+	const M nxy = T::mnot(xy);
+	const M nyz = T::mnot(yz);
+	const M nxz = T::mnot(xz);
+	const I one = T::seti(1);
+	const I zero = T::seti(0);
+	const I i1 = T::selecti(T::mand(xy, T::mor(yz, xz)), one, zero);
+	const I j1 = T::selecti(T::mand(nxy, yz), one, zero);
+	const I k1 = T::selecti(T::mand(nyz, T::mor(nxy, nxz)), one, zero);
+	const I i2 = T::selecti(T::mor(xy, T::mand(yz, xz)), one, zero);
+	const I j2 = T::selecti(T::mor(nxy, yz), one, zero);
+	const I k2 = T::selecti(T::mor(nyz, T::mand(nxy, nxz)), one, zero);
+
+	const F x1 = T::add(T::sub(x0, T::tofloat(i1)), T::set(G3));
+	const F y1 = T::add(T::sub(y0, T::tofloat(j1)), T::set(G3));
+	const F z1 = T::add(T::sub(z0, T::tofloat(k1)), T::set(G3));
+	const F x2 = T::add(T::sub(x0, T::tofloat(i2)), T::set(2.0f * G3));
+	const F y2 = T::add(T::sub(y0, T::tofloat(j2)), T::set(2.0f * G3));
+	const F z2 = T::add(T::sub(z0, T::tofloat(k2)), T::set(2.0f * G3));
+	const F x3 = T::add(T::sub(x0, T::set(1.0f)), T::set(3.0f * G3));
+	const F y3 = T::add(T::sub(y0, T::set(1.0f)), T::set(3.0f * G3));
+	const F z3 = T::add(T::sub(z0, T::set(1.0f)), T::set(3.0f * G3));
+
+	const I ii = T::andi(i, 0xff);
+	const I jj = T::andi(j, 0xff);
+	const I kk = T::andi(k, 0xff);
+	const I gi0 = perm<T>(params, T::addi(ii, perm<T>(params, T::addi(jj, perm<T>(params, kk)))));
+	const I gi1 = perm<T>(params, T::addi(T::addi(ii, i1), perm<T>(params, T::addi(T::addi(jj, j1), perm<T>(params, T::addi(kk, k1))))));
+	const I gi2 = perm<T>(params, T::addi(T::addi(ii, i2), perm<T>(params, T::addi(T::addi(jj, j2), perm<T>(params, T::addi(kk, k2))))));
+	const I gi3 = perm<T>(params, T::addi(T::addi(ii, one), perm<T>(params, T::addi(T::addi(jj, one), perm<T>(params, T::addi(kk, one))))));
+
+	const F r = T::set(0.6f);
+	const F n0 = corner<T>(T::sub(T::sub(T::sub(r, T::mul(x0, x0)), T::mul(y0, y0)), T::mul(z0, z0)), grad<T>(gi0, x0, y0, z0));
+	const F n1 = corner<T>(T::sub(T::sub(T::sub(r, T::mul(x1, x1)), T::mul(y1, y1)), T::mul(z1, z1)), grad<T>(gi1, x1, y1, z1));
+	const F n2 = corner<T>(T::sub(T::sub(T::sub(r, T::mul(x2, x2)), T::mul(y2, y2)), T::mul(z2, z2)), grad<T>(gi2, x2, y2, z2));
+	const F n3 = corner<T>(T::sub(T::sub(T::sub(r, T::mul(x3, x3)), T::mul(y3, y3)), T::mul(z3, z3)), grad<T>(gi3, x3, y3, z3));
+	return T::mul(T::set(32.0f), T::add(T::add(T::add(n0, n1), n2), n3));
+}
+
+template<class T>
+inline typename T::F fBm(const Params& params, typename T::F x, typename T::F y) {
+	typename T::F sum = T::set(0.0f);
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < params.octaves; ++i) {
+		const typename T::F f = T::set(freq);
+		const typename T::F n = noise<T>(params, T::mul(x, f), T::mul(y, f));
+		sum = T::add(sum, T::mul(n, T::set(amp)));
+		freq *= params.lacunarity;
+		amp *= params.gain;
+	}
+	return sum;
+}
+
+template<class T>
+inline typename T::F fBm(const Params& params, typename T::F x, typename T::F y, typename T::F z) {
+	typename T::F sum = T::set(0.0f);
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < params.octaves; ++i) {
+		const typename T::F f = T::set(freq);
+		const typename T::F n = noise<T>(params, T::mul(x, f), T::mul(y, f), T::mul(z, f));
+		sum = T::add(sum, T::mul(n, T::set(amp)));
+		freq *= params.lacunarity;
+		amp *= params.gain;
+	}
+	return sum;
+}
+
+/**
+ * @brief The remaining values that don't fill all lanes are evaluated in a zero padded batch
+ */
+template<class T>
+void fBm2(const Params& params, const float* x, const float* y, int count, float* out) {
+	int i = 0;
+	for (; i + T::Width <= count; i += T::Width) {
+		T::store(out + i, fBm<T>(params, T::load(x + i), T::load(y + i)));
+	}
+	const int remaining = count - i;
+	if (remaining <= 0) {
+		return;
+	}
+	float tx[T::Width] = {};
+	float ty[T::Width] = {};
+	float to[T::Width];
+	for (int r = 0; r < remaining; ++r) {
+		tx[r] = x[i + r];
+		ty[r] = y[i + r];
+	}
+	T::store(to, fBm<T>(params, T::load(tx), T::load(ty)));
+	for (int r = 0; r < remaining; ++r) {
+		out[i + r] = to[r];
+	}
+}
+
+template<class T>
+void fBm3(const Params& params, const float* x, const float* y, const float* z, int count, float* out) {
+	int i = 0;
+	for (; i + T::Width <= count; i += T::Width) {
+		T::store(out + i, fBm<T>(params, T::load(x + i), T::load(y + i), T::load(z + i)));
+	}
+	const int remaining = count - i;
+	if (remaining <= 0) {
+		return;
+	}
+	float tx[T::Width] = {};
+	float ty[T::Width] = {};
+	float tz[T::Width] = {};
+	float to[T::Width];
+	for (int r = 0; r < remaining; ++r) {
+		tx[r] = x[i + r];
+		ty[r] = y[i + r];
+		tz[r] = z[i + r];
+	}
+	T::store(to, fBm<T>(params, T::load(tx), T::load(ty), T::load(tz)));
+	for (int r = 0; r < remaining; ++r) {
+		out[i + r] = to[r];
+	}
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "noise/SimplexBatch.h"
+#include "noise/Simplex.h"
+#include <vector>
+
+namespace noise {
+
+class SimplexBatchTest: public app::AbstractTest {
+protected:
+	static constexpr int Count = 211;
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_x.resize(Count);
+		_y.resize(Count);
+		_z.resize(Count);
+		for (int i = 0; i < Count; ++i) {
+			// negative and positive values, values on the lattice and in between
+			_x[i] = (float)(i - Count / 2) * 0.37f;
+			_y[i] = (float)(i % 17) * 0.5f - 3.0f;
+			_z[i] = (float)(i % 5) * 1.13f - 2.0f;
+		}
+	}
+};
+
+TEST_F(SimplexBatchTest, testMatchesScalarNoise) {
+	std::vector<float> out2(Count);
+	std::vector<float> out3(Count);
+	fBmBatch(_x.data(), _y.data(), Count, out2.data(), 2, 2.0f, 0.5f);
+	fBmBatch(_x.data(), _y.data(), _z.data(), Count, out3.data(), 2, 2.0f, 0.5f);
+	for (int i = 0; i < Count; ++i) {
+		EXPECT_NEAR(noise::fBm(glm::vec2(_x[i], _y[i]), 2, 2.0f, 0.5f), out2[i], 0.0001f) << "index " << i;
+		EXPECT_NEAR(noise::fBm(glm::vec3(_x[i], _y[i], _z[i]), 2, 2.0f, 0.5f), out3[i], 0.0001f) << "index " << i;
+	}
+}
+
+TEST_F(SimplexBatchTest, testLevelsAreIdentical) {
+	std::vector<float> scalar2(Count);
+	std::vector<float> scalar3(Count);
+	fBmBatch(BatchLevel::Scalar, _x.data(), _y.data(), Count, scalar2.data());
+	fBmBatch(BatchLevel::Scalar, _x.data(), _y.data(), _z.data(), Count, scalar3.data());
+	for (int l = (int)BatchLevel::Scalar + 1; l < (int)BatchLevel::Max; ++l) {
+		const BatchLevel level = (BatchLevel)l;
+		if (!batchLevelSupported(level)) {
+			continue;
+		}
+		std::vector<float> out2(Count);
+		std::vector<float> out3(Count);
+		fBmBatch(level, _x.data(), _y.data(), Count, out2.data());
+		fBmBatch(level, _x.data(), _y.data(), _z.data(), Count, out3.data());
+		for (int i = 0; i < Count; ++i) {
+			ASSERT_EQ(scalar2[i], out2[i]) << "level " << l << " index " << i;
+			ASSERT_EQ(scalar3[i], out3[i]) << "level " << l << " index " << i;
+		}
+	}
+}
+
+TEST_F(SimplexBatchTest, testIndependentOfLanePosition) {
+	std::vector<float> all(Count);
+	fBmBatch(_x.data(), _y.data(), _z.data(), Count, all.data());
+	// evaluate with an offset and a count that doesn't fill all lanes
+	for (int offset = 1; offset < 9; ++offset) {
+		const int count = Count - offset - 2;
+		std::vector<float> out(count);
+		fBmBatch(_x.data() + offset, _y.data() + offset, _z.data() + offset, count, out.data());
+		for (int i = 0; i < count; ++i) {
+			ASSERT_EQ(all[offset + i], out[i]) << "offset " << offset << " index " << i;
+		}
+	}
+}
+
+}
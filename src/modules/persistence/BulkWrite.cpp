@@ -0,0 +1,160 @@
+/**
+ * @file
+ */
+
+#include "BulkWrite.h"
+#include "BindParam.h"
+#include "ISavable.h"
+#include "Model.h"
+#include "SQLGenerator.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+
+namespace persistence {
+
+/**
+ * @brief The values of the fields the conflict handling of the insert statement is based on - empty if there is
+ * no conflict handling.
+ * @sa createUpsertStatement()
+ */
+static core::String createRowKey(const Model& model) {
+	bool primaryKeyIncluded = false;
+	for (const Field& f : model.fields()) {
+		if (f.isPrimaryKey() && model.isValid(f)) {
+			primaryKeyIncluded = !model.primaryKeys().empty();
+			break;
+		}
+	}
+	const std::set<core::String>* uniqueKey = nullptr;
+	if (!primaryKeyIncluded) {
+		for (const auto& set : model.uniqueKeys()) {
+			for (const Field& f : model.fields()) {
+				if (!model.isValid(f) || f.isPrimaryKey() || f.isAutoincrement()) {
+					continue;
+				}
+				if (set.find(f.name) != set.end()) {
+					uniqueKey = &set;
+					break;
+				}
+			}
+			if (uniqueKey != nullptr) {
+				break;
+			}
+		}
+		if (uniqueKey == nullptr) {
+			return core::String();
+		}
+	}
+	const Fields& fields = model.fields();
+	BindParam params((int)fields.size());
+	core::String key;
+	for (const Field& f : fields) {
+		if (!model.isValid(f)) {
+			continue;
+		}
+		if (primaryKeyIncluded ? !f.isPrimaryKey() : uniqueKey->find(f.name) == uniqueKey->end()) {
+			continue;
+		}
+		if (model.isNull(f)) {
+			key += "NULL";
+		} else if (f.type == FieldType::TIMESTAMP && model.getValue<Timestamp>(f).isNow()) {
+			key += "NOW()";
+		} else {
+			const int index = params.position;
+			params.push(model, f);
+			if (params.formats[index] == 1) {
+				if (params.values[index] != nullptr) {
+					key += core::String(params.values[index], params.lengths[index]);
+				}
+			} else {
+				key += params.values[index];
+			}
+		}
+		// unit separator
+		key += '\x1f';
+	}
+	return key;
+}
+
+BulkWrite::Statement& BulkWrite::statement(std::vector<Statement>& statements, core::Map<core::String, int, 64, core::StringHash>& indices, const core::String& key, const core::String& rowKey) {
+	int index;
+	if (indices.get(key, index)) {
+		Statement& s = statements[index];
+		if (rowKey.empty() || s.rowKeys.insert(rowKey).second) {
+			return s;
+		}
+	}
+	index = (int)statements.size();
+	indices.put(key, index);
+	statements.emplace_back();
+	Statement& s = statements.back();
+	s.key = key;
+	if (!rowKey.empty()) {
+		s.rowKeys.insert(rowKey);
+	}
+	return s;
+}
+
+bool BulkWrite::add(ISavable* savable) {
+	core_assert(savable != nullptr);
+	std::vector<const Model*> models;
+	if (!savable->getDirtyModels(models)) {
+		return false;
+	}
+	for (const Model* m : models) {
+		add(*m);
+	}
+	return true;
+}
+
+void BulkWrite::add(const Model& model) {
+	core_trace_scoped(BulkWriteAdd);
+	BindParam params((int)model.fields().size());
+	Statement* s;
+	if (model.shouldBeDeleted()) {
+		const core::String& stmt = createDeleteStatement(model, &params);
+		s = &statement(_deletes, _deleteIndices, stmt, core::String());
+		if (s->rows == 0) {
+			s->base = stmt;
+			s->insert = false;
+			s->parameterCount = params.position;
+		}
+	} else {
+		core::String values;
+		core::String conflict;
+		int parameterCount = 0;
+		const core::String& base = createBulkInsertBaseStatement(model, &params, values, conflict, parameterCount);
+		s = &statement(_inserts, _insertIndices, base + values, createRowKey(model));
+		if (s->rows == 0) {
+			s->base = base;
+			s->values = values;
+			s->conflict = conflict;
+			s->parameterCount = parameterCount;
+		}
+	}
+	core_assert(s->parameterCount == params.position);
+	for (int i = 0; i < params.position; ++i) {
+		const char *value = params.values[i];
+		if (params.formats[i] == 1) {
+			// binary data - an empty blob doesn't have a data pointer
+			s->parameters.emplace_back(value == nullptr ? "" : value, (size_t)params.lengths[i]);
+		} else {
+			core_assert_msg(value != nullptr, "NULL values are not bound as parameter");
+			s->parameters.emplace_back(value);
+		}
+		s->lengths.push_back(params.lengths[i]);
+		s->formats.push_back(params.formats[i]);
+	}
+	++s->rows;
+	++_rows;
+}
+
+void BulkWrite::clear() {
+	_inserts.clear();
+	_deletes.clear();
+	_insertIndices.clear();
+	_deleteIndices.clear();
+	_rows = 0;
+}
+
+}
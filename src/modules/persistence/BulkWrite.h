@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/Map.h"
+#include <unordered_set>
+#include <vector>
+
+namespace persistence {
+
+class ISavable;
+class Model;
+
+/**
+ * @brief Snapshot of dirty models that are written to the database in bulk.
+ *
+ * The models are grouped by the statement they need: models of the same table with the same fields set share
+ * one multi row insert (upsert) statement. The parameters are copied when a model is added - the models may be
+ * modified again afterwards and the write can be executed on another thread.
+ *
+ * A multi row upsert can't update the same row twice. A model with the same key as a model that was already added
+ * to a statement opens a new statement that is executed after the first one.
+ *
+ * @sa DBHandler::write()
+ */
+class BulkWrite {
+public:
+	struct Statement {
+		// models with the same key share the statement
+		core::String key;
+		// insert statements: the parts of @c createBulkInsertStatement() - delete statements: the whole statement
+		core::String base;
+		core::String values;
+		core::String conflict;
+		bool insert = true;
+		// the amount of parameters of one row
+		int parameterCount = 0;
+		int rows = 0;
+		// the parameters of all rows
+		std::vector<core::String> parameters;
+		std::vector<int> lengths;
+		std::vector<int> formats;
+		// the keys of the rows to detect rows that would be updated twice
+		std::unordered_set<core::String, core::StringHash> rowKeys;
+	};
+
+private:
+	std::vector<Statement> _inserts;
+	std::vector<Statement> _deletes;
+	// the index of the statement new rows are added to
+	core::Map<core::String, int, 64, core::StringHash> _insertIndices;
+	core::Map<core::String, int, 64, core::StringHash> _deleteIndices;
+	int _rows = 0;
+
+	Statement& statement(std::vector<Statement>& statements, core::Map<core::String, int, 64, core::StringHash>& indices, const core::String& key, const core::String& rowKey);
+
+public:
+	/**
+	 * @return @c false if the savable didn't have any dirty models
+	 */
+	bool add(ISavable* savable);
+	void add(const Model& model);
+	void clear();
+
+	/**
+	 * @brief The insert statements are executed before the delete statements
+	 */
+	const std::vector<Statement>& inserts() const;
+	const std::vector<Statement>& deletes() const;
+
+	int rows() const;
+	bool empty() const;
+};
+
+inline const std::vector<BulkWrite::Statement>& BulkWrite::inserts() const {
+	return _inserts;
+}
+
+inline const std::vector<BulkWrite::Statement>& BulkWrite::deletes() const {
+	return _deletes;
+}
+
+inline int BulkWrite::rows() const {
+	return _rows;
+}
+
+inline bool BulkWrite::empty() const {
+	return _rows == 0;
+}
+
+}
@@ -5,10 +5,24 @@
 #include "DBHandler.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/Common.h"
+#include "core/StringUtil.h"
 #include "postgres/PQSymbol.h"
 
 namespace persistence {
 
+namespace {
+
+// the maximum amount of rows per insert statement - only powers of two are used to keep the amount of
+// prepared statements per model type small
+const int MaxBulkRows = 64;
+// the maximum amount of parameters postgres accepts for one statement
+const int MaxParameters = 65535;
+// the amount of statements that are sent before the results are read
+const int MaxPipelineExecutions = 256;
+
+}
+
 DBHandler::DBHandler(bool useForeignKeys) :
 		_useForeignKeys(useForeignKeys) {
 }
@@ -110,6 +124,140 @@ MassQuery DBHandler::massQuery() const {
 	return MassQuery(this);
 }
 
+bool DBHandler::prepareBulkStatement(Connection* c, const BulkWrite::Statement& statement, int rows, core::String& name) const {
+	int id;
+	{
+		core::ScopedLock lock(_bulkStatementLock);
+		if (!_bulkStatements.get(statement.key, id)) {
+			id = (int)_bulkStatements.size();
+			_bulkStatements.put(statement.key, id);
+		}
+	}
+	name = core::string::format("bulk%i_%i", id, rows);
+	if (c->hasPreparedStatement(name)) {
+		return true;
+	}
+	core::String query;
+	if (statement.insert) {
+		query = createBulkInsertStatement(statement.base, statement.values, statement.conflict, statement.parameterCount, rows);
+	} else {
+		core_assert(rows == 1);
+		query = statement.base;
+	}
+	Log::debug(logid, "Prepare statement '%s': '%s'", name.c_str(), query.c_str());
+	State s(c);
+	if (!s.prepare(name.c_str(), query.c_str(), statement.parameterCount * rows)) {
+		Log::error(logid, "Failed to prepare statement '%s'", query.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool DBHandler::write(const BulkWrite& bulkWrite) const {
+	if (bulkWrite.empty()) {
+		return true;
+	}
+	core_trace_scoped(DBHandlerWrite);
+	ScopedConnection scoped(_connectionPool, connection());
+	if (!scoped) {
+		Log::error(logid, "Could not execute the bulk write - could not acquire connection");
+		return false;
+	}
+	Connection* c = scoped.connection();
+
+	std::vector<const BulkWrite::Statement*> statements;
+	statements.reserve(bulkWrite.inserts().size() + bulkWrite.deletes().size());
+	for (const BulkWrite::Statement& s : bulkWrite.inserts()) {
+		statements.push_back(&s);
+	}
+	for (const BulkWrite::Statement& s : bulkWrite.deletes()) {
+		statements.push_back(&s);
+	}
+
+	bool success = true;
+	std::vector<std::vector<const char*>> values(statements.size());
+	std::vector<core::String> names;
+	std::vector<PreparedExecution> executions;
+	for (size_t i = 0; i < statements.size(); ++i) {
+		const BulkWrite::Statement& s = *statements[i];
+		std::vector<const char*>& v = values[i];
+		v.reserve(s.parameters.size());
+		for (const core::String& p : s.parameters) {
+			v.push_back(p.c_str());
+		}
+		int maxRows = s.insert ? MaxBulkRows : 1;
+		while (maxRows > 1 && maxRows * s.parameterCount > MaxParameters) {
+			maxRows /= 2;
+		}
+		for (int row = 0; row < s.rows;) {
+			int rows = maxRows;
+			while (rows > s.rows - row) {
+				rows /= 2;
+			}
+			core::String name;
+			if (!prepareBulkStatement(c, s, rows, name)) {
+				success = false;
+				break;
+			}
+			PreparedExecution e;
+			const int offset = row * s.parameterCount;
+			e.parameterCount = rows * s.parameterCount;
+			if (e.parameterCount > 0) {
+				e.paramValues = &v[offset];
+				e.paramLengths = &s.lengths[offset];
+				e.paramFormats = &s.formats[offset];
+			}
+			names.push_back(name);
+			executions.push_back(e);
+			row += rows;
+		}
+	}
+	if (!success) {
+		return false;
+	}
+	const int amount = (int)executions.size();
+	for (int i = 0; i < amount; ++i) {
+		executions[i].name = names[i].c_str();
+	}
+
+	// one transaction for the whole write - the pipeline segments would be committed independently otherwise
+	State begin(c);
+	if (!begin.exec(createTransactionBegin())) {
+		return false;
+	}
+	if (State::supportsPipeline()) {
+		for (int i = 0; i < amount; i += MaxPipelineExecutions) {
+			State s(c);
+			if (!s.execPreparedPipeline(&executions[i], core_min(MaxPipelineExecutions, amount - i))) {
+				Log::error(logid, "Failed to execute the bulk write pipeline");
+				success = false;
+				break;
+			}
+		}
+	} else {
+		// one round trip per statement
+		for (const PreparedExecution& e : executions) {
+			State s(c);
+			if (!s.execPrepared(e.name, e.parameterCount, e.paramValues, e.paramLengths, e.paramFormats)) {
+				Log::error(logid, "Failed to execute prepared statement '%s'", e.name);
+				success = false;
+				break;
+			}
+		}
+	}
+	if (!success) {
+		State rollback(c);
+		rollback.exec(createTransactionRollback());
+		return false;
+	}
+	State commit(c);
+	if (!commit.exec(createTransactionCommit())) {
+		return false;
+	}
+	Log::debug(logid, "Wrote %i rows with %i statements", bulkWrite.rows(), amount);
+	return true;
+}
+
 bool DBHandler::dropTable(const Model& model) const {
 	const State& s = execInternal(createDropTableStatement(model));
 	if (!s.result) {
@@ -13,9 +13,13 @@
 #include "ConnectionPool.h"
 #include "Model.h"
 #include "MassQuery.h"
+#include "BulkWrite.h"
 #include "core/StringUtil.h"
 #include "core/Log.h"
 #include "core/IComponent.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/Map.h"
+#include "core/Trace.h"
 #include "ScopedConnection.h"
 #include "BindParam.h"
 #include "SQLGenerator.h"
@@ -44,6 +48,16 @@ private:
 
 	mutable ConnectionPool _connectionPool;
 
+	// the ids of the prepared statements of the bulk writes - keyed by BulkWrite::Statement::key
+	mutable core::Map<core::String, int, 64, core::StringHash> _bulkStatements core_thread_guarded_by(_bulkStatementLock);
+	mutable core_trace_mutex(core::Lock, _bulkStatementLock, "DBHandlerBulkStatements");
+
+	/**
+	 * @brief Prepares the statement with the given amount of rows on the connection if this wasn't done before
+	 * @param[out] name The name of the prepared statement
+	 */
+	bool prepareBulkStatement(Connection* connection, const BulkWrite::Statement& statement, int rows, core::String& name) const;
+
 	virtual Connection* connection() const;
 
 	bool insertMetadata(const Model& model) const;
@@ -256,6 +270,15 @@ public:
 
 	MassQuery massQuery() const;
 
+	/**
+	 * @brief Executes the statements of the bulk write. The rows are inserted with multi row statements that are
+	 * prepared once per connection and all statements are sent in a pipeline if the client library supports it.
+	 * All statements are executed in one transaction - nothing is written if one of them fails.
+	 * @note The auto increment values of inserted rows are not returned
+	 * @return @c true if all statements were executed successfully, @c false otherwise.
+	 */
+	bool write(const BulkWrite& bulkWrite) const;
+
 	bool dropTable(const Model& model) const;
 	bool dropTable(Model&& model) const;
 	bool tableExists(const Model& model) const;
@@ -4,9 +4,8 @@
 
 #pragma once
 
-#include "BindParam.h"
+#include "BulkWrite.h"
 #include <memory>
-#include <vector>
 
 namespace persistence {
 
@@ -15,13 +14,15 @@ class DBHandler;
 
 /**
  * @brief Implements mass updates for @c ISavable instances.
+ *
+ * The dirty models are copied into a @c BulkWrite when they are added and are written with multi row
+ * statements on @c commit().
  */
 class MassQuery {
 private:
 	const DBHandler * const _dbHandler;
 	const size_t _commitSize;
-	std::vector<const Model*> _insertOrUpdate;
-	std::vector<const Model*> _delete;
+	BulkWrite _bulkWrite;
 	friend class DBHandler;
 	MassQuery(const DBHandler* dbHandler, size_t amount = 1000);
 
@@ -4,7 +4,6 @@
 
 #include "PersistenceMgr.h"
 #include "DBHandler.h"
-#include "MassQuery.h"
 #include "core/Common.h"
 #include "core/Trace.h"
 
@@ -14,6 +13,15 @@ PersistenceMgr::PersistenceMgr(const DBHandlerPtr& dbHandler) :
 		_lock("persistencemgr"), _dbHandler(dbHandler) {
 }
 
+PersistenceMgr::~PersistenceMgr() {
+	if (_writer) {
+		// the writes that are still queued are executed before the writer is stopped
+		flush();
+		_writeQueue.abortWait();
+		_writer->join();
+	}
+}
+
 bool PersistenceMgr::registerSavable(uint32_t fourcc, ISavable *savable) {
 	Log::trace(logid, "Register savable (fourcc: %u, savable: %p)", fourcc, savable);
 	core::ScopedWriteLock lock(_lock);
@@ -34,9 +42,10 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 	if (s != i->second.end()) {
 		i->second.erase(s);
 		// make sure to persist the dirty state
-		MassQuery stmt = _dbHandler->massQuery();
-		stmt.add(savable);
-		stmt.commit();
+		const BulkWritePtr& bulkWrite = std::make_shared<BulkWrite>();
+		if (bulkWrite->add(savable)) {
+			write(bulkWrite);
+		}
 		Log::trace(logid, "Removed savable (fourcc: %u, savable: %p)", fourcc, savable);
 		return true;
 	}
@@ -44,31 +53,79 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 	return false;
 }
 
+int PersistenceMgr::runWriter(void *data) {
+	PersistenceMgr* mgr = (PersistenceMgr*)data;
+	BulkWritePtr bulkWrite;
+	while (mgr->_writeQueue.waitAndPop(bulkWrite)) {
+		core_trace_scoped(PersistenceMgrWrite);
+		if (!mgr->_dbHandler->write(*bulkWrite)) {
+			Log::error(logid, "Failed to persist %i rows", bulkWrite->rows());
+		}
+		bulkWrite.reset();
+		{
+			core::ScopedLock lock(mgr->_writeLock);
+			--mgr->_pendingWrites;
+		}
+		mgr->_writeDone.notify_all();
+	}
+	return 0;
+}
+
+void PersistenceMgr::write(const BulkWritePtr& bulkWrite) {
+	if (!_writer) {
+		_dbHandler->write(*bulkWrite);
+		return;
+	}
+	{
+		core::ScopedLock lock(_writeLock);
+		++_pendingWrites;
+	}
+	_writeQueue.push(bulkWrite);
+}
+
+void PersistenceMgr::flush() {
+	core_trace_scoped(PersistenceMgrFlush);
+	core::ScopedLock lock(_writeLock);
+	_writeDone.wait(_writeLock, [this] () {
+		return _pendingWrites == 0;
+	});
+}
+
 bool PersistenceMgr::init() {
+	if (!_writer) {
+		_writeQueue.reset();
+		_writer = std::make_unique<core::Thread>("DBWriter", runWriter, this);
+	}
 	return true;
 }
 
 void PersistenceMgr::shutdown() {
 	core_trace_scoped(PersistenceMgrShutdown);
 	update(0l);
+	flush();
+	if (_writer) {
+		_writeQueue.abortWait();
+		_writer->join();
+		_writer.reset();
+	}
 	core::ScopedWriteLock lock(_lock);
 	_savables.clear();
 }
 
 void PersistenceMgr::update(long dt) {
 	core_trace_scoped(PersistenceMgrUpdate);
+	const BulkWritePtr& bulkWrite = std::make_shared<BulkWrite>();
 	core::ScopedReadLock lock(_lock);
 	for (auto& collection : _savables) {
-		if (collection.second.empty()) {
-			continue;
-		}
-		MassQuery stmt = _dbHandler->massQuery();
 		for (ISavable *savable : collection.second) {
-			stmt.add(savable);
+			bulkWrite->add(savable);
 		}
-		stmt.commit();
 	}
-	Log::debug(logid, "Persisted dirty states of %i savables", (int)_savables.size());
+	Log::debug(logid, "Collected %i dirty rows of %i savables", bulkWrite->rows(), (int)_savables.size());
+	if (!bulkWrite->empty()) {
+		// queued while the lock is held to keep the order of the writes
+		write(bulkWrite);
+	}
 }
 
 }
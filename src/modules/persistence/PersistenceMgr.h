@@ -9,8 +9,13 @@
 #include <unordered_set>
 #include "ISavable.h"
 #include "DBHandler.h"
+#include "BulkWrite.h"
 #include "core/IComponent.h"
 #include "core/concurrent/ReadWriteLock.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Thread.h"
+#include "core/collection/ConcurrentQueue.h"
 
 /**
  * Persistence layer
@@ -20,6 +25,10 @@ namespace persistence {
 /**
  * @brief This class is responsible for calling the update mechanisms for the single components of each player.
  * It will collect all database actions in prepared statements to write delta values into the database.
+ *
+ * The dirty models are copied on the calling thread - the database is written on an own writer thread in the
+ * order the models were collected. Neither @c update() nor @c unregisterSavable() wait for the database.
+ *
  * @note Your @c ISavable instances must be registered and unregistered.
  */
 class PersistenceMgr : public core::IComponent {
@@ -30,9 +39,23 @@ private:
 	Map _savables core_thread_guarded_by(_lock);
 	core::ReadWriteLock _lock;
 	const DBHandlerPtr _dbHandler;
+
+	using BulkWritePtr = std::shared_ptr<BulkWrite>;
+	core::ConcurrentQueue<BulkWritePtr> _writeQueue;
+	std::unique_ptr<core::Thread> _writer;
+	// the amount of bulk writes that were queued and are not yet executed
+	int _pendingWrites core_thread_guarded_by(_writeLock) = 0;
+	core_trace_mutex(core::Lock, _writeLock, "PersistenceMgrWrite");
+	core::ConditionVariable _writeDone;
+
+	static int runWriter(void *data);
+	/**
+	 * @brief Hands the bulk write over to the writer thread - or executes it if the writer isn't running
+	 */
+	void write(const BulkWritePtr& bulkWrite);
 public:
 	PersistenceMgr(const DBHandlerPtr& dbHandler);
-	virtual ~PersistenceMgr() {}
+	virtual ~PersistenceMgr();
 
 	virtual bool registerSavable(uint32_t fourcc, ISavable *savable);
 	virtual bool unregisterSavable(uint32_t fourcc, ISavable *savable);
@@ -44,6 +67,11 @@ public:
 	void shutdown() override;
 
 	void update(long dt);
+
+	/**
+	 * @brief Blocks until all queued writes are executed
+	 */
+	void flush();
 };
 
 typedef std::shared_ptr<PersistenceMgr> PersistenceMgrPtr;
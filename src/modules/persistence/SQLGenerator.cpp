@@ -908,6 +908,45 @@ core::String createInsertStatement(const Model& model, BindParam* params, int* p
 	return createInsertStatement({&model}, params, parameterCount);
 }
 
+core::String createBulkInsertBaseStatement(const Model& model, BindParam* params, core::String& values, core::String& conflict, int& parameterCount) {
+	bool primaryKeyIncluded = false;
+	const core::String& stmt = createInsertBaseStatement(model, primaryKeyIncluded);
+	int insertValueIndex = 1;
+	values = createInsertValuesStatement(model, params, insertValueIndex);
+	parameterCount = insertValueIndex - 1;
+	conflict.clear();
+	createUpsertStatement(model, conflict, primaryKeyIncluded, parameterCount);
+	return stmt;
+}
+
+core::String createBulkInsertStatement(const core::String& base, const core::String& values, const core::String& conflict, int parameterCount, int rows) {
+	core::String stmt;
+	stmt.reserve(base.size() + rows * (values.size() + 8) + conflict.size() + 16);
+	stmt += base;
+	stmt += " VALUES ";
+	const char *v = values.c_str();
+	for (int row = 0; row < rows; ++row) {
+		if (row > 0) {
+			stmt += ",";
+		}
+		const int offset = row * parameterCount;
+		for (const char *c = v; *c != '\0'; ++c) {
+			stmt += *c;
+			if (*c != '$' || offset == 0) {
+				continue;
+			}
+			int index = 0;
+			while (c[1] >= '0' && c[1] <= '9') {
+				index = index * 10 + (*++c - '0');
+			}
+			stmt += core::string::toString(index + offset);
+		}
+	}
+	stmt += conflict;
+	stmt += ";";
+	return stmt;
+}
+
 // https://www.postgresql.org/docs/current/static/functions-formatting.html
 // https://www.postgresql.org/docs/current/static/functions-datetime.html
 core::String createSelect(const Model& model, BindParam* params) {
@@ -28,6 +28,20 @@ extern core::String createInsertBaseStatement(const Model& table, bool& primaryK
 extern core::String createInsertValuesStatement(const Model& table, BindParam* params, int& insertValueIndex);
 extern core::String createInsertStatement(const Model& model, BindParam* params = nullptr, int* parameterCount = nullptr);
 extern core::String createInsertStatement(const std::vector<const Model*>& tables, BindParam* params = nullptr, int* parameterCount = nullptr);
+/**
+ * @brief Creates the parts of a multi row insert statement for models that have the same fields set as the given model.
+ * @param[out] values The values of one row - the placeholders start at @c $1
+ * @param[out] conflict The conflict handling of the statement - auto increment values are not returned
+ * @param[out] parameterCount The amount of parameters of one row
+ * @return The insert statement without the values
+ * @sa createBulkInsertStatement()
+ */
+extern core::String createBulkInsertBaseStatement(const Model& model, BindParam* params, core::String& values, core::String& conflict, int& parameterCount);
+/**
+ * @brief Puts the parts of @c createBulkInsertBaseStatement() together - the placeholders of each row are
+ * shifted by the @c parameterCount of the rows before.
+ */
+extern core::String createBulkInsertStatement(const core::String& base, const core::String& values, const core::String& conflict, int parameterCount, int rows);
 
 extern core::String createCountStatement(const Model& model, BindParam* params = nullptr);
 extern core::String createSelect(const Model& model, BindParam* params = nullptr);
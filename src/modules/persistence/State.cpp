@@ -71,6 +71,71 @@ bool State::execPrepared(const char *name, int parameterCount, const char *const
 	return result;
 }
 
+bool State::supportsPipeline() {
+#if defined(HAVE_POSTGRES) && defined(LIBPQ_HAS_PIPELINING)
+	return PQenterPipelineMode != nullptr && PQexitPipelineMode != nullptr && PQpipelineSync != nullptr
+			&& PQsendQueryPrepared != nullptr && PQgetResult != nullptr;
+#else
+	return false;
+#endif
+}
+
+bool State::execPreparedPipeline(const PreparedExecution *executions, int amount) {
+	affectedRows = 0;
+	result = false;
+#if defined(HAVE_POSTGRES) && defined(LIBPQ_HAS_PIPELINING)
+	if (!supportsPipeline()) {
+		return false;
+	}
+	ConnectionType* c = _connection->connection();
+	if (PQenterPipelineMode(c) != 1) {
+		Log::error("Failed to enter the pipeline mode: %s", PQerrorMessage(c));
+		return false;
+	}
+	int sent = 0;
+	for (; sent < amount; ++sent) {
+		const PreparedExecution& e = executions[sent];
+		if (PQsendQueryPrepared(c, e.name, e.parameterCount, e.paramValues, e.paramLengths, e.paramFormats, _resultFormat) != 1) {
+			Log::error("Failed to send the prepared statement '%s': %s", e.name, PQerrorMessage(c));
+			break;
+		}
+	}
+	bool success = sent == amount;
+	if (PQpipelineSync(c) != 1) {
+		Log::error("Failed to sync the pipeline: %s", PQerrorMessage(c));
+		PQexitPipelineMode(c);
+		return false;
+	}
+	// the results of each execution are terminated by a null result
+	for (int i = 0; i < sent; ++i) {
+		while (ResultType* r = PQgetResult(c)) {
+			const ExecStatusType state = PQresultStatus(r);
+			if (state == PGRES_FATAL_ERROR || state == PGRES_BAD_RESPONSE) {
+				Log::error("Fatal error in prepared statement '%s': %s", executions[i].name, PQresultErrorMessage(r));
+				success = false;
+			} else if (state == PGRES_PIPELINE_ABORTED) {
+				success = false;
+			}
+			PQclear(r);
+		}
+	}
+	ResultType* sync = PQgetResult(c);
+	if (sync == nullptr || PQresultStatus(sync) != PGRES_PIPELINE_SYNC) {
+		Log::error("Failed to read the pipeline sync result");
+		success = false;
+	}
+	if (sync != nullptr) {
+		PQclear(sync);
+	}
+	if (PQexitPipelineMode(c) != 1) {
+		Log::error("Failed to exit the pipeline mode: %s", PQerrorMessage(c));
+		success = false;
+	}
+	result = success;
+#endif
+	return result;
+}
+
 bool State::isBool(const char *value) {
 	return *value == '1' || *value == 't' || *value == 'y' || *value == 'o' || *value == 'T';
 }
@@ -11,6 +11,18 @@
 
 namespace persistence {
 
+/**
+ * @brief The parameters of the execution of a prepared statement
+ * @sa State::execPreparedPipeline()
+ */
+struct PreparedExecution {
+	const char *name = nullptr;
+	int parameterCount = 0;
+	const char *const *paramValues = nullptr;
+	const int *paramLengths = nullptr;
+	const int *paramFormats = nullptr;
+};
+
 /**
  * @brief Wraps the postgres api
  */
@@ -34,6 +46,19 @@ public:
 	bool exec(const char* statement, int parameterCount = 0, const char *const *paramValues = nullptr, const int *paramLengths = nullptr, const int *paramFormats = nullptr);
 	bool prepare(const char *name, const char* statement, int parameterCount);
 	bool execPrepared(const char *name, int parameterCount, const char *const *paramValues = nullptr, const int *paramLengths = nullptr, const int *paramFormats = nullptr);
+	/**
+	 * @brief Sends all executions to the server before the results are read - this is only one round trip.
+	 * Outside of a transaction block the executions are done in an implicit transaction - if one of them
+	 * fails, none of them is committed. Inside of a transaction block a failure aborts the transaction.
+	 * @note The results of the executions are not available
+	 * @return @c false if one of the executions failed or if the pipeline mode isn't supported
+	 * @sa supportsPipeline()
+	 */
+	bool execPreparedPipeline(const PreparedExecution *executions, int amount);
+	/**
+	 * @return @c true if the loaded client library supports the pipeline mode
+	 */
+	static bool supportsPipeline();
 
 	/**
 	 * @param[in] colIndex The column index of the current row. Starting at index 0 for the first column
@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "persistence/BulkWrite.h"
+#include "persistence/DBHandler.h"
+#include "core/GameConfig.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "TestModels.h"
+#include <vector>
+
+/**
+ * @brief Compares the pipelined bulk write with one insert statement per model.
+ * @note Needs the same database as the persistence tests - the benchmarks are skipped if there is no connection
+ */
+class PersistenceBenchmark : public app::AbstractBenchmark {
+protected:
+	persistence::DBHandlerPtr _dbHandler;
+	bool _supported = false;
+	std::vector<persistence::db::TestModel> _models;
+
+	void onCleanupApp() override {
+		if (_dbHandler) {
+			_dbHandler->shutdown();
+			_dbHandler.reset();
+		}
+	}
+
+	bool onInitApp() override {
+		core::Var::get(cfg::DatabaseMinConnections, "1");
+		core::Var::get(cfg::DatabaseMaxConnections, "2");
+		core::Var::get(cfg::DatabaseName, "enginetest");
+		core::Var::get(cfg::DatabaseHost, "localhost");
+		core::Var::get(cfg::DatabasePort, "5432");
+		core::Var::get(cfg::DatabaseUser, "vengi");
+		core::Var::get(cfg::DatabasePassword, "engine");
+		_dbHandler = std::make_shared<persistence::DBHandler>();
+		_supported = _dbHandler->init();
+		if (!_supported) {
+			// not a failure - the benchmarks are skipped
+			return true;
+		}
+		_dbHandler->createOrUpdateTable(persistence::db::TestModel());
+		_dbHandler->truncate(persistence::db::TestModel());
+		return true;
+	}
+
+	/**
+	 * @brief The models are updated with every iteration - the ids stay the same
+	 */
+	void createModels(int amount) {
+		_models.resize(amount);
+		for (int i = 0; i < amount; ++i) {
+			persistence::db::TestModel& model = _models[i];
+			model.setId(i + 1);
+			model.setEmail(core::string::format("benchmark%i@localhost", i));
+			model.setName(core::string::format("benchmark%i", i));
+			model.setPassword("secret");
+			model.setPoints(1);
+		}
+	}
+
+	bool skip(benchmark::State& state) const {
+		if (_supported) {
+			return false;
+		}
+		state.SkipWithError("No database connection");
+		return true;
+	}
+};
+
+BENCHMARK_DEFINE_F(PersistenceBenchmark, Insert) (benchmark::State& state) {
+	if (skip(state)) {
+		return;
+	}
+	createModels((int)state.range(0));
+	for (auto _ : state) {
+		for (persistence::db::TestModel& model : _models) {
+			_dbHandler->insert(model);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)_models.size());
+}
+
+BENCHMARK_DEFINE_F(PersistenceBenchmark, Write) (benchmark::State& state) {
+	if (skip(state)) {
+		return;
+	}
+	createModels((int)state.range(0));
+	persistence::BulkWrite bulkWrite;
+	for (auto _ : state) {
+		bulkWrite.clear();
+		for (const persistence::db::TestModel& model : _models) {
+			bulkWrite.add(model);
+		}
+		_dbHandler->write(bulkWrite);
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)_models.size());
+}
+
+BENCHMARK_REGISTER_F(PersistenceBenchmark, Insert)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PersistenceBenchmark, Write)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -57,6 +57,13 @@ void postgresShutdown() {
 	PQsetNoticeProcessor = nullptr;
 	PQflush = nullptr;
 	PQfname = nullptr;
+	PQsendQueryPrepared = nullptr;
+	PQgetResult = nullptr;
+#ifdef LIBPQ_HAS_PIPELINING
+	PQenterPipelineMode = nullptr;
+	PQexitPipelineMode = nullptr;
+	PQpipelineSync = nullptr;
+#endif
 #endif
 }
 
@@ -123,6 +130,13 @@ bool postgresInit() {
 	DYNLOAD(obj, PQsetNoticeProcessor);
 	DYNLOAD(obj, PQflush);
 	DYNLOAD(obj, PQfname);
+	DYNLOAD(obj, PQsendQueryPrepared);
+	DYNLOAD(obj, PQgetResult);
+#ifdef LIBPQ_HAS_PIPELINING
+	DYNLOAD(obj, PQenterPipelineMode);
+	DYNLOAD(obj, PQexitPipelineMode);
+	DYNLOAD(obj, PQpipelineSync);
+#endif
 
 	if (PQescapeStringConn == nullptr || PQexec == nullptr
 			|| PQinitSSL == nullptr || PQsetdbLogin == nullptr
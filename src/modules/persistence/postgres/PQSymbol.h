@@ -60,6 +60,14 @@ DYNDEFINE(PQsslInUse);
 DYNDEFINE(PQsetNoticeProcessor);
 DYNDEFINE(PQflush);
 DYNDEFINE(PQfname);
+DYNDEFINE(PQsendQueryPrepared);
+DYNDEFINE(PQgetResult);
+#ifdef LIBPQ_HAS_PIPELINING
+// optional - only available since libpq 14
+DYNDEFINE(PQenterPipelineMode);
+DYNDEFINE(PQexitPipelineMode);
+DYNDEFINE(PQpipelineSync);
+#endif
 #undef DYNDEFINE
 #endif
 }
@@ -0,0 +1,139 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "persistence/BulkWrite.h"
+#include "persistence/ISavable.h"
+#include "TestModels.h"
+
+namespace persistence {
+
+class BulkWriteTest : public app::AbstractTest {
+};
+
+TEST_F(BulkWriteTest, testGroupByStatement) {
+	BulkWrite bulkWrite;
+	for (int i = 0; i < 10; ++i) {
+		db::TestModel model;
+		model.setId(i);
+		model.setPoints(i * 10);
+		bulkWrite.add(model);
+	}
+	db::TestModel other;
+	other.setId(100);
+	other.setName("name");
+	bulkWrite.add(other);
+	db::TestUpdate1Model update;
+	update.setId(1);
+	bulkWrite.add(update);
+
+	EXPECT_EQ(12, bulkWrite.rows());
+	ASSERT_EQ(3u, bulkWrite.inserts().size());
+	EXPECT_TRUE(bulkWrite.deletes().empty());
+	const BulkWrite::Statement& s = bulkWrite.inserts()[0];
+	EXPECT_EQ(10, s.rows);
+	EXPECT_EQ(2, s.parameterCount);
+	ASSERT_EQ(20u, s.parameters.size());
+	EXPECT_EQ("9", s.parameters[18]);
+	EXPECT_EQ("90", s.parameters[19]);
+	EXPECT_EQ(1, bulkWrite.inserts()[1].rows);
+	EXPECT_EQ(1, bulkWrite.inserts()[2].rows);
+}
+
+TEST_F(BulkWriteTest, testParametersAreCopied) {
+	BulkWrite bulkWrite;
+	db::TestModel model;
+	model.setId(1);
+	model.setName("before");
+	bulkWrite.add(model);
+	model.setName("after");
+	ASSERT_EQ(1u, bulkWrite.inserts().size());
+	EXPECT_EQ("before", bulkWrite.inserts()[0].parameters[1]);
+}
+
+TEST_F(BulkWriteTest, testBlob) {
+	BulkWrite bulkWrite;
+	const uint8_t data[] = { 0x01, 0x00, 0x02, 0x00 };
+	db::BlobtestModel model;
+	model.setId(1);
+	model.setData(Blob((uint8_t*)data, sizeof(data)));
+	bulkWrite.add(model);
+	ASSERT_EQ(1u, bulkWrite.inserts().size());
+	const BulkWrite::Statement& s = bulkWrite.inserts()[0];
+	ASSERT_EQ(2u, s.parameters.size());
+	// the binary data is copied, too
+	EXPECT_EQ(1, s.formats[0]);
+	ASSERT_EQ((int)sizeof(data), s.lengths[0]);
+	EXPECT_EQ(0, memcmp(data, s.parameters[0].c_str(), sizeof(data)));
+}
+
+TEST_F(BulkWriteTest, testSameKeyTwice) {
+	BulkWrite bulkWrite;
+	db::TestModel model;
+	model.setId(1);
+	model.setPoints(1);
+	bulkWrite.add(model);
+	model.setId(2);
+	bulkWrite.add(model);
+	// a multi row upsert can't update the same row twice
+	model.setId(1);
+	bulkWrite.add(model);
+	model.setId(3);
+	bulkWrite.add(model);
+
+	EXPECT_EQ(4, bulkWrite.rows());
+	ASSERT_EQ(2u, bulkWrite.inserts().size());
+	EXPECT_EQ(2, bulkWrite.inserts()[0].rows);
+	EXPECT_EQ(2, bulkWrite.inserts()[1].rows);
+	EXPECT_EQ(bulkWrite.inserts()[0].key, bulkWrite.inserts()[1].key);
+}
+
+TEST_F(BulkWriteTest, testDelete) {
+	BulkWrite bulkWrite;
+	db::TestModel model;
+	model.setId(1);
+	model.setPoints(1);
+	bulkWrite.add(model);
+	model.flagForDelete();
+	bulkWrite.add(model);
+	model.setId(2);
+	bulkWrite.add(model);
+
+	ASSERT_EQ(1u, bulkWrite.inserts().size());
+	ASSERT_EQ(1u, bulkWrite.deletes().size());
+	const BulkWrite::Statement& s = bulkWrite.deletes()[0];
+	EXPECT_FALSE(s.insert);
+	EXPECT_EQ(R"(DELETE FROM "public"."test" WHERE "id" = $1)", s.base);
+	EXPECT_EQ(2, s.rows);
+	ASSERT_EQ(2u, s.parameters.size());
+	EXPECT_EQ("2", s.parameters[1]);
+}
+
+TEST_F(BulkWriteTest, testSavable) {
+	class Savable : public ISavable {
+	public:
+		db::TestModel model;
+		bool dirty = true;
+		bool getDirtyModels(Models& models) override {
+			if (!dirty) {
+				return false;
+			}
+			models.push_back(&model);
+			dirty = false;
+			return true;
+		}
+	};
+	Savable savable;
+	savable.model.setId(1);
+	savable.model.setPoints(1);
+	BulkWrite bulkWrite;
+	EXPECT_TRUE(bulkWrite.add(&savable));
+	EXPECT_FALSE(bulkWrite.add(&savable));
+	EXPECT_EQ(1, bulkWrite.rows());
+	bulkWrite.clear();
+	EXPECT_TRUE(bulkWrite.empty());
+	EXPECT_TRUE(bulkWrite.inserts().empty());
+}
+
+}
@@ -88,6 +88,48 @@ TEST_F(SQLGeneratorTest, testInsertAutoIncrementGiven) {
 			createInsertStatement(model));
 }
 
+TEST_F(SQLGeneratorTest, testBulkInsert) {
+	db::TestModel model;
+	model.setId(1);
+	model.setPoints(2);
+	core::String values;
+	core::String conflict;
+	int parameterCount = 0;
+	BindParam params(2);
+	const core::String& base = createBulkInsertBaseStatement(model, &params, values, conflict, parameterCount);
+	ASSERT_EQ(2, parameterCount);
+	ASSERT_EQ(2, params.position);
+	ASSERT_EQ(R"(INSERT INTO "public"."test" ("id", "points") VALUES ($1, $2) ON CONFLICT ("id") DO UPDATE SET "points" = "public"."test"."points" + EXCLUDED."points";)",
+			createBulkInsertStatement(base, values, conflict, parameterCount, 1));
+	ASSERT_EQ(R"(INSERT INTO "public"."test" ("id", "points") VALUES ($1, $2),($3, $4),($5, $6) ON CONFLICT ("id") DO UPDATE SET "points" = "public"."test"."points" + EXCLUDED."points";)",
+			createBulkInsertStatement(base, values, conflict, parameterCount, 3));
+}
+
+TEST_F(SQLGeneratorTest, testBulkInsertPlaceholders) {
+	db::TestModel model;
+	model.setId(1);
+	model.setPassword("secret");
+	model.setRegistrationdate(Timestamp::now());
+	core::String values;
+	core::String conflict;
+	int parameterCount = 0;
+	const core::String& base = createBulkInsertBaseStatement(model, nullptr, values, conflict, parameterCount);
+	ASSERT_EQ(2, parameterCount);
+	ASSERT_EQ(R"(INSERT INTO "public"."test" ("id", "password", "registrationdate") VALUES ($1, crypt($2, gen_salt('bf', 8)), NOW() AT TIME ZONE 'UTC'),($3, crypt($4, gen_salt('bf', 8)), NOW() AT TIME ZONE 'UTC') ON CONFLICT ("id") DO UPDATE SET "password" = EXCLUDED."password", "registrationdate" = EXCLUDED."registrationdate";)",
+			createBulkInsertStatement(base, values, conflict, parameterCount, 2));
+}
+
+TEST_F(SQLGeneratorTest, testBulkInsertKeyOnly) {
+	db::TestModel model;
+	model.setId(1);
+	core::String values;
+	core::String conflict;
+	int parameterCount = 0;
+	const core::String& base = createBulkInsertBaseStatement(model, nullptr, values, conflict, parameterCount);
+	ASSERT_EQ(R"(INSERT INTO "public"."test" ("id") VALUES ($1),($2) ON CONFLICT ("id") DO NOTHING;)",
+			createBulkInsertStatement(base, values, conflict, parameterCount, 2));
+}
+
 TEST_F(SQLGeneratorTest, testCount) {
 	ASSERT_EQ(R"(SELECT COUNT(*) FROM "public"."test")", createCountStatement(db::TestModel()));
 }
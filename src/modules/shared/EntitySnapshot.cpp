@@ -0,0 +1,311 @@
+/**
+ * @file
+ */
+
+#include "EntitySnapshot.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <glm/gtc/constants.hpp>
+
+namespace shared {
+
+namespace {
+
+enum EntityDeltaFlags : uint8_t {
+	Position = 1 << 0,
+	Orientation = 1 << 1,
+	Animation = 1 << 2,
+	// no baseline state - all values are written as they are
+	Full = 1 << 3,
+	// the entity is no longer part of the snapshot
+	Removed = 1 << 4
+};
+
+inline uint32_t zigzag(int32_t v) {
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+inline int32_t unzigzag(uint32_t v) {
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u);
+}
+
+inline void writeVarInt(uint64_t v, std::vector<uint8_t>& out) {
+	while (v >= 0x80u) {
+		out.push_back((uint8_t)(v | 0x80u));
+		v >>= 7;
+	}
+	out.push_back((uint8_t)v);
+}
+
+class Reader {
+private:
+	const uint8_t* _data;
+	const uint8_t* _end;
+public:
+	Reader(const uint8_t* data, size_t size) :
+			_data(data), _end(data + size) {
+	}
+
+	inline bool eos() const {
+		return _data >= _end;
+	}
+
+	bool readByte(uint8_t& v) {
+		if (_data >= _end) {
+			return false;
+		}
+		v = *_data++;
+		return true;
+	}
+
+	bool readVarInt(uint64_t& v) {
+		v = 0u;
+		for (int shift = 0; shift < 64; shift += 7) {
+			uint8_t b;
+			if (!readByte(b)) {
+				return false;
+			}
+			v |= (uint64_t)(b & 0x7Fu) << shift;
+			if ((b & 0x80u) == 0u) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool readZigZag(int32_t& v) {
+		uint64_t u;
+		if (!readVarInt(u) || u > 0xFFFFFFFFu) {
+			return false;
+		}
+		v = unzigzag((uint32_t)u);
+		return true;
+	}
+};
+
+void writeFull(const EntityState& state, std::vector<uint8_t>& out) {
+	for (int i = 0; i < 3; ++i) {
+		writeVarInt(zigzag(state.pos[i]), out);
+	}
+	writeVarInt(state.orientation, out);
+	out.push_back((uint8_t)state.animation);
+}
+
+void writeDelta(uint8_t flags, const EntityState& base, const EntityState& state, std::vector<uint8_t>& out) {
+	if (flags & Position) {
+		for (int i = 0; i < 3; ++i) {
+			writeVarInt(zigzag(state.pos[i] - base.pos[i]), out);
+		}
+	}
+	if (flags & Orientation) {
+		// the wrap around is intended - the shortest way is encoded
+		writeVarInt(zigzag((int16_t)(uint16_t)(state.orientation - base.orientation)), out);
+	}
+	if (flags & Animation) {
+		out.push_back((uint8_t)state.animation);
+	}
+}
+
+uint8_t deltaFlags(const EntityState& base, const EntityState& state) {
+	uint8_t flags = 0u;
+	if (base.pos != state.pos) {
+		flags |= Position;
+	}
+	if (base.orientation != state.orientation) {
+		flags |= Orientation;
+	}
+	if (base.animation != state.animation) {
+		flags |= Animation;
+	}
+	return flags;
+}
+
+}
+
+glm::ivec3 quantizePosition(const glm::vec3& pos) {
+	return glm::ivec3(glm::round(pos * PositionScale));
+}
+
+glm::vec3 dequantizePosition(const glm::ivec3& pos) {
+	return glm::vec3(pos) / PositionScale;
+}
+
+uint16_t quantizeOrientation(float orientation) {
+	const float normalized = orientation / glm::two_pi<float>();
+	const float wrapped = normalized - glm::floor(normalized);
+	return (uint16_t)((int)glm::round(wrapped * 65536.0f) & 0xFFFF);
+}
+
+float dequantizeOrientation(uint16_t orientation) {
+	return (float)orientation * (glm::two_pi<float>() / 65536.0f);
+}
+
+EntityState quantize(const glm::vec3& pos, float orientation, network::Animation animation) {
+	EntityState state;
+	state.pos = quantizePosition(pos);
+	state.orientation = quantizeOrientation(orientation);
+	state.animation = animation;
+	return state;
+}
+
+int EntitySnapshotCodec::encode(const EntitySnapshotEntries* baseline, const EntitySnapshotEntries& current, std::vector<uint8_t>& out) {
+	core_trace_scoped(EntitySnapshotEncode);
+	out.clear();
+	int written = 0;
+	int64_t lastId = 0;
+	auto writeId = [&] (int64_t id) {
+		core_assert_msg(id >= lastId, "Snapshot entries must be sorted by id");
+		writeVarInt((uint64_t)(id - lastId), out);
+		lastId = id;
+		++written;
+	};
+
+	const EntitySnapshotEntry* b = baseline != nullptr ? baseline->data() : nullptr;
+	const EntitySnapshotEntry* bend = baseline != nullptr ? b + baseline->size() : nullptr;
+	for (const EntitySnapshotEntry& entry : current) {
+		// everything in the baseline with a lower id vanished
+		for (; b != bend && b->id < entry.id; ++b) {
+			writeId(b->id);
+			out.push_back(Removed);
+		}
+		if (b != bend && b->id == entry.id) {
+			const uint8_t flags = deltaFlags(b->state, entry.state);
+			if (flags != 0u) {
+				writeId(entry.id);
+				out.push_back(flags);
+				writeDelta(flags, b->state, entry.state, out);
+			}
+			++b;
+			continue;
+		}
+		writeId(entry.id);
+		out.push_back(Full);
+		writeFull(entry.state, out);
+	}
+	for (; b != bend; ++b) {
+		writeId(b->id);
+		out.push_back(Removed);
+	}
+	return written;
+}
+
+bool EntitySnapshotCodec::decode(const EntitySnapshotEntries* baseline, const uint8_t* data, size_t size,
+		EntitySnapshotEntries& current, EntitySnapshotEntries* changed) {
+	core_trace_scoped(EntitySnapshotDecode);
+	current.clear();
+	if (changed != nullptr) {
+		changed->clear();
+	}
+	if (baseline != nullptr) {
+		current.reserve(baseline->size());
+	}
+	Reader reader(data, size);
+	int64_t id = 0;
+	const EntitySnapshotEntry* b = baseline != nullptr ? baseline->data() : nullptr;
+	const EntitySnapshotEntry* bend = baseline != nullptr ? b + baseline->size() : nullptr;
+	while (!reader.eos()) {
+		uint64_t idDelta;
+		uint8_t flags;
+		if (!reader.readVarInt(idDelta) || !reader.readByte(flags)) {
+			return false;
+		}
+		id += (int64_t)idDelta;
+		// unchanged entities are taken from the baseline
+		for (; b != bend && b->id < id; ++b) {
+			current.push_back(*b);
+		}
+		const bool inBaseline = b != bend && b->id == id;
+		if (flags & Removed) {
+			if (!inBaseline) {
+				return false;
+			}
+			++b;
+			continue;
+		}
+		EntitySnapshotEntry entry;
+		entry.id = id;
+		if (flags & Full) {
+			uint64_t orientation;
+			for (int i = 0; i < 3; ++i) {
+				if (!reader.readZigZag(entry.state.pos[i])) {
+					return false;
+				}
+			}
+			uint8_t animation;
+			if (!reader.readVarInt(orientation) || orientation > 0xFFFFu || !reader.readByte(animation)) {
+				return false;
+			}
+			entry.state.orientation = (uint16_t)orientation;
+			entry.state.animation = (network::Animation)animation;
+			if (inBaseline) {
+				++b;
+			}
+		} else {
+			if (!inBaseline) {
+				return false;
+			}
+			entry.state = b->state;
+			++b;
+			if (flags & Position) {
+				for (int i = 0; i < 3; ++i) {
+					int32_t delta;
+					if (!reader.readZigZag(delta)) {
+						return false;
+					}
+					entry.state.pos[i] += delta;
+				}
+			}
+			if (flags & Orientation) {
+				int32_t delta;
+				if (!reader.readZigZag(delta)) {
+					return false;
+				}
+				entry.state.orientation = (uint16_t)(entry.state.orientation + delta);
+			}
+			if (flags & Animation) {
+				uint8_t animation;
+				if (!reader.readByte(animation)) {
+					return false;
+				}
+				entry.state.animation = (network::Animation)animation;
+			}
+		}
+		current.push_back(entry);
+		if (changed != nullptr) {
+			changed->push_back(entry);
+		}
+	}
+	for (; b != bend; ++b) {
+		current.push_back(*b);
+	}
+	return true;
+}
+
+const EntitySnapshotEntries* EntitySnapshotHistory::get(uint32_t sequence) const {
+	if (sequence == 0u) {
+		return nullptr;
+	}
+	const Snapshot& snapshot = _snapshots[sequence % Size];
+	if (snapshot.sequence != sequence) {
+		return nullptr;
+	}
+	return &snapshot.entries;
+}
+
+EntitySnapshotEntries& EntitySnapshotHistory::store(uint32_t sequence) {
+	core_assert(sequence != 0u);
+	Snapshot& snapshot = _snapshots[sequence % Size];
+	snapshot.sequence = sequence;
+	snapshot.entries.clear();
+	return snapshot.entries;
+}
+
+void EntitySnapshotHistory::clear() {
+	for (int i = 0; i < Size; ++i) {
+		_snapshots[i].sequence = 0u;
+		_snapshots[i].entries.clear();
+	}
+}
+
+}
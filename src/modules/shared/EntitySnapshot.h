@@ -0,0 +1,120 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Shared_generated.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Shared between client and server
+ */
+namespace shared {
+
+/**
+ * @brief The quantized state of an entity as it is transferred in an entity snapshot
+ */
+struct EntityState {
+	/**
+	 * Fixed point world position - see @c PositionScale
+	 */
+	glm::ivec3 pos { 0 };
+	/**
+	 * The orientation mapped from [0, 2pi) to [0, 65536)
+	 */
+	uint16_t orientation = 0u;
+	network::Animation animation = network::Animation::IDLE;
+
+	inline bool operator==(const EntityState& rhs) const {
+		return pos == rhs.pos && orientation == rhs.orientation && animation == rhs.animation;
+	}
+
+	inline bool operator!=(const EntityState& rhs) const {
+		return !(*this == rhs);
+	}
+};
+
+/**
+ * The amount of fixed point steps per world unit
+ */
+constexpr float PositionScale = 16.0f;
+
+glm::ivec3 quantizePosition(const glm::vec3& pos);
+glm::vec3 dequantizePosition(const glm::ivec3& pos);
+uint16_t quantizeOrientation(float orientation);
+float dequantizeOrientation(uint16_t orientation);
+EntityState quantize(const glm::vec3& pos, float orientation, network::Animation animation);
+
+struct EntitySnapshotEntry {
+	int64_t id;
+	EntityState state;
+
+	inline bool operator<(const EntitySnapshotEntry& rhs) const {
+		return id < rhs.id;
+	}
+};
+
+/**
+ * @brief All entity states of a snapshot - sorted by the entity id
+ */
+typedef std::vector<EntitySnapshotEntry> EntitySnapshotEntries;
+
+/**
+ * @brief Bit packed delta encoding for the entity states of a snapshot.
+ *
+ * The snapshot is encoded against a baseline that the receiver already knows. Entities that didn't change
+ * since the baseline are not transferred at all, changed values are written as zigzag varint deltas, new
+ * entities get their full state and entities that are no longer part of the snapshot are marked as removed.
+ * Applying the data to the baseline on the receiving side results in exactly the states of the sender.
+ */
+class EntitySnapshotCodec {
+public:
+	/**
+	 * @param[in] baseline The entries of the baseline snapshot or @c nullptr to encode the full states
+	 * @param[in] current The sorted entries of the current snapshot
+	 * @param[out] out The encoded data - the vector is cleared before
+	 * @return The amount of entities that were written
+	 */
+	static int encode(const EntitySnapshotEntries* baseline, const EntitySnapshotEntries& current, std::vector<uint8_t>& out);
+
+	/**
+	 * @param[in] baseline The entries of the baseline snapshot or @c nullptr if the data contains the full states
+	 * @param[out] current The sorted entries of the snapshot after the data was applied. Must not be the baseline.
+	 * @param[out] changed The entries that were transferred in the data. Might be @c nullptr.
+	 * @return @c false if the data is invalid or doesn't match the baseline
+	 */
+	static bool decode(const EntitySnapshotEntries* baseline, const uint8_t* data, size_t size,
+			EntitySnapshotEntries& current, EntitySnapshotEntries* changed = nullptr);
+};
+
+/**
+ * @brief Ring buffer of the last snapshots that can be used as baseline for the delta encoding.
+ * The sequence @c 0 is reserved for "no baseline".
+ */
+class EntitySnapshotHistory {
+public:
+	static constexpr int Size = 32;
+private:
+	struct Snapshot {
+		uint32_t sequence = 0u;
+		EntitySnapshotEntries entries;
+	};
+	Snapshot _snapshots[Size];
+public:
+	/**
+	 * @return The entries of the snapshot with the given sequence or @c nullptr if it is no longer (or not yet) known
+	 */
+	const EntitySnapshotEntries* get(uint32_t sequence) const;
+	/**
+	 * @brief Reserves the slot for the given sequence number and returns the (cleared) entries to fill.
+	 * This overwrites the oldest snapshot.
+	 */
+	EntitySnapshotEntries& store(uint32_t sequence);
+	void clear();
+};
+
+}
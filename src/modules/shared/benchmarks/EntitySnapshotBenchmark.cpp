@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "shared/EntitySnapshot.h"
+#include "ServerMessages_generated.h"
+#include "math/Random.h"
+#include <glm/gtc/constants.hpp>
+#include <vector>
+
+/**
+ * @brief Measures the bytes per client and tick for a crowd of visible entities. Every entity moves
+ * a bit each tick and turns from time to time.
+ */
+class EntitySnapshotBenchmark : public app::AbstractBenchmark {
+protected:
+	struct BenchmarkEntity {
+		glm::vec3 pos;
+		glm::vec3 dir;
+		float orientation;
+	};
+	std::vector<BenchmarkEntity> _entities;
+	math::Random _random;
+
+	void fill(int n) {
+		_entities.resize(n);
+		for (BenchmarkEntity& e : _entities) {
+			e.pos = glm::vec3(_random.randomf(-500.0f, 500.0f), _random.randomf(0.0f, 64.0f), _random.randomf(-500.0f, 500.0f));
+			e.dir = glm::vec3(_random.randomf(-0.3f, 0.3f), 0.0f, _random.randomf(-0.3f, 0.3f));
+			e.orientation = _random.randomf(0.0f, glm::two_pi<float>());
+		}
+	}
+
+	void tick(shared::EntitySnapshotEntries& entries) {
+		entries.clear();
+		int64_t id = 1;
+		for (BenchmarkEntity& e : _entities) {
+			e.pos += e.dir;
+			if (_random.randomf() < 0.05f) {
+				e.orientation += _random.randomf(-0.5f, 0.5f);
+			}
+			entries.push_back({id++, shared::quantize(e.pos, e.orientation, network::Animation::RUN)});
+		}
+	}
+
+	/**
+	 * @return The size of the former protocol: one @c network::EntityUpdate message per visible entity
+	 */
+	static size_t entityUpdateBytes(int n) {
+		flatbuffers::FlatBufferBuilder fbb;
+		const network::Vec3 pos { 1.0f, 2.0f, 3.0f };
+		auto msg = network::CreateServerMessage(fbb, network::ServerMsgType::EntityUpdate,
+				network::CreateEntityUpdate(fbb, 4711, &pos, 1.0f, network::Animation::RUN).Union());
+		network::FinishServerMessageBuffer(fbb, msg);
+		return fbb.GetSize() * (size_t)n;
+	}
+};
+
+BENCHMARK_DEFINE_F(EntitySnapshotBenchmark, Encode)(benchmark::State &state) {
+	const int n = (int)state.range(0);
+	// the amount of ticks until the client acknowledges a snapshot
+	const uint32_t ackDelay = (uint32_t)state.range(1);
+	fill(n);
+	shared::EntitySnapshotHistory history;
+	shared::EntitySnapshotEntries entries;
+	std::vector<uint8_t> data;
+	flatbuffers::FlatBufferBuilder fbb;
+	uint32_t sequence = 0u;
+	size_t bytes = 0u;
+	for (auto _ : state) {
+		tick(entries);
+		const uint32_t baselineSequence = sequence >= ackDelay ? sequence + 1u - ackDelay : 0u;
+		const shared::EntitySnapshotEntries* baseline = history.get(baselineSequence);
+		shared::EntitySnapshotCodec::encode(baseline, entries, data);
+		++sequence;
+		fbb.Clear();
+		auto vec = fbb.CreateVector(data);
+		auto msg = network::CreateServerMessage(fbb, network::ServerMsgType::EntitySnapshot,
+				network::CreateEntitySnapshot(fbb, sequence, baseline != nullptr ? baselineSequence : 0u, vec).Union());
+		network::FinishServerMessageBuffer(fbb, msg);
+		bytes += fbb.GetSize();
+		std::swap(history.store(sequence), entries);
+	}
+	state.counters["bytes"] = benchmark::Counter((double)bytes, benchmark::Counter::kAvgIterations);
+	state.counters["entityupdate_bytes"] = (double)entityUpdateBytes(n);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_REGISTER_F(EntitySnapshotBenchmark, Encode)
+	->Args({100, 1})->Args({500, 1})->Args({2000, 1})
+	->Args({100, 4})->Args({500, 4})->Args({2000, 4});
+
+BENCHMARK_MAIN();
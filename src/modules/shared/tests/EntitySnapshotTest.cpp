@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "shared/EntitySnapshot.h"
+#include <glm/gtc/constants.hpp>
+
+namespace shared {
+
+class EntitySnapshotTest: public app::AbstractTest {
+protected:
+	EntitySnapshotEntry entry(int64_t id, const glm::vec3& pos, float orientation = 0.0f, network::Animation animation = network::Animation::IDLE) const {
+		return EntitySnapshotEntry{id, quantize(pos, orientation, animation)};
+	}
+
+	void roundtrip(const EntitySnapshotEntries* baseline, const EntitySnapshotEntries& current, int expectedWritten) {
+		std::vector<uint8_t> data;
+		EXPECT_EQ(expectedWritten, EntitySnapshotCodec::encode(baseline, current, data));
+		EntitySnapshotEntries decoded;
+		ASSERT_TRUE(EntitySnapshotCodec::decode(baseline, data.data(), data.size(), decoded));
+		ASSERT_EQ(current.size(), decoded.size());
+		for (size_t i = 0; i < current.size(); ++i) {
+			EXPECT_EQ(current[i].id, decoded[i].id);
+			EXPECT_TRUE(current[i].state == decoded[i].state) << "Entity " << current[i].id << " doesn't match";
+		}
+	}
+};
+
+TEST_F(EntitySnapshotTest, testQuantize) {
+	const glm::vec3 pos(-100.3f, 12.0f, 4711.7f);
+	const glm::vec3& dequantized = dequantizePosition(quantizePosition(pos));
+	for (int i = 0; i < 3; ++i) {
+		EXPECT_NEAR(pos[i], dequantized[i], 0.5f / PositionScale);
+	}
+	EXPECT_NEAR(1.0f, dequantizeOrientation(quantizeOrientation(1.0f)), 0.001f);
+	EXPECT_EQ(quantizeOrientation(0.5f), quantizeOrientation(0.5f + glm::two_pi<float>()));
+	EXPECT_EQ(quantizeOrientation(-0.5f), quantizeOrientation(glm::two_pi<float>() - 0.5f));
+}
+
+TEST_F(EntitySnapshotTest, testFull) {
+	const EntitySnapshotEntries current{entry(1, glm::vec3(1.0f)), entry(5, glm::vec3(-1000.0f, 2.0f, 3.0f), 2.0f, network::Animation::RUN)};
+	roundtrip(nullptr, current, 2);
+}
+
+TEST_F(EntitySnapshotTest, testDelta) {
+	const EntitySnapshotEntries baseline{entry(1, glm::vec3(1.0f)), entry(2, glm::vec3(2.0f)), entry(3, glm::vec3(3.0f)), entry(7, glm::vec3(7.0f))};
+	// 1 is unchanged, 2 moved, 3 vanished, 4 is new, 7 rotated
+	const EntitySnapshotEntries current{entry(1, glm::vec3(1.0f)), entry(2, glm::vec3(2.5f, 2.0f, 1.0f)), entry(4, glm::vec3(4.0f)),
+			entry(7, glm::vec3(7.0f), glm::two_pi<float>() - 0.01f)};
+	roundtrip(&baseline, current, 4);
+}
+
+TEST_F(EntitySnapshotTest, testUnchanged) {
+	const EntitySnapshotEntries baseline{entry(1, glm::vec3(1.0f)), entry(2, glm::vec3(2.0f))};
+	std::vector<uint8_t> data;
+	EXPECT_EQ(0, EntitySnapshotCodec::encode(&baseline, baseline, data));
+	EXPECT_TRUE(data.empty());
+}
+
+TEST_F(EntitySnapshotTest, testInvalidBaseline) {
+	const EntitySnapshotEntries baseline{entry(1, glm::vec3(1.0f))};
+	const EntitySnapshotEntries current{entry(1, glm::vec3(2.0f))};
+	std::vector<uint8_t> data;
+	ASSERT_EQ(1, EntitySnapshotCodec::encode(&baseline, current, data));
+	EntitySnapshotEntries decoded;
+	EXPECT_FALSE(EntitySnapshotCodec::decode(nullptr, data.data(), data.size(), decoded)) << "A delta can't be applied without the baseline";
+	EXPECT_FALSE(EntitySnapshotCodec::decode(&baseline, data.data(), data.size() - 1, decoded)) << "Truncated data should be detected";
+}
+
+TEST_F(EntitySnapshotTest, testHistory) {
+	EntitySnapshotHistory history;
+	EXPECT_EQ(nullptr, history.get(0u));
+	EXPECT_EQ(nullptr, history.get(1u));
+	history.store(1u).push_back(entry(1, glm::vec3(1.0f)));
+	ASSERT_NE(nullptr, history.get(1u));
+	EXPECT_EQ(1u, history.get(1u)->size());
+	history.store(1u + EntitySnapshotHistory::Size);
+	EXPECT_EQ(nullptr, history.get(1u)) << "The oldest snapshot should have been overwritten";
+	EXPECT_NE(nullptr, history.get(1u + EntitySnapshotHistory::Size));
+}
+
+}
@@ -8,6 +8,7 @@
 
 #include "IMGUI.h"
 #include "core/String.h"
+#include "core/collection/Array.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
 #include "core/collection/StringMap.h"
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "core/String.h"
+#include "core/collection/Array.h"
 #include "core/collection/List.h"
 #include "core/NonCopyable.h"
 #include "core/collection/StringMap.h"
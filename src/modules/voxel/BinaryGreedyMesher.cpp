@@ -0,0 +1,244 @@
+/**
+ * @file
+ */
+
+#include "BinaryGreedyMesher.h"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace voxel {
+
+namespace {
+
+// the axis that spans the rows (u) and the axis that is iterated for the rows (v) of the planes of an axis.
+// these are chosen in a way that the corner order of the quads is the same for each axis
+const int UAxis[] = { 2, 0, 1 };
+const int VAxis[] = { 1, 2, 0 };
+
+// corner order of the quads for faces looking into the negative and the positive direction of an axis
+const int CornerU[2][4] = { { 0, 1, 1, 0 }, { 0, 0, 1, 1 } };
+const int CornerV[2][4] = { { 0, 0, 1, 1 }, { 0, 1, 1, 0 } };
+
+inline int countTrailingZeros(uint64_t v) {
+	core_assert(v != 0u);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return (int)index;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+/**
+ * @brief Same as in the @c CubicSurfaceExtractor - 0 is the darkest, 3 is no occlusion at all
+ */
+inline uint8_t vertexAmbientOcclusion(bool side1, bool side2, bool corner) {
+	if (side1 && side2) {
+		return 0;
+	}
+	return 3 - (side1 + side2 + corner);
+}
+
+}
+
+void BinaryGreedyMesher::begin(const glm::ivec3& size) {
+	core_assert(size.x > 0 && size.x <= MaxBlockSize);
+	core_assert(size.y > 0 && size.y <= MaxBlockSize);
+	core_assert(size.z > 0 && size.z <= MaxBlockSize);
+	_size = size + 2;
+	_voxels.resize(_size.x * _size.y * _size.z);
+	_columns[0].assign(_size.y * _size.z, 0u);
+	_columns[1].assign(_size.z * _size.x, 0u);
+	_columns[2].assign(_size.x * _size.y, 0u);
+}
+
+void BinaryGreedyMesher::meshify(const glm::ivec3& blockOffset, Mesh* result, const glm::ivec3& translate, bool mergeQuads,
+		bool reuseVertices, bool ambientOcclusion) {
+	core_trace_scoped(BinaryGreedyMeshify);
+	for (int axis = 0; axis < 3; ++axis) {
+		meshifyAxis(axis, blockOffset, result, translate, mergeQuads, reuseVertices, ambientOcclusion);
+	}
+}
+
+void BinaryGreedyMesher::meshifyAxis(int axis, const glm::ivec3& blockOffset, Mesh* result, const glm::ivec3& translate,
+		bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
+	const int ua = UAxis[axis];
+	const int va = VAxis[axis];
+	const int sizeA = _size[axis];
+	const int sizeU = _size[ua];
+	const int sizeV = _size[va];
+	const uint64_t* columns = _columns[axis].data();
+	// only the planes of the block - not those of the border
+	const uint64_t planeMask = (((uint64_t)1 << (sizeA - 2)) - 1u) << 1;
+
+	_planes[0].assign(sizeA * sizeV, 0u);
+	_planes[1].assign(sizeA * sizeV, 0u);
+	uint64_t usedPlanes[2] = { 0u, 0u };
+	{
+		core_trace_scoped(BinaryGreedyFaces);
+		for (int v = 1; v < sizeV - 1; ++v) {
+			for (int u = 1; u < sizeU - 1; ++u) {
+				const uint64_t column = columns[v * sizeU + u];
+				if (column == 0u) {
+					continue;
+				}
+				// bit p: voxel p is solid and voxel p - 1 is not - the face belongs to voxel p
+				// bit p: voxel p - 1 is solid and voxel p is not - the face belongs to voxel p - 1
+				const uint64_t faces[2] = { column & ~(column << 1) & planeMask, (column << 1) & ~column & planeMask };
+				const uint64_t bit = (uint64_t)1 << u;
+				for (int dir = 0; dir < 2; ++dir) {
+					uint64_t f = faces[dir];
+					usedPlanes[dir] |= f;
+					while (f != 0u) {
+						const int p = countTrailingZeros(f);
+						_planes[dir][p * sizeV + v] |= bit;
+						f &= f - 1u;
+					}
+				}
+			}
+		}
+	}
+
+	if (usedPlanes[0] == 0u && usedPlanes[1] == 0u) {
+		return;
+	}
+
+	_faceKeys.resize(sizeU * sizeV);
+	_corners.resize(sizeU * sizeV);
+
+	for (int dir = 0; dir < 2; ++dir) {
+		uint64_t planes = usedPlanes[dir];
+		while (planes != 0u) {
+			const int p = countTrailingZeros(planes);
+			planes &= planes - 1u;
+			// the voxel the face belongs to and the layer the face is looking into
+			const int voxelLayer = dir == 0 ? p : p - 1;
+			const int emptyLayer = dir == 0 ? p - 1 : p;
+			uint64_t* rows = &_planes[dir][p * sizeV];
+
+			auto solid = [=] (int u, int v) {
+				return ((columns[v * sizeU + u] >> emptyLayer) & 1u) != 0u;
+			};
+			// the corner of the face at u, v is given by du and dv
+			auto cornerAO = [&] (int u, int v, int du, int dv) {
+				const int su = du != 0 ? 1 : -1;
+				const int sv = dv != 0 ? 1 : -1;
+				return vertexAmbientOcclusion(solid(u + su, v), solid(u, v + sv), solid(u + su, v + sv));
+			};
+			auto faceVoxel = [&] (int u, int v) -> const Voxel& {
+				glm::ivec3 pos;
+				pos[axis] = voxelLayer;
+				pos[ua] = u;
+				pos[va] = v;
+				return _voxels[voxelIndex(pos.x, pos.y, pos.z)];
+			};
+
+			if (mergeQuads) {
+				core_trace_scoped(BinaryGreedyFaceKeys);
+				for (int v = 1; v < sizeV - 1; ++v) {
+					uint64_t row = rows[v];
+					while (row != 0u) {
+						const int u = countTrailingZeros(row);
+						row &= row - 1u;
+						const Voxel& voxel = faceVoxel(u, v);
+						uint32_t key = voxel.getColor();
+						if (ambientOcclusion) {
+							key |= (uint32_t)voxel.getFlags() << 8;
+							for (int corner = 0; corner < 4; ++corner) {
+								key |= (uint32_t)cornerAO(u, v, CornerU[0][corner], CornerV[0][corner]) << (11 + corner * 2);
+							}
+						}
+						_faceKeys[v * sizeU + u] = key;
+					}
+				}
+			}
+
+			++_stamp;
+			auto addVertex = [&] (int u, int v, const Voxel& voxel, uint8_t ao) -> IndexType {
+				VoxelVertex vertex;
+				glm::ivec3 pos;
+				pos[axis] = blockOffset[axis] + p - 1;
+				pos[ua] = blockOffset[ua] + u - 1;
+				pos[va] = blockOffset[va] + v - 1;
+				vertex.position = pos + translate;
+				vertex.colorIndex = voxel.getColor();
+				vertex.ambientOcclusion = ao;
+				vertex.flags = voxel.getFlags();
+				vertex.padding = 0u;
+				if (!reuseVertices) {
+					return result->addVertex(vertex);
+				}
+				CornerVertex& existing = _corners[v * sizeU + u];
+				if (existing.stamp == _stamp) {
+					const VoxelVertex& other = result->getVertex(existing.index);
+					if (other.colorIndex == vertex.colorIndex && other.info == vertex.info) {
+						return existing.index;
+					}
+				}
+				existing.stamp = _stamp;
+				existing.index = result->addVertex(vertex);
+				return existing.index;
+			};
+
+			auto addQuad = [&] (int u, int v, int w, int h) {
+				const Voxel& voxel = faceVoxel(u, v);
+				IndexType indices[4];
+				uint8_t ao[4];
+				for (int i = 0; i < 4; ++i) {
+					const int du = CornerU[dir][i];
+					const int dv = CornerV[dir][i];
+					// the ambient occlusion of a corner is taken from the face at that corner
+					ao[i] = cornerAO(u + du * (w - 1), v + dv * (h - 1), du, dv);
+					indices[i] = addVertex(u + du * w, v + dv * h, voxel, ao[i]);
+				}
+				if (ao[3] + ao[1] > ao[0] + ao[2]) {
+					result->addTriangle(indices[1], indices[2], indices[3]);
+					result->addTriangle(indices[1], indices[3], indices[0]);
+				} else {
+					result->addTriangle(indices[0], indices[1], indices[2]);
+					result->addTriangle(indices[0], indices[2], indices[3]);
+				}
+			};
+
+			core_trace_scoped(BinaryGreedyMerge);
+			for (int v = 1; v < sizeV - 1; ++v) {
+				while (rows[v] != 0u) {
+					const uint64_t row = rows[v];
+					const int u = countTrailingZeros(row);
+					if (!mergeQuads) {
+						rows[v] &= row - 1u;
+						addQuad(u, v, 1, 1);
+						continue;
+					}
+					const uint32_t key = _faceKeys[v * sizeU + u];
+					// the length of the run of set bits that starts at u
+					const int run = countTrailingZeros(~(row >> u));
+					int w = 1;
+					while (w < run && _faceKeys[v * sizeU + u + w] == key) {
+						++w;
+					}
+					const uint64_t mask = (((uint64_t)1 << w) - 1u) << u;
+					rows[v] &= ~mask;
+					int h = 1;
+					for (; v + h < sizeV - 1; ++h) {
+						uint64_t& next = rows[v + h];
+						if ((next & mask) != mask) {
+							break;
+						}
+						const uint32_t* keys = &_faceKeys[(v + h) * sizeU + u];
+						if (std::any_of(keys, keys + w, [key] (uint32_t k) { return k != key; })) {
+							break;
+						}
+						next &= ~mask;
+					}
+					addQuad(u, v, w, h);
+				}
+			}
+		}
+	}
+}
+
+}
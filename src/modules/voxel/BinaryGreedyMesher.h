@@ -0,0 +1,143 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Mesh.h"
+#include "Voxel.h"
+#include "VoxelVertex.h"
+#include "Region.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <vector>
+#include <stdint.h>
+
+namespace voxel {
+
+/**
+ * @brief Extracts the cubic mesh of a block of at most @c BinaryGreedyMesher::MaxBlockSize voxels per axis
+ * by the use of occupancy bitmasks.
+ *
+ * The block is filled with the voxels of the block region plus a one voxel border on each side. For each
+ * axis the occupancy of the voxels is stored as 64 bit columns along that axis. The visible faces of a whole
+ * column are found with a single shift and mask operation, they are then transposed into per plane bitmasks
+ * that are greedily merged into quads by scanning the bits of the rows.
+ *
+ * @note Solid voxels are the voxels that are neither air nor water - this matches @c IsQuadNeeded
+ * @sa extractBinaryGreedyMesh()
+ */
+class BinaryGreedyMesher : public core::NonCopyable {
+public:
+	/**
+	 * The amount of voxels per axis of a block - the border voxels fill the 64 bits of the columns
+	 */
+	static constexpr int MaxBlockSize = 62;
+private:
+	struct CornerVertex {
+		uint32_t stamp;
+		IndexType index;
+	};
+
+	// the size of the block including the border
+	glm::ivec3 _size { 0 };
+	std::vector<Voxel> _voxels;
+	// occupancy columns along x (indexed by y,z), y (indexed by z,x) and z (indexed by x,y)
+	std::vector<uint64_t> _columns[3];
+	// the visible faces of the planes of one axis for the negative and positive direction
+	std::vector<uint64_t> _planes[2];
+	std::vector<uint32_t> _faceKeys;
+	std::vector<CornerVertex> _corners;
+	uint32_t _stamp = 0u;
+
+	inline int voxelIndex(int x, int y, int z) const {
+		return (z * _size.x + x) * _size.y + y;
+	}
+
+	void meshifyAxis(int axis, const glm::ivec3& blockOffset, Mesh* result, const glm::ivec3& translate,
+			bool mergeQuads, bool reuseVertices, bool ambientOcclusion);
+public:
+	/**
+	 * @brief Prepares the block for the given amount of voxels per axis (without the border)
+	 */
+	void begin(const glm::ivec3& size);
+
+	/**
+	 * @brief Coordinates are relative to the lower corner of the block border. That means that the first voxel
+	 * of the block is at @c 1,1,1 and the border voxels are at @c 0 and @c size+1
+	 */
+	inline void setVoxel(int x, int y, int z, const Voxel& voxel) {
+		core_assert(x >= 0 && x < _size.x && y >= 0 && y < _size.y && z >= 0 && z < _size.z);
+		_voxels[voxelIndex(x, y, z)] = voxel;
+		if (isAir(voxel.getMaterial()) || isWater(voxel.getMaterial())) {
+			return;
+		}
+		_columns[0][y * _size.z + z] |= (uint64_t)1 << x;
+		_columns[1][z * _size.x + x] |= (uint64_t)1 << y;
+		_columns[2][x * _size.y + y] |= (uint64_t)1 << z;
+	}
+
+	/**
+	 * @brief Adds the quads of the block to the given mesh
+	 * @param[in] blockOffset The position of the first (non border) voxel of the block relative to the lower
+	 * corner of the extracted region
+	 */
+	void meshify(const glm::ivec3& blockOffset, Mesh* result, const glm::ivec3& translate, bool mergeQuads,
+			bool reuseVertices, bool ambientOcclusion);
+};
+
+/**
+ * @brief Alternative to @c extractCubicMesh() that produces the same faces with the same colors and ambient
+ * occlusion values, but finds and merges them with 64 bit word operations on occupancy bitmasks.
+ *
+ * The region is split into blocks of @c BinaryGreedyMesher::MaxBlockSize voxels per axis. Quads are not merged
+ * across block boundaries. The merged quads are not necessarily the same as those of @c extractCubicMesh() as
+ * the greedy merging picks the rectangles in a fixed scan order - but they cover the same faces.
+ *
+ * @note Solid voxels are the voxels that are neither air nor water - this matches @c IsQuadNeeded
+ */
+template<typename VolumeType>
+void extractBinaryGreedyMesh(VolumeType* volData, const Region& region, Mesh* result, const glm::ivec3& translate,
+		bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
+	core_trace_scoped(ExtractBinaryGreedyMesh);
+
+	result->clear();
+	const glm::ivec3& lower = region.getLowerCorner();
+	const glm::ivec3& upper = region.getUpperCorner();
+	result->setOffset(lower);
+
+	BinaryGreedyMesher mesher;
+	typename VolumeType::Sampler volumeSampler(volData);
+	constexpr int blockSize = BinaryGreedyMesher::MaxBlockSize;
+	for (int32_t bz = lower.z; bz <= upper.z; bz += blockSize) {
+		for (int32_t bx = lower.x; bx <= upper.x; bx += blockSize) {
+			for (int32_t by = lower.y; by <= upper.y; by += blockSize) {
+				const glm::ivec3 size(core_min(blockSize, upper.x - bx + 1), core_min(blockSize, upper.y - by + 1),
+						core_min(blockSize, upper.z - bz + 1));
+				mesher.begin(size);
+				{
+					core_trace_scoped(FillBlock);
+					for (int32_t z = 0; z < size.z + 2; ++z) {
+						for (int32_t x = 0; x < size.x + 2; ++x) {
+							volumeSampler.setPosition(bx + x - 1, by - 1, bz + z - 1);
+							for (int32_t y = 0; y < size.y + 2; ++y) {
+								mesher.setVoxel(x, y, z, volumeSampler.voxel());
+								volumeSampler.movePositiveY();
+							}
+						}
+					}
+				}
+				const glm::ivec3 blockOffset(bx - lower.x, by - lower.y, bz - lower.z);
+				mesher.meshify(blockOffset, result, translate, mergeQuads, reuseVertices, ambientOcclusion);
+			}
+		}
+	}
+
+	result->removeUnusedVertices();
+	result->compressIndices();
+}
+
+}
@@ -10,6 +10,7 @@
 #include "math/Functions.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/round.hpp>
+#include <thread>
 
 namespace voxel {
 
@@ -21,9 +22,11 @@ namespace voxel {
  * @param targetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use.
  * @param chunkSideLength The size of the chunks making up the volume. Small chunks will compress/decompress faster, but there will also be
  * more of them meaning voxel access could be slower.
+ * @param compressedMemoryUsageInBytes The upper limit of the memory that is used to keep evicted chunks run-length encoded
+ * before they are handed over to the pager. Use @c 0 to disable this.
  */
-PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16_t chunkSideLength) :
-		_chunkSideLength(chunkSideLength), _pager(pager), _region(0, 0, 0, -1, -1, -1) {
+PagedVolume::PagedVolume(Pager* pager, uint64_t targetMemoryUsageInBytes, uint16_t chunkSideLength, uint64_t compressedMemoryUsageInBytes) :
+		_compressedMemoryLimit(compressedMemoryUsageInBytes), _chunkSideLength(chunkSideLength), _pager(pager), _region(0, 0, 0, -1, -1, -1) {
 	// Validation of parameters
 	core_assert_msg(_pager, "You must provide a valid pager when constructing a PagedVolume");
 	core_assert_msg(targetMemoryUsageInBytes >= 1 * 1024 * 1024, "Target memory usage is too small to be practical");
@@ -36,21 +39,24 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
 	// Use to perform modulo by bit operations
 	_chunkMask = _chunkSideLength - 1;
 
-	// Calculate the number of chunks based on the memory limit and the size of each chunk.
-	uint32_t chunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
-	_chunkCountLimit = targetMemoryUsageInBytes / chunkSizeInBytes;
-
-	// Enforce sensible limits on the number of chunks.
-	const uint32_t minPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
-	if (_chunkCountLimit < minPracticalNoOfChunks) {
-		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk limit is at %i, Chunk size: %uKb",
-				targetMemoryUsageInBytes / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+	// The chunks are charged with the memory of their current storage - but the limit must be enough for
+	// a chunk and its neighbours even if all of them are dense.
+	const uint64_t chunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
+	const uint64_t minPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
+	_memoryLimit = targetMemoryUsageInBytes;
+	if (_memoryLimit < minPracticalNoOfChunks * chunkSizeInBytes) {
+		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Dense chunk size: %uKb",
+				(uint32_t)(targetMemoryUsageInBytes / (1024 * 1024)), (uint32_t)(chunkSizeInBytes / 1024));
+		_memoryLimit = minPracticalNoOfChunks * chunkSizeInBytes;
 	}
-	_chunkCountLimit = core_max(_chunkCountLimit, minPracticalNoOfChunks);
+	_evictionBatchBytes = core_max(chunkSizeInBytes, _memoryLimit / 32u);
 
 	// Inform the user about the chosen memory configuration.
-	Log::info("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each).",
-			(_chunkCountLimit * chunkSizeInBytes) / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+	Log::info("Memory usage limit for volume now set to %uMb (%u dense chunks of %uKb each).",
+			(uint32_t)(_memoryLimit / (1024 * 1024)), (uint32_t)(_memoryLimit / chunkSizeInBytes), (uint32_t)(chunkSizeInBytes / 1024));
+	if (_compressedMemoryLimit > 0u) {
+		Log::info("Memory usage limit for compressed chunks now set to %uMb.", (uint32_t)(_compressedMemoryLimit / (1024 * 1024)));
+	}
 }
 
 /**
@@ -93,6 +99,41 @@ const Voxel& PagedVolume::voxel(const glm::ivec3& v3dPos) const {
 	return chunk(v3dPos)->voxel(xOffset, yOffset, zOffset);
 }
 
+// The innermost modification batch of the current thread
+static thread_local PagedVolume::ModificationBatch* activeBatch = nullptr;
+
+PagedVolume::ModificationBatch::ModificationBatch(PagedVolume* volume) :
+		_volume(volume), _previous(activeBatch) {
+	_active = _previous == nullptr || _previous->volume() != volume;
+	if (_active) {
+		activeBatch = this;
+	}
+}
+
+PagedVolume::ModificationBatch::~ModificationBatch() {
+	if (!_active) {
+		return;
+	}
+	activeBatch = _previous;
+	flush();
+}
+
+void PagedVolume::ModificationBatch::add(const glm::ivec3& chunkPos, int32_t x, int32_t y, int32_t z) {
+	auto i = _regions.find(chunkPos);
+	if (i == _regions.end()) {
+		_regions.put(chunkPos, Region(x, y, z, x, y, z));
+		return;
+	}
+	i->value.accumulate(x, y, z);
+}
+
+void PagedVolume::ModificationBatch::flush() {
+	for (auto i = _regions.begin(); i != _regions.end(); ++i) {
+		_volume->notifyModified(i->value);
+	}
+	_regions.clear();
+}
+
 /**
  * @param uXPos the @c x position of the voxel
  * @param uYPos the @c y position of the voxel
@@ -112,6 +153,11 @@ void PagedVolume::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, const Vo
 	const uint32_t yOffset = static_cast<uint32_t>(uYPos & _chunkMask);
 	const uint32_t zOffset = static_cast<uint32_t>(uZPos & _chunkMask);
 	chunk(chunkX, chunkY, chunkZ)->setVoxel(xOffset, yOffset, zOffset, tValue);
+	if (activeBatch != nullptr && activeBatch->volume() == this) {
+		activeBatch->add(glm::ivec3(chunkX, chunkY, chunkZ), uXPos, uYPos, uZPos);
+		return;
+	}
+	notifyModified(Region(uXPos, uYPos, uZPos, uXPos, uYPos, uZPos));
 }
 
 /**
@@ -154,7 +200,7 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
 				const uint16_t yOffset = static_cast<uint16_t>(y & _chunkMask);
 
 				ChunkPtr chunkPtr = chunk(chunkX, chunkY, chunkZ);
-				const int32_t n = core_min(left, int32_t(chunkPtr->_sideLength));
+				const int32_t n = core_min(left, int32_t(chunkPtr->_sideLength) - yOffset);
 
 				chunkPtr->setVoxels(xOffset, yOffset, zOffset, array, n);
 				left -= n;
@@ -163,80 +209,522 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
 			}
 		}
 	}
+	notifyModified(Region(uXPos, uYPos, uZPos, uXPos + nx - 1, uYPos + amount - 1, uZPos + nz - 1));
+}
+
+void PagedVolume::addListener(Listener* listener) {
+	_listeners.push_back(listener);
+}
+
+void PagedVolume::removeListener(Listener* listener) {
+	for (size_t i = 0; i < _listeners.size(); ++i) {
+		if (_listeners[i] == listener) {
+			_listeners.erase(i);
+			return;
+		}
+	}
+}
+
+void PagedVolume::notifyModified(const Region& region) const {
+	for (Listener* listener : _listeners) {
+		listener->onVoxelsModified(region);
+	}
+}
+
+void PagedVolume::notifyPagedIn(const ChunkPtr& chunk) const {
+	for (Listener* listener : _listeners) {
+		listener->onChunkPagedIn(chunk);
+	}
+}
+
+void PagedVolume::notifyEvicted(const glm::ivec3& chunkPos) const {
+	for (Listener* listener : _listeners) {
+		listener->onChunkEvicted(chunkPos);
+	}
 }
 
 /**
  * Removes all voxels from memory by removing all chunks. The application has the chance to persist the data via @c Pager::pageOut
  */
 void PagedVolume::flushAll() {
-	core::ScopedWriteLock writeLock(_volumeLock);
-	_chunks.clear();
+	core::ScopedLock lock(_clockLock);
+	for (const ChunkPtr& chunk : _clock) {
+		detachMemoryUsage(chunk);
+		notifyEvicted(chunk->chunkPos());
+	}
+	for (int i = 0; i < ChunkShardCount; ++i) {
+		ChunkShard& shard = _shards[i];
+		core::ScopedWriteLock writeLock(shard.lock);
+		shard.chunks.clear();
+	}
+	_clock.clear();
+	_clockHand = 0u;
+
+	core::DynamicArray<CompressedChunkPtr> compressedChunks;
+	{
+		core::ScopedLock compressedLock(_compressedLock);
+		compressedChunks.reserve(_compressedChunks.size());
+		for (auto iter = _compressedChunks.begin(); iter != _compressedChunks.end(); ++iter) {
+			compressedChunks.push_back(iter->value);
+		}
+		_compressedChunks.clear();
+		_compressedQueue.clear();
+		_compressedHead = 0u;
+		_compressedBytes = 0u;
+	}
+	core::DynamicArray<CompressedChunkPtr> modified;
+	for (const CompressedChunkPtr& compressed : compressedChunks) {
+		// the chunk is still compressed or written back by another thread - only after that we know
+		// whether the pager still has to get the data
+		while (!compressed->_ready) {
+			std::this_thread::yield();
+		}
+		if (compressed->_modified) {
+			modified.push_back(compressed);
+		}
+	}
+	writeBackCompressedChunks(modified);
+}
+
+PagedVolume::Statistics PagedVolume::statistics() const {
+	Statistics stats;
+	for (int i = 0; i < ChunkShardCount; ++i) {
+		const ChunkShard& shard = _shards[i];
+		stats.hits += shard.hits;
+		stats.misses += shard.misses;
+	}
+	stats.evictions = _evictions;
+	stats.pageOuts = _pageOuts;
+	stats.compressedHits = _compressedHits;
+	{
+		core::ScopedLock lock(_compressedLock);
+		stats.compressedChunks = (int)_compressedChunks.size();
+		stats.compressedBytes = _compressedBytes;
+	}
+	core::ScopedLock lock(_clockLock);
+	stats.chunks = (int)_clock.size();
+	stats.bytes = _memoryUsage;
+	return stats;
+}
+
+PagedVolume::ChunkShard& PagedVolume::chunkShard(const glm::ivec3& pos) const {
+	// don't use the hash of the chunk map here - otherwise all chunks of a shard would end up in the same buckets
+	const uint32_t h = ((uint32_t)pos.x * 73856093u) ^ ((uint32_t)pos.y * 19349663u) ^ ((uint32_t)pos.z * 83492791u);
+	return _shards[(h >> 16) & (ChunkShardCount - 1)];
+}
+
+void PagedVolume::addChunk(const ChunkPtr& chunk) const {
+	// the new chunk is charged before the room is made for it - but it's not yet part of the clock, the
+	// clock hand would otherwise evict it right away
+	attachMemoryUsage(chunk);
+	deleteOldestChunksIfNeeded();
+	core::ScopedLock lock(_clockLock);
+	_clock.push_back(chunk);
+}
+
+/**
+ * The resident chunk charges every storage switch to the memory usage of the volume from now on
+ */
+void PagedVolume::attachMemoryUsage(const ChunkPtr& chunk) const {
+	core::ScopedLock lock(chunk->_storageLock);
+	chunk->_memoryUsage = &_memoryUsage;
+	_memoryUsage += chunk->sizeInBytes();
+}
+
+/**
+ * An evicted chunk might still be used somewhere else - but it doesn't count into the budget anymore
+ */
+void PagedVolume::detachMemoryUsage(const ChunkPtr& chunk) const {
+	core::ScopedLock lock(chunk->_storageLock);
+	if (chunk->_memoryUsage == nullptr) {
+		return;
+	}
+	chunk->_memoryUsage = nullptr;
+	_memoryUsage -= chunk->sizeInBytes();
+}
+
+/**
+ * As we have added a chunk we may have exceeded our target chunk limit. Advance the clock hand until enough
+ * chunks are found that weren't accessed since the last round. If the compressed tier is enabled, the evicted
+ * chunks are compressed - otherwise the modified chunks are handed over to the pager in one batch.
+ */
+void PagedVolume::deleteOldestChunksIfNeeded() const {
+	core::DynamicArray<ChunkPtr> evicted;
+	core::DynamicArray<ChunkPtr> toCompress;
+	core::DynamicArray<CompressedChunkPtr> compressedChunks;
+	{
+		core::ScopedLock lock(_clockLock);
+		if (_memoryUsage < _memoryLimit) {
+			return;
+		}
+		core_trace_scoped(DeleteOldestChunks);
+		const uint64_t targetBytes = _memoryLimit - _evictionBatchBytes;
+		// every chunk gets its second chance - if we didn't find anything after two rounds all chunks are loading
+		size_t steps = 2u * _clock.size();
+		while (_memoryUsage > targetBytes && !_clock.empty() && steps-- > 0u) {
+			if (_clockHand >= _clock.size()) {
+				_clockHand = 0u;
+			}
+			const ChunkPtr& chunk = _clock[_clockHand];
+			if (chunk->_loading) {
+				++_clockHand;
+				continue;
+			}
+			if (chunk->_referenced.exchange(false)) {
+				++_clockHand;
+				continue;
+			}
+			ChunkShard& shard = chunkShard(chunk->chunkPos());
+			bool compress = false;
+			{
+				core::ScopedWriteLock writeLock(shard.lock);
+				shard.chunks.remove(chunk->chunkPos());
+				// The compressed chunk must be visible before the shard lock is released - otherwise another
+				// thread would page in the chunk again. If there is still a reference somewhere else, the chunk
+				// might still get modified and is paged out by its destructor.
+				if (_compressedMemoryLimit > 0u && *chunk.refCnt() == 1) {
+					const CompressedChunkPtr& compressed = core::make_shared<CompressedChunk>(chunk->chunkPos());
+					core::ScopedLock compressedLock(_compressedLock);
+					_compressedChunks.put(chunk->chunkPos(), compressed);
+					compressedChunks.push_back(compressed);
+					compress = true;
+				}
+			}
+			if (compress) {
+				toCompress.push_back(chunk);
+			} else {
+				evicted.push_back(chunk);
+			}
+			detachMemoryUsage(chunk);
+			// the last chunk takes the place of the evicted one - the clock hand will check it next
+			_clock[_clockHand] = _clock.back();
+			_clock.pop();
+		}
+	}
+	if (evicted.empty() && toCompress.empty()) {
+		return;
+	}
+	Log::debug("evicted %i chunks - reached %uKb", (int)(evicted.size() + toCompress.size()), (uint32_t)(_memoryLimit / 1024));
+	_evictions.increment((int)(evicted.size() + toCompress.size()));
+	for (const ChunkPtr& chunk : evicted) {
+		notifyEvicted(chunk->chunkPos());
+	}
+	for (const ChunkPtr& chunk : toCompress) {
+		notifyEvicted(chunk->chunkPos());
+	}
+
+	if (!toCompress.empty()) {
+		core_trace_scoped(CompressChunks);
+		for (size_t i = 0; i < toCompress.size(); ++i) {
+			const ChunkPtr& chunk = toCompress[i];
+			const CompressedChunkPtr& compressed = compressedChunks[i];
+			compressed->compress(*chunk.get());
+			compressed->_modified = chunk->_dataModified;
+			// the compressed chunk is responsible for the page out now
+			chunk->_dataModified = false;
+			core::ScopedLock compressedLock(_compressedLock);
+			compressed->_ready = true;
+			CompressedChunkPtr current;
+			if (_compressedChunks.get(compressed->chunkPos(), current) && current == compressed) {
+				compressed->_accounted = true;
+				_compressedBytes += compressed->sizeInBytes();
+				_compressedQueue.push_back(compressed);
+			}
+		}
+		deleteOldestCompressedChunksIfNeeded();
+	}
+
+	// Chunks that are still in use somewhere else are paged out by their destructor once the last
+	// reference is gone - otherwise we might lose modifications that are done after this point.
+	core::DynamicArray<Chunk*> dirty;
+	dirty.reserve(evicted.size());
+	for (const ChunkPtr& chunk : evicted) {
+		if (!chunk->_dataModified) {
+			continue;
+		}
+		_pageOuts.increment();
+		if (*chunk.refCnt() == 1) {
+			dirty.push_back(chunk.get());
+		}
+	}
+	if (!dirty.empty()) {
+		core_trace_scoped(PageOutChunks);
+		_pager->pageOutChunks(dirty.data(), (int)dirty.size());
+		for (Chunk* chunk : dirty) {
+			chunk->_dataModified = false;
+		}
+	}
+}
+
+void PagedVolume::removeCompressedChunk(const CompressedChunkPtr& compressed) const {
+	_compressedChunks.remove(compressed->chunkPos());
+	if (compressed->_accounted) {
+		compressed->_accounted = false;
+		_compressedBytes -= compressed->sizeInBytes();
+	}
+}
+
+/**
+ * Removes the chunks that were compressed first until the compressed tier fits into its memory limit again.
+ * Modified chunks are decompressed one last time to hand them over to the pager.
+ */
+void PagedVolume::deleteOldestCompressedChunksIfNeeded() const {
+	core::DynamicArray<CompressedChunkPtr> modified;
+	{
+		core::ScopedLock lock(_compressedLock);
+		while (_compressedHead < _compressedQueue.size()) {
+			if (_compressedBytes <= _compressedMemoryLimit && (int)_compressedChunks.size() < CompressedChunkCountLimit) {
+				break;
+			}
+			const CompressedChunkPtr compressed = _compressedQueue[_compressedHead];
+			_compressedQueue[_compressedHead++] = CompressedChunkPtr();
+			CompressedChunkPtr current;
+			if (!_compressedChunks.get(compressed->chunkPos(), current) || current != compressed) {
+				// was decompressed in the meantime
+				continue;
+			}
+			if (!compressed->_modified) {
+				removeCompressedChunk(compressed);
+				continue;
+			}
+			// keep the chunk visible until the pager is done - other threads will wait for it
+			compressed->_accounted = false;
+			_compressedBytes -= compressed->sizeInBytes();
+			compressed->_ready = false;
+			modified.push_back(compressed);
+		}
+		if (_compressedHead > 0u && _compressedHead * 2u >= _compressedQueue.size()) {
+			_compressedQueue.erase(0, _compressedHead);
+			_compressedHead = 0u;
+		}
+	}
+	writeBackCompressedChunks(modified);
+}
+
+void PagedVolume::writeBackCompressedChunks(const core::DynamicArray<CompressedChunkPtr>& compressed) const {
+	if (compressed.empty()) {
+		return;
+	}
+	core_trace_scoped(WriteBackCompressedChunks);
+	core::DynamicArray<ChunkPtr> chunks;
+	core::DynamicArray<Chunk*> dirty;
+	chunks.reserve(compressed.size());
+	dirty.reserve(compressed.size());
+	for (const CompressedChunkPtr& c : compressed) {
+		const ChunkPtr& chunk = core::make_shared<Chunk>(c->chunkPos(), _chunkSideLength, _pager);
+		if (!c->decompress(*chunk.get())) {
+			Log::error("Failed to decompress chunk at %i:%i:%i", c->chunkPos().x, c->chunkPos().y, c->chunkPos().z);
+			continue;
+		}
+		chunks.push_back(chunk);
+		dirty.push_back(chunk.get());
+	}
+	_pageOuts.increment((int)dirty.size());
+	_pager->pageOutChunks(dirty.data(), (int)dirty.size());
+
+	core::ScopedLock lock(_compressedLock);
+	for (const ChunkPtr& chunk : chunks) {
+		chunk->_dataModified = false;
+	}
+	for (const CompressedChunkPtr& c : compressed) {
+		c->_modified = false;
+		CompressedChunkPtr current;
+		if (_compressedChunks.get(c->chunkPos(), current) && current == c) {
+			removeCompressedChunk(c);
+		}
+		c->_ready = true;
+	}
+}
+
+/**
+ * @return @c true if the chunk was evicted before and could get restored from the compressed tier
+ */
+bool PagedVolume::decompressChunk(const ChunkPtr& chunk) const {
+	if (_compressedMemoryLimit == 0u) {
+		return false;
+	}
+	CompressedChunkPtr compressed;
+	{
+		core::ScopedLock lock(_compressedLock);
+		if (!_compressedChunks.get(chunk->chunkPos(), compressed)) {
+			return false;
+		}
+		removeCompressedChunk(compressed);
+	}
+	// the chunk is still compressed or written back by another thread
+	while (!compressed->_ready) {
+		std::this_thread::yield();
+	}
+	core_trace_scoped(DecompressChunk);
+	if (!compressed->decompress(*chunk.get())) {
+		const glm::ivec3& pos = chunk->chunkPos();
+		Log::error("Failed to decompress chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+		return false;
+	}
+	chunk->_dataModified = compressed->_modified;
+	compressed->release();
+	++_compressedHits;
+	return true;
 }
 
 /**
- * As we have added a chunk we may have exceeded our target chunk limit. Search through the array to
- * determine how many chunks we have, as well as finding the oldest timestamp. Note that this is potentially
- * wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
- * just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
- * the data in is probably more expensive.
+ * Chunks that are uniform (like air above the terrain) or only consist of a few different voxels are
+ * converted into a more compact storage after they were paged in.
  */
-void PagedVolume::deleteOldestChunkIfNeeded() const {
-	core_trace_scoped(DeleteOldestChunk);
-	ChunkMap::iterator oldestChunk = _chunks.end();
-	uint32_t oldestChunkTimestamp = _timestamper;
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const ChunkPtr& chunk = i->second;
-		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
-			oldestChunkTimestamp = chunk->_chunkLastAccessed;
-			oldestChunk = i;
+void PagedVolume::compactChunk(const ChunkPtr& chunk) const {
+	core_trace_scoped(CompactChunk);
+	ChunkShard& shard = chunkShard(chunk->chunkPos());
+	// nobody can get a new reference while we hold the write lock
+	core::ScopedWriteLock writeLock(shard.lock);
+	// one reference is in the chunk map, the other one is held by the caller of chunk() - any other
+	// reference means that another thread might access the voxels right now
+	if (*chunk.refCnt() > 2) {
+		return;
+	}
+	chunk->compact();
+}
+
+struct PagedVolume::PagingThread {
+	// the chunk this thread waits for - guarded by the paging wait lock of the volume
+	const Chunk* waitingFor = nullptr;
+};
+
+// A chunk that is paged in is owned by the thread that is filling it. The pager might access other chunks of
+// the volume while filling the chunk - the chunks of the own thread are returned while they are filled, for all
+// other chunks the thread waits until they are ready.
+thread_local PagedVolume::PagingThread PagedVolume::_pagingThread;
+
+void PagedVolume::finishLoading(const ChunkPtr& chunk) const {
+	chunk->_loadingThread = nullptr;
+	chunk->_loading = false;
+}
+
+void PagedVolume::waitForChunk(const ChunkPtr& chunk) const {
+	PagingThread* self = &_pagingThread;
+	{
+		core::ScopedLock lock(_pagingWaitLock);
+		if (!chunk->_loading) {
+			return;
 		}
+		// follow the threads that are waiting for each other - if this ends at our own thread, waiting would
+		// deadlock. Both pagers need a chunk of each other in this case - like a nested page in on one thread
+		// the chunk is returned before it was completely filled.
+		const PagingThread* owner = chunk->_loadingThread;
+		while (owner != nullptr) {
+			if (owner == self) {
+				if (chunk->_loadingThread != self) {
+					const glm::ivec3& pos = chunk->chunkPos();
+					Log::debug("Cyclic page in of chunk %i:%i:%i", pos.x, pos.y, pos.z);
+				}
+				return;
+			}
+			if (owner->waitingFor == nullptr) {
+				break;
+			}
+			owner = owner->waitingFor->_loadingThread;
+		}
+		self->waitingFor = chunk.get();
 	}
-	if (oldestChunk != _chunks.end()) {
-		Log::debug("delete oldest chunk - reached %u", _chunkCountLimit);
-		_chunks.erase(oldestChunk);
+	while (chunk->_loading) {
+		std::this_thread::yield();
 	}
+	core::ScopedLock lock(_pagingWaitLock);
+	self->waitingFor = nullptr;
 }
 
-PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+void PagedVolume::pageInChunk(const ChunkPtr& chunk) const {
 	core_trace_scoped(CreateNewChunk);
-	// The chunk was not found so we will create a new one.
-	glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	Log::debug("create new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
-	ChunkPtr chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
-	chunk->_chunkLastAccessed = ++_timestamper; // Important, as we may soon delete the oldest chunk
-
-	// Pass the chunk to the Pager to give it a chance to initialise it with any data
-	// From the coordinates of the chunk we deduce the coordinates of the contained voxels.
-	PagerContext pctx;
-	const glm::ivec3& mins = pos * static_cast<int32_t>(_chunkSideLength);
-	const glm::ivec3& maxs = mins + glm::ivec3(_chunkSideLength - 1);
-	pctx.region = Region(mins, maxs);
-	pctx.chunk = chunk;
-
-	// Page the data in
-	// We'll use this later to decide if data needs to be paged out again.
-	chunk->_dataModified = _pager->pageIn(pctx);
-	Log::debug("finished creating new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
+	const glm::ivec3& pos = chunk->chunkPos();
+	Log::debug("create new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
 
-	return chunk;
+	if (decompressChunk(chunk)) {
+		compactChunk(chunk);
+		finishLoading(chunk);
+		notifyPagedIn(chunk);
+		Log::debug("restored compressed chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+		return;
+	}
+
+	{
+		// Pass the chunk to the Pager to give it a chance to initialise it with any data
+		// From the coordinates of the chunk we deduce the coordinates of the contained voxels.
+		PagerContext pctx;
+		const glm::ivec3& mins = pos * static_cast<int32_t>(_chunkSideLength);
+		const glm::ivec3& maxs = mins + glm::ivec3(_chunkSideLength - 1);
+		pctx.region = Region(mins, maxs);
+		pctx.chunk = chunk;
+
+		// Page the data in
+		// We'll use this later to decide if data needs to be paged out again.
+		chunk->_dataModified = _pager->pageIn(pctx);
+	}
+	compactChunk(chunk);
+	finishLoading(chunk);
+	notifyPagedIn(chunk);
+	Log::debug("finished creating new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+}
+
+bool PagedVolume::hasChunk(const glm::ivec3& chunkPos) const {
+	ChunkShard& shard = chunkShard(chunkPos);
+	core::ScopedReadLock readLock(shard.lock);
+	return shard.chunks.hasKey(chunkPos);
+}
+
+bool PagedVolume::prefetchChunk(const glm::ivec3& chunkPos) const {
+	core_trace_scoped(PagedVolumePrefetchChunk);
+	ChunkShard& shard = chunkShard(chunkPos);
+	ChunkPtr chunk;
+	{
+		core::ScopedWriteLock writeLock(shard.lock);
+		if (shard.chunks.hasKey(chunkPos)) {
+			return false;
+		}
+		chunk = core::make_shared<Chunk>(chunkPos, _chunkSideLength, _pager);
+		chunk->_loading = true;
+		chunk->_loadingThread = &_pagingThread;
+		shard.chunks.put(chunkPos, chunk);
+	}
+	pageInChunk(chunk);
+	addChunk(chunk);
+	return true;
 }
 
 PagedVolume::ChunkPtr PagedVolume::chunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
 	core_trace_scoped(PagedVolumeChunk);
-	core::ScopedWriteLock chunkWriteLock(_volumeLock);
 	const glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	auto i = _chunks.find(pos);
-	if (i == _chunks.end()) {
-		const ChunkPtr& chunk = createNewChunk(chunkX, chunkY, chunkZ);
-		_chunks.put(pos, chunk);
-		const size_t chunkCount = _chunks.size();
-		if (chunkCount >= _chunkCountLimit) {
-			deleteOldestChunkIfNeeded();
-		}
-		return chunk;
-	}
-	const ChunkPtr& chunk = i->second;
-	chunk->_chunkLastAccessed = ++_timestamper;
+	ChunkShard& shard = chunkShard(pos);
+	ChunkPtr chunk;
+	{
+		core::ScopedReadLock readLock(shard.lock);
+		shard.chunks.get(pos, chunk);
+	}
+	if (!chunk) {
+		bool created = false;
+		{
+			core::ScopedWriteLock writeLock(shard.lock);
+			if (!shard.chunks.get(pos, chunk)) {
+				chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+				chunk->_loading = true;
+				chunk->_loadingThread = &_pagingThread;
+				shard.chunks.put(pos, chunk);
+				created = true;
+			}
+		}
+		if (created) {
+			++shard.misses;
+			pageInChunk(chunk);
+			addChunk(chunk);
+			return chunk;
+		}
+	}
+	++shard.hits;
+	// avoid the write if possible - the cache line is shared between all threads accessing the chunk
+	if (!chunk->_referenced) {
+		chunk->_referenced = true;
+	}
+	if (chunk->_loading) {
+		waitForChunk(chunk);
+	}
 	return chunk;
 }
 
@@ -10,9 +10,14 @@
 #include "core/GLM.h"
 #include "core/Assert.h"
 #include "core/concurrent/ReadWriteLock.h"
+#include "core/concurrent/ReadWriteSpinLock.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
 #include "core/SharedPtr.h"
+#include "core/Trace.h"
+#include <atomic>
 
 namespace voxel {
 
@@ -31,24 +36,88 @@ namespace voxel {
  */
 class PagedVolume: public core::NonCopyable {
 	friend class PagedVolumeWrapper;
+	// the chunk a paging thread waits for - see waitForChunk()
+	struct PagingThread;
+	static thread_local PagingThread _pagingThread;
 public:
 	/// The PagedVolume stores it data as a set of Chunk instances which can be loaded and unloaded as memory requirements dictate.
 	class Chunk;
 	/// The Pager class is responsible for the loading and unloading of Chunks, and can be subclassed by the user.
 	class Pager;
 
+	/**
+	 * @brief The way the voxels of a chunk are stored
+	 */
+	enum class ChunkStorage : uint8_t {
+		/** one voxel per position */
+		Dense,
+		/** all voxels are the same - nothing is allocated */
+		Uniform,
+		/** bit-packed indices into a small local palette */
+		Palette
+	};
+
 	class Chunk {
 		friend class PagedVolume;
 		friend class PagedVolumeWrapper;
 
 	public:
+		/** the max amount of different voxels for the palette storage */
+		static constexpr int MaxPaletteSize = 16;
+
+		/**
+		 * @note A new chunk is uniformly filled with air and doesn't allocate any voxel memory. It switches
+		 * to the dense storage on the first write of a different voxel.
+		 */
 		Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pager);
 		~Chunk();
 
 		bool setData(const Voxel* voxels, size_t sizeInBytes);
-		Voxel* data() const;
+		/**
+		 * @return The uncompressed voxels
+		 * @note Switches to the dense storage
+		 */
+		Voxel* data();
 		uint32_t dataSizeInBytes() const;
 		uint32_t voxels() const;
+		/**
+		 * @return The memory that is used by the chunk with its current storage
+		 */
+		uint32_t sizeInBytes() const;
+
+		ChunkStorage storage() const;
+		/**
+		 * @brief Switches to the dense storage - this is done automatically on the first write that
+		 * would change a uniform or palette chunk.
+		 */
+		void makeDense();
+		/**
+		 * @brief Converts a dense chunk into the uniform or palette storage if possible
+		 * @note The caller must make sure that no other thread accesses the chunk data at the same time
+		 * @return @c true if the storage was changed
+		 */
+		bool compact();
+
+		/**
+		 * @brief Fills the whole chunk with the given voxel without allocating any voxel memory
+		 */
+		void setUniform(const Voxel& voxel);
+		/**
+		 * @param palette The different voxels of the chunk - not more than @c MaxPaletteSize
+		 * @param indices The bit-packed palette indices in morton order - see @c paletteBits()
+		 */
+		bool setPalette(const Voxel* palette, int paletteSize, const uint8_t* indices, uint32_t indicesSizeInBytes);
+		const Voxel* palette() const;
+		int paletteSize() const;
+		const uint8_t* paletteIndices() const;
+		uint32_t paletteIndicesSizeInBytes() const;
+		/** @return The amount of bits that are used per palette index */
+		static int paletteBits(int paletteSize);
+		/** @return The amount of bytes that are needed to store the palette indices of the given amount of voxels */
+		static uint32_t paletteIndicesSizeInBytes(uint32_t voxels, int paletteSize);
+
+		/** @return The voxel at the given morton index */
+		const Voxel& voxelByIndex(uint32_t index) const;
 
 		const Voxel& voxel(uint32_t x, uint32_t y, uint32_t z) const;
 		const Voxel& voxel(const glm::i16vec3& pos) const;
@@ -62,12 +131,41 @@ public:
 		int16_t sideLength() const;
 
 	private:
-		// This is updated by the PagedVolume and used to discard the least recently used chunks.
-		uint32_t _chunkLastAccessed = 0u;
+		// This is set by the PagedVolume on every access and cleared by the clock hand that is used to
+		// discard the least recently used chunks.
+		core::AtomicBool _referenced { true };
+		// Set as long as the pager is filling the chunk. The chunk is already visible for other threads
+		// at this point - but they have to wait until it's ready.
+		core::AtomicBool _loading { false };
+		// The thread that is filling the chunk while @c _loading is set
+		core::AtomicPtr<PagingThread> _loadingThread { nullptr };
 
 		static uint32_t calculateSizeInBytes(uint32_t sideLength);
+		/**
+		 * @brief Charges the storage switch to the memory usage of the volume
+		 * @param before The size in bytes before the storage was changed
+		 * @note Must be called with the storage lock being held
+		 */
+		void updateMemoryUsage(uint32_t before);
 
 		Voxel* _data = nullptr;
+		// The bit-packed palette indices of the palette storage. This is kept until the chunk is deleted
+		// when switching to the dense storage, as another thread might still read from them.
+		uint8_t* _paletteIndices = nullptr;
+		uint32_t _paletteIndicesSize = 0u;
+		Voxel _palette[MaxPaletteSize];
+		uint8_t _paletteSize = 0u;
+		uint8_t _paletteBits = 0u;
+		// The voxel of the uniform storage
+		Voxel _uniformVoxel;
+		// The voxel access isn't locked - the data of a new storage is published by a release store to this
+		// member. Readers have to load it with acquire semantics before they touch the data.
+		std::atomic<ChunkStorage> _storage { ChunkStorage::Uniform };
+		// Only needed to switch the storage - the voxel access itself isn't locked
+		core_trace_mutex(core::Lock, _storageLock, "PagedVolumeChunk");
+		// The memory usage of the volume the chunk is resident in - guarded by the storage lock. This is
+		// @c nullptr as long as the chunk isn't part of the volume memory budget.
+		std::atomic<uint64_t>* _memoryUsage = nullptr;
 		uint16_t _sideLength = 0u;
 
 		// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
@@ -107,10 +205,73 @@ public:
 		 */
 		virtual bool pageIn(PagerContext& ctx) = 0;
 		virtual void pageOut(Chunk* chunk) = 0;
+		/**
+		 * @brief Called with all modified chunks that were evicted at once
+		 * @note The default implementation calls @c pageOut() for every chunk.
+		 */
+		virtual void pageOutChunks(Chunk** chunks, int amount) {
+			for (int i = 0; i < amount; ++i) {
+				pageOut(chunks[i]);
+			}
+		}
 	};
 
 	typedef core::SharedPtr<Pager> PagerPtr;
 
+	/**
+	 * @brief Gets notified about voxels that were modified with setVoxel(), setVoxels() or
+	 * Sampler::setVoxel(). Filling a chunk in the pager doesn't notify the listeners.
+	 *
+	 * setVoxels() notifies once per call. The Sampler notifies once per chunk it modified - when it
+	 * modifies a voxel of another chunk, on Sampler::flushModified() or when it's destroyed. setVoxel()
+	 * notifies once per voxel - unless it's called while a ModificationBatch is active.
+	 *
+	 * The listener is called on the thread that modified the voxels.
+	 */
+	class Listener {
+	public:
+		virtual ~Listener() {}
+		/**
+		 * @param region The region (in world coordinates) that contains all modified voxels
+		 */
+		virtual void onVoxelsModified(const Region& region) = 0;
+		/**
+		 * @brief Called on the paging thread once the chunk is resident - either filled by the pager or
+		 * restored from the compressed tier.
+		 */
+		virtual void onChunkPagedIn(const ChunkPtr& chunk) {
+		}
+		/**
+		 * @brief Called after the chunk at the given chunk position was removed from the resident chunks
+		 */
+		virtual void onChunkEvicted(const glm::ivec3& chunkPos) {
+		}
+	};
+
+	/**
+	 * @brief Collects the voxels that are modified with setVoxel() on the calling thread while the batch
+	 * exists. The listeners are notified once per modified chunk when the batch is destroyed.
+	 * A batch for a volume that already has an active batch on this thread is merged into the outer one.
+	 */
+	class ModificationBatch {
+	private:
+		typedef core::Map<glm::ivec3, Region, 64, glm::hash<glm::ivec3>> Regions;
+		PagedVolume* _volume;
+		ModificationBatch* _previous;
+		bool _active;
+		Regions _regions;
+	public:
+		ModificationBatch(PagedVolume* volume);
+		~ModificationBatch();
+
+		void add(const glm::ivec3& chunkPos, int32_t x, int32_t y, int32_t z);
+		/**
+		 * @brief Notifies the listeners about the voxels that were modified so far
+		 */
+		void flush();
+		PagedVolume* volume() const;
+	};
+
 	class Sampler {
 	public:
 		Sampler(const PagedVolume* volume);
@@ -135,8 +296,15 @@ public:
 		virtual void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
 		/**
 		 * @brief Set the given voxel to the current position in the sampler
+		 * @note The listeners of the volume are notified once the sampler leaves the chunk
+		 * @sa flushModified()
 		 */
 		bool setVoxel(const Voxel& voxel);
+		/**
+		 * @brief Notifies the listeners of the volume about the voxels that were modified with setVoxel()
+		 * in the current chunk
+		 */
+		void flushModified();
 		glm::ivec3 position() const;
 
 		/**
@@ -200,6 +368,8 @@ public:
 
 		//Other current position information
 		Voxel* _currentVoxel = nullptr;
+		// Only a dense chunk allows to move the voxel pointer - otherwise each position change goes through the chunk
+		bool _denseChunk = false;
 		ChunkPtr _currentChunk;
 		mutable ChunkPtr _cachedChunk;
 
@@ -212,11 +382,47 @@ public:
 		int32_t _lastZChunk = 0;
 
 		const uint16_t _chunkSideLengthMinusOne;
+
+		// the voxels of @c _modifiedChunk that were modified but not yet announced to the listeners
+		Region _modifiedRegion = Region::InvalidRegion;
+		glm::ivec3 _modifiedChunk { 0 };
+
+		void modified();
 	};
 
 public:
-	/** @brief Constructor for creating a fixed size volume. */
-	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32);
+	/**
+	 * @brief Counters for the chunk cache
+	 * @sa statistics()
+	 */
+	struct Statistics {
+		/** chunk lookups that found a resident chunk */
+		int hits = 0;
+		/** chunk lookups that didn't find a resident chunk */
+		int misses = 0;
+		/** chunks that were removed because the memory limit was reached */
+		int evictions = 0;
+		/** evicted chunks that were modified and thus were handed over to the pager */
+		int pageOuts = 0;
+		/** currently resident chunks */
+		int chunks = 0;
+		/** memory used by the resident chunks with their current storage */
+		uint64_t bytes = 0u;
+		/** misses that were satisfied by decompressing an evicted chunk instead of paging it in */
+		int compressedHits = 0;
+		/** evicted chunks that are kept compressed in memory */
+		int compressedChunks = 0;
+		/** memory used by the compressed chunks */
+		uint64_t compressedBytes = 0u;
+	};
+
+	/**
+	 * @brief Constructor for creating a fixed size volume.
+	 * @param compressedMemoryUsageInBytes The memory that is used to keep evicted chunks in a compressed form. If this is
+	 * @c 0 the evicted chunks are handed over to the pager directly.
+	 */
+	PagedVolume(Pager* pager, uint64_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32,
+			uint64_t compressedMemoryUsageInBytes = 0u);
 	~PagedVolume();
 
 	/** @brief Gets a voxel at the position given by <tt>x,y,z</tt> coordinates */
@@ -237,8 +443,27 @@ public:
 	/** @brief Removes all voxels from memory */
 	void flushAll();
 
+	/**
+	 * @note The listeners are not guarded by a lock - register them before the volume is modified
+	 * by several threads.
+	 */
+	void addListener(Listener* listener);
+	void removeListener(Listener* listener);
+
 	ChunkPtr chunk(const glm::ivec3& pos) const;
 
+	/**
+	 * @brief Pages in the chunk at the given chunk position on the calling thread if it isn't resident yet.
+	 * Other threads that request the chunk in the meantime wait for it instead of paging it in a second time.
+	 * @return @c false if the chunk is already resident or currently paged in by another thread
+	 */
+	bool prefetchChunk(const glm::ivec3& chunkPos) const;
+
+	/**
+	 * @return @c true if the chunk at the given chunk position is resident or currently paged in
+	 */
+	bool hasChunk(const glm::ivec3& chunkPos) const;
+
 	glm::ivec3 chunkPos(int x, int y, int z) const;
 
 	inline glm::ivec3 chunkPos(const glm::ivec3& worldPos) const {
@@ -249,6 +474,8 @@ public:
 		return _chunkSideLength;
 	}
 
+	Statistics statistics() const;
+
 protected:
 	/// Copy constructor
 	PagedVolume(const PagedVolume& rhs);
@@ -257,16 +484,111 @@ protected:
 	PagedVolume& operator=(const PagedVolume& rhs);
 
 private:
+	/**
+	 * The run-length encoded voxels of an evicted chunk. This is the second in-memory tier before the
+	 * chunk is handed over to the pager.
+	 */
+	class CompressedChunk {
+	public:
+		CompressedChunk(const glm::ivec3& pos);
+		~CompressedChunk();
+
+		void compress(const Chunk& chunk);
+		bool decompress(Chunk& chunk) const;
+		/** @brief Frees the compressed data */
+		void release();
+
+		uint32_t sizeInBytes() const;
+		const glm::ivec3& chunkPos() const;
+
+		// Not set as long as the data is compressed or written back to the pager - the chunk
+		// might already be requested again by another thread in the meantime.
+		core::AtomicBool _ready { false };
+		// The chunk was modified and wasn't written back to the pager yet
+		core::AtomicBool _modified { false };
+		// The size is part of the memory that is used by the compressed tier
+		bool _accounted = false;
+
+	private:
+		glm::ivec3 _chunkSpacePosition;
+		uint8_t* _data = nullptr;
+		uint32_t _sizeInBytes = 0u;
+	};
+	typedef core::SharedPtr<CompressedChunk> CompressedChunkPtr;
+
 	ChunkPtr chunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	ChunkPtr createNewChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	void deleteOldestChunkIfNeeded() const;
+	void pageInChunk(const ChunkPtr& chunk) const;
+	void addChunk(const ChunkPtr& chunk) const;
+	void deleteOldestChunksIfNeeded() const;
+	bool decompressChunk(const ChunkPtr& chunk) const;
+	void compactChunk(const ChunkPtr& chunk) const;
+	void removeCompressedChunk(const CompressedChunkPtr& compressed) const;
+	void deleteOldestCompressedChunksIfNeeded() const;
+	void writeBackCompressedChunks(const core::DynamicArray<CompressedChunkPtr>& compressed) const;
+	void waitForChunk(const ChunkPtr& chunk) const;
+	void finishLoading(const ChunkPtr& chunk) const;
+	void attachMemoryUsage(const ChunkPtr& chunk) const;
+	void detachMemoryUsage(const ChunkPtr& chunk) const;
+	void notifyModified(const Region& region) const;
+	void notifyPagedIn(const ChunkPtr& chunk) const;
+	void notifyEvicted(const glm::ivec3& chunkPos) const;
+
+	/**
+	 * The resident chunks are charged with the memory of their current storage - a uniform chunk only
+	 * costs its management data while a dense chunk costs every voxel.
+	 */
+	uint64_t _memoryLimit = 0u;
+	/**
+	 * The memory that is freed at once if the limit is reached. This allows the pager to write several
+	 * modified chunks in one go.
+	 */
+	uint64_t _evictionBatchBytes = 0u;
+	mutable std::atomic<uint64_t> _memoryUsage { 0u };
+
+	/**
+	 * All resident chunks. The clock hand cycles over them to find the chunks to evict: chunks that
+	 * were accessed since the hand passed them the last time get a second chance. This is a cheap
+	 * approximation of a lru list that doesn't need any lock for the chunk access.
+	 */
+	mutable core::DynamicArray<ChunkPtr> _clock core_thread_guarded_by(_clockLock);
+	mutable size_t _clockHand core_thread_guarded_by(_clockLock) = 0u;
+	core_trace_mutex(core::Lock, _clockLock, "PagedVolumeClock");
+
+	mutable core::AtomicInt _evictions { 0 };
+	mutable core::AtomicInt _pageOuts { 0 };
+	mutable core::AtomicInt _compressedHits { 0 };
 
-	mutable int32_t _timestamper = 0;
+	typedef core::Map<glm::ivec3, CompressedChunkPtr, 64, glm::hash<glm::ivec3>> CompressedChunkMap;
+	static constexpr int CompressedChunkCountLimit = 16384;
 
-	uint32_t _chunkCountLimit = 0u;
+	uint64_t _compressedMemoryLimit = 0u;
+	mutable uint64_t _compressedBytes core_thread_guarded_by(_compressedLock) = 0u;
+	mutable CompressedChunkMap _compressedChunks core_thread_guarded_by(_compressedLock);
+	/**
+	 * The compressed chunks in the order they were evicted - entries that were decompressed in the meantime
+	 * are skipped. The chunks before @c _compressedHead were already removed.
+	 */
+	mutable core::DynamicArray<CompressedChunkPtr> _compressedQueue core_thread_guarded_by(_compressedLock);
+	mutable size_t _compressedHead core_thread_guarded_by(_compressedLock) = 0u;
+	core_trace_mutex(core::Lock, _compressedLock, "PagedVolumeCompressed");
 
 	typedef core::Map<glm::ivec3, ChunkPtr, 64, glm::hash<glm::ivec3>> ChunkMap;
-	mutable ChunkMap _chunks core_thread_guarded_by(_volumeLock);
+
+	/**
+	 * The chunk directory is split into shards that are locked independently. Looking up an already
+	 * resident chunk only needs the shared lock of its shard, only creating and deleting a chunk needs
+	 * the exclusive lock.
+	 */
+	struct ChunkShard {
+		ChunkMap chunks core_thread_guarded_by(lock);
+		core::ReadWriteSpinLock lock;
+		core::AtomicInt hits { 0 };
+		core::AtomicInt misses { 0 };
+	};
+	static constexpr int ChunkShardCount = 16;
+	mutable ChunkShard _shards[ChunkShardCount];
+
+	ChunkShard& chunkShard(const glm::ivec3& pos) const;
 
 	// The size of the chunks
 	uint16_t _chunkSideLength;
@@ -274,12 +596,17 @@ private:
 	int32_t _chunkMask;
 
 	Pager* _pager = nullptr;
+	core::DynamicArray<Listener*> _listeners;
+	// guards the waiting chunks of the paging threads
+	core_trace_mutex(core::Lock, _pagingWaitLock, "PagedVolumePagingWait");
 
 	Region _region;
-
-	mutable core::ReadWriteLock _volumeLock{"pagedvolume"};
 };
 
+inline PagedVolume* PagedVolume::ModificationBatch::volume() const {
+	return _volume;
+}
+
 inline const Voxel& PagedVolume::Sampler::voxel() const {
 	return *_currentVoxel;
 }
@@ -314,12 +641,12 @@ static const int32_t deltaZ[256] = { 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 22
 		14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 112348, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28,
 		4, 220, 4, 28, 4 };
 
-#define CAN_GO_NEG_X(val) ((val) > 0)
-#define CAN_GO_POS_X(val)  ((val) < this->_chunkSideLengthMinusOne)
-#define CAN_GO_NEG_Y(val) ((val) > 0)
-#define CAN_GO_POS_Y(val)  ((val) < this->_chunkSideLengthMinusOne)
-#define CAN_GO_NEG_Z(val) ((val) > 0)
-#define CAN_GO_POS_Z(val)  ((val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_X(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_X(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_Y(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_Y(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_Z(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_Z(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
 
 #define NEG_X_DELTA (-(deltaX[this->_xPosInChunk-1]))
 #define POS_X_DELTA (deltaX[this->_xPosInChunk])
@@ -19,10 +19,9 @@ PagedVolume::Chunk::Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pag
 	_sideLength = sideLength;
 	_sideLengthPower = math::logBase2(sideLength);
 
-	// Allocate the data
-	const uint32_t uNoOfVoxels = _sideLength * _sideLength * _sideLength;
-	_data = (Voxel*)core_malloc(uNoOfVoxels * sizeof(Voxel));
-	core_memset(_data, 0, uNoOfVoxels * sizeof(Voxel));
+	// The data is allocated on the first write of a different voxel
+	_uniformVoxel = Voxel();
+	_storage = ChunkStorage::Uniform;
 }
 
 PagedVolume::Chunk::~Chunk() {
@@ -32,25 +31,241 @@ PagedVolume::Chunk::~Chunk() {
 
 	core_free(_data);
 	_data = nullptr;
+	core_free(_paletteIndices);
+	_paletteIndices = nullptr;
 }
 
 bool PagedVolume::Chunk::setData(const Voxel* voxels, size_t sizeInBytes) {
 	if (sizeInBytes != dataSizeInBytes()) {
 		return false;
 	}
+	makeDense();
 	_dataModified = true;
 	core_memcpy((uint8_t*)_data, (const uint8_t*)voxels, sizeInBytes);
 	return true;
 }
 
-Voxel* PagedVolume::Chunk::data() const {
+Voxel* PagedVolume::Chunk::data() {
+	makeDense();
 	return _data;
 }
 
+PagedVolume::ChunkStorage PagedVolume::Chunk::storage() const {
+	return _storage.load(std::memory_order_acquire);
+}
+
+void PagedVolume::Chunk::makeDense() {
+	if (_storage == ChunkStorage::Dense) {
+		return;
+	}
+	core::ScopedLock lock(_storageLock);
+	if (_storage == ChunkStorage::Dense) {
+		return;
+	}
+	const uint32_t before = sizeInBytes();
+	const uint32_t amount = voxels();
+	Voxel* data = (Voxel*)core_malloc(amount * sizeof(Voxel));
+	if (_storage == ChunkStorage::Uniform) {
+		for (uint32_t i = 0u; i < amount; ++i) {
+			data[i] = _uniformVoxel;
+		}
+	} else {
+		for (uint32_t i = 0u; i < amount; ++i) {
+			data[i] = voxelByIndex(i);
+		}
+	}
+	core_free(_data);
+	_data = data;
+	// other threads must not see the new storage type before the data is there
+	_storage.store(ChunkStorage::Dense, std::memory_order_release);
+	updateMemoryUsage(before);
+}
+
+bool PagedVolume::Chunk::compact() {
+	core::ScopedLock lock(_storageLock);
+	if (_storage != ChunkStorage::Dense) {
+		return false;
+	}
+	const uint32_t before = sizeInBytes();
+	const uint32_t amount = voxels();
+	Voxel palette[MaxPaletteSize];
+	int size = 0;
+	int last = 0;
+	palette[size++] = _data[0];
+	for (uint32_t i = 1u; i < amount; ++i) {
+		if (_data[i].isIdentical(palette[last])) {
+			continue;
+		}
+		last = -1;
+		for (int j = 0; j < size; ++j) {
+			if (_data[i].isIdentical(palette[j])) {
+				last = j;
+				break;
+			}
+		}
+		if (last == -1) {
+			if (size == MaxPaletteSize) {
+				return false;
+			}
+			last = size;
+			palette[size++] = _data[i];
+		}
+	}
+
+	core_free(_paletteIndices);
+	_paletteIndices = nullptr;
+	_paletteIndicesSize = 0u;
+	if (size == 1) {
+		_uniformVoxel = palette[0];
+		_storage = ChunkStorage::Uniform;
+		core_free(_data);
+		_data = nullptr;
+		updateMemoryUsage(before);
+		return true;
+	}
+
+	const int bits = paletteBits(size);
+	_paletteIndicesSize = paletteIndicesSizeInBytes(amount, size);
+	_paletteIndices = (uint8_t*)core_malloc(_paletteIndicesSize);
+	core_memset(_paletteIndices, 0, _paletteIndicesSize);
+	last = 0;
+	for (uint32_t i = 0u; i < amount; ++i) {
+		if (!_data[i].isIdentical(palette[last])) {
+			for (int j = 0; j < size; ++j) {
+				if (_data[i].isIdentical(palette[j])) {
+					last = j;
+					break;
+				}
+			}
+		}
+		const uint32_t bitIndex = i * bits;
+		_paletteIndices[bitIndex >> 3] |= (uint8_t)(last << (bitIndex & 7));
+	}
+	for (int i = 0; i < size; ++i) {
+		_palette[i] = palette[i];
+	}
+	_paletteSize = (uint8_t)size;
+	_paletteBits = (uint8_t)bits;
+	_storage = ChunkStorage::Palette;
+	core_free(_data);
+	_data = nullptr;
+	updateMemoryUsage(before);
+	return true;
+}
+
+void PagedVolume::Chunk::setUniform(const Voxel& voxel) {
+	core::ScopedLock lock(_storageLock);
+	const uint32_t before = sizeInBytes();
+	_uniformVoxel = voxel;
+	_storage = ChunkStorage::Uniform;
+	core_free(_data);
+	_data = nullptr;
+	updateMemoryUsage(before);
+	_dataModified = true;
+}
+
+bool PagedVolume::Chunk::setPalette(const Voxel* palette, int paletteSize, const uint8_t* indices, uint32_t indicesSizeInBytes) {
+	if (paletteSize <= 0 || paletteSize > MaxPaletteSize) {
+		return false;
+	}
+	if (indicesSizeInBytes != paletteIndicesSizeInBytes(voxels(), paletteSize)) {
+		return false;
+	}
+	const int bits = paletteBits(paletteSize);
+	const uint8_t mask = (uint8_t)((1 << bits) - 1);
+	for (uint32_t i = 0u; i < indicesSizeInBytes * 8u; i += bits) {
+		if (((indices[i >> 3] >> (i & 7)) & mask) >= paletteSize) {
+			return false;
+		}
+	}
+	core::ScopedLock lock(_storageLock);
+	const uint32_t before = sizeInBytes();
+	core_free(_paletteIndices);
+	_paletteIndices = (uint8_t*)core_malloc(indicesSizeInBytes);
+	core_memcpy(_paletteIndices, indices, indicesSizeInBytes);
+	_paletteIndicesSize = indicesSizeInBytes;
+	for (int i = 0; i < paletteSize; ++i) {
+		_palette[i] = palette[i];
+	}
+	_paletteSize = (uint8_t)paletteSize;
+	_paletteBits = (uint8_t)bits;
+	_storage = ChunkStorage::Palette;
+	core_free(_data);
+	_data = nullptr;
+	updateMemoryUsage(before);
+	_dataModified = true;
+	return true;
+}
+
+const Voxel* PagedVolume::Chunk::palette() const {
+	return _palette;
+}
+
+int PagedVolume::Chunk::paletteSize() const {
+	return _paletteSize;
+}
+
+const uint8_t* PagedVolume::Chunk::paletteIndices() const {
+	return _paletteIndices;
+}
+
+uint32_t PagedVolume::Chunk::paletteIndicesSizeInBytes() const {
+	return _paletteIndicesSize;
+}
+
+int PagedVolume::Chunk::paletteBits(int paletteSize) {
+	// only use powers of two - an index never spans two bytes
+	if (paletteSize <= 2) {
+		return 1;
+	}
+	if (paletteSize <= 4) {
+		return 2;
+	}
+	return 4;
+}
+
+uint32_t PagedVolume::Chunk::paletteIndicesSizeInBytes(uint32_t voxels, int paletteSize) {
+	return (voxels * paletteBits(paletteSize) + 7u) / 8u;
+}
+
+const Voxel& PagedVolume::Chunk::voxelByIndex(uint32_t index) const {
+	// pairs with the release store of the writer that switches the storage
+	const ChunkStorage storage = _storage.load(std::memory_order_acquire);
+	if (storage == ChunkStorage::Dense) {
+		return _data[index];
+	}
+	if (storage == ChunkStorage::Uniform) {
+		return _uniformVoxel;
+	}
+	const uint32_t bitIndex = index * _paletteBits;
+	const uint8_t mask = (uint8_t)((1 << _paletteBits) - 1);
+	return _palette[(_paletteIndices[bitIndex >> 3] >> (bitIndex & 7)) & mask];
+}
+
 uint32_t PagedVolume::Chunk::dataSizeInBytes() const {
 	return voxels() * sizeof(Voxel);
 }
 
+uint32_t PagedVolume::Chunk::sizeInBytes() const {
+	uint32_t sizeInBytes = (uint32_t)sizeof(Chunk) + _paletteIndicesSize;
+	if (_data != nullptr) {
+		sizeInBytes += dataSizeInBytes();
+	}
+	return sizeInBytes;
+}
+
+void PagedVolume::Chunk::updateMemoryUsage(uint32_t before) {
+	if (_memoryUsage == nullptr) {
+		return;
+	}
+	const uint32_t after = sizeInBytes();
+	if (after >= before) {
+		*_memoryUsage += after - before;
+	} else {
+		*_memoryUsage -= before - after;
+	}
+}
+
 uint32_t PagedVolume::Chunk::voxels() const {
 	return _sideLength * _sideLength * _sideLength;
 }
@@ -61,10 +276,9 @@ const Voxel& PagedVolume::Chunk::voxel(uint32_t x, uint32_t y, uint32_t z) const
 	core_assert_msg(x < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", x, _sideLength);
 	core_assert_msg(y < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", y, _sideLength);
 	core_assert_msg(z < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", z, _sideLength);
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[x] | morton256_y[y] | morton256_z[z];
-	return _data[index];
+	return voxelByIndex(index);
 }
 
 const Voxel& PagedVolume::Chunk::voxel(const glm::i16vec3& pos) const {
@@ -77,9 +291,15 @@ void PagedVolume::Chunk::setVoxel(uint32_t x, uint32_t y, uint32_t z, const Voxe
 	core_assert_msg(x < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(y < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(z < _sideLength, "Supplied position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[x] | morton256_y[y] | morton256_z[z];
+	if (_storage != ChunkStorage::Dense) {
+		if (voxelByIndex(index).isIdentical(value)) {
+			_dataModified = true;
+			return;
+		}
+		makeDense();
+	}
 	_data[index] = value;
 	_dataModified = true;
 }
@@ -91,14 +311,27 @@ void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t z, const Voxel* values,
 void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t y, uint32_t z, const Voxel* values, int amount) {
 	// This code is not usually expected to be called by the user, with the exception of when implementing paging
 	// of uncompressed data. It's a performance critical code path
-	core_assert_msg(amount <= _sideLength, "Supplied amount exceeds chunk boundaries");
+	core_assert_msg(y + amount <= _sideLength, "Supplied amount exceeds chunk boundaries");
 	core_assert_msg(x < _sideLength, "Supplied x position is outside of the chunk");
 	core_assert_msg(y < _sideLength, "Supplied y position is outside of the chunk");
 	core_assert_msg(z < _sideLength, "Supplied z position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
-	for (int i = y; i < amount; ++i) {
-		const uint32_t index = morton256_x[x] | morton256_y[i] | morton256_z[z];
+	if (_storage != ChunkStorage::Dense) {
+		for (int i = 0; i < amount; ++i) {
+			const uint32_t index = morton256_x[x] | morton256_y[y + i] | morton256_z[z];
+			if (!voxelByIndex(index).isIdentical(values[i])) {
+				makeDense();
+				break;
+			}
+		}
+		if (_storage != ChunkStorage::Dense) {
+			_dataModified = true;
+			return;
+		}
+	}
+
+	for (int i = 0; i < amount; ++i) {
+		const uint32_t index = morton256_x[x] | morton256_y[y + i] | morton256_z[z];
 		_data[index] = values[i];
 	}
 	_dataModified = true;
@@ -0,0 +1,129 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+
+namespace voxel {
+
+namespace {
+
+/**
+ * A run of equal voxels in the (morton ordered) chunk data
+ */
+struct VoxelRun {
+	uint16_t length;
+	Voxel voxel;
+};
+static_assert(sizeof(VoxelRun) == 4, "Unexpected padding in the voxel run");
+
+}
+
+PagedVolume::CompressedChunk::CompressedChunk(const glm::ivec3& pos) :
+		_chunkSpacePosition(pos) {
+}
+
+PagedVolume::CompressedChunk::~CompressedChunk() {
+	release();
+}
+
+void PagedVolume::CompressedChunk::release() {
+	core_free(_data);
+	_data = nullptr;
+	_sizeInBytes = 0u;
+}
+
+void PagedVolume::CompressedChunk::compress(const Chunk& chunk) {
+	release();
+	const uint32_t amount = chunk.voxels();
+	if (amount == 0u) {
+		return;
+	}
+
+	if (chunk.storage() == ChunkStorage::Uniform) {
+		const uint32_t runs = (amount + 0xFFFEu) / 0xFFFFu;
+		_sizeInBytes = runs * (uint32_t)sizeof(VoxelRun);
+		VoxelRun* out = (VoxelRun*)core_malloc(_sizeInBytes);
+		_data = (uint8_t*)out;
+		uint32_t left = amount;
+		for (uint32_t i = 0u; i < runs; ++i, ++out) {
+			out->length = (uint16_t)core_min(left, 0xFFFFu);
+			out->voxel = chunk.voxelByIndex(0);
+			left -= out->length;
+		}
+		return;
+	}
+
+	// count the runs first to allocate the exact amount of memory
+	uint32_t runs = 1u;
+	uint32_t length = 1u;
+	for (uint32_t i = 1u; i < amount; ++i) {
+		if (length < 0xFFFFu && chunk.voxelByIndex(i).isIdentical(chunk.voxelByIndex(i - 1))) {
+			++length;
+			continue;
+		}
+		++runs;
+		length = 1u;
+	}
+
+	_sizeInBytes = runs * (uint32_t)sizeof(VoxelRun);
+	VoxelRun* out = (VoxelRun*)core_malloc(_sizeInBytes);
+	_data = (uint8_t*)out;
+	out->length = 1u;
+	out->voxel = chunk.voxelByIndex(0);
+	for (uint32_t i = 1u; i < amount; ++i) {
+		const Voxel& voxel = chunk.voxelByIndex(i);
+		if (out->length < 0xFFFFu && voxel.isIdentical(out->voxel)) {
+			++out->length;
+			continue;
+		}
+		++out;
+		out->length = 1u;
+		out->voxel = voxel;
+	}
+}
+
+bool PagedVolume::CompressedChunk::decompress(Chunk& chunk) const {
+	core_assert_msg(chunk.chunkPos() == _chunkSpacePosition, "Chunk position doesn't match");
+	const uint32_t amount = chunk.voxels();
+	const VoxelRun* runs = (const VoxelRun*)_data;
+	const uint32_t runCount = _sizeInBytes / (uint32_t)sizeof(VoxelRun);
+	if (runCount == 0u) {
+		return false;
+	}
+
+	// don't allocate the voxel memory if all runs are the same
+	uint32_t uniform = runs[0].length;
+	for (uint32_t i = 1u; i < runCount && runs[i].voxel.isIdentical(runs[0].voxel); ++i) {
+		uniform += runs[i].length;
+	}
+	if (uniform == amount) {
+		chunk.setUniform(runs[0].voxel);
+		return true;
+	}
+
+	Voxel* voxels = chunk.data();
+	uint32_t n = 0u;
+	for (uint32_t i = 0u; i < runCount; ++i) {
+		const VoxelRun& run = runs[i];
+		if (n + run.length > amount) {
+			return false;
+		}
+		for (uint32_t j = 0u; j < run.length; ++j) {
+			voxels[n++] = run.voxel;
+		}
+	}
+	return n == amount;
+}
+
+uint32_t PagedVolume::CompressedChunk::sizeInBytes() const {
+	return _sizeInBytes;
+}
+
+const glm::ivec3& PagedVolume::CompressedChunk::chunkPos() const {
+	return _chunkSpacePosition;
+}
+
+}
@@ -9,12 +9,12 @@
 
 namespace voxel {
 
-#define CAN_GO_NEG_X(val) ((val) > 0)
-#define CAN_GO_POS_X(val) ((val) < this->_chunkSideLengthMinusOne)
-#define CAN_GO_NEG_Y(val) ((val) > 0)
-#define CAN_GO_POS_Y(val) ((val) < this->_chunkSideLengthMinusOne)
-#define CAN_GO_NEG_Z(val) ((val) > 0)
-#define CAN_GO_POS_Z(val) ((val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_X(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_X(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_Y(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_Y(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
+#define CAN_GO_NEG_Z(val) (this->_denseChunk && (val) > 0)
+#define CAN_GO_POS_Z(val) (this->_denseChunk && (val) < this->_chunkSideLengthMinusOne)
 
 #define NEG_X_DELTA (-(deltaX[this->_xPosInChunk-1]))
 #define POS_X_DELTA (deltaX[this->_xPosInChunk])
@@ -32,6 +32,30 @@ PagedVolume::Sampler::Sampler(const PagedVolume& volume) :
 }
 
 PagedVolume::Sampler::~Sampler() {
+	flushModified();
+}
+
+void PagedVolume::Sampler::flushModified() {
+	if (!_modifiedRegion.isValid()) {
+		return;
+	}
+	const Region region = _modifiedRegion;
+	_modifiedRegion = Region::InvalidRegion;
+	_volume->notifyModified(region);
+}
+
+void PagedVolume::Sampler::modified() {
+	const glm::ivec3& pos = position();
+	const glm::ivec3& chunkPos = _currentChunk->chunkPos();
+	if (_modifiedRegion.isValid()) {
+		if (_modifiedChunk == chunkPos) {
+			_modifiedRegion.accumulate(pos);
+			return;
+		}
+		flushModified();
+	}
+	_modifiedChunk = chunkPos;
+	_modifiedRegion = Region(pos, pos);
 }
 
 const Voxel& PagedVolume::Sampler::voxelAt(int x, int y, int z) const {
@@ -86,17 +110,26 @@ void PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 	_zPosInChunk = static_cast<uint32_t>(zPos & _volume->_chunkMask);
 
 	const uint32_t voxelIndexInChunk = morton256_x[_xPosInChunk] | morton256_y[_yPosInChunk] | morton256_z[_zPosInChunk];
-	_currentVoxel = _currentChunk->_data + voxelIndexInChunk;
+	_denseChunk = _currentChunk->storage() == ChunkStorage::Dense;
+	_currentVoxel = const_cast<Voxel*>(&_currentChunk->voxelByIndex(voxelIndexInChunk));
 }
 
 bool PagedVolume::Sampler::setVoxel(const Voxel& voxel) {
 	if (_currentVoxel == nullptr) {
 		return false;
 	}
+	if (!_denseChunk) {
+		// the chunk decides whether it has to switch to the dense storage
+		_currentChunk->setVoxel(_xPosInChunk, _yPosInChunk, _zPosInChunk, voxel);
+		setPosition(_xPosInVolume, _yPosInVolume, _zPosInVolume);
+		modified();
+		return true;
+	}
 	//Need to think what effect this has on any existing iterators.
 	//core_assert_msg(false, "This function cannot be used on PagedVolume samplers.");
 	//TODO: the region is not updated properly - but we might not need this for paged volumes.
 	*_currentVoxel = voxel;
+	modified();
 	return true;
 }
 
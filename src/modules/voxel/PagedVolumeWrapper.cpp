@@ -40,7 +40,8 @@ void PagedVolumeWrapper::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_
 		_currentChunk = _volume->chunk(xChunk, yChunk, zChunk);
 	}
 
-	_currentVoxel = _currentChunk->_data + voxelIndexInChunk;
+	_denseChunk = _currentChunk->storage() == PagedVolume::ChunkStorage::Dense;
+	_currentVoxel = const_cast<Voxel*>(&_currentChunk->voxelByIndex(voxelIndexInChunk));
 }
 
 PagedVolumeWrapper::PagedVolumeWrapper(PagedVolume* voxelStorage, const PagedVolume::ChunkPtr& chunk, const Region& region) :
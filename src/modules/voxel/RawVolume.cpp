@@ -6,6 +6,7 @@
 #include "core/Assert.h"
 #include "core/StandardLib.h"
 #include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
 #include <limits>
 
 namespace voxel {
@@ -42,12 +43,33 @@ RawVolume::RawVolume(const RawVolume& copy) :
 	core_memcpy((void*)_data, (void*)copy._data, size);
 }
 
+RawVolume::RawVolume(const RawVolume& copy, const Region& region) :
+		_region(region) {
+	_region.cropTo(copy.region());
+	core_assert_msg(_region.isValid(), "The region to copy doesn't intersect the volume");
+	setBorderValue(copy.borderValue());
+	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	_data = (Voxel*)core_malloc(size);
+	_mins = (glm::max)(copy._mins, _region.getLowerCorner());
+	_maxs = (glm::min)(copy._maxs, _region.getUpperCorner());
+	_boundsValid = copy._boundsValid && glm::all(glm::lessThanEqual(_mins, _maxs));
+	const int32_t lineLength = width();
+	for (int32_t z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+		for (int32_t y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+			const Voxel* src = &copy.voxel(_region.getLowerX(), y, z);
+			Voxel* dest = &_data[(y - _region.getLowerY()) * lineLength + (z - _region.getLowerZ()) * lineLength * height()];
+			core_memcpy((void*)dest, (const void*)src, lineLength * sizeof(Voxel));
+		}
+	}
+}
+
 RawVolume::RawVolume(RawVolume&& move) noexcept {
 	_data = move._data;
 	move._data = nullptr;
 	_mins = move._mins;
 	_maxs = move._maxs;
 	_region = move._region;
+	_borderVoxel = move._borderVoxel;
 	_boundsValid = move._boundsValid;
 }
 
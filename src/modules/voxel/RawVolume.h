@@ -93,6 +93,13 @@ public:
 	RawVolume(const RawVolume* copy);
 	RawVolume(const RawVolume& copy);
 	RawVolume(RawVolume&& move) noexcept;
+	/**
+	 * @brief Copies only the voxels of the given region - e.g. to hand a snapshot of the area a task is
+	 * going to read over to another thread without duplicating the whole volume.
+	 * @note The region is cropped to the region of the copied volume. Reading outside of it returns the
+	 * border value - so make sure to include the neighbours that are sampled.
+	 */
+	RawVolume(const RawVolume& copy, const Region& region);
 
 	static RawVolume* createRaw(const Voxel* data, const voxel::Region& region) {
 		return new RawVolume(data, region);
@@ -106,6 +106,13 @@ public:
 		return _material == other._material && _colorIndex == other._colorIndex;
 	}
 
+	/**
+	 * @brief Compares material, color and flags
+	 */
+	inline bool isIdentical(const Voxel& other) const {
+		return isSame(other) && _flags == other._flags;
+	}
+
 	/**
 	 * @brief Compares by the material type
 	 */
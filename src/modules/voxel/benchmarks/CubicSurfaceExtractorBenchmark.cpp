@@ -3,6 +3,7 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/BinaryGreedyMesher.h"
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/MaterialColor.h"
@@ -30,6 +31,44 @@ public:
 		}
 	}
 
+	/**
+	 * @brief Rolling hills with a few layers of different colors
+	 */
+	void fillTerrain(const voxel::Region& region, voxel::RawVolume* v) const {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+				const int height = region.getLowerY() + region.getHeightInVoxels() / 2 + (x * 7 + z * 3) % 5 + (x / 8 + z / 8) % 7;
+				for (int y = region.getLowerY(); y <= core_min(height, region.getUpperY()); ++y) {
+					const uint8_t color = y == height ? 1 : (y > height - 4 ? 2 : 3);
+					v->setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief A solid sphere that got some holes carved out and some voxels painted with a different color
+	 */
+	void fillModel(const voxel::Region& region, voxel::RawVolume* v) const {
+		const glm::ivec3 center = region.getCenter();
+		const int radius = region.getWidthInVoxels() / 2 - 1;
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+					const glm::ivec3 delta = glm::ivec3(x, y, z) - center;
+					if (delta.x * delta.x + delta.y * delta.y + delta.z * delta.z > radius * radius) {
+						continue;
+					}
+					if ((x / 3 + y / 5 + z / 3) % 7 == 0) {
+						continue;
+					}
+					const uint8_t color = (x * 31 + y * 17 + z * 11) % 13 == 0 ? 2 : 1;
+					v->setVoxel(x, y, z, voxel::createColorVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
 	class BenchmarkPager: public voxel::PagedVolume::Pager {
 	public:
 		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
@@ -132,6 +171,50 @@ BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractEmpty)(benc
 	}
 }
 
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, TerrainExtractCubic)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1));
+	voxel::RawVolume volume(region);
+	fillTerrain(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), true, true);
+	}
+	state.counters["Indices"] = (double)mesh.getNoOfIndices();
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, TerrainExtractBinaryGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1));
+	voxel::RawVolume volume(region);
+	fillTerrain(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner(), true, true);
+	}
+	state.counters["Indices"] = (double)mesh.getNoOfIndices();
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, ModelExtractCubic)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1));
+	voxel::RawVolume volume(region);
+	fillModel(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractCubicMesh(&volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), true, true);
+	}
+	state.counters["Indices"] = (double)mesh.getNoOfIndices();
+}
+
+BENCHMARK_DEFINE_F(CubicSurfaceExtractorBenchmark, ModelExtractBinaryGreedy)(benchmark::State &state) {
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(state.range(0) - 1));
+	voxel::RawVolume volume(region);
+	fillModel(region, &volume);
+	voxel::Mesh mesh(1024 * 1024, 1024 * 1024, false);
+	for (auto _ : state) {
+		voxel::extractBinaryGreedyMesh(&volume, region, &mesh, region.getLowerCorner(), true, true);
+	}
+	state.counters["Indices"] = (double)mesh.getNoOfIndices();
+}
+
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtract)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, RawVolumeExtractGreedyEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
@@ -142,4 +225,9 @@ BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtract)->RangeM
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractGreedyEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, PagedVolumeExtractEmpty)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
 
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, TerrainExtractCubic)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, TerrainExtractBinaryGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, ModelExtractCubic)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+BENCHMARK_REGISTER_F(CubicSurfaceExtractorBenchmark, ModelExtractBinaryGreedy)->RangeMultiplier(2)->Range(16, MAX_BENCHMARK_VOLUME_SIZE);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxel/PagedVolume.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/collection/DynamicArray.h"
+
+/**
+ * @brief Measures the voxel throughput of concurrent readers of a PagedVolume with
+ * all chunks already being resident.
+ */
+class PagedVolumeBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr int ChunkSideLength = 32;
+	const voxel::Region _region { 0, 127 };
+
+	class BenchmarkPager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const voxel::Region& region = ctx.region;
+			for (int y = 0; y < region.getHeightInVoxels() / 2; ++y) {
+				for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+					for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+						ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+					}
+				}
+			}
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	void pageInAll(voxel::PagedVolume& volume) const {
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); z += ChunkSideLength) {
+			for (int y = _region.getLowerY(); y <= _region.getUpperY(); y += ChunkSideLength) {
+				for (int x = _region.getLowerX(); x <= _region.getUpperX(); x += ChunkSideLength) {
+					volume.voxel(x, y, z);
+				}
+			}
+		}
+	}
+
+	template<class FUNC>
+	void run(benchmark::State &state, FUNC&& func) {
+		const int threads = (int)state.range(0);
+		BenchmarkPager pager;
+		voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, ChunkSideLength);
+		pageInAll(volume);
+		core::ThreadPool pool(threads, "PagedVolume");
+		pool.init();
+		core::DynamicArray<std::future<int>> futures;
+		futures.reserve(threads);
+		for (auto _ : state) {
+			for (int i = 0; i < threads; ++i) {
+				futures.emplace_back(pool.enqueue([&] () {
+					return func(volume);
+				}));
+			}
+			for (std::future<int>& f : futures) {
+				benchmark::DoNotOptimize(f.get());
+			}
+			futures.clear();
+		}
+		state.SetItemsProcessed(state.iterations() * threads * _region.voxels());
+	}
+};
+
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, SamplerThreads)(benchmark::State &state) {
+	run(state, [this] (const voxel::PagedVolume& volume) {
+		voxel::PagedVolume::Sampler sampler(volume);
+		int solid = 0;
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				sampler.setPosition(_region.getLowerX(), y, z);
+				for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+					// peeking into the neighbours hits the chunk lookup at the chunk borders
+					if (!voxel::isAir(sampler.peekVoxel0px1py0pz().getMaterial())) {
+						++solid;
+					}
+					sampler.movePositiveX();
+				}
+			}
+		}
+		return solid;
+	});
+}
+
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, VoxelLookupThreads)(benchmark::State &state) {
+	run(state, [this] (const voxel::PagedVolume& volume) {
+		int solid = 0;
+		for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+					// every access is a chunk lookup
+					if (!voxel::isAir(volume.voxel(x, y, z).getMaterial())) {
+						++solid;
+					}
+				}
+			}
+		}
+		return solid;
+	});
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, SamplerThreads)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, VoxelLookupThreads)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
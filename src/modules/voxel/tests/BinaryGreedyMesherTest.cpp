@@ -0,0 +1,146 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/BinaryGreedyMesher.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace voxel {
+
+class BinaryGreedyMesherTest: public app::AbstractTest {
+protected:
+	typedef std::tuple<int, int, int, uint8_t, uint8_t> Vertex;
+	typedef std::tuple<Vertex, Vertex, Vertex> Triangle;
+
+	/**
+	 * @brief Some terrain with caves, water and a few different colors - the region is larger than a
+	 * mesher block to also test the block boundaries
+	 */
+	void fill(RawVolume& volume) const {
+		const Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const int height = 20 + (x * 7 + z * 13) % 11 + (x / 9 + z / 7) % 5;
+				for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+					const uint32_t hash = (uint32_t)(x * 73856093) ^ (uint32_t)(y * 19349663) ^ (uint32_t)(z * 83492791);
+					if (y > height) {
+						if (y < 24) {
+							volume.setVoxel(x, y, z, createVoxel(VoxelType::Water, 0));
+						}
+						continue;
+					}
+					if (hash % 17u == 0u) {
+						continue;
+					}
+					const uint8_t color = y < height - 3 ? 1 : (uint8_t)(2 + hash % 3u);
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	std::vector<Triangle> triangles(const Mesh& mesh) const {
+		std::vector<Triangle> list;
+		const IndexType* indices = mesh.getRawIndexData();
+		const int amount = (int)mesh.getNoOfIndices();
+		auto vertex = [&] (IndexType index) {
+			const VoxelVertex& v = mesh.getVertex(index);
+			return Vertex(v.position.x, v.position.y, v.position.z, v.colorIndex, v.info);
+		};
+		for (int i = 0; i < amount; i += 3) {
+			list.emplace_back(vertex(indices[i]), vertex(indices[i + 1]), vertex(indices[i + 2]));
+		}
+		std::sort(list.begin(), list.end());
+		return list;
+	}
+
+	/**
+	 * @return The area of the faces per color
+	 */
+	std::map<uint8_t, int> area(const Mesh& mesh) const {
+		std::map<uint8_t, int> areas;
+		const IndexType* indices = mesh.getRawIndexData();
+		const int amount = (int)mesh.getNoOfIndices();
+		for (int i = 0; i < amount; i += 3) {
+			const VoxelVertex& v0 = mesh.getVertex(indices[i]);
+			const glm::ivec3 e1 = glm::ivec3(mesh.getVertex(indices[i + 1]).position) - glm::ivec3(v0.position);
+			const glm::ivec3 e2 = glm::ivec3(mesh.getVertex(indices[i + 2]).position) - glm::ivec3(v0.position);
+			const glm::ivec3 c(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+			// twice the triangle area - the triangles are axis aligned
+			areas[v0.colorIndex] += glm::abs(c.x) + glm::abs(c.y) + glm::abs(c.z);
+		}
+		return areas;
+	}
+};
+
+TEST_F(BinaryGreedyMesherTest, testSameFacesAsCubicSurfaceExtractor) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(79, 47, 71)));
+	fill(volume);
+	const Region region(glm::ivec3(1, 2, 0), glm::ivec3(70, 40, 65));
+	Mesh expected(1024 * 1024, 1024 * 1024);
+	Mesh mesh(1024 * 1024, 1024 * 1024);
+	extractCubicMesh(&volume, region, &expected, IsQuadNeeded(), glm::ivec3(3, 0, -2), false, true);
+	extractBinaryGreedyMesh(&volume, region, &mesh, glm::ivec3(3, 0, -2), false, true);
+	ASSERT_GT(expected.getNoOfIndices(), 0u);
+	EXPECT_EQ(expected.getOffset(), mesh.getOffset());
+	EXPECT_TRUE(triangles(expected) == triangles(mesh)) << "The faces, colors or ambient occlusion values differ";
+}
+
+TEST_F(BinaryGreedyMesherTest, testReuseVertices) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(31)));
+	fill(volume);
+	Mesh expected(1024 * 1024, 1024 * 1024);
+	Mesh mesh(1024 * 1024, 1024 * 1024);
+	extractBinaryGreedyMesh(&volume, volume.region(), &expected, glm::ivec3(0), false, false);
+	extractBinaryGreedyMesh(&volume, volume.region(), &mesh, glm::ivec3(0), false, true);
+	EXPECT_LT(mesh.getNoOfVertices(), expected.getNoOfVertices());
+	EXPECT_TRUE(triangles(expected) == triangles(mesh));
+}
+
+TEST_F(BinaryGreedyMesherTest, testMergeQuads) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(79, 47, 71)));
+	fill(volume);
+	const Region region(glm::ivec3(1, 2, 0), glm::ivec3(70, 40, 65));
+	Mesh cubic(1024 * 1024, 1024 * 1024);
+	Mesh single(1024 * 1024, 1024 * 1024);
+	Mesh merged(1024 * 1024, 1024 * 1024);
+	extractCubicMesh(&volume, region, &cubic, IsQuadNeeded(), region.getLowerCorner());
+	extractBinaryGreedyMesh(&volume, region, &single, region.getLowerCorner(), false, true);
+	extractBinaryGreedyMesh(&volume, region, &merged, region.getLowerCorner());
+	EXPECT_LT(merged.getNoOfIndices(), single.getNoOfIndices());
+	EXPECT_EQ(area(single), area(merged));
+	EXPECT_EQ(area(cubic), area(merged));
+}
+
+TEST_F(BinaryGreedyMesherTest, testMergeSingleColorBox) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15)));
+	for (int z = 2; z <= 12; ++z) {
+		for (int y = 2; y <= 12; ++y) {
+			for (int x = 2; x <= 12; ++x) {
+				volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1));
+			}
+		}
+	}
+	Mesh mesh(1024, 1024);
+	// without ambient occlusion each side of the box is exactly one quad
+	extractBinaryGreedyMesh(&volume, volume.region(), &mesh, glm::ivec3(0), true, true, false);
+	EXPECT_EQ(6u * 6u, mesh.getNoOfIndices());
+	EXPECT_EQ(24u, mesh.getNoOfVertices());
+}
+
+TEST_F(BinaryGreedyMesherTest, testEmpty) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15)));
+	Mesh mesh(1024, 1024);
+	extractBinaryGreedyMesh(&volume, volume.region(), &mesh, glm::ivec3(0));
+	EXPECT_EQ(0u, mesh.getNoOfIndices());
+	EXPECT_EQ(0u, mesh.getNoOfVertices());
+}
+
+}
@@ -0,0 +1,371 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/PagedVolume.h"
+#include "core/ArrayLength.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include <algorithm>
+#include <vector>
+
+namespace voxel {
+
+class PagedVolumeTest: public app::AbstractTest {
+protected:
+	class CountingPager: public PagedVolume::Pager {
+	public:
+		int pageIns = 0;
+		int pageOuts = 0;
+		int pageOutBatches = 0;
+
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			++pageIns;
+			ctx.chunk->setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 1));
+			return true;
+		}
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+			++pageOuts;
+		}
+
+		void pageOutChunks(PagedVolume::Chunk** chunks, int amount) override {
+			++pageOutBatches;
+			Pager::pageOutChunks(chunks, amount);
+		}
+	};
+
+	/**
+	 * @brief Reads a voxel of the neighbouring chunk while filling a chunk. The chunk waits until the
+	 * neighbour was started by another thread.
+	 */
+	class NeighbourPager: public PagedVolume::Pager {
+	public:
+		PagedVolume* volume = nullptr;
+		core::AtomicInt started { 0 };
+		// the neighbours of these chunk x positions are read
+		core::AtomicBool readNeighbour[2] { false, false };
+		core::AtomicInt neighbourMaterial[2] { -1, -1 };
+
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			const int x = ctx.chunk->chunkPos().x;
+			if (x < 0 || x > 1) {
+				return false;
+			}
+			started.increment();
+			while (started < 2) {
+				std::this_thread::yield();
+			}
+			if (readNeighbour[x]) {
+				const int other = 1 - x;
+				neighbourMaterial[x] = (int)volume->voxel(other * 32 + 31, 31, 31).getMaterial();
+			} else {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+			// the last voxel that is filled
+			ctx.chunk->setVoxel(31, 31, 31, createVoxel(VoxelType::Generic, 1));
+			return true;
+		}
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+		}
+	};
+};
+
+TEST_F(PagedVolumeTest, testStatistics) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	volume.voxel(0, 0, 0);
+	volume.voxel(1, 0, 0);
+	volume.voxel(32, 0, 0);
+	const PagedVolume::Statistics& stats = volume.statistics();
+	EXPECT_EQ(2, stats.misses);
+	EXPECT_EQ(1, stats.hits);
+	EXPECT_EQ(2, stats.chunks);
+	EXPECT_EQ(0, stats.evictions);
+	EXPECT_EQ(2, pager.pageIns);
+}
+
+TEST_F(PagedVolumeTest, testEviction) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	// the palette chunks of the pager are much smaller than dense chunks
+	const int chunks = 1000;
+	for (int i = 0; i < chunks; ++i) {
+		volume.voxel(i * 32, 0, 0);
+	}
+	const PagedVolume::Statistics& stats = volume.statistics();
+	EXPECT_EQ(chunks, stats.misses);
+	EXPECT_EQ(chunks, pager.pageIns);
+	EXPECT_LT(stats.chunks, chunks);
+	EXPECT_EQ(chunks, stats.chunks + stats.evictions);
+	EXPECT_EQ(stats.evictions, stats.pageOuts) << "All chunks were modified by the pager";
+	EXPECT_EQ(stats.pageOuts, pager.pageOuts);
+	EXPECT_GT(pager.pageOutBatches, 0);
+	// the evicted chunks are paged in again
+	volume.voxel(0, 0, 0);
+	EXPECT_EQ(chunks + 1, pager.pageIns);
+}
+
+TEST_F(PagedVolumeTest, testEvictionSecondChance) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	for (int i = 0; i < 1000; ++i) {
+		volume.voxel(i * 32, 0, 0);
+		// keep the first chunk hot
+		volume.voxel(0, 0, 0);
+	}
+	const int pageIns = pager.pageIns;
+	volume.voxel(0, 0, 0);
+	EXPECT_EQ(pageIns, pager.pageIns) << "The chunk that is accessed all the time should not get evicted";
+}
+
+TEST_F(PagedVolumeTest, testMemoryUsage) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 64 * 1024 * 1024, 32);
+	const uint64_t denseSizeInBytes = 32u * 32u * 32u * sizeof(Voxel);
+	volume.voxel(0, 0, 0);
+	const uint64_t paletteBytes = volume.statistics().bytes;
+	EXPECT_GT(paletteBytes, 0u);
+	EXPECT_LT(paletteBytes, denseSizeInBytes) << "The palette chunk should be charged with its real size";
+	volume.setVoxel(1, 0, 0, createVoxel(VoxelType::Grass, 2));
+	EXPECT_GE(volume.statistics().bytes, denseSizeInBytes) << "The switch to the dense storage should be charged";
+	volume.flushAll();
+	EXPECT_EQ(0u, volume.statistics().bytes);
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunks) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32, 1024 * 1024);
+	const int chunks = 100;
+	for (int i = 0; i < chunks; ++i) {
+		volume.setVoxel(i * 32 + 1, 0, 0, createVoxel(VoxelType::Grass, 2));
+	}
+	PagedVolume::Statistics stats = volume.statistics();
+	EXPECT_GT(stats.evictions, 0);
+	EXPECT_EQ(stats.evictions, stats.compressedChunks);
+	EXPECT_GT(stats.compressedBytes, 0u);
+	EXPECT_EQ(0, pager.pageOuts) << "Evicted chunks should be kept compressed";
+
+	// the evicted chunks are restored from the compressed tier
+	for (int i = 0; i < chunks; ++i) {
+		EXPECT_EQ(VoxelType::Generic, volume.voxel(i * 32, 0, 0).getMaterial());
+		EXPECT_EQ(VoxelType::Grass, volume.voxel(i * 32 + 1, 0, 0).getMaterial());
+		EXPECT_EQ(2, volume.voxel(i * 32 + 1, 0, 0).getColor());
+	}
+	EXPECT_EQ(chunks, pager.pageIns);
+	stats = volume.statistics();
+	EXPECT_GT(stats.compressedHits, 0);
+
+	volume.flushAll();
+	EXPECT_EQ(chunks, pager.pageOuts) << "Every modified chunk must be paged out once";
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunksMemoryLimit) {
+	CountingPager pager;
+	// 16 bytes are enough for two chunks with two runs each
+	PagedVolume volume(&pager, 1024 * 1024, 32, 16);
+	const int chunks = 100;
+	for (int i = 0; i < chunks; ++i) {
+		volume.voxel(i * 32, 0, 0);
+	}
+	const PagedVolume::Statistics& stats = volume.statistics();
+	EXPECT_LE(stats.compressedBytes, 16u);
+	EXPECT_LE(stats.compressedChunks, 2);
+	EXPECT_EQ(stats.evictions - stats.compressedChunks, pager.pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunksLargeMemoryLimit) {
+	CountingPager pager;
+	// doesn't fit into 32 bit - the compressed tier must not get disabled
+	const uint64_t compressedMemory = 4096ull * 1024ull * 1024ull;
+	PagedVolume volume(&pager, 1024 * 1024, 32, compressedMemory);
+	const int chunks = 1000;
+	for (int i = 0; i < chunks; ++i) {
+		volume.voxel(i * 32, 0, 0);
+	}
+	const PagedVolume::Statistics& stats = volume.statistics();
+	EXPECT_GT(stats.evictions, 0);
+	EXPECT_EQ(stats.evictions, stats.compressedChunks);
+	EXPECT_EQ(0, pager.pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testChunkStorage) {
+	CountingPager pager;
+	PagedVolume::Chunk chunk(glm::ivec3(0), 32, &pager);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Uniform, chunk.storage()) << "A new chunk should not allocate voxels";
+	chunk.setVoxel(1, 2, 3, Voxel());
+	EXPECT_EQ(PagedVolume::ChunkStorage::Uniform, chunk.storage()) << "Writing the same voxel should keep the storage";
+
+	const Voxel grass = createVoxel(VoxelType::Grass, 1);
+	chunk.setVoxel(1, 2, 3, grass);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Dense, chunk.storage());
+	EXPECT_TRUE(grass.isIdentical(chunk.voxel(1, 2, 3)));
+
+	EXPECT_TRUE(chunk.compact());
+	EXPECT_EQ(PagedVolume::ChunkStorage::Palette, chunk.storage());
+	EXPECT_TRUE(grass.isIdentical(chunk.voxel(1, 2, 3)));
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(1, 2, 4).getMaterial());
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(31, 31, 31).getMaterial());
+
+	// a write of a voxel that is already there doesn't need the dense storage
+	chunk.setVoxel(1, 2, 3, grass);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Palette, chunk.storage());
+	chunk.setVoxel(1, 2, 4, grass);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Dense, chunk.storage());
+	EXPECT_TRUE(grass.isIdentical(chunk.voxel(1, 2, 3)));
+	EXPECT_TRUE(grass.isIdentical(chunk.voxel(1, 2, 4)));
+
+	chunk.setUniform(grass);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Uniform, chunk.storage());
+	EXPECT_TRUE(grass.isIdentical(chunk.voxel(31, 31, 31)));
+}
+
+TEST_F(PagedVolumeTest, testChunkStorageAfterPageIn) {
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	EXPECT_EQ(VoxelType::Generic, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(PagedVolume::ChunkStorage::Palette, volume.chunk(glm::ivec3(0))->storage());
+
+	PagedVolume::Sampler sampler(volume);
+	sampler.setPosition(1, 0, 0);
+	EXPECT_EQ(VoxelType::Air, sampler.voxel().getMaterial());
+	EXPECT_EQ(VoxelType::Generic, sampler.peekVoxel1nx0py0pz().getMaterial());
+	sampler.moveNegativeX();
+	EXPECT_EQ(VoxelType::Generic, sampler.voxel().getMaterial());
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	EXPECT_EQ(PagedVolume::ChunkStorage::Dense, volume.chunk(glm::ivec3(0))->storage());
+	EXPECT_EQ(VoxelType::Rock, volume.voxel(0, 0, 0).getMaterial());
+	sampler.movePositiveX();
+	EXPECT_EQ(VoxelType::Air, sampler.voxel().getMaterial());
+	EXPECT_EQ(VoxelType::Rock, sampler.peekVoxel1nx0py0pz().getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testListener) {
+	class Listener: public PagedVolume::Listener {
+	public:
+		int calls = 0;
+		Region region = Region::InvalidRegion;
+		int pagedIn = 0;
+		int evicted = 0;
+		void onVoxelsModified(const Region& modified) override {
+			++calls;
+			region = modified;
+		}
+		void onChunkPagedIn(const PagedVolume::ChunkPtr& chunk) override {
+			++pagedIn;
+		}
+		void onChunkEvicted(const glm::ivec3& chunkPos) override {
+			++evicted;
+		}
+	};
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	Listener listener;
+	volume.addListener(&listener);
+	// paging in doesn't count as modification
+	EXPECT_EQ(VoxelType::Generic, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(0, listener.calls);
+	EXPECT_EQ(1, listener.pagedIn);
+
+	volume.setVoxel(40, 1, 2, createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(1, listener.calls);
+	EXPECT_EQ(Region(40, 1, 2, 40, 1, 2), listener.region);
+
+	const Voxel voxels[3] = {createVoxel(VoxelType::Rock, 0), createVoxel(VoxelType::Rock, 0), createVoxel(VoxelType::Rock, 0)};
+	volume.setVoxels(1, 2, 3, 2, 2, voxels, lengthof(voxels));
+	EXPECT_EQ(2, listener.calls);
+	EXPECT_EQ(Region(1, 2, 3, 2, 4, 4), listener.region);
+
+	// the sampler notifies once per modified chunk
+	PagedVolume::Sampler sampler(volume);
+	sampler.setPosition(5, 6, 7);
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	sampler.movePositiveX();
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	EXPECT_EQ(2, listener.calls);
+	sampler.flushModified();
+	EXPECT_EQ(3, listener.calls);
+	EXPECT_EQ(Region(5, 6, 7, 6, 6, 7), listener.region);
+	sampler.flushModified();
+	EXPECT_EQ(3, listener.calls);
+
+	const int pagedIn = listener.pagedIn;
+	EXPECT_EQ(0, listener.evicted);
+	volume.flushAll();
+	EXPECT_EQ(pagedIn, listener.evicted);
+
+	volume.removeListener(&listener);
+	volume.setVoxel(0, 0, 0, createVoxel(VoxelType::Air, 0));
+	EXPECT_EQ(3, listener.calls);
+}
+
+TEST_F(PagedVolumeTest, testModificationBatch) {
+	class Listener: public PagedVolume::Listener {
+	public:
+		std::vector<Region> regions;
+		void onVoxelsModified(const Region& modified) override {
+			regions.push_back(modified);
+		}
+	};
+	CountingPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	Listener listener;
+	volume.addListener(&listener);
+	{
+		PagedVolume::ModificationBatch batch(&volume);
+		{
+			// merged into the outer batch
+			PagedVolume::ModificationBatch inner(&volume);
+			volume.setVoxel(1, 2, 3, createVoxel(VoxelType::Rock, 0));
+		}
+		volume.setVoxel(4, 5, 6, createVoxel(VoxelType::Rock, 0));
+		volume.setVoxel(40, 5, 6, createVoxel(VoxelType::Rock, 0));
+		EXPECT_TRUE(listener.regions.empty());
+	}
+	ASSERT_EQ(2u, listener.regions.size());
+	std::sort(listener.regions.begin(), listener.regions.end(), [] (const Region& a, const Region& b) {
+		return a.getLowerX() < b.getLowerX();
+	});
+	EXPECT_EQ(Region(1, 2, 3, 4, 5, 6), listener.regions[0]);
+	EXPECT_EQ(Region(40, 5, 6, 40, 5, 6), listener.regions[1]);
+
+	volume.setVoxel(0, 0, 0, createVoxel(VoxelType::Air, 0));
+	EXPECT_EQ(3u, listener.regions.size());
+	volume.removeListener(&listener);
+}
+
+TEST_F(PagedVolumeTest, testPageInWaitsForNeighbour) {
+	NeighbourPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	pager.volume = &volume;
+	pager.readNeighbour[0] = true;
+	core::ThreadPool pool(2, "PagedVolumeTest");
+	pool.init();
+	// the page in of chunk 0 needs chunk 1 that is paged in by another thread at the same time
+	auto f1 = pool.enqueue([&] () { return volume.voxel(32, 0, 0).getMaterial(); });
+	auto f0 = pool.enqueue([&] () { return volume.voxel(0, 0, 0).getMaterial(); });
+	f0.get();
+	f1.get();
+	EXPECT_EQ((int)VoxelType::Generic, (int)pager.neighbourMaterial[0]);
+}
+
+TEST_F(PagedVolumeTest, testCyclicPageIn) {
+	NeighbourPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 32);
+	pager.volume = &volume;
+	pager.readNeighbour[0] = true;
+	pager.readNeighbour[1] = true;
+	core::ThreadPool pool(2, "PagedVolumeTest");
+	pool.init();
+	// both chunks need each other - this must not deadlock
+	auto f0 = pool.enqueue([&] () { return volume.voxel(0, 0, 0).getMaterial(); });
+	auto f1 = pool.enqueue([&] () { return volume.voxel(32, 0, 0).getMaterial(); });
+	f0.get();
+	f1.get();
+	EXPECT_EQ(VoxelType::Generic, volume.voxel(31, 31, 31).getMaterial());
+	EXPECT_EQ(VoxelType::Generic, volume.voxel(63, 31, 31).getMaterial());
+}
+
+}
@@ -0,0 +1,39 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class RawVolumeTest: public app::AbstractTest {
+};
+
+TEST_F(RawVolumeTest, testCopyRegion) {
+	RawVolume v(Region(0, 15));
+	for (int i = 0; i <= 15; ++i) {
+		v.setVoxel(i, i, i, createVoxel(VoxelType::Generic, i));
+	}
+	const RawVolume copy(v, Region(4, 7));
+	EXPECT_EQ(Region(4, 7), copy.region());
+	for (int i = 4; i <= 7; ++i) {
+		EXPECT_EQ(createVoxel(VoxelType::Generic, i), copy.voxel(i, i, i));
+		EXPECT_EQ(v.voxel(i, 4, 7), copy.voxel(i, 4, 7));
+	}
+	EXPECT_EQ(copy.borderValue(), copy.voxel(3, 3, 3));
+	EXPECT_EQ(glm::ivec3(4), copy.mins());
+	EXPECT_EQ(glm::ivec3(7), copy.maxs());
+}
+
+TEST_F(RawVolumeTest, testCopyRegionIsCropped) {
+	RawVolume v(Region(0, 15));
+	v.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(15, 15, 15, createVoxel(VoxelType::Generic, 2));
+	const RawVolume copy(v, Region(-2, 20));
+	EXPECT_EQ(v.region(), copy.region());
+	EXPECT_EQ(createVoxel(VoxelType::Generic, 1), copy.voxel(0, 0, 0));
+	EXPECT_EQ(createVoxel(VoxelType::Generic, 2), copy.voxel(15, 15, 15));
+}
+
+}
@@ -12,9 +12,19 @@
 #include "core/Log.h"
 #include "core/Assert.h"
 #include "voxel/CubicSurfaceExtractor.h"
+#include "io/FileStream.h"
+#include "core/Hash.h"
+#include "core/FourCC.h"
 
 namespace voxelformat {
 
+static const uint32_t BinaryMeshMagic = FourCC('V','M','S','H');
+/**
+ * @brief Increase this whenever the mesh extraction or the layout of the binary mesh files changes - the
+ * binary meshes are rebuilt then
+ */
+static constexpr uint32_t BinaryMeshVersion = 1u;
+
 MeshCache::~MeshCache() {
 	core_assert_msg(_initCalls == 0, "MeshCache wasn't shut down properly: %i", _initCalls);
 }
@@ -51,6 +61,124 @@ const voxel::Mesh* MeshCache::getMesh(const char *fullPath) {
 	return nullptr;
 }
 
+core::String MeshCache::binaryPath(const char *fullPath) {
+	return core::string::format("meshcache/%s.vmesh", fullPath);
+}
+
+bool MeshCache::loadBinaryMesh(const char *fullPath, uint32_t sourceHash, uint32_t sourceSize, voxel::Mesh& mesh) const {
+	const io::FilePtr& file = io::filesystem()->open(binaryPath(fullPath));
+	if (!file->exists()) {
+		return false;
+	}
+	io::FileStream stream(file);
+	uint32_t magic, version, hash, size, vertices, indices;
+	int32_t offset[3];
+	uint8_t bytesPerIndex;
+	if (stream.readInt(magic) != 0 || magic != BinaryMeshMagic) {
+		return false;
+	}
+	if (stream.readInt(version) != 0 || version != BinaryMeshVersion) {
+		Log::debug("Binary mesh for %s was created by another version: %u", fullPath, version);
+		return false;
+	}
+	if (stream.readInt(hash) != 0 || stream.readInt(size) != 0 || hash != sourceHash || size != sourceSize) {
+		Log::debug("Binary mesh for %s is outdated", fullPath);
+		return false;
+	}
+	for (int i = 0; i < 3; ++i) {
+		if (stream.readInt((uint32_t&)offset[i]) != 0) {
+			return false;
+		}
+	}
+	if (stream.readInt(vertices) != 0 || stream.readInt(indices) != 0 || stream.readByte(bytesPerIndex) != 0) {
+		return false;
+	}
+	if (bytesPerIndex != 1 && bytesPerIndex != 2 && bytesPerIndex != 4) {
+		return false;
+	}
+	if (stream.remaining() != (int64_t)vertices * (int64_t)sizeof(voxel::VoxelVertex) + (int64_t)indices * bytesPerIndex) {
+		Log::warn("Binary mesh for %s is truncated", fullPath);
+		return false;
+	}
+	voxel::VertexArray& vertexArray = mesh.getVertexVector();
+	voxel::IndexArray& indexArray = mesh.getIndexVector();
+	vertexArray.resize(vertices);
+	indexArray.resize(indices);
+	// the binary meshes are local to the machine - the vertices are stored in memory layout
+	if (vertices > 0u && stream.readBuf((uint8_t*)vertexArray.data(), vertices * sizeof(voxel::VoxelVertex)) != 0) {
+		mesh.clear();
+		return false;
+	}
+	if (bytesPerIndex == sizeof(voxel::IndexType)) {
+		if (indices > 0u && stream.readBuf((uint8_t*)indexArray.data(), indices * sizeof(voxel::IndexType)) != 0) {
+			mesh.clear();
+			return false;
+		}
+	} else {
+		for (uint32_t i = 0u; i < indices; ++i) {
+			int error;
+			voxel::IndexType index;
+			if (bytesPerIndex == 1) {
+				uint8_t val;
+				error = stream.readByte(val);
+				index = val;
+			} else {
+				uint16_t val;
+				error = stream.readShort(val);
+				index = val;
+			}
+			if (error != 0) {
+				mesh.clear();
+				return false;
+			}
+			indexArray[i] = index;
+		}
+	}
+	mesh.setOffset(glm::ivec3(offset[0], offset[1], offset[2]));
+	return true;
+}
+
+bool MeshCache::saveBinaryMesh(const char *fullPath, uint32_t sourceHash, uint32_t sourceSize, voxel::Mesh& mesh) const {
+	const io::FilesystemPtr& fs = io::filesystem();
+	const core::String& path = binaryPath(fullPath);
+	const core::String& fullBinaryPath = fs->writePath(path.c_str());
+	if (!fs->createDir(core::string::extractPath(fullBinaryPath))) {
+		Log::warn("Failed to create the directory for %s", fullBinaryPath.c_str());
+		return false;
+	}
+	const io::FilePtr& file = fs->open(path, io::FileMode::Write);
+	if (!file->validHandle()) {
+		Log::warn("Failed to open %s for writing", fullBinaryPath.c_str());
+		return false;
+	}
+	io::FileStream stream(file);
+	mesh.compressIndices();
+	const uint8_t bytesPerIndex = (uint8_t)mesh.compressedIndexSize();
+	const glm::ivec3& offset = mesh.getOffset();
+	bool success = stream.addInt(BinaryMeshMagic);
+	success &= stream.addInt(BinaryMeshVersion);
+	success &= stream.addInt(sourceHash);
+	success &= stream.addInt(sourceSize);
+	success &= stream.addInt((uint32_t)offset.x);
+	success &= stream.addInt((uint32_t)offset.y);
+	success &= stream.addInt((uint32_t)offset.z);
+	success &= stream.addInt((uint32_t)mesh.getNoOfVertices());
+	success &= stream.addInt((uint32_t)mesh.getNoOfIndices());
+	success &= stream.addByte(bytesPerIndex == 0u ? (uint8_t)sizeof(voxel::IndexType) : bytesPerIndex);
+	if (mesh.getNoOfVertices() > 0u) {
+		success &= stream.append((const uint8_t*)mesh.getRawVertexData(), mesh.getNoOfVertices() * sizeof(voxel::VoxelVertex));
+	}
+	if (mesh.getNoOfIndices() > 0u) {
+		success &= stream.append(mesh.compressedIndices(), mesh.getNoOfIndices() * bytesPerIndex);
+	}
+	if (!success) {
+		Log::warn("Failed to write the binary mesh %s", fullBinaryPath.c_str());
+		return false;
+	}
+	Log::debug("Wrote binary mesh %s", fullBinaryPath.c_str());
+	return true;
+}
+
 bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
 	Log::debug("Loading volume from %s", fullPath);
 	const io::FilesystemPtr& fs = io::filesystem();
@@ -66,6 +194,25 @@ bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
 		Log::error("Failed to load %s for any of the supported format extensions", fullPath);
 		return false;
 	}
+
+	// the binary meshes are only written for paths that are relative to the search paths
+	const bool binaryMesh = io::Filesystem::isRelativePath(fullPath);
+	uint32_t sourceHash = 0u;
+	uint32_t sourceSize = 0u;
+	if (binaryMesh) {
+		uint8_t *buf = nullptr;
+		const int size = file->read((void**)&buf);
+		if (size > 0) {
+			sourceHash = core::hash(buf, size);
+			sourceSize = (uint32_t)size;
+		}
+		delete[] buf;
+		if (loadBinaryMesh(fullPath, sourceHash, sourceSize, mesh)) {
+			Log::debug("Loaded binary mesh for %s", fullPath);
+			return true;
+		}
+	}
+
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(file, volumes)) {
 		Log::error("Failed to load %s", file->name().c_str());
@@ -87,6 +234,9 @@ bool MeshCache::loadMesh(const char* fullPath, voxel::Mesh& mesh) {
 	delete volume;
 
 	Log::info("Generated mesh for %s", fullPath);
+	if (binaryMesh) {
+		saveBinaryMesh(fullPath, sourceHash, sourceSize, mesh);
+	}
 	return true;
 }
 
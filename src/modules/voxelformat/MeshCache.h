@@ -14,6 +14,11 @@ namespace voxelformat {
 
 /**
  * @brief Cache @c voxel::Mesh instances by their name
+ *
+ * The extracted meshes are also stored on disk in the home path of the application. They are keyed by the hash
+ * of the source file and the version of the mesh extraction - a warm start doesn't need to extract the meshes
+ * again. The binary mesh files are rebuilt whenever the source file changes.
+ *
  * @note The cache is @b not threadsafe
  * @sa MeshCache
  */
@@ -24,6 +29,16 @@ protected:
 
 	voxel::Mesh& cacheEntry(const char *fullPath);
 	bool loadMesh(const char* fullPath, voxel::Mesh& mesh);
+
+	/**
+	 * @return The path of the binary mesh file relative to the home path
+	 */
+	static core::String binaryPath(const char *fullPath);
+	/**
+	 * @brief Loads the extracted mesh from the binary mesh file if it matches the given source file
+	 */
+	bool loadBinaryMesh(const char *fullPath, uint32_t sourceHash, uint32_t sourceSize, voxel::Mesh& mesh) const;
+	bool saveBinaryMesh(const char *fullPath, uint32_t sourceHash, uint32_t sourceSize, voxel::Mesh& mesh) const;
 public:
 	~MeshCache();
 	const voxel::Mesh* getMesh(const char *fullPath);
@@ -209,11 +209,7 @@ bool VXLFormat::readLimb(io::FileStream& stream, vxl_mdl& mdl, uint32_t limbIdx,
 	const size_t limbOffset = HeaderSize + LimbHeaderSize * mdl.header.n_limbs + footer.span_start_off;
 	wrap(stream.seek(limbOffset))
 	Log::debug("limbOffset: %u", (uint32_t)limbOffset);
-	for (uint32_t i = 0; i < baseSize; ++i) {
-		uint32_t v;
-		wrap(stream.readInt(v))
-		colStart[i] = v;
-	}
+	wrap(stream.readInts((uint32_t*)colStart.data(), baseSize))
 	// skip spanPosEnd values
 	stream.skip(sizeof(uint32_t) * baseSize);
 
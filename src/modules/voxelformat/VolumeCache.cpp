@@ -9,24 +9,24 @@
 #include "app/App.h"
 #include "command/Command.h"
 #include "core/Log.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace voxelformat {
 
+VolumeCache::VolumeCache(size_t maxBytes) :
+		_maxBytes(maxBytes) {
+}
+
 VolumeCache::~VolumeCache() {
 	core_assert_msg(_volumes.empty(), "VolumeCache wasn't shut down properly");
 }
 
-voxel::RawVolume* VolumeCache::loadVolume(const core::String &filename) {
-	{
-		core::ScopedLock lock(_mutex);
-		auto i = _volumes.find(filename);
-		if (i != _volumes.end()) {
-			return i->second;
-		}
-	}
+RawVolumePtr VolumeCache::load(const core::String &filename, bool& cache) {
 	Log::debug("Loading volume from %s", filename.c_str());
 	const io::FilesystemPtr& fs = io::filesystem();
 
+	cache = false;
 	io::FilePtr file;
 	for (const char **ext = SUPPORTED_VOXEL_FORMATS_LOAD_LIST; *ext; ++ext) {
 		file = fs->open(core::string::format("%s.%s", filename.c_str(), *ext));
@@ -36,61 +36,142 @@ voxel::RawVolume* VolumeCache::loadVolume(const core::String &filename) {
 	}
 	if (!file->exists()) {
 		Log::debug("Failed to load %s for any of the supported format extensions", filename.c_str());
-		return nullptr;
+		return RawVolumePtr();
 	}
+	// broken files are not loaded again
+	cache = true;
 	voxel::VoxelVolumes volumes;
 	if (!voxelformat::loadVolumeFormat(file, volumes)) {
 		Log::error("Failed to load %s", file->name().c_str());
 		voxelformat::clearVolumes(volumes);
-		core::ScopedLock lock(_mutex);
-		_volumes.put(filename, nullptr);
-		return nullptr;
+		return RawVolumePtr();
 	}
 	voxel::RawVolume* v = volumes.merge();
 	voxelformat::clearVolumes(volumes);
+	return RawVolumePtr(v);
+}
 
-	core::ScopedLock lock(_mutex);
-	_volumes.put(filename, v);
+RawVolumePtr VolumeCache::loadVolume(const core::String &filename) {
+	std::promise<RawVolumePtr> promise;
+	std::shared_future<RawVolumePtr> inFlight;
+	{
+		core::ScopedLock lock(_mutex);
+		auto i = _volumes.find(filename);
+		if (i != _volumes.end()) {
+			i->value.lastAccess = ++_accessCounter;
+			return i->value.volume;
+		}
+		auto loading = _loading.find(filename);
+		if (loading != _loading.end()) {
+			inFlight = loading->value;
+		} else {
+			_loading.put(filename, promise.get_future().share());
+		}
+	}
+	if (inFlight.valid()) {
+		// another thread is already loading the volume - wait for it
+		core_trace_scoped(VolumeCacheWait);
+		return inFlight.get();
+	}
+
+	bool cache = false;
+	const RawVolumePtr& v = load(filename, cache);
+
+	{
+		core::ScopedLock lock(_mutex);
+		_loading.remove(filename);
+		if (cache) {
+			Entry entry;
+			entry.volume = v;
+			if (v) {
+				entry.bytes = (size_t)v->region().voxels() * sizeof(voxel::Voxel);
+			}
+			entry.lastAccess = ++_accessCounter;
+			_bytes += entry.bytes;
+			_volumes.put(filename, entry);
+			evict(filename);
+		}
+	}
+	promise.set_value(v);
 	return v;
 }
 
-bool VolumeCache::removeVolume(const char* fullPath) {
-	const core::String filename = fullPath;
-	core::ScopedLock lock(_mutex);
-	auto i = _volumes.find(filename);
-	if (i != _volumes.end()) {
+void VolumeCache::evict(const core::String &keep) {
+	while (_bytes > _maxBytes) {
+		const core::String* lru = nullptr;
+		uint64_t lastAccess = 0u;
+		for (const auto& e : _volumes) {
+			if (e->value.bytes == 0u || e->key == keep) {
+				continue;
+			}
+			if (lru == nullptr || e->value.lastAccess < lastAccess) {
+				lru = &e->key;
+				lastAccess = e->value.lastAccess;
+			}
+		}
+		if (lru == nullptr) {
+			return;
+		}
+		auto i = _volumes.find(*lru);
+		Log::debug("Evict volume %s from the cache", lru->c_str());
+		_bytes -= i->value.bytes;
 		_volumes.erase(i);
-		return true;
 	}
-	return false;
 }
 
-bool VolumeCache::deleteVolume(const char* fullPath) {
+bool VolumeCache::preload(const core::DynamicArray<core::String> &fullPaths) {
+	core_trace_scoped(VolumeCachePreload);
+	core::AtomicInt failed { 0 };
+	app::App::getInstance()->threadPool().parallelFor(0, (int)fullPaths.size(), 1, [&] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			if (!loadVolume(fullPaths[i])) {
+				failed.increment();
+			}
+		}
+	});
+	return failed == 0;
+}
+
+bool VolumeCache::removeVolume(const char* fullPath) {
 	const core::String filename = fullPath;
 	core::ScopedLock lock(_mutex);
 	auto i = _volumes.find(filename);
 	if (i != _volumes.end()) {
-		delete i->value;
+		_bytes -= i->value.bytes;
 		_volumes.erase(i);
 		return true;
 	}
 	return false;
 }
 
+void VolumeCache::setMaxBytes(size_t maxBytes) {
+	core::ScopedLock lock(_mutex);
+	_maxBytes = maxBytes;
+	evict("");
+}
+
+size_t VolumeCache::bytes() const {
+	core::ScopedLock lock(_mutex);
+	return _bytes;
+}
+
+size_t VolumeCache::size() const {
+	core::ScopedLock lock(_mutex);
+	return _volumes.size();
+}
+
 void VolumeCache::construct() {
 	command::Command::registerCommand("volumecachelist", [&] (const command::CmdArgs& argv) {
-		Log::info("Cache content");
 		core::ScopedLock lock(_mutex);
+		Log::info("Cache content (%i bytes of %i)", (int)_bytes, (int)_maxBytes);
 		for (const auto& e : _volumes) {
-			Log::info(" * %s", e->key.c_str());
+			Log::info(" * %s (%i bytes)", e->key.c_str(), (int)e->value.bytes);
 		}
 	});
 	command::Command::registerCommand("volumecacheclear", [&] (const command::CmdArgs& argv) {
 		core::ScopedLock lock(_mutex);
-		for (const auto & e : _volumes) {
-			delete e->value;
-		}
 		_volumes.clear();
+		_bytes = 0u;
 	});
 }
 
@@ -100,10 +181,8 @@ bool VolumeCache::init() {
 
 void VolumeCache::shutdown() {
 	core::ScopedLock lock(_mutex);
-	for (const auto & e : _volumes) {
-		delete e->value;
-	}
 	_volumes.clear();
+	_bytes = 0u;
 }
 
 }
@@ -7,41 +7,77 @@
 #include "core/IComponent.h"
 #include "voxel/RawVolume.h"
 #include "core/collection/StringMap.h"
+#include "core/collection/DynamicArray.h"
 #include <memory>
+#include <future>
 #include "core/concurrent/Lock.h"
 #include "core/Trace.h"
 
 namespace voxelformat {
 
+using RawVolumePtr = std::shared_ptr<voxel::RawVolume>;
+
 /**
  * @brief Caches @c voxel::RawVolume instances by their name
+ *
+ * Concurrent requests for a volume that is not yet cached are coalesced - only the first caller loads the
+ * volume, the others wait for the result. The cache has a budget in bytes - if it is exceeded, the least
+ * recently used volumes are evicted. Evicted volumes stay alive as long as they are referenced by a caller.
+ *
  * @note The cache is threadsafe
  * @sa MeshCache
  */
 class VolumeCache : public core::IComponent {
 private:
-	core::StringMap<voxel::RawVolume*> _volumes core_thread_guarded_by(_mutex);
+	struct Entry {
+		RawVolumePtr volume;
+		size_t bytes = 0u;
+		uint64_t lastAccess = 0u;
+	};
+	core::StringMap<Entry> _volumes core_thread_guarded_by(_mutex);
+	// the volumes that are currently loaded by another thread
+	core::StringMap<std::shared_future<RawVolumePtr>> _loading core_thread_guarded_by(_mutex);
+	size_t _bytes core_thread_guarded_by(_mutex) = 0u;
+	size_t _maxBytes core_thread_guarded_by(_mutex);
+	uint64_t _accessCounter core_thread_guarded_by(_mutex) = 0u;
 	core_trace_mutex(core::Lock, _mutex, "VolumeCache");
+
+	static RawVolumePtr load(const core::String &fullPath, bool& cache);
+	void evict(const core::String &keep) core_thread_requires(_mutex);
 public:
+	static constexpr size_t DefaultMaxBytes = 256u * 1024u * 1024u;
+
+	VolumeCache(size_t maxBytes = DefaultMaxBytes);
 	~VolumeCache();
 	/**
-	 * The returned volume is not owned by the caller. The cache will delete the memory.
+	 * The returned volume is shared with the cache - it stays valid even if it is evicted from the cache.
 	 */
-	voxel::RawVolume* loadVolume(const core::String &fullPath);
+	RawVolumePtr loadVolume(const core::String &fullPath);
 	/**
-	 * Remove the volume with the given path from the cache - and free the memory of the volume.
-	 *
-	 * @sa removeVolume(path)
+	 * @brief Loads the given volumes in parallel on the thread pool of the application and returns once all of
+	 * them were loaded.
+	 * @return @c true if all volumes were loaded
 	 */
-	bool deleteVolume(const char* fullPath);
+	bool preload(const core::DynamicArray<core::String> &fullPaths);
 	/**
-	 * Remove the volume with the given path from the cache - but don't delete it here.
-	 * It is the caller's responsibily to properly delete the volume pointer.
-	 *
-	 * @sa deleteVolume(path)
+	 * Remove the volume with the given path from the cache. The memory is freed once the volume isn't
+	 * referenced anymore.
 	 */
 	bool removeVolume(const char* fullPath);
 
+	/**
+	 * @brief The budget of the cache in bytes. The least recently used volumes are evicted if this is exceeded.
+	 */
+	void setMaxBytes(size_t maxBytes);
+	/**
+	 * @return The amount of bytes of all cached volumes
+	 */
+	size_t bytes() const;
+	/**
+	 * @return The amount of cached volumes
+	 */
+	size_t size() const;
+
 	bool init() override;
 	void shutdown() override;
 	void construct() override;
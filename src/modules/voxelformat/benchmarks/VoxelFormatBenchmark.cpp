@@ -0,0 +1,104 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/BinVoxFormat.h"
+#include "voxelformat/QBTFormat.h"
+#include "voxelformat/VXLFormat.h"
+#include "voxelformat/VXMFormat.h"
+#include "voxelformat/VoxFormat.h"
+
+class VoxelFormatBenchmark : public app::AbstractBenchmark {
+protected:
+	void load(benchmark::State &state, const char *filename, voxel::VoxFileFormat &format) {
+		const io::FilePtr& file = io::filesystem()->open(filename);
+		if (!file->exists()) {
+			state.SkipWithError("Could not open the file");
+			return;
+		}
+		for (auto _ : state) {
+			file->seek(0, RW_SEEK_SET);
+			voxel::RawVolume *volume = format.load(file);
+			if (volume == nullptr) {
+				state.SkipWithError("Could not load the file");
+				return;
+			}
+			delete volume;
+		}
+		state.SetBytesProcessed(state.iterations() * file->length());
+	}
+
+	/**
+	 * @brief Reads the whole file primitive by primitive like the format loaders do
+	 */
+	void readStream(benchmark::State &state, const char *filename) {
+		const io::FilePtr& file = io::filesystem()->open(filename);
+		if (!file->exists()) {
+			state.SkipWithError("Could not open the file");
+			return;
+		}
+		const size_t readBufferSize = (size_t)state.range(0);
+		for (auto _ : state) {
+			io::FileStream stream(file, readBufferSize);
+			uint32_t sum = 0u;
+			while (stream.remaining() >= 4) {
+				uint8_t b;
+				uint16_t s;
+				stream.readByte(b);
+				stream.readShort(s);
+				stream.readByte(b);
+				sum += b + s;
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+		state.SetBytesProcessed(state.iterations() * file->length());
+	}
+
+public:
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, StreamRead)(benchmark::State &state) {
+	readStream(state, "cc.vxl");
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadVXL)(benchmark::State &state) {
+	voxel::VXLFormat format;
+	load(state, "cc.vxl", format);
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadVox)(benchmark::State &state) {
+	voxel::VoxFormat format;
+	load(state, "magicavoxel.vox", format);
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadQBT)(benchmark::State &state) {
+	voxel::QBTFormat format;
+	load(state, "qubicle.qbt", format);
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadBinVox)(benchmark::State &state) {
+	voxel::BinVoxFormat format;
+	load(state, "test.binvox", format);
+}
+
+BENCHMARK_DEFINE_F(VoxelFormatBenchmark, LoadVXM)(benchmark::State &state) {
+	voxel::VXMFormat format;
+	load(state, "test2.vxm", format);
+}
+
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, StreamRead)->Arg(0)->Arg(io::FileStream::DefaultReadBufferSize);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadVXL);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadVox);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadQBT);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadBinVox);
+BENCHMARK_REGISTER_F(VoxelFormatBenchmark, LoadVXM);
+
+BENCHMARK_MAIN();
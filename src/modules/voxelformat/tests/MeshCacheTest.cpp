@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxFormatTest.h"
+#include "voxelformat/MeshCache.h"
+#include "core/FourCC.h"
+
+namespace voxel {
+
+class MeshCacheTest: public AbstractVoxFormatTest {
+protected:
+	class TestMeshCache : public voxelformat::MeshCache {
+	public:
+		using voxelformat::MeshCache::binaryPath;
+	};
+
+	static constexpr const char *Model = "magicavoxel";
+
+	void removeBinaryMesh() {
+		const io::FilesystemPtr& fs = _testApp->filesystem();
+		fs->removeFile(fs->writePath(TestMeshCache::binaryPath(Model).c_str()));
+	}
+
+	void TearDown() override {
+		removeBinaryMesh();
+		AbstractVoxFormatTest::TearDown();
+	}
+};
+
+TEST_F(MeshCacheTest, testBinaryMesh) {
+	removeBinaryMesh();
+	TestMeshCache cache;
+	ASSERT_TRUE(cache.init());
+	const Mesh* mesh = cache.getMesh(Model);
+	ASSERT_NE(nullptr, mesh);
+	ASSERT_GT(mesh->getNoOfVertices(), 0u);
+	const io::FilesystemPtr& fs = _testApp->filesystem();
+	ASSERT_TRUE(fs->exists(TestMeshCache::binaryPath(Model)));
+
+	TestMeshCache warm;
+	ASSERT_TRUE(warm.init());
+	const Mesh* binaryMesh = warm.getMesh(Model);
+	ASSERT_NE(nullptr, binaryMesh);
+	ASSERT_EQ(mesh->getNoOfVertices(), binaryMesh->getNoOfVertices());
+	ASSERT_EQ(mesh->getNoOfIndices(), binaryMesh->getNoOfIndices());
+	EXPECT_EQ(mesh->getOffset(), binaryMesh->getOffset());
+	for (size_t i = 0; i < mesh->getNoOfVertices(); ++i) {
+		const VoxelVertex& expected = mesh->getVertex((IndexType)i);
+		const VoxelVertex& actual = binaryMesh->getVertex((IndexType)i);
+		ASSERT_EQ(expected.position, actual.position) << "vertex " << i;
+		ASSERT_EQ(expected.info, actual.info) << "vertex " << i;
+		ASSERT_EQ(expected.colorIndex, actual.colorIndex) << "vertex " << i;
+	}
+	for (size_t i = 0; i < mesh->getNoOfIndices(); ++i) {
+		ASSERT_EQ(mesh->getIndex((IndexType)i), binaryMesh->getIndex((IndexType)i)) << "index " << i;
+	}
+	warm.shutdown();
+	cache.shutdown();
+}
+
+TEST_F(MeshCacheTest, testInvalidBinaryMesh) {
+	const io::FilesystemPtr& fs = _testApp->filesystem();
+	const core::String& path = TestMeshCache::binaryPath(Model);
+	const uint8_t garbage[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	ASSERT_TRUE(fs->write(path, garbage, sizeof(garbage)));
+
+	TestMeshCache cache;
+	ASSERT_TRUE(cache.init());
+	const Mesh* mesh = cache.getMesh(Model);
+	ASSERT_NE(nullptr, mesh);
+	EXPECT_GT(mesh->getNoOfVertices(), 0u);
+	cache.shutdown();
+
+	// the binary mesh was rebuilt
+	const io::FilePtr& file = fs->open(path);
+	ASSERT_TRUE(file->exists());
+	uint32_t magic = 0u;
+	ASSERT_EQ(1, file->read(&magic, sizeof(magic), 1));
+	EXPECT_EQ(FourCC('V','M','S','H'), magic);
+}
+
+}
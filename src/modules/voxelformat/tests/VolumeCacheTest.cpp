@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxFormatTest.h"
+#include "voxelformat/VolumeCache.h"
+#include "core/concurrent/ThreadPool.h"
+#include <future>
+#include <vector>
+
+namespace voxel {
+
+class VolumeCacheTest: public AbstractVoxFormatTest {
+};
+
+TEST_F(VolumeCacheTest, testConcurrentLoad) {
+	voxelformat::VolumeCache cache;
+	ASSERT_TRUE(cache.init());
+	const int threadCount = 4;
+	voxelformat::RawVolumePtr volumes[threadCount];
+	core::ThreadPool pool(threadCount, "VolumeCacheTest");
+	pool.init();
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < threadCount; ++i) {
+		futures.push_back(pool.enqueue([&cache, &volumes, i] () {
+			volumes[i] = cache.loadVolume("magicavoxel");
+		}));
+	}
+	for (std::future<void>& f : futures) {
+		f.get();
+	}
+	pool.shutdown();
+	ASSERT_TRUE(volumes[0]);
+	for (int i = 1; i < threadCount; ++i) {
+		EXPECT_EQ(volumes[0], volumes[i]) << "Each caller should get the volume of the first load";
+	}
+	EXPECT_EQ(1u, cache.size());
+	cache.shutdown();
+}
+
+TEST_F(VolumeCacheTest, testEviction) {
+	voxelformat::VolumeCache cache;
+	ASSERT_TRUE(cache.init());
+	const voxelformat::RawVolumePtr& first = cache.loadVolume("magicavoxel");
+	ASSERT_TRUE(first);
+	const size_t firstBytes = cache.bytes();
+	EXPECT_GT(firstBytes, 0u);
+	cache.setMaxBytes(firstBytes);
+	const voxelformat::RawVolumePtr& second = cache.loadVolume("qubicle");
+	ASSERT_TRUE(second);
+	EXPECT_EQ(1u, cache.size()) << "The least recently used volume should have been evicted";
+	EXPECT_EQ(second, cache.loadVolume("qubicle"));
+	// the evicted volume is still valid for the callers that reference it
+	EXPECT_TRUE(first->region().isValid());
+	cache.shutdown();
+}
+
+TEST_F(VolumeCacheTest, testPreload) {
+	voxelformat::VolumeCache cache;
+	ASSERT_TRUE(cache.init());
+	core::DynamicArray<core::String> paths;
+	paths.push_back("magicavoxel");
+	paths.push_back("qubicle");
+	EXPECT_TRUE(cache.preload(paths));
+	EXPECT_EQ(2u, cache.size());
+	paths.push_back("doesnotexist");
+	EXPECT_FALSE(cache.preload(paths));
+	cache.shutdown();
+}
+
+}
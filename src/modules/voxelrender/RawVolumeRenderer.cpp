@@ -378,13 +378,17 @@ bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
 					continue;
 				}
 
-				voxel::RawVolume copy(volume);
-				_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
+				voxel::Region reg = finalRegion;
+				reg.shiftUpperCorner(1, 1, 1);
+				// the extractor also samples the direct neighbours of the region - only these
+				// voxels are copied to not duplicate the whole volume for every mesh
+				voxel::Region snapshotRegion = reg;
+				snapshotRegion.grow(1);
+				voxel::RawVolume snapshot(*volume, snapshotRegion);
+				_threadPool.enqueue([movedSnapshot = core::move(snapshot), mins, idx, reg, this] () {
 					++_runningExtractorTasks;
-					voxel::Region reg = finalRegion;
-					reg.shiftUpperCorner(1, 1, 1);
 					voxel::Mesh mesh(65536, 65536, true);
-					voxel::extractCubicMesh(&movedCopy, reg, &mesh, raw::CustomIsQuadNeeded(), reg.getLowerCorner());
+					voxel::extractCubicMesh(&movedSnapshot, reg, &mesh, raw::CustomIsQuadNeeded(), reg.getLowerCorner());
 					_pendingQueue.emplace(mins, idx, core::move(mesh));
 					Log::debug("Enqueue mesh for idx: %i", idx);
 					--_runningExtractorTasks;
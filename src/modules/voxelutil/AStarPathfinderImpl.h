@@ -5,18 +5,15 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/Assert.h"
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
-#include <algorithm>
 #include <limits> //For numeric_limits
-#include <set>
+#include <stdint.h>
 #include <vector>
 
 namespace voxel {
 
-class OpenNodesContainer;
-class ClosedNodesContainer;
-
 /// The Connectivity of a voxel determines how many neighbours it has.
 enum Connectivity {
 	/// Each voxel has six neighbours, which are those sharing a face.
@@ -27,137 +24,147 @@ enum Connectivity {
 	TwentySixConnected
 };
 
+/**
+ * @brief A node of the search. The nodes are pooled in one array and reference each other by their index
+ * in this array.
+ */
 struct Node {
-	Node(int x, int y, int z) :
-			// Initialise with NaNs so that we will know if we forget to set these properly.
-			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()), parent(nullptr) {
-		position = {x, y, z};
-	}
-
-	bool operator==(const Node& rhs) const {
-		return position == rhs.position;
-	}
-
-	bool operator<(const Node& rhs) const {
-		if (position.x < rhs.position.x)
-			return true;
-		if (rhs.position.x < position.x)
-			return false;
-
-		if (position.y < rhs.position.y)
-			return true;
-		if (rhs.position.y < position.y)
-			return false;
-
-		if (position.z < rhs.position.z)
-			return true;
-		if (rhs.position.z < position.z)
-			return false;
-
-		return false;
+	Node(const glm::ivec3& pos) :
+			position(pos),
+			// Not reached yet - any path to this node is cheaper
+			gVal(std::numeric_limits<float>::max()), hVal(0.0f) {
 	}
 
 	glm::ivec3 position;
 	float gVal;
 	float hVal;
-	Node* parent;
+	/// The index of the parent node or @c -1
+	int32_t parent = -1;
+	bool closed = false;
 
 	inline float f() const {
 		return gVal + hVal;
 	}
 };
 
-typedef std::set<Node> AllNodesContainer;
-
-class AllNodesContainerIteratorComparator {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return (&(*lhs)) < (&(*rhs));
-	}
-};
-
-class NodeSort {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return lhs->f() > rhs->f();
-	}
-};
-
+/**
+ * @brief Binary min heap of node indices.
+ *
+ * The heap position of each node is tracked - this allows to check whether a node is part of the open set
+ * and to decrease its key in O(log n) without searching the node in the heap. The node indices are expected
+ * to be dense (e.g. the indices of a node pool).
+ */
 class OpenNodesContainer {
-public:
-	typedef std::vector<AllNodesContainer::iterator>::iterator iterator;
+private:
+	struct Entry {
+		float f;
+		int32_t node;
+	};
+	std::vector<Entry> _heap;
+	// the heap position for each node index or -1 if the node is not in the heap
+	std::vector<int32_t> _positions;
+
+	inline void place(int32_t pos, const Entry& entry) {
+		_heap[pos] = entry;
+		_positions[entry.node] = pos;
+	}
+
+	void siftUp(int32_t pos) {
+		const Entry entry = _heap[pos];
+		while (pos > 0) {
+			const int32_t parent = (pos - 1) / 2;
+			if (_heap[parent].f <= entry.f) {
+				break;
+			}
+			place(pos, _heap[parent]);
+			pos = parent;
+		}
+		place(pos, entry);
+	}
+
+	void siftDown(int32_t pos) {
+		const Entry entry = _heap[pos];
+		const int32_t size = (int32_t)_heap.size();
+		for (;;) {
+			int32_t child = pos * 2 + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && _heap[child + 1].f < _heap[child].f) {
+				++child;
+			}
+			if (entry.f <= _heap[child].f) {
+				break;
+			}
+			place(pos, _heap[child]);
+			pos = child;
+		}
+		place(pos, entry);
+	}
 
 public:
-	inline void clear() {
-		open.clear();
+	/**
+	 * @brief Removes all nodes but keeps the memory
+	 */
+	void clear() {
+		for (const Entry& entry : _heap) {
+			_positions[entry.node] = -1;
+		}
+		_heap.clear();
 	}
 
 	inline bool empty() const {
-		return open.empty();
+		return _heap.empty();
 	}
 
-	void insert(AllNodesContainer::iterator node) {
-		open.push_back(node);
-		push_heap(open.begin(), open.end(), NodeSort());
+	inline size_t size() const {
+		return _heap.size();
 	}
 
-	inline AllNodesContainer::iterator getFirst() {
-		return open[0];
+	inline bool contains(int32_t node) const {
+		return node < (int32_t)_positions.size() && _positions[node] != -1;
 	}
 
-	void removeFirst() {
-		pop_heap(open.begin(), open.end(), NodeSort());
-		open.pop_back();
-	}
-
-	void remove(iterator iterToRemove) {
-		open.erase(iterToRemove);
-		make_heap(open.begin(), open.end(), NodeSort());
-	}
-
-	inline iterator begin() {
-		return open.begin();
-	}
-
-	inline iterator end() {
-		return open.end();
-	}
-
-	iterator find(AllNodesContainer::iterator node) {
-		return std::find(open.begin(), open.end(), node);
-	}
-
-private:
-	std::vector<AllNodesContainer::iterator> open;
-};
-
-class ClosedNodesContainer {
-public:
-	typedef std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator>::iterator iterator;
-
-public:
-	inline void clear() {
-		closed.clear();
-	}
-
-	inline void insert(AllNodesContainer::iterator node) {
-		closed.insert(node);
-	}
-
-	inline void remove(iterator iterToRemove) {
-		closed.erase(iterToRemove);
+	/**
+	 * @brief Adds the node or updates its key if it's already in the heap
+	 */
+	void insert(int32_t node, float f) {
+		if (node >= (int32_t)_positions.size()) {
+			_positions.resize(node + 1, -1);
+		}
+		const int32_t pos = _positions[node];
+		if (pos != -1) {
+			const float old = _heap[pos].f;
+			_heap[pos].f = f;
+			if (f < old) {
+				siftUp(pos);
+			} else {
+				siftDown(pos);
+			}
+			return;
+		}
+		_heap.push_back(Entry{f, node});
+		siftUp((int32_t)_heap.size() - 1);
 	}
 
-	inline iterator end() {
-		return closed.end();
+	/**
+	 * @return The node with the lowest key
+	 */
+	inline int32_t getFirst() const {
+		core_assert(!_heap.empty());
+		return _heap[0].node;
 	}
 
-	inline iterator find(AllNodesContainer::iterator node) {
-		return closed.find(node);
+	void removeFirst() {
+		core_assert(!_heap.empty());
+		_positions[_heap[0].node] = -1;
+		const Entry last = _heap.back();
+		_heap.pop_back();
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			siftDown(0);
+		}
 	}
-
-private:
-	std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator> closed;
 };
 
 }
@@ -39,6 +39,8 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
 
 				float solidVoxels = 0.0f;
+				// the palette lookup is expensive - it can be skipped if all children share the same color
+				int uniformColor = -1;
 				float avgOf8Red = 0.0f;
 				float avgOf8Green = 0.0f;
 				float avgOf8Blue = 0.0f;
@@ -52,6 +54,11 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 							const Voxel& child = srcSampler.voxel();
 
 							if (isBlocked(child.getMaterial())) {
+								if (solidVoxels <= 0.0f) {
+									uniformColor = child.getColor();
+								} else if (uniformColor != child.getColor()) {
+									uniformColor = -1;
+								}
 								++solidVoxels;
 								const glm::vec4& color = colors[child.getColor()];
 								avgOf8Red += color.r;
@@ -65,8 +72,11 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 				// We only make a voxel solid if the eight corresponding voxels are also all solid. This
 				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
 				if (solidVoxels >= 7.0f) {
-					const glm::vec4 avgColor(avgOf8Red / solidVoxels, avgOf8Green / solidVoxels, avgOf8Blue / solidVoxels, 1.0f);
-					const int index = core::Color::getClosestMatch(avgColor, colors);
+					int index = uniformColor;
+					if (index < 0) {
+						const glm::vec4 avgColor(avgOf8Red / solidVoxels, avgOf8Green / solidVoxels, avgOf8Blue / solidVoxels, 1.0f);
+						index = core::Color::getClosestMatch(avgColor, colors);
+					}
 					Voxel voxel = createVoxel(VoxelType::Generic, index);
 					destVolume.setVoxel(dstPos, voxel);
 				} else {
@@ -108,6 +118,8 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 				float totalGreen = 0.0f;
 				float totalBlue = 0.0f;
 				float totalExposedFaces = 0.0f;
+				int uniformColor = -1;
+				bool uniform = true;
 
 				// Look at the 64 (4x4x4) children
 				for (int32_t childZ = -1; childZ < 3; childZ++) {
@@ -142,6 +154,14 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 								++exposedFaces;
 							}
 
+							if (exposedFaces > 0.0f) {
+								if (uniformColor < 0) {
+									uniformColor = child.getColor();
+								} else if (uniformColor != child.getColor()) {
+									uniform = false;
+								}
+							}
+
 							const glm::vec4& color = colors[child.getColor()];
 							totalRed += color.r * exposedFaces;
 							totalGreen += color.g * exposedFaces;
@@ -157,8 +177,11 @@ void rescaleVolume(const SourceVolume& sourceVolume, const Region& sourceRegion,
 					++totalExposedFaces;
 				}
 
-				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
-				const int index = core::Color::getClosestMatch(avgColor, colors);
+				int index = uniformColor;
+				if (!uniform || index < 0) {
+					const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
+					index = core::Color::getClosestMatch(avgColor, colors);
+				}
 				const Voxel voxel = createVoxel(VoxelType::Generic, index);
 				destVolume.setVoxel(dstPos, voxel);
 			}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ */
+
+#include "voxel/tests/AbstractVoxelTest.h"
+#include "voxelutil/AStarPathfinder.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class AStarPathfinderTest: public AbstractVoxelTest {
+};
+
+TEST_F(AStarPathfinderTest, testStraightPath) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	std::vector<glm::ivec3> result;
+	AStarPathfinderParams<voxel::RawVolume> params(&volume, glm::ivec3(0), glm::ivec3(10, 0, 0), &result, 1.0f, 10000, SixConnected);
+	AStarPathfinder<voxel::RawVolume> pathfinder(params);
+	ASSERT_TRUE(pathfinder.execute());
+	ASSERT_EQ(11u, result.size());
+	EXPECT_EQ(glm::ivec3(0), result.front());
+	EXPECT_EQ(glm::ivec3(10, 0, 0), result.back());
+}
+
+TEST_F(AStarPathfinderTest, testPathAroundWall) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	// a wall on the x axis with a gap at z = 15
+	for (int y = 0; y <= 15; ++y) {
+		for (int z = 0; z < 15; ++z) {
+			volume.setVoxel(8, y, z, createVoxel(VoxelType::Dirt, 0));
+		}
+	}
+	auto validator = [] (const voxel::RawVolume* v, const glm::ivec3& pos) {
+		return v->region().containsPoint(pos) && isAir(v->voxel(pos).getMaterial());
+	};
+	std::vector<glm::ivec3> result;
+	AStarPathfinderParams<voxel::RawVolume, decltype(validator)> params(&volume, glm::ivec3(0), glm::ivec3(15, 0, 0), &result, 1.0f, 10000,
+			SixConnected, validator);
+	AStarPathfinder<voxel::RawVolume, decltype(validator)> pathfinder(params);
+	ASSERT_TRUE(pathfinder.execute());
+	// to the gap and back
+	EXPECT_EQ(15u + 15u + 15u + 1u, result.size());
+	for (size_t i = 1; i < result.size(); ++i) {
+		EXPECT_TRUE(isAir(volume.voxel(result[i]).getMaterial()));
+		const glm::ivec3& d = glm::abs(result[i] - result[i - 1]);
+		EXPECT_EQ(1, d.x + d.y + d.z);
+	}
+
+	// close the gap
+	for (int y = 0; y <= 15; ++y) {
+		volume.setVoxel(8, y, 15, createVoxel(VoxelType::Dirt, 0));
+	}
+	EXPECT_FALSE(pathfinder.execute());
+	EXPECT_TRUE(result.empty());
+}
+
+}
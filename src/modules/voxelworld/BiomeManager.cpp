@@ -41,11 +41,13 @@ void BiomeManager::shutdown() {
 		delete biome;
 	}
 	_biomes.clear();
+	_biomeLookupDirty = true;
 	for (int i = 0; i < core::enumVal(ZoneType::Max); ++i) {
 		for (const Zone* zone : _zones[i]) {
 			delete zone;
 		}
 		_zones[i].clear();
+		_zoneGrid[i].clear();
 	}
 }
 
@@ -96,6 +98,7 @@ Biome* BiomeManager::addBiome(int lower, int upper, float humidity, float temper
 	Biome* biome = new Biome(type, int16_t(lower), int16_t(upper),
 			humidity, temperature, underGround, treeDistribution);
 	_biomes.push_back(biome);
+	_biomeLookupDirty = true;
 	return biome;
 }
 
@@ -117,6 +120,104 @@ float BiomeManager::getTemperature(int x, int z) {
 	return noise::norm(n);
 }
 
+void BiomeManager::updateBiomeLookup() const {
+	core::ScopedLock lock(_biomeLookupLock);
+	if (!_biomeLookupDirty) {
+		return;
+	}
+	core_trace_scoped(BiomeUpdateLookup);
+	// a new band starts at each height where a biome starts or ends
+	bool bandStart[voxel::MAX_HEIGHT + 1] = {};
+	bandStart[0] = true;
+	for (const Biome* biome : _biomes) {
+		if (biome->yMin >= 0 && biome->yMin <= voxel::MAX_HEIGHT) {
+			bandStart[biome->yMin] = true;
+		}
+		if (biome->yMax + 1 >= 0 && biome->yMax + 1 <= voxel::MAX_HEIGHT) {
+			bandStart[biome->yMax + 1] = true;
+		}
+	}
+
+	const int res = BiomeLookupResolution;
+	const float step = 1.0f / (float)res;
+	_biomeBands.resize(voxel::MAX_HEIGHT + 1);
+	_biomeCells.clear();
+	_biomeCandidates.clear();
+	std::vector<const Biome*> biomes;
+	std::vector<float> minDistances;
+	int band = -1;
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		if (!bandStart[y]) {
+			_biomeBands[y] = band;
+			continue;
+		}
+		_biomeBands[y] = ++band;
+		for (int underground = 0; underground <= 1; ++underground) {
+			biomes.clear();
+			for (const Biome* biome : _biomes) {
+				if (y > biome->yMax || y < biome->yMin || biome->underground != (underground != 0)) {
+					continue;
+				}
+				biomes.push_back(biome);
+			}
+			minDistances.resize(biomes.size());
+			for (int hi = 0; hi < res; ++hi) {
+				const float h0 = (float)hi * step;
+				const float h1 = h0 + step;
+				for (int ti = 0; ti < res; ++ti) {
+					const float t0 = (float)ti * step;
+					const float t1 = t0 + step;
+					// the best match for any position in the cell is not farther away than the smallest of the
+					// maximal distances - only the biomes that might come closer than that are candidates
+					float bound = (std::numeric_limits<float>::max)();
+					for (size_t i = 0; i < biomes.size(); ++i) {
+						const Biome* biome = biomes[i];
+						const float nearH = glm::clamp(biome->humidity, h0, h1) - biome->humidity;
+						const float nearT = glm::clamp(biome->temperature, t0, t1) - biome->temperature;
+						const float farH = core_max(glm::abs(biome->humidity - h0), glm::abs(biome->humidity - h1));
+						const float farT = core_max(glm::abs(biome->temperature - t0), glm::abs(biome->temperature - t1));
+						minDistances[i] = nearH * nearH + nearT * nearT;
+						bound = core_min(bound, farH * farH + farT * farT);
+					}
+					BiomeCell cell;
+					cell.offset = (uint32_t)_biomeCandidates.size();
+					for (size_t i = 0; i < biomes.size(); ++i) {
+						if (minDistances[i] <= bound + glm::epsilon<float>()) {
+							_biomeCandidates.push_back(biomes[i]);
+						}
+					}
+					cell.count = (uint32_t)_biomeCandidates.size() - cell.offset;
+					_biomeCells.push_back(cell);
+				}
+			}
+		}
+	}
+	_biomeLookupDirty = false;
+}
+
+const Biome* BiomeManager::getBiomeFromLookup(int y, float humidity, float temperature, bool underground) const {
+	const int res = BiomeLookupResolution;
+	const int hi = core_min((int)(humidity * (float)res), res - 1);
+	const int ti = core_min((int)(temperature * (float)res), res - 1);
+	const int band = _biomeBands[y];
+	const BiomeCell& cell = _biomeCells[((band * 2 + (underground ? 1 : 0)) * res + hi) * res + ti];
+
+	const Biome *biomeBestMatch = _defaultBiome;
+	float distMin = (std::numeric_limits<float>::max)();
+	const Biome* const* candidates = _biomeCandidates.data() + cell.offset;
+	for (uint32_t i = 0u; i < cell.count; ++i) {
+		const Biome* biome = candidates[i];
+		const float dTemperature = temperature - biome->temperature;
+		const float dHumidity = humidity - biome->humidity;
+		const float dist = (dTemperature * dTemperature) + (dHumidity * dHumidity);
+		if (dist < distMin) {
+			biomeBestMatch = biome;
+			distMin = dist;
+		}
+	}
+	return biomeBestMatch;
+}
+
 const Biome* BiomeManager::getBiome(const glm::ivec3& pos, bool underground) const {
 	core_assert_msg(_defaultBiome != nullptr, "BiomeManager is not yet initialized");
 	core_trace_scoped(BiomeGetBiome);
@@ -142,6 +243,14 @@ const Biome* BiomeManager::getBiome(const glm::ivec3& pos, bool underground) con
 		last.underground = underground;
 	}
 
+	if (_biomeLookupDirty) {
+		updateBiomeLookup();
+	}
+	if (pos.y >= 0 && pos.y <= voxel::MAX_HEIGHT && humidity >= 0.0f && humidity <= 1.0f && temperature >= 0.0f
+			&& temperature <= 1.0f) {
+		return getBiomeFromLookup(pos.y, humidity, temperature, underground);
+	}
+
 	const Biome *biomeBestMatch = _defaultBiome;
 	float distMin = (std::numeric_limits<float>::max)();
 
@@ -263,12 +372,37 @@ int BiomeManager::getCityDensity(const glm::ivec2& pos) const {
 	return 0;
 }
 
+glm::ivec2 BiomeManager::zoneCell(int x, int z) {
+	return glm::ivec2(glm::floor(glm::vec2(x, z) / (float)ZoneCellSize));
+}
+
 void BiomeManager::addZone(const glm::ivec3& pos, float radius, ZoneType type) {
-	_zones[core::enumVal(type)].push_back(new Zone(pos, radius, type));
+	Zone* zone = new Zone(pos, radius, type);
+	_zones[core::enumVal(type)].push_back(zone);
+	ZoneGrid& grid = _zoneGrid[core::enumVal(type)];
+	const int r = (int)glm::ceil(radius);
+	const glm::ivec2& mins = zoneCell(pos.x - r, pos.z - r);
+	const glm::ivec2& maxs = zoneCell(pos.x + r, pos.z + r);
+	for (int z = mins.y; z <= maxs.y; ++z) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			const glm::ivec2 cell(x, z);
+			auto iter = grid.find(cell);
+			if (iter == grid.end()) {
+				grid.put(cell, std::vector<const Zone*>{zone});
+			} else {
+				iter->value.push_back(zone);
+			}
+		}
+	}
 }
 
 const Zone* BiomeManager::getZone(const glm::ivec3& pos, ZoneType type) const {
-	for (const Zone* z : _zones[core::enumVal(type)]) {
+	const ZoneGrid& grid = _zoneGrid[core::enumVal(type)];
+	auto iter = grid.find(zoneCell(pos.x, pos.z));
+	if (iter == grid.end()) {
+		return nullptr;
+	}
+	for (const Zone* z : iter->value) {
 		const float distance = glm::distance2(glm::vec3(pos), glm::vec3(z->pos()));
 		if (distance < glm::pow(z->radius(), 2)) {
 			return z;
@@ -278,8 +412,13 @@ const Zone* BiomeManager::getZone(const glm::ivec3& pos, ZoneType type) const {
 }
 
 const Zone* BiomeManager::getZone(const glm::ivec2& pos, ZoneType type) const {
+	const ZoneGrid& grid = _zoneGrid[core::enumVal(type)];
+	auto iter = grid.find(zoneCell(pos.x, pos.y));
+	if (iter == grid.end()) {
+		return nullptr;
+	}
 	const glm::vec3 p(pos.x, 0.0f, pos.y);
-	for (const Zone* z : _zones[core::enumVal(type)]) {
+	for (const Zone* z : iter->value) {
 		const glm::ivec3& zp = z->pos();
 		const float distance = glm::distance2(p, glm::vec3(zp.x, 0.0f, zp.z));
 		if (distance < glm::pow(z->radius(), 2)) {
@@ -5,6 +5,10 @@
 #pragma once
 
 #include "core/Trace.h"
+#include "core/GLM.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
 #include "Biome.h"
 #include "noise/Noise.h"
 #include <glm/fwd.hpp>
@@ -59,10 +63,40 @@ class BiomeManager {
 private:
 	std::vector<Biome*> _biomes;
 	std::vector<Zone*> _zones[int(ZoneType::Max)];
+
+	/**
+	 * @brief The size of the cells of the zone grid in voxels
+	 */
+	static constexpr int ZoneCellSize = 256;
+	typedef core::Map<glm::ivec2, std::vector<const Zone*>, 64, glm::hash<glm::ivec2>> ZoneGrid;
+	// each zone is registered in all cells that are touched by its radius - in the order the zones were added
+	ZoneGrid _zoneGrid[int(ZoneType::Max)];
+
+	/**
+	 * @brief The amount of humidity and temperature steps of the biome lookup table
+	 */
+	static constexpr int BiomeLookupResolution = 32;
+	struct BiomeCell {
+		uint32_t offset = 0u;
+		uint32_t count = 0u;
+	};
+	// the heights are grouped into bands - all heights of a band share the same set of biomes
+	mutable std::vector<int> _biomeBands;
+	// the cells of the lookup table per band, underground flag, humidity and temperature
+	mutable std::vector<BiomeCell> _biomeCells;
+	// the biomes that might be the best match somewhere in a cell
+	mutable std::vector<const Biome*> _biomeCandidates;
+	mutable core::AtomicBool _biomeLookupDirty { true };
+	core_trace_mutex(core::Lock, _biomeLookupLock, "BiomeLookup");
+
 	const Biome* _defaultBiome = nullptr;
 	static void distributePointsInRegion(const voxel::Region& region, std::vector<glm::vec2>& positions, math::Random& random, int border, float distribution);
 	noise::Noise _noise;
 
+	void updateBiomeLookup() const;
+	const Biome* getBiomeFromLookup(int y, float humidity, float temperature, bool underground) const;
+	static glm::ivec2 zoneCell(int x, int z);
+
 public:
 	BiomeManager();
 	~BiomeManager();
@@ -9,36 +9,56 @@
 #include "core/Enum.h"
 #include "core/Trace.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
 
 namespace voxelworld {
 
-#define WORLD_FILE_VERSION 2
+// version 3 stores the chunk storage type - see voxel::PagedVolume::ChunkStorage
+#define WORLD_FILE_VERSION 3
 
-bool ChunkPersister::saveCompressed(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& outStream) const {
-	// save the stuff
-	const voxel::Voxel* voxelBuf = chunk->data();
-	const int voxelSize = chunk->dataSizeInBytes();
-	uint32_t neededVoxelBufLen = core::zip::compressBound(voxelSize);
-	uint8_t* compressedVoxelBuf = new uint8_t[neededVoxelBufLen];
-	std::unique_ptr<uint8_t[]> smartBuf(compressedVoxelBuf);
+static bool compress(const uint8_t* buf, int size, core::ByteStream& outStream) {
+	uint32_t neededBufLen = core::zip::compressBound(size);
+	uint8_t* compressedBuf = new uint8_t[neededBufLen];
+	std::unique_ptr<uint8_t[]> smartBuf(compressedBuf);
 	size_t finalBufferSize;
 	{
 		core_trace_scoped(ChunkPersisterCompress);
-		const bool success = core::zip::compress((const uint8_t*)voxelBuf, voxelSize, compressedVoxelBuf, neededVoxelBufLen, &finalBufferSize);
+		const bool success = core::zip::compress(buf, size, compressedBuf, neededBufLen, &finalBufferSize);
 		if (!success) {
 			Log::error("Failed to compress the voxel data");
 			return false;
 		}
 	}
-	{
-		core_trace_scoped(ChunkPersisterSaveCompressed);
-		outStream.addInt(voxelSize);
-		outStream.addByte(WORLD_FILE_VERSION);
-		outStream.append(compressedVoxelBuf, finalBufferSize);
-	}
+	outStream.append(compressedBuf, finalBufferSize);
 	return true;
 }
 
+bool ChunkPersister::saveCompressed(const voxel::PagedVolume::ChunkPtr& chunk, core::ByteStream& outStream) const {
+	core_trace_scoped(ChunkPersisterSaveCompressed);
+	const int voxelSize = chunk->dataSizeInBytes();
+	const voxel::PagedVolume::ChunkStorage storage = chunk->storage();
+	outStream.addInt(voxelSize);
+	outStream.addByte(WORLD_FILE_VERSION);
+	outStream.addByte((uint8_t)storage);
+	switch (storage) {
+	case voxel::PagedVolume::ChunkStorage::Uniform: {
+		const voxel::Voxel& voxel = chunk->voxelByIndex(0);
+		outStream.append((const uint8_t*)&voxel, sizeof(voxel));
+		return true;
+	}
+	case voxel::PagedVolume::ChunkStorage::Palette: {
+		const int paletteSize = chunk->paletteSize();
+		outStream.addByte((uint8_t)paletteSize);
+		outStream.append((const uint8_t*)chunk->palette(), paletteSize * sizeof(voxel::Voxel));
+		return compress(chunk->paletteIndices(), (int)chunk->paletteIndicesSizeInBytes(), outStream);
+	}
+	case voxel::PagedVolume::ChunkStorage::Dense:
+		break;
+	}
+	// TODO: doesn't work on big endian
+	return compress((const uint8_t*)chunk->data(), voxelSize, outStream);
+}
+
 bool ChunkPersister::loadCompressed(const voxel::PagedVolume::ChunkPtr& chunk, const uint8_t *fileBuf, size_t fileLen) const {
 	core_trace_scoped(ChunkPersisterLoadCompressed);
 	const size_t headerSize = sizeof(int32_t) + sizeof(uint8_t);
@@ -50,7 +70,8 @@ bool ChunkPersister::loadCompressed(const voxel::PagedVolume::ChunkPtr& chunk, c
 	const int len = bs.readInt();
 	const int version = bs.readByte();
 
-	if (version != WORLD_FILE_VERSION) {
+	// version 2 only knows about dense chunks
+	if (version != WORLD_FILE_VERSION && version != 2) {
 		Log::warn("chunk has a wrong version number %i (expected %i)",
 				version, WORLD_FILE_VERSION);
 		return false;
@@ -61,7 +82,58 @@ bool ChunkPersister::loadCompressed(const voxel::PagedVolume::ChunkPtr& chunk, c
 		return false;
 	}
 	const uint8_t* buf = fileBuf + headerSize;
-	const size_t remaining = fileLen - headerSize;
+	size_t remaining = fileLen - headerSize;
+
+	voxel::PagedVolume::ChunkStorage storage = voxel::PagedVolume::ChunkStorage::Dense;
+	if (version == WORLD_FILE_VERSION) {
+		storage = (voxel::PagedVolume::ChunkStorage)*buf;
+		++buf;
+		--remaining;
+	}
+
+	switch (storage) {
+	case voxel::PagedVolume::ChunkStorage::Uniform: {
+		if (remaining < sizeof(voxel::Voxel)) {
+			Log::error("Not enough data for a uniform chunk");
+			return false;
+		}
+		voxel::Voxel voxel;
+		core_memcpy((uint8_t*)&voxel, buf, sizeof(voxel));
+		chunk->setUniform(voxel);
+		return true;
+	}
+	case voxel::PagedVolume::ChunkStorage::Palette: {
+		if (remaining < 1) {
+			return false;
+		}
+		const int paletteSize = *buf;
+		const size_t paletteBytes = paletteSize * sizeof(voxel::Voxel);
+		if (paletteSize <= 0 || paletteSize > voxel::PagedVolume::Chunk::MaxPaletteSize || remaining < 1 + paletteBytes) {
+			Log::error("Invalid palette size %i", paletteSize);
+			return false;
+		}
+		voxel::Voxel palette[voxel::PagedVolume::Chunk::MaxPaletteSize];
+		core_memcpy((uint8_t*)palette, buf + 1, paletteBytes);
+		buf += 1 + paletteBytes;
+		remaining -= 1 + paletteBytes;
+		const uint32_t indicesSize = voxel::PagedVolume::Chunk::paletteIndicesSizeInBytes(chunk->voxels(), paletteSize);
+		std::unique_ptr<uint8_t[]> indices(new uint8_t[indicesSize]);
+		if (!core::zip::uncompress(buf, remaining, indices.get(), indicesSize)) {
+			Log::error("Failed to uncompress the palette indices");
+			return false;
+		}
+		if (!chunk->setPalette(palette, paletteSize, indices.get(), indicesSize)) {
+			Log::error("Invalid palette chunk data");
+			return false;
+		}
+		return true;
+	}
+	case voxel::PagedVolume::ChunkStorage::Dense:
+		break;
+	default:
+		Log::error("Unknown chunk storage %i", (int)storage);
+		return false;
+	}
 
 	// TODO: doesn't work on big endian
 	uint8_t *targetBuf = (uint8_t*)chunk->data();
@@ -13,54 +13,102 @@
 #include "core/ByteStream.h"
 #include "core/Zip.h"
 #include "core/Log.h"
+#include <vector>
 
 namespace voxelworld {
 
-static core::String getWorldName(const glm::ivec3& chunkPos, unsigned int seed) {
-	return core::string::format("world_%u_%i_%i_%i.wld", seed, chunkPos.x, chunkPos.y, chunkPos.z);
+static core::String getRegionName(const glm::ivec3& regionPos, unsigned int seed) {
+	return core::string::format("world_%u_%i_%i_%i.wrg", seed, regionPos.x, regionPos.y, regionPos.z);
+}
+
+void FilePersister::shutdown() {
+	core::ScopedLock lock(_regionLock);
+	_regions.clear();
+}
+
+FilePersister::RegionFilePtr FilePersister::region(const glm::ivec3& chunkPos, unsigned int seed) {
+	const glm::ivec3& regionPos = RegionFile::regionPos(chunkPos);
+	core::ScopedLock lock(_regionLock);
+	if (seed != _regionSeed) {
+		_regions.clear();
+		_regionSeed = seed;
+	}
+	RegionFilePtr regionFile;
+	if (_regions.get(regionPos, regionFile)) {
+		return regionFile;
+	}
+	if ((int)_regions.size() >= MaxOpenRegions) {
+		// only this map holds a reference to these regions - no other thread can get them without the lock
+		for (auto i = _regions.begin(); i != _regions.end();) {
+			if (i->value.use_count() == 1) {
+				_regions.erase(i);
+				i = _regions.begin();
+			} else {
+				++i;
+			}
+		}
+	}
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	filesystem->createDir(filesystem->homePath());
+	const core::String& filename = filesystem->writePath(getRegionName(regionPos, seed).c_str());
+	regionFile = std::make_shared<RegionFile>();
+	if (!regionFile->open(filename)) {
+		Log::error("Failed to open region file %s", filename.c_str());
+		return RegionFilePtr();
+	}
+	_regions.put(regionPos, regionFile);
+	return regionFile;
 }
 
 void FilePersister::erase(const voxel::Region& region, unsigned int seed) {
 	core_trace_scoped(WorldPersisterErase);
-#if 0
-	voxel::PagedVolume::ChunkPtr chunk = ctx.getChunk();
-	const io::FilesystemPtr& filesystem = io::filesystem();
-	const voxel::Region& region = ctx.region;
-	const core::String& filename = getWorldName(region, seed);
-	// TODO: filesystem->remove(filename);
-#endif
+	// the region is the region of a chunk - the chunk position is derived from its lower corner
+	const int sideLength = region.getWidthInVoxels();
+	if (sideLength <= 0) {
+		return;
+	}
+	const glm::ivec3& chunkPos = glm::ivec3(glm::floor(glm::vec3(region.getLowerCorner()) / (float)sideLength));
+	const RegionFilePtr& regionFile = this->region(chunkPos, seed);
+	if (!regionFile) {
+		return;
+	}
+	if (!regionFile->erase(chunkPos)) {
+		Log::error("Failed to erase chunk %i:%i:%i from %s", chunkPos.x, chunkPos.y, chunkPos.z, regionFile->path().c_str());
+	}
 }
 
 bool FilePersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
 	core_trace_scoped(WorldPersisterLoad);
-	const io::FilesystemPtr& filesystem = io::filesystem();
-	const core::String& filename = getWorldName(chunk->chunkPos(), seed);
-	const io::FilePtr& f = filesystem->open(filename);
-	if (!f->exists()) {
+	const glm::ivec3& chunkPos = chunk->chunkPos();
+	const RegionFilePtr& regionFile = region(chunkPos, seed);
+	if (!regionFile) {
+		return false;
+	}
+	std::vector<uint8_t> buf;
+	if (!regionFile->read(chunkPos, buf)) {
 		return false;
 	}
-	Log::trace("Try to load world %s", f->name().c_str());
-	uint8_t *fileBuf;
-	const int fileLen = f->read((void **) &fileBuf);
-	const bool success = loadCompressed(chunk, fileBuf, fileLen);
-	delete[] fileBuf;
-	return success;
+	Log::trace("Loaded chunk %i:%i:%i from %s", chunkPos.x, chunkPos.y, chunkPos.z, regionFile->path().c_str());
+	return loadCompressed(chunk, buf.data(), buf.size());
 }
 
 bool FilePersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
-	core_trace_scoped(WorldPersisterLoad);
+	core_trace_scoped(WorldPersisterSave);
 	core::ByteStream final;
 	if (!saveCompressed(chunk, final)) {
 		return false;
 	}
-	const core::String& filename = getWorldName(chunk->chunkPos(), seed);
-	const io::FilesystemPtr& filesystem = io::filesystem();
-
-	if (!filesystem->write(filename, final.getBuffer(), final.getSize())) {
-		Log::error("Failed to write file %s", filename.c_str());
+	const glm::ivec3& chunkPos = chunk->chunkPos();
+	const RegionFilePtr& regionFile = region(chunkPos, seed);
+	if (!regionFile) {
+		return false;
+	}
+	if (!regionFile->write(chunkPos, final.getBuffer(), final.getSize())) {
+		Log::error("Failed to write chunk %i:%i:%i to %s", chunkPos.x, chunkPos.y, chunkPos.z, regionFile->path().c_str());
 		return false;
 	}
-	Log::debug("Wrote file %s (%i)", filename.c_str(), (int)final.getSize());
+	Log::debug("Wrote chunk %i:%i:%i to %s (%i)", chunkPos.x, chunkPos.y, chunkPos.z, regionFile->path().c_str(),
+			(int)final.getSize());
 	return true;
 }
 
@@ -5,6 +5,12 @@
 #pragma once
 
 #include "ChunkPersister.h"
+#include "RegionFile.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include "core/GLM.h"
+#include <memory>
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -12,10 +18,30 @@ class PagedVolumeWrapper;
 
 namespace voxelworld {
 
+/**
+ * @brief Stores the chunks in region files of @c RegionFile::RegionSize^3 chunks in the home path
+ *
+ * The region files are kept open - up to @c FilePersister::MaxOpenRegions files that are not in use are closed
+ * again if more regions are needed.
+ *
+ * @sa RegionFile
+ */
 class FilePersister : public ChunkPersister {
+public:
+	static constexpr int MaxOpenRegions = 64;
+private:
+	typedef std::shared_ptr<RegionFile> RegionFilePtr;
+	typedef core::Map<glm::ivec3, RegionFilePtr, 64, glm::hash<glm::ivec3>> Regions;
+	Regions _regions;
+	unsigned int _regionSeed = 0u;
+	core_trace_mutex(core::Lock, _regionLock, "FilePersister");
+
+	RegionFilePtr region(const glm::ivec3& chunkPos, unsigned int seed);
 public:
 	virtual ~FilePersister() {}
 
+	void shutdown() override;
+
 	bool load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
 	bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
 	void erase(const voxel::Region& region, unsigned int seed) override;
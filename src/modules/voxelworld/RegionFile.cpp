@@ -0,0 +1,314 @@
+/**
+ * @file
+ */
+
+#include "RegionFile.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include <SDL_endian.h>
+#include <SDL_rwops.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace voxelworld {
+
+RegionFile::~RegionFile() {
+	close();
+}
+
+bool RegionFile::openFile(const core::String& path, const char *mode) {
+	// the stdio handle is kept to flush the data to the disk
+	_fp = fopen(path.c_str(), mode);
+	if (_fp == nullptr) {
+		return false;
+	}
+	_file = SDL_RWFromFP(_fp, SDL_FALSE);
+	if (_file == nullptr) {
+		fclose(_fp);
+		_fp = nullptr;
+		return false;
+	}
+	return true;
+}
+
+void RegionFile::closeFile() {
+	SDL_RWclose(_file);
+	_file = nullptr;
+	fclose(_fp);
+	_fp = nullptr;
+	_usedSectors.clear();
+	_pendingFree.clear();
+}
+
+bool RegionFile::open(const core::String& path) {
+	core_trace_scoped(RegionFileOpen);
+	core::ScopedLock lock(_lock);
+	if (_file != nullptr) {
+		Log::debug("Region file %s is already open", _path.c_str());
+		return false;
+	}
+	_path = path;
+	if (openFile(path, "r+b")) {
+		const long fileLength = (long)SDL_RWsize(_file);
+		if (readHeader(fileLength)) {
+			return true;
+		}
+		Log::error("Invalid region file %s", path.c_str());
+		closeFile();
+		return false;
+	}
+	if (!openFile(path, "w+b")) {
+		Log::error("Failed to create region file %s", path.c_str());
+		return false;
+	}
+	for (int i = 0; i < Chunks; ++i) {
+		_entries[i] = Entry();
+	}
+	_sectors = HeaderSectors;
+	_usedSectors.assign(_sectors, true);
+	if (!writeHeader() || !sync()) {
+		Log::error("Failed to write the header of region file %s", path.c_str());
+		closeFile();
+		return false;
+	}
+	return true;
+}
+
+void RegionFile::close() {
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return;
+	}
+	if (sync()) {
+		truncate();
+	} else {
+		Log::error("Failed to flush region file %s", _path.c_str());
+	}
+	closeFile();
+}
+
+bool RegionFile::sync() {
+	core_trace_scoped(RegionFileSync);
+	if (fflush(_fp) != 0) {
+		return false;
+	}
+#ifdef _WIN32
+	if (_commit(_fileno(_fp)) != 0) {
+		return false;
+	}
+#else
+	if (fsync(fileno(_fp)) != 0) {
+		return false;
+	}
+#endif
+	for (const Entry& entry : _pendingFree) {
+		markSectors(entry, false);
+	}
+	_pendingFree.clear();
+	return true;
+}
+
+void RegionFile::markSectors(const Entry& entry, bool used) {
+	const uint32_t end = entry.sector + sectorCount(entry.length);
+	if (end > (uint32_t)_usedSectors.size()) {
+		_usedSectors.resize(end, false);
+	}
+	for (uint32_t i = entry.sector; i < end; ++i) {
+		_usedSectors[i] = used;
+	}
+}
+
+uint32_t RegionFile::allocate(uint32_t sectors) const {
+	uint32_t run = 0u;
+	for (uint32_t i = HeaderSectors; i < _sectors; ++i) {
+		if (_usedSectors[i]) {
+			run = 0u;
+			continue;
+		}
+		if (++run == sectors) {
+			return i + 1u - sectors;
+		}
+	}
+	// the free sectors at the end of the file are extended
+	return _sectors - run;
+}
+
+void RegionFile::truncate() {
+	uint32_t sectors = _sectors;
+	while (sectors > (uint32_t)HeaderSectors && !_usedSectors[sectors - 1]) {
+		--sectors;
+	}
+	if (sectors == _sectors) {
+		return;
+	}
+	const long length = (long)sectors * SectorSize;
+#ifdef _WIN32
+	const bool truncated = _chsize(_fileno(_fp), length) == 0;
+#else
+	const bool truncated = ftruncate(fileno(_fp), (off_t)length) == 0;
+#endif
+	if (!truncated) {
+		Log::warn("Failed to truncate region file %s", _path.c_str());
+		return;
+	}
+	Log::debug("Truncated region file %s from %u to %u sectors", _path.c_str(), _sectors, sectors);
+	_sectors = sectors;
+	_usedSectors.resize(_sectors);
+}
+
+uint32_t RegionFile::sectors() const {
+	core::ScopedLock lock(_lock);
+	return _sectors;
+}
+
+bool RegionFile::readHeader(long fileLength) {
+	if (fileLength < HeaderSectors * SectorSize) {
+		return false;
+	}
+	uint32_t header[HeaderSize / sizeof(uint32_t) + Chunks * 2];
+	if (SDL_RWseek(_file, 0, RW_SEEK_SET) != 0 || SDL_RWread(_file, header, sizeof(header), 1) != 1) {
+		return false;
+	}
+	if (SDL_SwapLE32(header[0]) != Magic || SDL_SwapLE32(header[1]) != Version
+	 || SDL_SwapLE32(header[2]) != (uint32_t)RegionSize || SDL_SwapLE32(header[3]) != (uint32_t)SectorSize) {
+		return false;
+	}
+	_sectors = (uint32_t)((fileLength + SectorSize - 1) / SectorSize);
+	_usedSectors.assign(_sectors, false);
+	for (int i = 0; i < HeaderSectors; ++i) {
+		_usedSectors[i] = true;
+	}
+	const uint32_t* table = header + HeaderSize / sizeof(uint32_t);
+	for (int i = 0; i < Chunks; ++i) {
+		Entry& entry = _entries[i];
+		entry.sector = SDL_SwapLE32(table[i * 2 + 0]);
+		entry.length = SDL_SwapLE32(table[i * 2 + 1]);
+		if (entry.length == 0u) {
+			continue;
+		}
+		const uint64_t end = (uint64_t)entry.sector * SectorSize + entry.length;
+		if (entry.sector < (uint32_t)HeaderSectors || end > (uint64_t)fileLength) {
+			Log::warn("Invalid chunk entry %i in region file %s", i, _path.c_str());
+			entry = Entry();
+			continue;
+		}
+		markSectors(entry, true);
+	}
+	return true;
+}
+
+bool RegionFile::writeHeader() {
+	uint8_t buf[HeaderSectors * SectorSize] = {};
+	uint32_t* header = (uint32_t*)buf;
+	header[0] = SDL_SwapLE32(Magic);
+	header[1] = SDL_SwapLE32(Version);
+	header[2] = SDL_SwapLE32((uint32_t)RegionSize);
+	header[3] = SDL_SwapLE32((uint32_t)SectorSize);
+	uint32_t* table = header + HeaderSize / sizeof(uint32_t);
+	for (int i = 0; i < Chunks; ++i) {
+		table[i * 2 + 0] = SDL_SwapLE32(_entries[i].sector);
+		table[i * 2 + 1] = SDL_SwapLE32(_entries[i].length);
+	}
+	return SDL_RWseek(_file, 0, RW_SEEK_SET) == 0 && SDL_RWwrite(_file, buf, sizeof(buf), 1) == 1;
+}
+
+bool RegionFile::contains(const glm::ivec3& chunkPos) const {
+	core::ScopedLock lock(_lock);
+	return _entries[entryIndex(chunkPos)].length > 0u;
+}
+
+bool RegionFile::read(const glm::ivec3& chunkPos, std::vector<uint8_t>& out) const {
+	core_trace_scoped(RegionFileRead);
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const Entry& entry = _entries[entryIndex(chunkPos)];
+	if (entry.length == 0u) {
+		return false;
+	}
+	out.resize(entry.length);
+	const Sint64 offset = (Sint64)entry.sector * SectorSize;
+	if (SDL_RWseek(_file, offset, RW_SEEK_SET) != offset || SDL_RWread(_file, out.data(), entry.length, 1) != 1) {
+		Log::error("Failed to read chunk %i:%i:%i from region file %s", chunkPos.x, chunkPos.y, chunkPos.z, _path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool RegionFile::write(const glm::ivec3& chunkPos, const uint8_t* data, size_t size) {
+	core_trace_scoped(RegionFileWrite);
+	if (size == 0u || size > UINT32_MAX) {
+		return false;
+	}
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	Entry entry;
+	entry.length = (uint32_t)size;
+	const uint32_t sectors = sectorCount(entry.length);
+	entry.sector = allocate(sectors);
+	const Sint64 offset = (Sint64)entry.sector * SectorSize;
+	if (SDL_RWseek(_file, offset, RW_SEEK_SET) != offset || SDL_RWwrite(_file, data, size, 1) != 1) {
+		Log::error("Failed to write chunk %i:%i:%i to region file %s", chunkPos.x, chunkPos.y, chunkPos.z, _path.c_str());
+		return false;
+	}
+	const uint32_t end = entry.sector + sectors;
+	if (end > _sectors) {
+		// keep the end of the file sector aligned
+		const size_t padding = (size_t)sectors * SectorSize - size;
+		if (padding > 0u) {
+			const uint8_t zeros[SectorSize] = {};
+			if (SDL_RWwrite(_file, zeros, padding, 1) != 1) {
+				Log::error("Failed to pad chunk %i:%i:%i in region file %s", chunkPos.x, chunkPos.y, chunkPos.z, _path.c_str());
+				return false;
+			}
+		}
+		_sectors = end;
+	}
+	markSectors(entry, true);
+
+	// the data must be on the disk before the table entry is pointed to it
+	if (!sync()) {
+		Log::error("Failed to flush chunk %i:%i:%i to region file %s", chunkPos.x, chunkPos.y, chunkPos.z, _path.c_str());
+		return false;
+	}
+	const int index = entryIndex(chunkPos);
+	const uint32_t raw[2] = { SDL_SwapLE32(entry.sector), SDL_SwapLE32(entry.length) };
+	const Sint64 entryOffset = HeaderSize + index * EntrySize;
+	if (SDL_RWseek(_file, entryOffset, RW_SEEK_SET) != entryOffset || SDL_RWwrite(_file, raw, sizeof(raw), 1) != 1) {
+		Log::error("Failed to update the table entry of chunk %i:%i:%i in region file %s", chunkPos.x, chunkPos.y,
+				chunkPos.z, _path.c_str());
+		return false;
+	}
+	if (_entries[index].length > 0u) {
+		_pendingFree.push_back(_entries[index]);
+	}
+	_entries[index] = entry;
+	return true;
+}
+
+bool RegionFile::erase(const glm::ivec3& chunkPos) {
+	core::ScopedLock lock(_lock);
+	if (_file == nullptr) {
+		return false;
+	}
+	const int index = entryIndex(chunkPos);
+	if (_entries[index].length == 0u) {
+		return true;
+	}
+	const uint32_t raw[2] = { 0u, 0u };
+	const Sint64 entryOffset = HeaderSize + index * EntrySize;
+	if (SDL_RWseek(_file, entryOffset, RW_SEEK_SET) != entryOffset || SDL_RWwrite(_file, raw, sizeof(raw), 1) != 1) {
+		return false;
+	}
+	_pendingFree.push_back(_entries[index]);
+	_entries[index] = Entry();
+	return true;
+}
+
+}
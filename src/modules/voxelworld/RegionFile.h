@@ -0,0 +1,153 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
+#include <glm/vec3.hpp>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+
+struct SDL_RWops;
+
+namespace voxelworld {
+
+/**
+ * @brief Container file for the compressed data of @c RegionFile::RegionSize^3 chunks
+ *
+ * The file starts with a header and a table of one entry per chunk. An entry stores the sector the data of the
+ * chunk starts at and the length of the data in bytes. The chunk data is aligned to @c RegionFile::SectorSize.
+ *
+ * Writing a chunk puts the data into the first free sectors that are big enough (or appends it to the end of the
+ * file), flushes it to the disk and only afterwards updates the table entry. The entry is 8 byte aligned and never
+ * crosses a sector boundary - an interrupted write leaves the old chunk data intact. The sectors of replaced or
+ * erased chunk data are reused once the updated table entry was flushed, too. Free sectors at the end of the file
+ * are cut off when the file is closed.
+ *
+ * @note All methods are thread safe. Reading only holds the lock while the bytes are read - the uncompressing
+ * happens outside of the region file.
+ */
+class RegionFile : public core::NonCopyable {
+public:
+	/**
+	 * The amount of chunks per axis - for the usual world heights this already covers all chunks on the y axis,
+	 * so a region is a column of N×N chunks
+	 */
+	static constexpr int RegionSizePower = 3;
+	static constexpr int RegionSize = 1 << RegionSizePower;
+	static constexpr int Chunks = RegionSize * RegionSize * RegionSize;
+	static constexpr int SectorSize = 512;
+private:
+	static constexpr uint32_t Magic = 0x4E475256; // VRGN
+	static constexpr uint32_t Version = 1u;
+	// magic, version, region size, sector size
+	static constexpr int HeaderSize = 4 * sizeof(uint32_t);
+	static constexpr int EntrySize = 2 * sizeof(uint32_t);
+	static constexpr int HeaderSectors = (HeaderSize + Chunks * EntrySize + SectorSize - 1) / SectorSize;
+
+	struct Entry {
+		uint32_t sector = 0u;
+		uint32_t length = 0u;
+	};
+
+	FILE* _fp = nullptr;
+	SDL_RWops* _file = nullptr;
+	core::String _path;
+	Entry _entries[Chunks];
+	// the first free sector at the end of the file
+	uint32_t _sectors = 0u;
+	// one flag per sector of the file
+	std::vector<bool> _usedSectors;
+	// the sectors of replaced table entries - they are free once the table was flushed
+	std::vector<Entry> _pendingFree;
+	core_trace_mutex(core::Lock, _lock, "RegionFile");
+
+	static int entryIndex(const glm::ivec3& chunkPos);
+	static uint32_t sectorCount(uint32_t length);
+	bool openFile(const core::String& path, const char *mode);
+	void closeFile();
+	bool readHeader(long fileLength);
+	bool writeHeader();
+	/**
+	 * @brief Writes the buffered data to the disk - the sectors of replaced entries are free afterwards
+	 */
+	bool sync();
+	void markSectors(const Entry& entry, bool used);
+	/**
+	 * @return The first sector of a free range of the given amount of sectors
+	 */
+	uint32_t allocate(uint32_t sectors) const;
+	/**
+	 * @brief Cuts off the free sectors at the end of the file
+	 */
+	void truncate();
+public:
+	~RegionFile();
+
+	/**
+	 * @brief Opens the given region file or creates it if it doesn't exist yet
+	 * @param[in] path The full path of the region file
+	 */
+	bool open(const core::String& path);
+	void close();
+
+	const core::String& path() const;
+
+	/**
+	 * @return The position of the region the given chunk is part of
+	 */
+	static glm::ivec3 regionPos(const glm::ivec3& chunkPos);
+
+	/**
+	 * @return @c true if there is data stored for the given chunk
+	 */
+	bool contains(const glm::ivec3& chunkPos) const;
+
+	/**
+	 * @brief Reads the data of the given chunk
+	 * @param[in] chunkPos The chunk position - not the region local position
+	 * @param[out] out The data that was previously written with @c write()
+	 * @return @c false if there is no data for the chunk or the data could not get read
+	 */
+	bool read(const glm::ivec3& chunkPos, std::vector<uint8_t>& out) const;
+
+	/**
+	 * @brief Stores the data of the given chunk and replaces any previous data of the chunk
+	 * @param[in] chunkPos The chunk position - not the region local position
+	 */
+	bool write(const glm::ivec3& chunkPos, const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Removes the table entry of the given chunk
+	 */
+	bool erase(const glm::ivec3& chunkPos);
+
+	/**
+	 * @return The amount of sectors the file is made of
+	 */
+	uint32_t sectors() const;
+};
+
+inline const core::String& RegionFile::path() const {
+	return _path;
+}
+
+inline uint32_t RegionFile::sectorCount(uint32_t length) {
+	return (uint32_t)(((uint64_t)length + SectorSize - 1) / SectorSize);
+}
+
+inline glm::ivec3 RegionFile::regionPos(const glm::ivec3& chunkPos) {
+	return glm::ivec3(chunkPos.x >> RegionSizePower, chunkPos.y >> RegionSizePower, chunkPos.z >> RegionSizePower);
+}
+
+inline int RegionFile::entryIndex(const glm::ivec3& chunkPos) {
+	const glm::ivec3 local(chunkPos.x & (RegionSize - 1), chunkPos.y & (RegionSize - 1), chunkPos.z & (RegionSize - 1));
+	return (local.y * RegionSize + local.z) * RegionSize + local.x;
+}
+
+}
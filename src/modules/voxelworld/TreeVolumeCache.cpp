@@ -52,13 +52,13 @@ void TreeVolumeCache::shutdown() {
 	_treeTypeCount.clear();
 }
 
-voxel::RawVolume* TreeVolumeCache::loadTree(const glm::ivec3& treePos, const char *treeType) {
+voxelformat::RawVolumePtr TreeVolumeCache::loadTree(const glm::ivec3& treePos, const char *treeType) {
 	int treeCount = 1;
 	if (!_treeTypeCount.get(treeType, treeCount)) {
 		Log::warn("Could not get tree type count for %s - assuming 1", treeType);
 	}
 	if (treeCount <= 0) {
-		return nullptr;
+		return voxelformat::RawVolumePtr();
 	}
 	const int treeIndex = 1 + (glm::abs(treePos.x + treePos.z) % treeCount);
 	const core::String &filename = core::string::format("models/trees/%s/%i", treeType, treeIndex);
@@ -29,7 +29,7 @@ public:
 	 * the registered biome tree types
 	 * @return voxel::RawVolume or @c nullptr if no tree volume was found for the given tree type.
 	 */
-	voxel::RawVolume* loadTree(const glm::ivec3& treePos, const char *treeType);
+	voxelformat::RawVolumePtr loadTree(const glm::ivec3& treePos, const char *treeType);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+/**
+ * @file
+ */
+
+#include "WorldHeightmap.h"
+#include "voxel/Constants.h"
+#include "voxel/Voxel.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include <algorithm>
+
+namespace voxelworld {
+
+namespace {
+
+// the amount of times a heightmap is built again if the voxels of the chunk were modified in the meantime
+const int MaxBuildAttempts = 3;
+// the amount of chunk modifications that are remembered to detect outdated heightmaps
+const int MaxModifications = 4096;
+
+}
+
+WorldHeightmap::~WorldHeightmap() {
+	shutdown();
+}
+
+bool WorldHeightmap::init(voxel::PagedVolume* volumeData) {
+	if (volumeData == nullptr) {
+		return false;
+	}
+	_volumeData = volumeData;
+	_sideLength = _volumeData->chunkSideLength();
+	// the runs of a column must not be split over several chunks
+	_enabled = _sideLength > voxel::MAX_HEIGHT;
+	_volumeData->addListener(this);
+	return true;
+}
+
+void WorldHeightmap::shutdown() {
+	if (_volumeData != nullptr) {
+		_volumeData->removeListener(this);
+	}
+	{
+		core::ScopedLock updateLock(_updateLock);
+		_modifications.clear();
+	}
+	core::ScopedWriteLock lock(_lock);
+	_heightmaps.clear();
+	_volumeData = nullptr;
+	_enabled = false;
+}
+
+bool WorldHeightmap::cacheable(const glm::ivec3& chunkPos) const {
+	return _enabled && chunkPos.y == 0;
+}
+
+bool WorldHeightmap::modifiedSince(const glm::ivec3& chunkPos, int generation) const {
+	if (generation < _forgottenGeneration) {
+		return true;
+	}
+	int modified;
+	return _modifications.get(chunkPos, modified) && modified > generation;
+}
+
+void WorldHeightmap::computeColumn(const voxel::PagedVolume::Chunk& chunk, int x, int z, Column& column) const {
+	column.runs = 0u;
+	bool enterableRun = false;
+	for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+		const bool enterable = voxel::isEnterable(chunk.voxel(x, y, z).getMaterial());
+		if (enterable == enterableRun) {
+			continue;
+		}
+		enterableRun = enterable;
+		if (!enterable) {
+			column.end[column.runs++] = (uint8_t)(y - 1);
+			continue;
+		}
+		if (column.runs == MaxRuns) {
+			column.runs = OverflowRuns;
+			return;
+		}
+		column.start[column.runs] = (uint8_t)y;
+	}
+	if (enterableRun) {
+		column.end[column.runs++] = (uint8_t)voxel::MAX_HEIGHT;
+	}
+}
+
+WorldHeightmap::HeightmapPtr WorldHeightmap::build(const voxel::PagedVolume::Chunk& chunk) const {
+	core_trace_scoped(WorldHeightmapBuild);
+	const HeightmapPtr& heightmap = std::make_shared<Heightmap>();
+	heightmap->columns.resize(_sideLength * _sideLength);
+	if (chunk.storage() == voxel::PagedVolume::ChunkStorage::Uniform) {
+		Column column;
+		computeColumn(chunk, 0, 0, column);
+		std::fill(heightmap->columns.begin(), heightmap->columns.end(), column);
+		return heightmap;
+	}
+	for (int z = 0; z < _sideLength; ++z) {
+		for (int x = 0; x < _sideLength; ++x) {
+			computeColumn(chunk, x, z, heightmap->columns[z * _sideLength + x]);
+		}
+	}
+	return heightmap;
+}
+
+bool WorldHeightmap::column(int x, int z, Column& column) const {
+	if (!_enabled) {
+		return false;
+	}
+	const glm::ivec3& chunkPos = _volumeData->chunkPos(x, 0, z);
+	const int lx = x - chunkPos.x * _sideLength;
+	const int lz = z - chunkPos.z * _sideLength;
+	{
+		core::ScopedReadLock lock(_lock);
+		HeightmapPtr heightmap;
+		if (!_heightmaps.get(chunkPos, heightmap)) {
+			return false;
+		}
+		column = heightmap->columns[lz * _sideLength + lx];
+	}
+	return column.runs != OverflowRuns;
+}
+
+bool WorldHeightmap::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result) const {
+	if (position.y < 0 || position.y > voxel::MAX_HEIGHT) {
+		return false;
+	}
+	Column c;
+	if (!column(position.x, position.z, c)) {
+		_misses.increment();
+		return false;
+	}
+	_hits.increment();
+	// the voxels are looked up after the lock was released - this might page in the chunk again
+	for (int i = 0; i < c.runs; ++i) {
+		if (position.y < c.start[i]) {
+			// the position is solid - the next run starts at the first enterable voxel above
+			const int maxDistance = core_min(maxDistanceUpwards, voxel::MAX_HEIGHT - position.y);
+			if (c.start[i] - position.y > maxDistance) {
+				result = voxelutil::FloorTraceResult();
+			} else {
+				result = voxelutil::FloorTraceResult(c.start[i], _volumeData->voxel(position.x, c.start[i], position.z));
+			}
+			return true;
+		}
+		if (position.y <= c.end[i]) {
+			if (c.start[i] == 0) {
+				// there is no solid voxel below
+				result = voxelutil::FloorTraceResult(position.y, _volumeData->voxel(position));
+			} else {
+				result = voxelutil::FloorTraceResult(c.start[i], _volumeData->voxel(position.x, c.start[i] - 1, position.z));
+			}
+			return true;
+		}
+	}
+	// solid up to the top of the world
+	result = voxelutil::FloorTraceResult();
+	return true;
+}
+
+void WorldHeightmap::onChunkPagedIn(const voxel::PagedVolume::ChunkPtr& chunk) {
+	const glm::ivec3& chunkPos = chunk->chunkPos();
+	if (!cacheable(chunkPos)) {
+		return;
+	}
+	for (int i = 0; i < MaxBuildAttempts; ++i) {
+		int generation;
+		{
+			core::ScopedLock updateLock(_updateLock);
+			generation = _generation;
+		}
+		const HeightmapPtr& heightmap = build(*chunk.get());
+		core::ScopedLock updateLock(_updateLock);
+		if (modifiedSince(chunkPos, generation)) {
+			continue;
+		}
+		core::ScopedWriteLock lock(_lock);
+		_heightmaps.put(chunkPos, heightmap);
+		_builds.increment();
+		return;
+	}
+	Log::debug("Chunk %i:%i:%i was modified while building the heightmap", chunkPos.x, chunkPos.y, chunkPos.z);
+}
+
+void WorldHeightmap::onChunkEvicted(const glm::ivec3& chunkPos) {
+	if (!cacheable(chunkPos)) {
+		return;
+	}
+	core::ScopedWriteLock lock(_lock);
+	_heightmaps.remove(chunkPos);
+}
+
+void WorldHeightmap::onVoxelsModified(const voxel::Region& region) {
+	if (!_enabled || region.getUpperY() < 0 || region.getLowerY() > voxel::MAX_HEIGHT) {
+		return;
+	}
+	core_trace_scoped(WorldHeightmapUpdate);
+	const glm::ivec3& mins = _volumeData->chunkPos(region.getLowerX(), 0, region.getLowerZ());
+	const glm::ivec3& maxs = _volumeData->chunkPos(region.getUpperX(), 0, region.getUpperZ());
+	{
+		// only the heightmaps of these chunks that are currently built are outdated
+		core::ScopedLock updateLock(_updateLock);
+		++_generation;
+		if ((int)_modifications.size() >= MaxModifications) {
+			_modifications.clear();
+			_forgottenGeneration = _generation;
+		}
+		for (int cz = mins.z; cz <= maxs.z; ++cz) {
+			for (int cx = mins.x; cx <= maxs.x; ++cx) {
+				_modifications.put(glm::ivec3(cx, 0, cz), _generation);
+			}
+		}
+	}
+	std::vector<Column> columns;
+	for (int cz = mins.z; cz <= maxs.z; ++cz) {
+		for (int cx = mins.x; cx <= maxs.x; ++cx) {
+			const glm::ivec3 chunkPos(cx, 0, cz);
+			{
+				core::ScopedReadLock lock(_lock);
+				if (!_heightmaps.hasKey(chunkPos)) {
+					continue;
+				}
+			}
+			// fetched before the update lock is acquired - the chunk might get paged in again
+			const voxel::PagedVolume::ChunkPtr& chunk = _volumeData->chunk(chunkPos * _sideLength);
+			const int x0 = core_max(region.getLowerX() - cx * _sideLength, 0);
+			const int x1 = core_min(region.getUpperX() - cx * _sideLength, _sideLength - 1);
+			const int z0 = core_max(region.getLowerZ() - cz * _sideLength, 0);
+			const int z1 = core_min(region.getUpperZ() - cz * _sideLength, _sideLength - 1);
+			const int width = x1 - x0 + 1;
+			columns.resize(width * (z1 - z0 + 1));
+
+			core::ScopedLock updateLock(_updateLock);
+			for (int z = z0; z <= z1; ++z) {
+				for (int x = x0; x <= x1; ++x) {
+					computeColumn(*chunk.get(), x, z, columns[(z - z0) * width + x - x0]);
+				}
+			}
+			core::ScopedWriteLock lock(_lock);
+			HeightmapPtr heightmap;
+			if (!_heightmaps.get(chunkPos, heightmap)) {
+				continue;
+			}
+			for (int z = z0; z <= z1; ++z) {
+				for (int x = x0; x <= x1; ++x) {
+					heightmap->columns[z * _sideLength + x] = columns[(z - z0) * width + x - x0];
+				}
+			}
+		}
+	}
+}
+
+int WorldHeightmap::cachedChunks() const {
+	core::ScopedReadLock lock(_lock);
+	return (int)_heightmaps.size();
+}
+
+WorldHeightmap::Statistics WorldHeightmap::statistics() const {
+	Statistics stats;
+	stats.builds = _builds;
+	stats.hits = _hits;
+	stats.misses = _misses;
+	return stats;
+}
+
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "voxel/Region.h"
+#include "voxelutil/FloorTraceResult.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ReadWriteSpinLock.h"
+#include "core/collection/Map.h"
+#include "core/GLM.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include <memory>
+#include <vector>
+
+namespace voxelworld {
+
+/**
+ * @brief Caches the walkable floor levels of the columns of the resident chunks.
+ *
+ * Each column stores the runs of enterable voxels from the bottom to the top of the world - every run that
+ * doesn't start at the bottom of the world starts at a walkable floor. Several runs per column cover caves and
+ * overhangs. The columns of a chunk are computed when the chunk is paged in and only the affected columns are
+ * computed again when voxels are modified. A floor query is a lookup in the runs of a single column.
+ *
+ * Only chunks that span the whole world height are cached. If a query can't be answered from the cache (the
+ * chunk isn't cached or the column has more than @c MaxRuns runs) the caller has to trace the column.
+ *
+ * @note The cache can be queried from any thread.
+ */
+class WorldHeightmap : public voxel::PagedVolume::Listener, public core::NonCopyable {
+public:
+	/**
+	 * @brief The maximum amount of enterable runs per column
+	 */
+	static constexpr int MaxRuns = 4;
+
+	/**
+	 * @brief The enterable runs of a column sorted from bottom to top - @c start and @c end are inclusive.
+	 */
+	struct Column {
+		uint8_t runs = 0u;
+		uint8_t start[MaxRuns] {};
+		uint8_t end[MaxRuns] {};
+	};
+	static constexpr uint8_t OverflowRuns = 0xFF;
+
+	struct Statistics {
+		int builds = 0;
+		int hits = 0;
+		int misses = 0;
+	};
+
+private:
+	voxel::PagedVolume* _volumeData = nullptr;
+	int _sideLength = 0;
+	bool _enabled = false;
+
+	struct Heightmap {
+		// the columns of the chunk - x is the fastest changing index
+		std::vector<Column> columns;
+	};
+	typedef std::shared_ptr<Heightmap> HeightmapPtr;
+	// keyed by the chunk position
+	typedef core::Map<glm::ivec3, HeightmapPtr, 64, glm::hash<glm::ivec3>> Heightmaps;
+	Heightmaps _heightmaps core_thread_guarded_by(_lock);
+	mutable core::ReadWriteSpinLock _lock;
+
+	// serializes the computation and the update of columns - a column that is stored is never older than the
+	// last modification of its voxels
+	core_trace_mutex(core::Lock, _updateLock, "WorldHeightmapUpdate");
+	// incremented with every modification
+	int _generation core_thread_guarded_by(_updateLock) = 0;
+	// the generation of the last modification of a chunk - a heightmap that was built before its chunk was
+	// modified isn't cached
+	typedef core::Map<glm::ivec3, int, 64, glm::hash<glm::ivec3>> Modifications;
+	Modifications _modifications core_thread_guarded_by(_updateLock);
+	// heightmaps that were built before this generation aren't cached - the modifications are forgotten once
+	// there are too many of them
+	int _forgottenGeneration core_thread_guarded_by(_updateLock) = 0;
+
+	core::AtomicInt _builds { 0 };
+	mutable core::AtomicInt _hits { 0 };
+	mutable core::AtomicInt _misses { 0 };
+
+	bool cacheable(const glm::ivec3& chunkPos) const;
+	bool modifiedSince(const glm::ivec3& chunkPos, int generation) const;
+	void computeColumn(const voxel::PagedVolume::Chunk& chunk, int x, int z, Column& column) const;
+	HeightmapPtr build(const voxel::PagedVolume::Chunk& chunk) const;
+
+public:
+	~WorldHeightmap();
+
+	/**
+	 * @note Registers the heightmap as listener at the volume
+	 */
+	bool init(voxel::PagedVolume* volumeData);
+	void shutdown();
+
+	/**
+	 * @brief Answers the query in the same way as @c voxelutil::findWalkableFloor() does
+	 * @return @c false if the column isn't cached - @c result isn't modified in this case
+	 */
+	bool findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards, voxelutil::FloorTraceResult& result) const;
+
+	/**
+	 * @return @c false if the column isn't cached
+	 */
+	bool column(int x, int z, Column& column) const;
+
+	void onVoxelsModified(const voxel::Region& region) override;
+	void onChunkPagedIn(const voxel::PagedVolume::ChunkPtr& chunk) override;
+	void onChunkEvicted(const glm::ivec3& chunkPos) override;
+
+	int cachedChunks() const;
+	Statistics statistics() const;
+};
+
+}
@@ -51,18 +51,24 @@ voxel::PagedVolume::Sampler WorldMgr::sampler() {
 	return voxel::PagedVolume::Sampler(_volumeData);
 }
 
-bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
-	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
-	return true;
+bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength, uint32_t compressedMemoryMegaBytes) {
+	_volumeData = new voxel::PagedVolume(_pager.get(), (uint64_t)volumeMemoryMegaBytes * 1024u * 1024u, chunkSideLength,
+			(uint64_t)compressedMemoryMegaBytes * 1024u * 1024u);
+	return _heightmap.init(_volumeData);
 }
 
 void WorldMgr::shutdown() {
+	_heightmap.shutdown();
 	delete _volumeData;
 	_volumeData = nullptr;
 }
 
 voxelutil::FloorTraceResult WorldMgr::findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards) const {
 	core_assert_msg(_volumeData != nullptr, "WorldMgr is not initialized");
+	voxelutil::FloorTraceResult result;
+	if (_heightmap.findWalkableFloor(position, maxDistanceUpwards, result)) {
+		return result;
+	}
 	voxel::PagedVolume::Sampler sampler(_volumeData);
 	return voxelutil::findWalkableFloor(&sampler, position, maxDistanceUpwards);
 }
@@ -10,6 +10,7 @@
 #include "voxel/PagedVolume.h"
 #include "voxelutil/Raycast.h"
 #include "voxelutil/FloorTraceResult.h"
+#include "WorldHeightmap.h"
 #include "voxelformat/VolumeCache.h"
 #include "voxel/Constants.h"
 #include "core/GLM.h"
@@ -44,10 +45,14 @@ public:
 	/**
 	 * @sa voxelutil::FloorTraceResult
 	 * @return The y component for the given x and z coordinates that is walkable - or @c NO_FLOOR_FOUND.
+	 * @note The floor levels of the resident chunks are cached - see @c WorldHeightmap
 	 */
 	voxelutil::FloorTraceResult findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards = voxel::MAX_HEIGHT) const;
 
-	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256);
+	/**
+	 * @param compressedMemoryMegaBytes The memory that is used to keep evicted chunks compressed before they are paged out
+	 */
+	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256, uint32_t compressedMemoryMegaBytes = 0u);
 	void shutdown();
 	void reset();
 
@@ -64,6 +69,7 @@ public:
 
 	voxel::PagedVolume::Sampler sampler();
 	voxel::PagedVolume *volumeData();
+	const WorldHeightmap& heightmap() const;
 
 private:
 	friend class WorldMgrTest;
@@ -75,6 +81,7 @@ private:
 
 	voxel::PagedVolume::PagerPtr _pager;
 	voxel::PagedVolume *_volumeData = nullptr;
+	WorldHeightmap _heightmap;
 	mutable std::mt19937 _engine;
 	long _seed = 0l;
 
@@ -85,6 +92,10 @@ inline voxel::PagedVolume *WorldMgr::volumeData() {
 	return _volumeData;
 }
 
+inline const WorldHeightmap& WorldMgr::heightmap() const {
+	return _heightmap;
+}
+
 inline glm::ivec3 WorldMgr::chunkPos(const glm::ivec3& pos) const {
 	const float size = _volumeData->chunkSideLength();
 	const int x = glm::floor(pos.x / size);
@@ -7,9 +7,11 @@
 #include "voxel/PagedVolumeWrapper.h"
 #include "voxelutil/Raycast.h"
 #include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/collection/Array.h"
+#include <vector>
 
 namespace voxelworld {
 
@@ -97,61 +99,124 @@ void WorldPager::createWorld(voxel::PagedVolumeWrapper& volume) const {
 	const int size = 2;
 	core_assert(depth % size == 0);
 	core_assert(width % size == 0);
+	const int columns = width / size;
+	std::vector<float> noiseValues(columns);
 	for (int z = lowerZ; z < lowerZ + depth; z += size) {
-		for (int x = lowerX; x < lowerX + width; x += size) {
+		getNoiseValues(lowerX, z, columns, size, noiseValues.data());
+		for (int i = 0; i < columns; ++i) {
+			const int x = lowerX + i * size;
 			voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
-			const int ni = fillVoxels(x, minsY, z, voxels);
+			const int ni = fillVoxels(x, minsY, z, noiseValues[i], voxels);
 			volume.setVoxels(x, minsY, z, size, size, voxels, ni);
 		}
 	}
 }
 
-float WorldPager::getNoiseValue(float x, float z) const {
+/**
+ * The noise inputs of a row of columns - they are evaluated for every row of every chunk that is paged in,
+ * so they are kept per pager thread instead of allocating them again for every call
+ */
+struct NoiseScratch {
+	std::vector<float> landscapeX;
+	std::vector<float> landscapeZ;
+	std::vector<float> mountainX;
+	std::vector<float> mountainZ;
+	std::vector<float> mountainNoise;
+
+	void resize(int count) {
+		landscapeX.resize(count);
+		landscapeZ.resize(count);
+		mountainX.resize(count);
+		mountainZ.resize(count);
+		mountainNoise.resize(count);
+	}
+};
+
+static thread_local NoiseScratch noiseScratch;
+
+void WorldPager::getNoiseValues(int x, int z, int count, int step, float* n) const {
 	core_trace_scoped(NoiseValue);
-	const glm::vec2 noisePos2d(_noiseSeedOffset.x + x, _noiseSeedOffset.y + z);
+	noiseScratch.resize(count);
+	std::vector<float>& landscapeX = noiseScratch.landscapeX;
+	std::vector<float>& landscapeZ = noiseScratch.landscapeZ;
+	std::vector<float>& mountainX = noiseScratch.mountainX;
+	std::vector<float>& mountainZ = noiseScratch.mountainZ;
+	std::vector<float>& mountainNoise = noiseScratch.mountainNoise;
 	// TODO: move the noise settings into the biome
-	const float landscapeNoise = noise::fBm(noisePos2d * _worldCtx.landscapeNoiseFrequency, _worldCtx.landscapeNoiseOctaves,
+	const float noiseZ = _noiseSeedOffset.y + (float)z;
+	for (int i = 0; i < count; ++i) {
+		const float noiseX = _noiseSeedOffset.x + (float)(x + i * step);
+		landscapeX[i] = noiseX * _worldCtx.landscapeNoiseFrequency;
+		landscapeZ[i] = noiseZ * _worldCtx.landscapeNoiseFrequency;
+		mountainX[i] = noiseX * _worldCtx.mountainNoiseFrequency;
+		mountainZ[i] = noiseZ * _worldCtx.mountainNoiseFrequency;
+	}
+	noise::fBmBatch(landscapeX.data(), landscapeZ.data(), count, n, _worldCtx.landscapeNoiseOctaves,
 			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
-	const float noiseNormalized = noise::norm(landscapeNoise);
-	const float mountainNoise = noise::fBm(noisePos2d * _worldCtx.mountainNoiseFrequency, _worldCtx.mountainNoiseOctaves,
+	noise::fBmBatch(mountainX.data(), mountainZ.data(), count, mountainNoise.data(), _worldCtx.mountainNoiseOctaves,
 			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
-	const float mountainNoiseNormalized = noise::norm(mountainNoise);
-	const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
-	const float n = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
-	return n;
+	for (int i = 0; i < count; ++i) {
+		const float noiseNormalized = noise::norm(n[i]);
+		const float mountainNoiseNormalized = noise::norm(mountainNoise[i]);
+		const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
+		n[i] = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
+	}
 }
 
-float WorldPager::getDensity(float x, float y, float z, float n) const {
+void WorldPager::getDensities(int x, int minsY, int z, int maxHeight, float n, float* densities) const {
 	core_trace_scoped(DensityValue);
-	const glm::vec3 noisePos3d(_noiseSeedOffset.x + x, y, _noiseSeedOffset.y + z);
+	const int startY = minsY + 1;
+	const int count = maxHeight - startY;
+	if (count <= 0) {
+		return;
+	}
+	float noiseX[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseY[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseZ[voxel::MAX_TERRAIN_HEIGHT];
+	core_assert(maxHeight <= voxel::MAX_TERRAIN_HEIGHT);
 	// TODO: move the noise settings into the biome
-	const float noiseVal = noise::norm(
-			noise::fBm(noisePos3d * _worldCtx.caveNoiseFrequency, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoiseLacunarity, _worldCtx.caveNoiseGain));
-	const float finalDensity = n + noiseVal;
-	return finalDensity;
+	const float freq = _worldCtx.caveNoiseFrequency;
+	const float columnX = (_noiseSeedOffset.x + (float)x) * freq;
+	const float columnZ = (_noiseSeedOffset.y + (float)z) * freq;
+	for (int i = 0; i < count; ++i) {
+		noiseX[i] = columnX;
+		noiseY[i] = (float)(startY + i) * freq;
+		noiseZ[i] = columnZ;
+	}
+	float* out = densities + startY;
+	noise::fBmBatch(noiseX, noiseY, noiseZ, count, out, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoiseLacunarity,
+			_worldCtx.caveNoiseGain);
+	for (int i = 0; i < count; ++i) {
+		out[i] = n + noise::norm(out[i]);
+	}
 }
 
-int WorldPager::terrainHeight(int x, int y, int z) const {
-	const float n = getNoiseValue(x, z);
-	return terrainHeight(x, y, z, n);
+int WorldPager::terrainHeight(int x, int minsY, int z) const {
+	float n;
+	getNoiseValues(x, z, 1, 1, &n);
+	const int maxHeight = maxTerrainHeight(x, z, n);
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	getDensities(x, minsY, z, maxHeight, n, densities);
+	return terrainHeight(minsY, maxHeight, densities);
 }
 
-int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
-	core_trace_scoped(TerrainHeight);
+int WorldPager::maxTerrainHeight(int x, int z, float n) const {
 	const int maxHeight = voxel::MAX_TERRAIN_HEIGHT - 1;
 	int centerHeight;
 	// the center of a city should make the terrain more even
 	const float cityMultiplier = _biomeManager.getCityMultiplier(glm::ivec2(x, z), &centerHeight);
-	int ni;
 	if (cityMultiplier < 1.0f) {
 		const float revn = (1.0f - cityMultiplier);
-		ni = revn * centerHeight + (cityMultiplier * n * maxHeight);
-	} else {
-		ni = n * maxHeight;
+		return revn * centerHeight + (cityMultiplier * n * maxHeight);
 	}
-	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
-		if (density > _worldCtx.caveDensityThreshold) {
+	return n * maxHeight;
+}
+
+int WorldPager::terrainHeight(int minsY, int maxHeight, const float* densities) const {
+	core_trace_scoped(TerrainHeight);
+	int ni = maxHeight;
+	for (int y = maxHeight - 1; y >= minsY + 1; --y) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
 			break;
 		}
 		--ni;
@@ -159,10 +224,13 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	return ni;
 }
 
-int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const {
+int WorldPager::fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const {
 	core_trace_scoped(FillVoxels);
-	const float n = getNoiseValue(x, z);
-	const int ni = terrainHeight(x, minsY, z, n);
+	const int maxHeight = maxTerrainHeight(x, z, n);
+	// the densities are evaluated once and shared between the terrain height and the voxel generation
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	getDensities(x, minsY, z, maxHeight, n, densities);
+	const int ni = terrainHeight(minsY, maxHeight, densities);
 	if (ni < minsY) {
 		return 0;
 	}
@@ -174,8 +242,7 @@ int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const
 	voxels[0] = dirt;
 	glm::ivec3 pos(x, 0, z);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
-		if (density > _worldCtx.caveDensityThreshold) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
 			const bool cave = y < ni - 1;
 			pos.y = y;
 			const voxel::Voxel& voxel = _biomeManager.getVoxel(pos, cave);
@@ -254,11 +321,11 @@ void WorldPager::placeTrees(voxel::PagedVolume::PagerContext& pagerCtx) {
 			}
 			const char *treeType = treeTypes[treeTypeIndex++];
 			treeTypeIndex %= treeTypeSize;
-			const voxel::RawVolume* v = _volumeCache.loadTree(treePos, treeType);
-			if (v == nullptr) {
+			const voxelformat::RawVolumePtr& v = _volumeCache.loadTree(treePos, treeType);
+			if (!v) {
 				continue;
 			}
-			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v, axes[positionIndex % axesSize]);
+			const voxelutil::RawVolumeRotateWrapper rotateWrapper(v.get(), axes[positionIndex % axesSize]);
 			addVolumeToPosition(chunkWrapper, rotateWrapper, treePos);
 		}
 	}
@@ -269,6 +336,8 @@ void WorldPager::addVolumeToPosition(voxel::PagedVolumeWrapper& target, const vo
 	const glm::ivec3& mins = region.getLowerCorner();
 	const glm::ivec3& maxs = region.getUpperCorner();
 	const voxel::Region& targetRegion = target.region();
+	// voxels outside of the paged chunk are set in the volume - announce them once per chunk
+	voxel::PagedVolume::ModificationBatch batch(target.volume());
 	for (int x = mins.x; x <= maxs.x; ++x) {
 		const int nx = pos.x + x;
 		for (int y = mins.y; y <= maxs.y; ++y) {
@@ -32,7 +32,7 @@ namespace voxelworld {
 class WorldPager: public voxel::PagedVolume::Pager {
 private:
 	unsigned int _seed = 0l;
-	glm::vec2 _noiseSeedOffset;
+	glm::vec2 _noiseSeedOffset { 0.0f };
 
 	voxel::PagedVolume *_volumeData = nullptr;
 	BiomeManager _biomeManager;
@@ -46,14 +46,27 @@ private:
 	void addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos);
 
 	int terrainHeight(int x, int minsY, int z) const;
-	int terrainHeight(int x, int minsY, int z, float n) const;
-	int fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const;
+	/**
+	 * @return The terrain height of a column before the caves are carved out
+	 */
+	int maxTerrainHeight(int x, int z, float n) const;
+	/**
+	 * @brief Walks down the given density column until the first solid voxel is hit
+	 */
+	int terrainHeight(int minsY, int maxHeight, const float* densities) const;
+	int fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const;
 
 	/**
-	 * @return A float value between [0.0-1.0]
+	 * @brief Evaluates the 2d noise for @c count columns in a row along the x axis
+	 * @param[out] n A float value between [0.0-1.0] for each column
+	 */
+	void getNoiseValues(int x, int z, int count, int step, float* n) const;
+	/**
+	 * @brief Evaluates the density of a whole column at once
+	 * @param[out] densities Receives the density for each y in the range [minsY + 1, maxHeight - 1] - the array
+	 * is indexed by y
 	 */
-	float getNoiseValue(float x, float z) const;
-	float getDensity(float x, float y, float z, float n) const;
+	void getDensities(int x, int minsY, int z, int maxHeight, float n, float* densities) const;
 
 public:
 	WorldPager(const voxelformat::VolumeCachePtr& volumeCache, const ChunkPersisterPtr& chunkPersister);
@@ -0,0 +1,756 @@
+/**
+ * @file
+ */
+
+#include "WorldPathfinder.h"
+#include "voxelutil/AStarPathfinderImpl.h"
+#include "voxel/Constants.h"
+#include "core/Common.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace voxelworld {
+
+namespace {
+
+const float StraightCost = 1.0f;
+const float DiagonalCost = glm::root_two<float>();
+// added to the costs of a step to a cell that is one voxel higher or lower
+const float ClimbCost = 0.5f;
+const float Unreachable = std::numeric_limits<float>::max();
+// borders with a longer stretch of transitions get an entrance at both ends of the stretch
+const int LongBorder = 6;
+// the max amount of abstract nodes that are visited before a search gives up
+const int MaxAbstractNodes = 20000;
+// the search doesn't enter clusters that are further away from the clusters of the start and the end
+const int MaxDetourClusters = 3;
+// if the caches are growing beyond these limits they are dropped completely
+const int MaxCachedClusters = 4096;
+const int MaxCachedPaths = 4096;
+const int MaxClusterGenerations = 4096;
+// the max amount of requests that a thread of the pool takes at once
+const size_t BatchSize = 16;
+
+const glm::ivec2 Directions[8] = {
+	glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1),
+	glm::ivec2(1, 1), glm::ivec2(-1, 1), glm::ivec2(1, -1), glm::ivec2(-1, -1)
+};
+
+typedef WorldPathfinder::Cluster Cluster;
+typedef WorldPathfinder::ClusterPtr ClusterPtr;
+
+/**
+ * The search state for the cells of one cluster. The arrays are only growing and are reused by the next
+ * search - a stamp marks the entries that belong to the current search.
+ */
+struct LocalScratch {
+	std::vector<float> g;
+	std::vector<int32_t> parent;
+	std::vector<uint32_t> visited;
+	std::vector<uint32_t> closed;
+	uint32_t stamp = 0u;
+	voxel::OpenNodesContainer open;
+
+	void reset(size_t cells) {
+		if (visited.size() < cells) {
+			g.resize(cells);
+			parent.resize(cells);
+			visited.resize(cells, 0u);
+			closed.resize(cells, 0u);
+		}
+		if (++stamp == 0u) {
+			std::fill(visited.begin(), visited.end(), 0u);
+			std::fill(closed.begin(), closed.end(), 0u);
+			stamp = 1u;
+		}
+		open.clear();
+	}
+
+	inline float cost(int32_t cell) const {
+		return visited[cell] == stamp ? g[cell] : Unreachable;
+	}
+
+	inline void set(int32_t cell, float cost, int32_t from) {
+		visited[cell] = stamp;
+		g[cell] = cost;
+		parent[cell] = from;
+	}
+};
+
+struct AbstractNode {
+	glm::ivec3 pos;
+	ClusterPtr cluster;
+	float g;
+	int32_t parent;
+	bool closed;
+};
+
+/**
+ * The search state for the entrances of the clusters
+ */
+struct AbstractScratch {
+	std::vector<AbstractNode> nodes;
+	core::Map<glm::ivec3, int32_t, 1024, glm::hash<glm::ivec3>> indices;
+	voxel::OpenNodesContainer open;
+	std::vector<float> startCosts;
+	std::vector<float> goalCosts;
+
+	void reset() {
+		nodes.clear();
+		indices.clear();
+		open.clear();
+	}
+};
+
+thread_local LocalScratch localScratch;
+thread_local AbstractScratch abstractScratch;
+
+inline float estimate(const glm::ivec3& a, const glm::ivec3& b) {
+	const int dx = glm::abs(a.x - b.x);
+	const int dz = glm::abs(a.z - b.z);
+	return (float)core_max(dx, dz) + (DiagonalCost - 1.0f) * (float)core_min(dx, dz);
+}
+
+inline float stepCost(const glm::ivec3& a, const glm::ivec3& b) {
+	const float cost = a.x != b.x && a.z != b.z ? DiagonalCost : StraightCost;
+	return a.y != b.y ? cost + ClimbCost : cost;
+}
+
+template<class FUNC>
+void forEachNeighbour(const Cluster& cluster, int32_t cell, FUNC&& func) {
+	const int column = cluster.cellColumns[cell];
+	const int lx = column % Cluster::Columns - 1;
+	const int lz = column / Cluster::Columns - 1;
+	const int y = cluster.floors[cell];
+	for (const glm::ivec2& dir : Directions) {
+		const int nx = lx + dir.x;
+		const int nz = lz + dir.y;
+		if (nx < 0 || nz < 0 || nx >= WorldPathfinder::ClusterSize || nz >= WorldPathfinder::ClusterSize) {
+			continue;
+		}
+		const int32_t neighbour = cluster.findCell(nx, nz, y, 1);
+		if (neighbour == -1) {
+			continue;
+		}
+		float cost = StraightCost;
+		if (dir.x != 0 && dir.y != 0) {
+			// don't cut corners
+			if (cluster.findCell(nx, lz, y, 1) == -1 || cluster.findCell(lx, nz, y, 1) == -1) {
+				continue;
+			}
+			cost = DiagonalCost;
+		}
+		if (cluster.floors[neighbour] != y) {
+			cost += ClimbCost;
+		}
+		func(neighbour, cost);
+	}
+}
+
+/**
+ * @brief A* over the cells of the cluster - the path doesn't leave the cluster.
+ * @return @c false if there is no path. Otherwise the cells from @c from to @c to are appended to the path.
+ */
+bool localSearch(const Cluster& cluster, int32_t from, int32_t to, WorldPathfinder::Path& path) {
+	LocalScratch& s = localScratch;
+	s.reset(cluster.floors.size());
+	const glm::ivec3& target = cluster.position(to);
+	s.set(from, 0.0f, -1);
+	s.open.insert(from, estimate(cluster.position(from), target));
+	bool found = false;
+	while (!s.open.empty()) {
+		const int32_t current = s.open.getFirst();
+		s.open.removeFirst();
+		if (current == to) {
+			found = true;
+			break;
+		}
+		s.closed[current] = s.stamp;
+		const float g = s.g[current];
+		forEachNeighbour(cluster, current, [&] (int32_t neighbour, float cost) {
+			if (s.closed[neighbour] == s.stamp) {
+				return;
+			}
+			const float newCost = g + cost;
+			if (newCost < s.cost(neighbour)) {
+				s.set(neighbour, newCost, current);
+				s.open.insert(neighbour, newCost + estimate(cluster.position(neighbour), target));
+			}
+		});
+	}
+	if (!found) {
+		return false;
+	}
+	const size_t offset = path.size();
+	for (int32_t cell = to; cell != -1; cell = s.parent[cell]) {
+		path.push_back(cluster.position(cell));
+	}
+	std::reverse(path.begin() + offset, path.end());
+	return true;
+}
+
+/**
+ * @brief Dijkstra over the cells of the cluster - fills the path costs from the given cell to each entrance
+ */
+void entranceCosts(const Cluster& cluster, int32_t from, std::vector<float>& costs) {
+	LocalScratch& s = localScratch;
+	s.reset(cluster.floors.size());
+	s.set(from, 0.0f, -1);
+	s.open.insert(from, 0.0f);
+	while (!s.open.empty()) {
+		const int32_t current = s.open.getFirst();
+		s.open.removeFirst();
+		s.closed[current] = s.stamp;
+		const float g = s.g[current];
+		forEachNeighbour(cluster, current, [&] (int32_t neighbour, float cost) {
+			if (s.closed[neighbour] == s.stamp) {
+				return;
+			}
+			const float newCost = g + cost;
+			if (newCost < s.cost(neighbour)) {
+				s.set(neighbour, newCost, current);
+				s.open.insert(neighbour, newCost);
+			}
+		});
+	}
+	costs.resize(cluster.entrances.size());
+	for (size_t i = 0; i < cluster.entrances.size(); ++i) {
+		costs[i] = s.cost(cluster.entrances[i].cell);
+	}
+}
+
+inline bool lessThan(const glm::ivec3& a, const glm::ivec3& b) {
+	if (a.x != b.x) {
+		return a.x < b.x;
+	}
+	if (a.y != b.y) {
+		return a.y < b.y;
+	}
+	return a.z < b.z;
+}
+
+}
+
+int32_t WorldPathfinder::Cluster::findCell(int lx, int lz, int y, int maxDistanceY) const {
+	const int c = column(lx, lz);
+	int32_t best = -1;
+	int bestDistance = maxDistanceY + 1;
+	for (int32_t cell = columnStart[c]; cell < columnStart[c + 1]; ++cell) {
+		const int distance = glm::abs((int)floors[cell] - y);
+		if (distance < bestDistance) {
+			best = cell;
+			bestDistance = distance;
+		}
+	}
+	return best;
+}
+
+glm::ivec3 WorldPathfinder::Cluster::position(int32_t cell) const {
+	const int c = cellColumns[cell];
+	return origin + glm::ivec3(c % Columns - 1, floors[cell], c / Columns - 1);
+}
+
+WorldPathfinder::~WorldPathfinder() {
+	shutdown();
+}
+
+bool WorldPathfinder::init(voxel::PagedVolume* volumeData, int threads) {
+	if (volumeData == nullptr || threads <= 0) {
+		return false;
+	}
+	_volumeData = volumeData;
+	_volumeData->addListener(this);
+	_threads = threads;
+	_threadPool = std::make_unique<core::ThreadPool>(threads, "Pathfinder");
+	_threadPool->init();
+	return true;
+}
+
+void WorldPathfinder::shutdown() {
+	if (_volumeData != nullptr) {
+		_volumeData->removeListener(this);
+	}
+	if (_threadPool) {
+		// queued batches are dropped - the running ones are finished
+		_threadPool->shutdown();
+		_threadPool.reset();
+	}
+	{
+		core::ScopedLock lock(_requestLock);
+		for (Request& request : _requests) {
+			request.promise.set_value(PathPtr());
+		}
+		_requests.clear();
+		_runningBatches = 0;
+	}
+	core::ScopedLock lock(_cacheLock);
+	_clusters.clear();
+	_paths.clear();
+	_clusterPaths.clear();
+	_volumeData = nullptr;
+}
+
+WorldPathfinder::ClusterPtr WorldPathfinder::buildCluster(const glm::ivec3& key) const {
+	core_trace_scoped(WorldPathfinderBuildCluster);
+	std::shared_ptr<Cluster> cluster = std::make_shared<Cluster>();
+	cluster->key = key;
+	cluster->origin = glm::ivec3(key.x * ClusterSize, 0, key.z * ClusterSize);
+	cluster->columnStart.reserve(Cluster::Columns * Cluster::Columns + 1);
+
+	voxel::PagedVolume::Sampler sampler(_volumeData);
+	for (int lz = -1; lz <= ClusterSize; ++lz) {
+		for (int lx = -1; lx <= ClusterSize; ++lx) {
+			const int column = Cluster::column(lx, lz);
+			cluster->columnStart.push_back((int32_t)cluster->floors.size());
+			sampler.setPosition(cluster->origin.x + lx, 0, cluster->origin.z + lz);
+			bool solidBelow = !voxel::isEnterable(sampler.voxel().getMaterial());
+			sampler.movePositiveY();
+			bool enterable = voxel::isEnterable(sampler.voxel().getMaterial());
+			for (int y = 1; y < voxel::MAX_HEIGHT; ++y) {
+				sampler.movePositiveY();
+				const bool enterableAbove = voxel::isEnterable(sampler.voxel().getMaterial());
+				if (solidBelow && enterable && enterableAbove) {
+					cluster->floors.push_back((uint8_t)y);
+					cluster->cellColumns.push_back((uint16_t)column);
+				}
+				solidBelow = !enterable;
+				enterable = enterableAbove;
+			}
+		}
+	}
+	cluster->columnStart.push_back((int32_t)cluster->floors.size());
+
+	// the entrances are only depending on the two columns along the border - so the neighbouring cluster
+	// finds the same transitions and picks the same entrances
+	struct Border {
+		glm::ivec2 inner;
+		glm::ivec2 outer;
+		glm::ivec2 step;
+	};
+	const int last = ClusterSize - 1;
+	const Border borders[] = {
+		{glm::ivec2(0, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1)},
+		{glm::ivec2(last, 0), glm::ivec2(ClusterSize, 0), glm::ivec2(0, 1)},
+		{glm::ivec2(0, 0), glm::ivec2(0, -1), glm::ivec2(1, 0)},
+		{glm::ivec2(0, last), glm::ivec2(0, ClusterSize), glm::ivec2(1, 0)}
+	};
+	for (const Border& border : borders) {
+		auto addEntrances = [&] (int t, bool add) {
+			const glm::ivec2 inner = border.inner + border.step * t;
+			const glm::ivec2 outer = border.outer + border.step * t;
+			const int c = Cluster::column(inner.x, inner.y);
+			bool transition = false;
+			for (int32_t cell = cluster->columnStart[c]; cell < cluster->columnStart[c + 1]; ++cell) {
+				const int32_t partner = cluster->findCell(outer.x, outer.y, cluster->floors[cell], 1);
+				if (partner == -1) {
+					continue;
+				}
+				transition = true;
+				if (add) {
+					cluster->entrances.push_back(Cluster::Entrance{cell, cluster->position(cell), cluster->position(partner)});
+				}
+			}
+			return transition;
+		};
+		int t = 0;
+		while (t < ClusterSize) {
+			if (!addEntrances(t, false)) {
+				++t;
+				continue;
+			}
+			const int first = t;
+			while (t < ClusterSize && addEntrances(t, false)) {
+				++t;
+			}
+			const int length = t - first;
+			if (length >= LongBorder) {
+				addEntrances(first, true);
+				addEntrances(t - 1, true);
+			} else {
+				addEntrances(first + (length - 1) / 2, true);
+			}
+		}
+	}
+
+	const size_t entrances = cluster->entrances.size();
+	cluster->costs.resize(entrances * entrances);
+	std::vector<float> costs;
+	for (size_t i = 0; i < entrances; ++i) {
+		// corner cells might be entrances for two borders
+		if (i > 0 && cluster->entrances[i].cell == cluster->entrances[i - 1].cell) {
+			std::copy_n(&cluster->costs[(i - 1) * entrances], entrances, &cluster->costs[i * entrances]);
+			continue;
+		}
+		entranceCosts(*cluster, cluster->entrances[i].cell, costs);
+		std::copy(costs.begin(), costs.end(), &cluster->costs[i * entrances]);
+	}
+	return cluster;
+}
+
+WorldPathfinder::ClusterPtr WorldPathfinder::cluster(const glm::ivec3& pos) {
+	const glm::ivec3& key = clusterKey(pos);
+	{
+		core::ScopedLock lock(_cacheLock);
+		auto i = _clusters.find(key);
+		if (i != _clusters.end()) {
+			return i->value;
+		}
+	}
+	const int generation = _generation;
+	const ClusterPtr& cluster = buildCluster(key);
+	_clusterBuilds.increment();
+	core::ScopedLock lock(_cacheLock);
+	if (modifiedSince(key, generation)) {
+		// the voxels were modified while the cluster was built - it's only used for the current search
+		return cluster;
+	}
+	auto i = _clusters.find(key);
+	if (i != _clusters.end()) {
+		// another thread was faster
+		return i->value;
+	}
+	if ((int)_clusters.size() >= MaxCachedClusters) {
+		_clusters.clear();
+	}
+	_clusters.put(key, cluster);
+	return cluster;
+}
+
+bool WorldPathfinder::walkableCell(const glm::ivec3& pos, ClusterPtr& cluster, int32_t& cell) {
+	cluster = this->cluster(pos);
+	cell = cluster->findCell(pos.x - cluster->origin.x, pos.z - cluster->origin.z, pos.y, voxel::MAX_HEIGHT);
+	return cell != -1;
+}
+
+WorldPathfinder::PathPtr WorldPathfinder::search(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& touchedClusters) {
+	core_trace_scoped(WorldPathfinderSearch);
+	ClusterPtr startCluster;
+	ClusterPtr endCluster;
+	int32_t startCell;
+	int32_t endCell;
+	const bool walkable = walkableCell(start, startCluster, startCell) && walkableCell(end, endCluster, endCell);
+	touchedClusters.push_back(clusterKey(start));
+	touchedClusters.push_back(clusterKey(end));
+	if (!walkable) {
+		return PathPtr();
+	}
+	std::shared_ptr<Path> path = std::make_shared<Path>();
+	if (startCluster->key == endCluster->key && localSearch(*startCluster, startCell, endCell, *path)) {
+		return path;
+	}
+
+	AbstractScratch& s = abstractScratch;
+	s.reset();
+	entranceCosts(*startCluster, startCell, s.startCosts);
+	entranceCosts(*endCluster, endCell, s.goalCosts);
+
+	const glm::ivec3& startPos = startCluster->position(startCell);
+	const glm::ivec3& endPos = endCluster->position(endCell);
+	const int32_t startNode = 0;
+	const int32_t goalNode = 1;
+	s.nodes.push_back(AbstractNode{startPos, startCluster, 0.0f, -1, false});
+	// the goal node is not added to the index map - the goal cell might be an entrance, too
+	s.nodes.push_back(AbstractNode{endPos, endCluster, Unreachable, -1, false});
+	s.indices.put(startPos, startNode);
+	s.open.insert(startNode, estimate(startPos, endPos));
+
+	auto relax = [&] (int32_t node, float g, int32_t parent) {
+		AbstractNode& n = s.nodes[node];
+		if (n.closed || g >= n.g) {
+			return;
+		}
+		n.g = g;
+		n.parent = parent;
+		s.open.insert(node, g + estimate(n.pos, endPos));
+	};
+	auto nodeIndex = [&] (const glm::ivec3& pos, const ClusterPtr& cluster) {
+		int32_t index;
+		if (!s.indices.get(pos, index)) {
+			index = (int32_t)s.nodes.size();
+			s.nodes.push_back(AbstractNode{pos, cluster, Unreachable, -1, false});
+			s.indices.put(pos, index);
+		}
+		return index;
+	};
+
+	const glm::ivec3& mins = glm::min(startCluster->key, endCluster->key) - MaxDetourClusters;
+	const glm::ivec3& maxs = glm::max(startCluster->key, endCluster->key) + MaxDetourClusters;
+
+	bool found = false;
+	while (!s.open.empty()) {
+		const int32_t current = s.open.getFirst();
+		s.open.removeFirst();
+		if (current == goalNode) {
+			found = true;
+			break;
+		}
+		if ((int)s.nodes.size() > MaxAbstractNodes) {
+			break;
+		}
+		s.nodes[current].closed = true;
+		// the node pool might grow while the neighbours are added
+		const glm::ivec3 pos = s.nodes[current].pos;
+		const ClusterPtr cluster = s.nodes[current].cluster;
+		const float g = s.nodes[current].g;
+		const size_t entrances = cluster->entrances.size();
+		if (current == startNode) {
+			for (size_t i = 0; i < entrances; ++i) {
+				if (s.startCosts[i] != Unreachable) {
+					relax(nodeIndex(cluster->entrances[i].pos, cluster), g + s.startCosts[i], current);
+				}
+			}
+		}
+		const bool goalCluster = cluster->key == endCluster->key;
+		for (size_t i = 0; i < entrances; ++i) {
+			const Cluster::Entrance& entrance = cluster->entrances[i];
+			if (entrance.pos != pos) {
+				continue;
+			}
+			for (size_t j = 0; j < entrances; ++j) {
+				const float cost = cluster->cost(i, j);
+				if (j != i && cost != Unreachable) {
+					relax(nodeIndex(cluster->entrances[j].pos, cluster), g + cost, current);
+				}
+			}
+			const glm::ivec3& partnerKey = clusterKey(entrance.partner);
+			if (partnerKey.x >= mins.x && partnerKey.x <= maxs.x && partnerKey.z >= mins.z && partnerKey.z <= maxs.z) {
+				const ClusterPtr& partnerCluster = this->cluster(entrance.partner);
+				relax(nodeIndex(entrance.partner, partnerCluster), g + stepCost(pos, entrance.partner), current);
+			}
+			if (goalCluster && s.goalCosts[i] != Unreachable) {
+				relax(goalNode, g + s.goalCosts[i], current);
+			}
+		}
+	}
+	if (!found) {
+		// the result depends on all clusters that were visited
+		for (const AbstractNode& node : s.nodes) {
+			touchedClusters.push_back(node.cluster->key);
+		}
+		return PathPtr();
+	}
+
+	// refine the path between the entrances into the cells of the clusters
+	std::vector<int32_t> waypoints;
+	for (int32_t node = goalNode; node != -1; node = s.nodes[node].parent) {
+		waypoints.push_back(node);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	path->push_back(startPos);
+	for (size_t i = 1; i < waypoints.size(); ++i) {
+		const AbstractNode& from = s.nodes[waypoints[i - 1]];
+		const AbstractNode& to = s.nodes[waypoints[i]];
+		if (from.pos == to.pos) {
+			continue;
+		}
+		const Cluster& cluster = *to.cluster;
+		if (from.cluster->key != cluster.key) {
+			// the step over the border to the partner entrance
+			path->push_back(to.pos);
+			touchedClusters.push_back(cluster.key);
+			continue;
+		}
+		const int32_t fromCell = cluster.findCell(from.pos.x - cluster.origin.x, from.pos.z - cluster.origin.z, from.pos.y, 0);
+		const int32_t toCell = cluster.findCell(to.pos.x - cluster.origin.x, to.pos.z - cluster.origin.z, to.pos.y, 0);
+		if (fromCell == -1 || toCell == -1) {
+			return PathPtr();
+		}
+		// the first cell is already part of the path
+		path->pop_back();
+		if (!localSearch(cluster, fromCell, toCell, *path)) {
+			return PathPtr();
+		}
+	}
+	return path;
+}
+
+WorldPathfinder::PathPtr WorldPathfinder::findPath(const glm::ivec3& start, const glm::ivec3& end) {
+	core_trace_scoped(WorldPathfinderFindPath);
+	if (_volumeData == nullptr) {
+		return PathPtr();
+	}
+	const PathKey key{start, end};
+	{
+		core::ScopedLock lock(_cacheLock);
+		auto i = _paths.find(key);
+		if (i != _paths.end()) {
+			_pathCacheHits.increment();
+			return i->value.path;
+		}
+	}
+	const int generation = _generation;
+	std::vector<glm::ivec3> touchedClusters;
+	const PathPtr& path = search(start, end, touchedClusters);
+	_pathSearches.increment();
+	std::sort(touchedClusters.begin(), touchedClusters.end(), lessThan);
+	touchedClusters.erase(std::unique(touchedClusters.begin(), touchedClusters.end()), touchedClusters.end());
+	core::ScopedLock lock(_cacheLock);
+	for (const glm::ivec3& touched : touchedClusters) {
+		if (modifiedSince(touched, generation)) {
+			return path;
+		}
+	}
+	if ((int)_paths.size() >= MaxCachedPaths) {
+		_paths.clear();
+		_clusterPaths.clear();
+	}
+	removePath(key);
+	for (const glm::ivec3& touched : touchedClusters) {
+		auto i = _clusterPaths.find(touched);
+		if (i == _clusterPaths.end()) {
+			_clusterPaths.put(touched, std::vector<PathKey>{key});
+		} else {
+			i->value.push_back(key);
+		}
+	}
+	_paths.put(key, CachedPath{path, core::move(touchedClusters)});
+	return path;
+}
+
+std::future<WorldPathfinder::PathPtr> WorldPathfinder::findPathAsync(const glm::ivec3& start, const glm::ivec3& end) {
+	Request request{start, end, std::promise<PathPtr>()};
+	std::future<PathPtr> future = request.promise.get_future();
+	core::ScopedLock lock(_requestLock);
+	if (!_threadPool) {
+		request.promise.set_value(PathPtr());
+		return future;
+	}
+	_requests.push_back(std::move(request));
+	if (_runningBatches < _threads) {
+		++_runningBatches;
+		if (!_threadPool->schedule([this] () { processBatch(); })) {
+			--_runningBatches;
+		}
+	}
+	return future;
+}
+
+void WorldPathfinder::processBatch() {
+	std::vector<Request> batch;
+	batch.reserve(BatchSize);
+	for (;;) {
+		batch.clear();
+		{
+			core::ScopedLock lock(_requestLock);
+			if (_requests.empty()) {
+				--_runningBatches;
+				return;
+			}
+			const size_t n = core_min(_requests.size(), BatchSize);
+			std::move(_requests.begin(), _requests.begin() + n, std::back_inserter(batch));
+			_requests.erase(_requests.begin(), _requests.begin() + n);
+		}
+		core_trace_scoped(WorldPathfinderBatch);
+		_batches.increment();
+		// equal requests are next to each other and are only searched once
+		std::sort(batch.begin(), batch.end(), [] (const Request& a, const Request& b) {
+			if (a.start != b.start) {
+				return lessThan(a.start, b.start);
+			}
+			return lessThan(a.end, b.end);
+		});
+		PathPtr path;
+		for (size_t i = 0; i < batch.size(); ++i) {
+			Request& request = batch[i];
+			if (i == 0 || request.start != batch[i - 1].start || request.end != batch[i - 1].end) {
+				path = findPath(request.start, request.end);
+			}
+			request.promise.set_value(path);
+		}
+	}
+}
+
+bool WorldPathfinder::modifiedSince(const glm::ivec3& key, int generation) const {
+	if (generation < _forgottenGeneration) {
+		return true;
+	}
+	int modified;
+	return _clusterGenerations.get(key, modified) && modified > generation;
+}
+
+bool WorldPathfinder::pathModified(const Path& path, size_t start, int generation) const {
+	core::ScopedLock lock(_cacheLock);
+	for (size_t i = start; i < path.size(); ++i) {
+		const glm::ivec3& key = clusterKey(path[i]);
+		if (i > start && key == clusterKey(path[i - 1])) {
+			continue;
+		}
+		if (modifiedSince(key, generation)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorldPathfinder::removePath(const PathKey& key) {
+	auto i = _paths.find(key);
+	if (i == _paths.end()) {
+		return;
+	}
+	for (const glm::ivec3& touched : i->value.clusters) {
+		auto c = _clusterPaths.find(touched);
+		if (c == _clusterPaths.end()) {
+			continue;
+		}
+		std::vector<PathKey>& keys = c->value;
+		keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+		if (keys.empty()) {
+			_clusterPaths.remove(touched);
+		}
+	}
+	_paths.remove(key);
+}
+
+void WorldPathfinder::invalidate(const voxel::Region& region) {
+	// the clusters contain the columns around them, too
+	const glm::ivec3& mins = clusterKey(region.getLowerCorner() - 1);
+	const glm::ivec3& maxs = clusterKey(region.getUpperCorner() + 1);
+	core::ScopedLock lock(_cacheLock);
+	_generation.increment();
+	const int generation = _generation;
+	if ((int)_clusterGenerations.size() >= MaxClusterGenerations) {
+		_clusterGenerations.clear();
+		_forgottenGeneration = generation;
+	}
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			const glm::ivec3 key(x, 0, z);
+			_clusterGenerations.put(key, generation);
+			_clusters.remove(key);
+			std::vector<PathKey> paths;
+			if (!_clusterPaths.get(key, paths)) {
+				continue;
+			}
+			for (const PathKey& pathKey : paths) {
+				removePath(pathKey);
+			}
+		}
+	}
+}
+
+void WorldPathfinder::onVoxelsModified(const voxel::Region& region) {
+	invalidate(region);
+}
+
+int WorldPathfinder::cachedClusters() const {
+	core::ScopedLock lock(_cacheLock);
+	return (int)_clusters.size();
+}
+
+int WorldPathfinder::cachedPaths() const {
+	core::ScopedLock lock(_cacheLock);
+	return (int)_paths.size();
+}
+
+WorldPathfinder::Statistics WorldPathfinder::statistics() const {
+	Statistics stats;
+	stats.clusterBuilds = _clusterBuilds;
+	stats.pathSearches = _pathSearches;
+	stats.pathCacheHits = _pathCacheHits;
+	stats.batches = _batches;
+	return stats;
+}
+
+}
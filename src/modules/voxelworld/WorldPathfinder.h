@@ -0,0 +1,252 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "voxel/Region.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/collection/Map.h"
+#include "core/GLM.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace voxelworld {
+
+/**
+ * @brief Finds paths for actors that walk on the surface of the world.
+ *
+ * A walkable cell is an enterable voxel with a solid voxel below and an enterable voxel above it. An actor
+ * can move to the eight horizontal neighbours of a cell if the height difference is at most one voxel.
+ *
+ * The search is hierarchical: the world is split into columns of @c ClusterSize x @c ClusterSize voxels that
+ * span the whole world height and are aligned to the chunks of the volume. For each cluster the walkable cells,
+ * the entrances on the borders to the neighbouring clusters and the path costs between these entrances are
+ * computed once and cached. A path request is answered by a search over the entrances of the clusters that is
+ * refined into voxel steps in each cluster along the way afterwards. The search only enters the clusters in a
+ * small margin around the clusters of the start and the end position.
+ *
+ * The results are cached, too - this includes the requests without a path. Modifying voxels of the volume
+ * drops the affected clusters and all results that depend on them. Clusters and paths that were computed while
+ * one of their clusters was modified are returned, but not cached.
+ *
+ * Asynchronous requests are collected and handed over to an own thread pool in batches - requests with the same
+ * start and end position in one batch are only searched once.
+ *
+ * @note The search nodes are pooled per thread - a search doesn't allocate memory once the pools have grown.
+ */
+class WorldPathfinder : public voxel::PagedVolume::Listener, public core::NonCopyable {
+public:
+	/**
+	 * @brief The edge length of the clusters in voxels.
+	 */
+	static constexpr int ClusterSizePower = 5;
+	static constexpr int ClusterSize = 1 << ClusterSizePower;
+
+	/**
+	 * @brief The walkable cells from the start to the end position - both are included.
+	 */
+	typedef std::vector<glm::ivec3> Path;
+	typedef std::shared_ptr<const Path> PathPtr;
+
+	struct Cluster;
+	typedef std::shared_ptr<const Cluster> ClusterPtr;
+
+	struct Statistics {
+		int clusterBuilds = 0;
+		int pathSearches = 0;
+		int pathCacheHits = 0;
+		int batches = 0;
+	};
+
+private:
+	voxel::PagedVolume* _volumeData = nullptr;
+	std::unique_ptr<core::ThreadPool> _threadPool;
+	int _threads = 0;
+
+	typedef core::Map<glm::ivec3, ClusterPtr, 256, glm::hash<glm::ivec3>> Clusters;
+	Clusters _clusters;
+
+	struct PathKey {
+		glm::ivec3 start;
+		glm::ivec3 end;
+		inline bool operator==(const PathKey& rhs) const {
+			return start == rhs.start && end == rhs.end;
+		}
+	};
+	struct PathKeyHasher {
+		inline size_t operator()(const PathKey& key) const {
+			const glm::hash<glm::ivec3> hasher;
+			return hasher(key.start) * 31u + hasher(key.end);
+		}
+	};
+	struct CachedPath {
+		// @c nullptr if there is no path
+		PathPtr path;
+		// the keys of the clusters the result depends on
+		std::vector<glm::ivec3> clusters;
+	};
+	typedef core::Map<PathKey, CachedPath, 256, PathKeyHasher> Paths;
+	Paths _paths;
+	// the cached paths that depend on a cluster
+	typedef core::Map<glm::ivec3, std::vector<PathKey>, 256, glm::hash<glm::ivec3>> ClusterPaths;
+	ClusterPaths _clusterPaths;
+
+	// incremented with every invalidation
+	core::AtomicInt _generation { 0 };
+	// the generation of the last invalidation of a cluster - clusters and paths that were computed before one
+	// of their clusters was invalidated are not cached
+	typedef core::Map<glm::ivec3, int, 256, glm::hash<glm::ivec3>> ClusterGenerations;
+	ClusterGenerations _clusterGenerations;
+	// everything that was computed before this generation is treated as outdated - the cluster generations
+	// are forgotten once there are too many of them
+	int _forgottenGeneration = 0;
+	core_trace_mutex(core::Lock, _cacheLock, "WorldPathfinderCache");
+
+	struct Request {
+		glm::ivec3 start;
+		glm::ivec3 end;
+		std::promise<PathPtr> promise;
+	};
+	std::vector<Request> _requests;
+	// the amount of batch tasks that were handed over to the thread pool and are still running
+	int _runningBatches = 0;
+	core_trace_mutex(core::Lock, _requestLock, "WorldPathfinderRequests");
+
+	core::AtomicInt _clusterBuilds { 0 };
+	core::AtomicInt _pathSearches { 0 };
+	core::AtomicInt _pathCacheHits { 0 };
+	core::AtomicInt _batches { 0 };
+
+	ClusterPtr buildCluster(const glm::ivec3& key) const;
+	bool walkableCell(const glm::ivec3& pos, ClusterPtr& cluster, int32_t& cell);
+	PathPtr search(const glm::ivec3& start, const glm::ivec3& end, std::vector<glm::ivec3>& touchedClusters);
+	bool modifiedSince(const glm::ivec3& key, int generation) const;
+	void removePath(const PathKey& key);
+	void processBatch();
+
+public:
+	~WorldPathfinder();
+
+	/**
+	 * @param threads The amount of threads that answer the asynchronous path requests
+	 * @note Registers the pathfinder as listener at the volume
+	 */
+	bool init(voxel::PagedVolume* volumeData, int threads = 1);
+	void shutdown();
+
+	/**
+	 * @brief Computes the path on the calling thread.
+	 * @param[in] start The position of the actor - the closest walkable cell in this column is used
+	 * @param[in] end The target position - the closest walkable cell in this column is used
+	 * @return @c nullptr if there is no path
+	 */
+	PathPtr findPath(const glm::ivec3& start, const glm::ivec3& end);
+
+	/**
+	 * @brief Queues the path request for the thread pool.
+	 * @sa findPath()
+	 */
+	std::future<PathPtr> findPathAsync(const glm::ivec3& start, const glm::ivec3& end);
+
+	/**
+	 * @brief Drops the cached clusters and paths that depend on the voxels of the given region.
+	 */
+	void invalidate(const voxel::Region& region);
+	void onVoxelsModified(const voxel::Region& region) override;
+
+	/**
+	 * @brief Incremented with every invalidation.
+	 * @sa pathModified()
+	 */
+	int generation() const;
+	/**
+	 * @brief Checks whether one of the clusters of the path cells beginning at @c start was invalidated after
+	 * the given generation - the path should be requested again in this case.
+	 */
+	bool pathModified(const Path& path, size_t start, int generation) const;
+
+	/**
+	 * @brief The cluster for the given world position - it is computed if it's not cached yet.
+	 */
+	ClusterPtr cluster(const glm::ivec3& pos);
+
+	/**
+	 * @brief The key of the cluster that contains the given world position
+	 */
+	static glm::ivec3 clusterKey(const glm::ivec3& pos);
+
+	int cachedClusters() const;
+	int cachedPaths() const;
+	Statistics statistics() const;
+};
+
+/**
+ * @brief The walkable cells of a cluster and the entrances to the neighbouring clusters.
+ *
+ * The walkable cells are stored per column, the columns of the border of the neighbouring clusters are
+ * included to find the entrances. A cell is addressed by its index in @c floors.
+ */
+struct WorldPathfinder::Cluster {
+	glm::ivec3 key;
+	// the world position of the lower corner of the cluster
+	glm::ivec3 origin;
+	static constexpr int Columns = ClusterSize + 2;
+	// the cells of column @c c are stored in [columnStart[c], columnStart[c + 1])
+	std::vector<int32_t> columnStart;
+	// the height level of each walkable cell - sorted per column
+	std::vector<uint8_t> floors;
+	// the column of each cell
+	std::vector<uint16_t> cellColumns;
+
+	struct Entrance {
+		int32_t cell;
+		glm::ivec3 pos;
+		// the cell in the neighbouring cluster
+		glm::ivec3 partner;
+	};
+	std::vector<Entrance> entrances;
+	// the path costs between the entrances inside of the cluster - @c entrances.size() squared
+	std::vector<float> costs;
+
+	/**
+	 * @param lx The local x coordinate in the range [-1, ClusterSize]
+	 * @param lz The local z coordinate in the range [-1, ClusterSize]
+	 */
+	static inline int column(int lx, int lz) {
+		return (lz + 1) * Columns + lx + 1;
+	}
+
+	/**
+	 * @return The cell in the column at the local coordinates that is closest to the given height level
+	 * and not further away than @c maxDistanceY - or @c -1
+	 */
+	int32_t findCell(int lx, int lz, int y, int maxDistanceY) const;
+	glm::ivec3 position(int32_t cell) const;
+	float cost(int from, int to) const;
+	bool inside(const glm::ivec3& pos) const;
+};
+
+inline glm::ivec3 WorldPathfinder::clusterKey(const glm::ivec3& pos) {
+	return glm::ivec3(pos.x >> ClusterSizePower, 0, pos.z >> ClusterSizePower);
+}
+
+inline float WorldPathfinder::Cluster::cost(int from, int to) const {
+	return costs[from * entrances.size() + to];
+}
+
+inline int WorldPathfinder::generation() const {
+	return _generation;
+}
+
+inline bool WorldPathfinder::Cluster::inside(const glm::ivec3& pos) const {
+	return pos.x >= origin.x && pos.x < origin.x + ClusterSize && pos.z >= origin.z && pos.z < origin.z + ClusterSize;
+}
+
+}
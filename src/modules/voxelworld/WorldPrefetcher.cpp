@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "WorldPrefetcher.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include <algorithm>
+#include <vector>
+
+namespace voxelworld {
+
+// the predicted position is clamped to this amount of chunks away from the current position
+static constexpr int MaxPredictedChunks = 4;
+
+WorldPrefetcher::~WorldPrefetcher() {
+	shutdown();
+}
+
+bool WorldPrefetcher::init(voxel::PagedVolume* volumeData, int threads) {
+	if (volumeData == nullptr || threads <= 0) {
+		return false;
+	}
+	_volumeData = volumeData;
+	_threadPool = std::make_unique<core::ThreadPool>(threads, "WorldPrefetcher");
+	_threadPool->init();
+	return true;
+}
+
+void WorldPrefetcher::shutdown() {
+	if (_threadPool) {
+		// queued chunks are dropped - the running ones are finished
+		_threadPool->shutdown();
+		_threadPool.reset();
+	}
+	core::ScopedLock lock(_lock);
+	_inFlight.clear();
+	_volumeData = nullptr;
+}
+
+int WorldPrefetcher::pending() const {
+	core::ScopedLock lock(_lock);
+	return (int)_inFlight.size();
+}
+
+int WorldPrefetcher::prefetch(const glm::vec3& position, const glm::vec3& velocity, int radius) {
+	core_trace_scoped(WorldPrefetch);
+	if (_volumeData == nullptr) {
+		return 0;
+	}
+	const glm::ivec3& current = _volumeData->chunkPos(glm::ivec3(glm::floor(position)));
+	glm::ivec3 predicted = _volumeData->chunkPos(glm::ivec3(glm::floor(position + velocity * _lookAhead)));
+	predicted = glm::clamp(predicted, current - MaxPredictedChunks, current + MaxPredictedChunks);
+	predicted.y = current.y;
+
+	const glm::ivec3& mins = glm::min(current, predicted) - radius;
+	const glm::ivec3& maxs = glm::max(current, predicted) + radius;
+	std::vector<glm::ivec3> chunks;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			const glm::ivec3 pos(x, current.y, z);
+			const glm::ivec3& dc = glm::abs(pos - current);
+			const glm::ivec3& dp = glm::abs(pos - predicted);
+			if (core_max(dc.x, dc.z) > radius && core_max(dp.x, dp.z) > radius) {
+				continue;
+			}
+			if (_volumeData->hasChunk(pos)) {
+				continue;
+			}
+			chunks.push_back(pos);
+		}
+	}
+	if (chunks.empty()) {
+		return 0;
+	}
+	// the chunks the observer is moving into are needed first
+	std::sort(chunks.begin(), chunks.end(), [&] (const glm::ivec3& a, const glm::ivec3& b) {
+		const glm::ivec3& da = a - predicted;
+		const glm::ivec3& db = b - predicted;
+		return da.x * da.x + da.z * da.z < db.x * db.x + db.z * db.z;
+	});
+
+	int requested = 0;
+	core::ScopedLock lock(_lock);
+	for (const glm::ivec3& pos : chunks) {
+		if (_inFlight.hasKey(pos)) {
+			continue;
+		}
+		const core::ThreadPool::Priority priority = pos == predicted || pos == current ? core::ThreadPool::Priority::High : core::ThreadPool::Priority::Normal;
+		voxel::PagedVolume* volumeData = _volumeData;
+		_inFlight.put(pos, true);
+		const bool scheduled = _threadPool->schedule([this, volumeData, pos] () {
+			if (volumeData->prefetchChunk(pos)) {
+				_prefetched.increment();
+			}
+			core::ScopedLock lock(_lock);
+			_inFlight.remove(pos);
+		}, priority);
+		if (!scheduled) {
+			_inFlight.remove(pos);
+			break;
+		}
+		++requested;
+	}
+	if (requested > 0) {
+		Log::trace("Requested %i chunks around %i:%i:%i", requested, current.x, current.y, current.z);
+	}
+	return requested;
+}
+
+}
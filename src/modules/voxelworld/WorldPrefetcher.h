@@ -0,0 +1,84 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/collection/Map.h"
+#include "core/GLM.h"
+#include "core/NonCopyable.h"
+#include "core/Trace.h"
+#include <memory>
+
+namespace voxelworld {
+
+/**
+ * @brief Pages in the chunks around moving observers (players or the camera) on an own thread pool before
+ * they are accessed.
+ *
+ * Without prefetching the chunks are paged in by the first thread that accesses a voxel of them - this might be
+ * a mesh extraction worker or the server tick. The chunks are published into the @c voxel::PagedVolume while
+ * they are still paged in. Threads that access a chunk that is still in flight wait for it instead of paging it
+ * in again.
+ *
+ * @sa voxel::PagedVolume::prefetchChunk()
+ */
+class WorldPrefetcher : public core::NonCopyable {
+private:
+	voxel::PagedVolume* _volumeData = nullptr;
+	std::unique_ptr<core::ThreadPool> _threadPool;
+	typedef core::Map<glm::ivec3, bool, 64, glm::hash<glm::ivec3>> Chunks;
+	// the chunks that were handed over to the thread pool but weren't paged in yet
+	Chunks _inFlight;
+	core_trace_mutex(core::Lock, _lock, "WorldPrefetcher");
+	core::AtomicInt _prefetched { 0 };
+	float _lookAhead = 4.0f;
+public:
+	~WorldPrefetcher();
+
+	/**
+	 * @param threads The amount of threads that page in the chunks
+	 */
+	bool init(voxel::PagedVolume* volumeData, int threads = 2);
+	void shutdown();
+
+	/**
+	 * @brief The seconds the position of the observer is extrapolated with its velocity to predict the chunks
+	 * that are needed next.
+	 */
+	void setLookAhead(float lookAhead);
+
+	/**
+	 * @brief Requests the chunks around the current and the predicted position of an observer. The
+	 * chunks that are closest to the predicted position are requested first.
+	 * @param[in] position The current position of the observer in world coordinates
+	 * @param[in] velocity The velocity of the observer in world units per second
+	 * @param[in] radius The amount of chunks in each horizontal direction around the positions
+	 * @return The amount of chunks that were newly requested
+	 */
+	int prefetch(const glm::vec3& position, const glm::vec3& velocity, int radius = 1);
+
+	/**
+	 * @return The amount of chunks that are requested but not yet paged in
+	 */
+	int pending() const;
+
+	/**
+	 * @return The amount of chunks that were paged in by the prefetcher
+	 */
+	int prefetched() const;
+};
+
+inline void WorldPrefetcher::setLookAhead(float lookAhead) {
+	_lookAhead = lookAhead;
+}
+
+inline int WorldPrefetcher::prefetched() const {
+	return _prefetched;
+}
+
+}
@@ -0,0 +1,143 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "voxelworld/WorldPager.h"
+#include "voxelworld/WorldPathfinder.h"
+#include "voxelformat/VolumeCache.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/PagedVolume.h"
+#include "io/Filesystem.h"
+#include "math/Random.h"
+#include <future>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Measures the paths across the generated terrain of the world
+ */
+class PathfinderBenchmark: public app::AbstractBenchmark {
+protected:
+	// the world pager generates chunks that span the whole world height
+	static constexpr int ChunkSize = 256;
+	// the start and end positions of the paths are inside of this area
+	static constexpr int Area = 256;
+
+	voxelformat::VolumeCachePtr _volumeCache;
+	std::unique_ptr<voxelworld::WorldPager> _pager;
+	std::unique_ptr<voxel::PagedVolume> _volume;
+	voxelworld::WorldPathfinder _pathfinder;
+
+	void onCleanupApp() override {
+		_pathfinder.shutdown();
+		if (_pager) {
+			_pager->shutdown();
+		}
+		_volume.reset();
+		_pager.reset();
+		if (_volumeCache) {
+			_volumeCache->shutdown();
+		}
+	}
+
+	bool onInitApp() override {
+		voxel::initDefaultMaterialColors();
+		_volumeCache = std::make_shared<voxelformat::VolumeCache>();
+		if (!_volumeCache->init()) {
+			return false;
+		}
+		_pager = std::make_unique<voxelworld::WorldPager>(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+		_pager->setSeed(0l);
+		_volume = std::make_unique<voxel::PagedVolume>(_pager.get(), 1024 * 1024 * 1024, ChunkSize);
+		const io::FilesystemPtr& filesystem = io::filesystem();
+		const core::String& luaParameters = filesystem->load("worldparams.lua");
+		const core::String& luaBiomes = filesystem->load("biomes.lua");
+		if (!_pager->init(_volume.get(), luaParameters, luaBiomes)) {
+			return false;
+		}
+		return _pathfinder.init(_volume.get(), 4);
+	}
+
+	/**
+	 * @brief Builds the clusters of the area - the benchmarks of the searches don't include the terrain
+	 * generation and the cluster computation this way.
+	 */
+	void warmup() {
+		for (int z = -Area; z < 2 * Area; z += voxelworld::WorldPathfinder::ClusterSize) {
+			for (int x = -Area; x < 2 * Area; x += voxelworld::WorldPathfinder::ClusterSize) {
+				_pathfinder.cluster(glm::ivec3(x, 0, z));
+			}
+		}
+	}
+
+	static glm::ivec3 randomPos(const math::Random& random) {
+		return glm::ivec3(random.random(0, Area - 1), voxel::MAX_HEIGHT / 2, random.random(0, Area - 1));
+	}
+};
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, BuildCluster) (benchmark::State& state) {
+	// the chunks are generated once
+	warmup();
+	int i = 0;
+	for (auto _ : state) {
+		const glm::ivec3 pos((i % 8) * voxelworld::WorldPathfinder::ClusterSize, 0, ((i / 8) % 8) * voxelworld::WorldPathfinder::ClusterSize);
+		++i;
+		_pathfinder.invalidate(voxel::Region(pos, pos));
+		benchmark::DoNotOptimize(_pathfinder.cluster(pos));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, FindPath) (benchmark::State& state) {
+	warmup();
+	const math::Random random(1);
+	int found = 0;
+	for (auto _ : state) {
+		// every path is a new one - the path cache doesn't help here
+		const voxelworld::WorldPathfinder::PathPtr& path = _pathfinder.findPath(randomPos(random), randomPos(random));
+		if (path) {
+			++found;
+		}
+	}
+	state.counters["found"] = benchmark::Counter((double)found / (double)state.iterations());
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, FindPathCached) (benchmark::State& state) {
+	warmup();
+	const math::Random random(1);
+	std::vector<glm::ivec3> positions;
+	for (int i = 0; i < 32; ++i) {
+		positions.push_back(randomPos(random));
+	}
+	int i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_pathfinder.findPath(positions[i % positions.size()], positions[(i + 1) % positions.size()]));
+		++i;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PathfinderBenchmark, FindPathAsync) (benchmark::State& state) {
+	warmup();
+	const int requests = (int)state.range(0);
+	const math::Random random(1);
+	std::vector<std::future<voxelworld::WorldPathfinder::PathPtr>> futures;
+	futures.reserve(requests);
+	for (auto _ : state) {
+		futures.clear();
+		for (int i = 0; i < requests; ++i) {
+			futures.push_back(_pathfinder.findPathAsync(randomPos(random), randomPos(random)));
+		}
+		for (std::future<voxelworld::WorldPathfinder::PathPtr>& future : futures) {
+			benchmark::DoNotOptimize(future.get());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * requests);
+}
+
+BENCHMARK_REGISTER_F(PathfinderBenchmark, BuildCluster)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, FindPath)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, FindPathCached)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(PathfinderBenchmark, FindPathAsync)->Arg(64)->Unit(benchmark::kMillisecond);
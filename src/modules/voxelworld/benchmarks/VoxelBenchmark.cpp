@@ -4,10 +4,16 @@
 
 #include "app/benchmark/AbstractBenchmark.h"
 #include "voxelworld/WorldPager.h"
+#include "voxelworld/FilePersister.h"
 #include "voxel/PagedVolume.h"
 #include "voxelworld/BiomeManager.h"
+#include "voxelworld/WorldHeightmap.h"
+#include "voxelutil/FloorTrace.h"
 #include "voxel/Constants.h"
 #include "voxelformat/VolumeCache.h"
+#include "io/Filesystem.h"
+#include "core/StringUtil.h"
+#include <vector>
 
 class PagedVolumeBenchmark: public app::AbstractBenchmark {
 protected:
@@ -43,6 +49,187 @@ BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, generateChunk) (benchmark::State& state) {
+	voxelworld::WorldPager pager(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+	pager.setSeed(0l);
+	const int chunkSize = 256;
+	voxel::PagedVolume volumeData(&pager, 512 * 1024 * 1024, chunkSize);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	const core::String& luaParameters = filesystem->load("worldparams.lua");
+	const core::String& luaBiomes = filesystem->load("biomes.lua");
+	pager.init(&volumeData, luaParameters, luaBiomes);
+	int i = 0;
+	for (auto _ : state) {
+		const glm::ivec3 chunkPos(i % 8, 0, i / 8);
+		++i;
+		voxel::PagedVolume::PagerContext pctx;
+		pctx.chunk = core::make_shared<voxel::PagedVolume::Chunk>(chunkPos, chunkSize, &pager);
+		pctx.region = voxel::Region(chunkPos * chunkSize, chunkPos * chunkSize + chunkSize - 1);
+		pager.pageIn(pctx);
+	}
+	pager.shutdown();
+	state.SetItemsProcessed(state.iterations() * chunkSize * chunkSize * chunkSize);
+}
+
+/**
+ * @brief Floor queries on a generated chunk - traced through the volume (0) or answered by the heightmap (1)
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, findWalkableFloor) (benchmark::State& state) {
+	voxelworld::WorldPager pager(_volumeCache, std::make_shared<voxelworld::ChunkPersister>());
+	pager.setSeed(0l);
+	const int chunkSize = 256;
+	voxel::PagedVolume volumeData(&pager, 512 * 1024 * 1024, chunkSize);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	const core::String& luaParameters = filesystem->load("worldparams.lua");
+	const core::String& luaBiomes = filesystem->load("biomes.lua");
+	pager.init(&volumeData, luaParameters, luaBiomes);
+	voxelworld::WorldHeightmap heightmap;
+	if (state.range(0) != 0) {
+		heightmap.init(&volumeData);
+	}
+	volumeData.voxel(0, 0, 0);
+	voxel::PagedVolume::Sampler sampler(&volumeData);
+	int i = 0;
+	for (auto _ : state) {
+		const glm::ivec3 pos(i % chunkSize, voxel::MAX_HEIGHT / 2, (i / chunkSize) % chunkSize);
+		++i;
+		voxelutil::FloorTraceResult result;
+		if (!heightmap.findWalkableFloor(pos, voxel::MAX_HEIGHT, result)) {
+			result = voxelutil::findWalkableFloor(&sampler, pos, voxel::MAX_HEIGHT);
+		}
+		benchmark::DoNotOptimize(result);
+	}
+	heightmap.shutdown();
+	pager.shutdown();
+}
+
 BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageIn);
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, generateChunk)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, findWalkableFloor)->Arg(0)->Arg(1);
+
+class PersisterBenchmark: public app::AbstractBenchmark {
+protected:
+	class Pager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			return false;
+		}
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	static constexpr int ChunkSize = 64;
+	static constexpr int Chunks = 16;
+	Pager _pager;
+
+	voxel::PagedVolume::ChunkPtr createChunk(const glm::ivec3& pos, bool fill) {
+		voxel::PagedVolume::ChunkPtr chunk = core::make_shared<voxel::PagedVolume::Chunk>(pos, ChunkSize, &_pager);
+		if (!fill) {
+			return chunk;
+		}
+		for (int z = 0; z < ChunkSize; ++z) {
+			for (int x = 0; x < ChunkSize; ++x) {
+				const int height = 20 + (x * 7 + z * 13 + pos.x * 3 + pos.z * 5) % 17;
+				for (int y = 0; y < height; ++y) {
+					chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Dirt, (x + y + z) % 8));
+				}
+			}
+		}
+		chunk->compact();
+		return chunk;
+	}
+
+	std::vector<voxel::PagedVolume::ChunkPtr> createChunks() {
+		std::vector<voxel::PagedVolume::ChunkPtr> chunks;
+		chunks.reserve(Chunks * Chunks);
+		for (int i = 0; i < Chunks * Chunks; ++i) {
+			chunks.push_back(createChunk(chunkPos(i), true));
+		}
+		return chunks;
+	}
+
+	glm::ivec3 chunkPos(int i) const {
+		return glm::ivec3(i % Chunks, 0, i / Chunks);
+	}
+
+	/**
+	 * @brief The old way to persist the chunks - one file per chunk
+	 */
+	static core::String chunkFile(const glm::ivec3& pos) {
+		return core::string::format("benchmark_%i_%i_%i.wld", pos.x, pos.y, pos.z);
+	}
+};
+
+BENCHMARK_DEFINE_F(PersisterBenchmark, RegionFileSave) (benchmark::State& state) {
+	voxelworld::FilePersister persister;
+	const std::vector<voxel::PagedVolume::ChunkPtr>& chunks = createChunks();
+	int i = 0;
+	for (auto _ : state) {
+		persister.save(chunks[i++ % chunks.size()], 1u);
+	}
+	persister.shutdown();
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PersisterBenchmark, ChunkFileSave) (benchmark::State& state) {
+	voxelworld::ChunkPersister persister;
+	const std::vector<voxel::PagedVolume::ChunkPtr>& chunks = createChunks();
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	int i = 0;
+	for (auto _ : state) {
+		const voxel::PagedVolume::ChunkPtr& chunk = chunks[i++ % chunks.size()];
+		core::ByteStream stream;
+		persister.saveCompressed(chunk, stream);
+		filesystem->write(chunkFile(chunk->chunkPos()), stream.getBuffer(), stream.getSize());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PersisterBenchmark, RegionFileLoad) (benchmark::State& state) {
+	voxelworld::FilePersister persister;
+	for (const voxel::PagedVolume::ChunkPtr& chunk : createChunks()) {
+		persister.save(chunk, 2u);
+	}
+	int i = 0;
+	for (auto _ : state) {
+		const voxel::PagedVolume::ChunkPtr& target = createChunk(chunkPos(i++ % (Chunks * Chunks)), false);
+		if (!persister.load(target, 2u)) {
+			state.SkipWithError("Failed to load chunk");
+			break;
+		}
+	}
+	persister.shutdown();
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(PersisterBenchmark, ChunkFileLoad) (benchmark::State& state) {
+	voxelworld::ChunkPersister persister;
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	for (const voxel::PagedVolume::ChunkPtr& chunk : createChunks()) {
+		core::ByteStream stream;
+		persister.saveCompressed(chunk, stream);
+		filesystem->write(chunkFile(chunk->chunkPos()), stream.getBuffer(), stream.getSize());
+	}
+	int i = 0;
+	for (auto _ : state) {
+		const glm::ivec3& pos = chunkPos(i++ % (Chunks * Chunks));
+		const voxel::PagedVolume::ChunkPtr& target = createChunk(pos, false);
+		const io::FilePtr& file = filesystem->open(chunkFile(pos));
+		uint8_t *buf;
+		const int len = file->read((void **) &buf);
+		const bool success = persister.loadCompressed(target, buf, len);
+		delete[] buf;
+		if (!success) {
+			state.SkipWithError("Failed to load chunk");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(PersisterBenchmark, RegionFileSave);
+BENCHMARK_REGISTER_F(PersisterBenchmark, ChunkFileSave);
+BENCHMARK_REGISTER_F(PersisterBenchmark, RegionFileLoad);
+BENCHMARK_REGISTER_F(PersisterBenchmark, ChunkFileLoad);
 
 BENCHMARK_MAIN();
@@ -5,6 +5,8 @@
 #include "AbstractVoxelTest.h"
 #include "voxelworld/BiomeManager.h"
 #include "io/Filesystem.h"
+#include "core/ArrayLength.h"
+#include <limits>
 
 namespace voxelworld {
 
@@ -96,4 +98,74 @@ TEST_F(BiomeManagerTest, testCityGradient) {
 		<< "Out of the radius of the city - here we should not have any influence on the height anymore";
 }
 
+TEST_F(BiomeManagerTest, testBiomeLookupMatchesBestBiome) {
+	BiomeManager mgr;
+	mgr.init("");
+	std::vector<const Biome*> biomes;
+	const voxel::VoxelType types[] = {voxel::VoxelType::Grass, voxel::VoxelType::Rock, voxel::VoxelType::Sand,
+			voxel::VoxelType::Dirt};
+	for (int i = 0; i < 24; ++i) {
+		const float humidity = (float)((i * 7) % 24) / 23.0f;
+		const float temperature = (float)((i * 5) % 24) / 23.0f;
+		const int lower = (i % 4) * 20;
+		const Biome* biome = mgr.addBiome(lower, lower + 40, humidity, temperature, types[i % lengthof(types)], i % 3 == 0, 90);
+		ASSERT_NE(nullptr, biome);
+		biomes.push_back(biome);
+	}
+	for (int x = -2000; x <= 2000; x += 97) {
+		for (int z = -2000; z <= 2000; z += 89) {
+			const float humidity = BiomeManager::getHumidity(x, z);
+			const float temperature = BiomeManager::getTemperature(x, z);
+			for (int y = 0; y < 120; y += 7) {
+				for (int underground = 0; underground <= 1; ++underground) {
+					const Biome* expected = nullptr;
+					float distMin = (std::numeric_limits<float>::max)();
+					for (const Biome* biome : biomes) {
+						if (y > biome->yMax || y < biome->yMin || biome->underground != (underground != 0)) {
+							continue;
+						}
+						const float dTemperature = temperature - biome->temperature;
+						const float dHumidity = humidity - biome->humidity;
+						const float dist = (dTemperature * dTemperature) + (dHumidity * dHumidity);
+						if (dist < distMin) {
+							expected = biome;
+							distMin = dist;
+						}
+					}
+					const Biome* biome = mgr.getBiome(glm::ivec3(x, y, z), underground != 0);
+					if (expected == nullptr) {
+						EXPECT_EQ(0, (int)biome->yMin) << "expected the default biome at " << x << ":" << y << ":" << z;
+					} else {
+						ASSERT_EQ(expected, biome) << "wrong biome at " << x << ":" << y << ":" << z;
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_F(BiomeManagerTest, testZoneGrid) {
+	BiomeManager mgr;
+	mgr.init("");
+	mgr.addZone(glm::ivec3(-1000, 0, -1000), 300.0f, ZoneType::City);
+	mgr.addZone(glm::ivec3(10, 0, 10), 100.0f, ZoneType::City);
+	mgr.addZone(glm::ivec3(0, 0, 0), 500.0f, ZoneType::City);
+
+	const Zone* zone = mgr.getZone(glm::ivec2(-1200, -1200), ZoneType::City);
+	ASSERT_NE(nullptr, zone);
+	EXPECT_EQ(glm::ivec3(-1000, 0, -1000), zone->pos());
+	EXPECT_EQ(nullptr, mgr.getZone(glm::ivec2(-1300, -1300), ZoneType::City));
+
+	zone = mgr.getZone(glm::ivec2(50, 50), ZoneType::City);
+	ASSERT_NE(nullptr, zone);
+	EXPECT_EQ(glm::ivec3(10, 0, 10), zone->pos()) << "The zone that was added first should win";
+
+	zone = mgr.getZone(glm::ivec2(-499, 0), ZoneType::City);
+	ASSERT_NE(nullptr, zone);
+	EXPECT_EQ(glm::ivec3(0), zone->pos());
+	EXPECT_EQ(nullptr, mgr.getZone(glm::ivec2(-500, 0), ZoneType::City));
+	EXPECT_TRUE(mgr.hasCity(glm::ivec3(0, 100, 300)));
+	EXPECT_FALSE(mgr.hasCity(glm::ivec3(0, 500, 0)));
+}
+
 }
@@ -19,4 +19,46 @@ TEST_F(WorldPersisterTest, testSaveLoad) {
 	ASSERT_EQ(voxel::VoxelType::Grass, _volData.voxel(32, 32, 32).getMaterial());
 }
 
+TEST_F(WorldPersisterTest, testErase) {
+	FilePersister persister;
+	const glm::ivec3 pos(-102, 0, 3);
+	voxel::PagedVolume::ChunkPtr chunk = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	chunk->setUniform(voxel::createVoxel(voxel::VoxelType::Water, 1));
+	ASSERT_TRUE(persister.save(chunk, _seed)) << "Could not save volume chunk";
+	persister.erase(voxel::Region(pos * 64, pos * 64 + 63), _seed);
+	voxel::PagedVolume::ChunkPtr loaded = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	EXPECT_FALSE(persister.load(loaded, _seed));
+}
+
+TEST_F(WorldPersisterTest, testSaveLoadUniform) {
+	FilePersister persister;
+	const glm::ivec3 pos(100, 0, 0);
+	const voxel::Voxel water = voxel::createVoxel(voxel::VoxelType::Water, 1);
+	voxel::PagedVolume::ChunkPtr chunk = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	chunk->setUniform(water);
+	ASSERT_TRUE(persister.save(chunk, _seed)) << "Could not save volume chunk";
+	voxel::PagedVolume::ChunkPtr loaded = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	ASSERT_TRUE(persister.load(loaded, _seed)) << "Could not load volume chunk";
+	EXPECT_EQ(voxel::PagedVolume::ChunkStorage::Uniform, loaded->storage());
+	EXPECT_TRUE(water.isIdentical(loaded->voxel(63, 63, 63)));
+}
+
+TEST_F(WorldPersisterTest, testSaveLoadPalette) {
+	FilePersister persister;
+	const glm::ivec3 pos(101, 0, 0);
+	const voxel::Voxel rock = voxel::createVoxel(voxel::VoxelType::Rock, 2);
+	voxel::PagedVolume::ChunkPtr chunk = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	for (int y = 0; y < 10; ++y) {
+		chunk->setVoxel(3, y, 5, rock);
+	}
+	ASSERT_TRUE(chunk->compact());
+	ASSERT_EQ(voxel::PagedVolume::ChunkStorage::Palette, chunk->storage());
+	ASSERT_TRUE(persister.save(chunk, _seed)) << "Could not save volume chunk";
+	voxel::PagedVolume::ChunkPtr loaded = core::make_shared<voxel::PagedVolume::Chunk>(pos, 64, &_pager);
+	ASSERT_TRUE(persister.load(loaded, _seed)) << "Could not load volume chunk";
+	EXPECT_EQ(voxel::PagedVolume::ChunkStorage::Palette, loaded->storage());
+	EXPECT_TRUE(rock.isIdentical(loaded->voxel(3, 9, 5)));
+	EXPECT_EQ(voxel::VoxelType::Air, loaded->voxel(3, 10, 5).getMaterial());
+}
+
 }
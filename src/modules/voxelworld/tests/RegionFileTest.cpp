@@ -0,0 +1,148 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/RegionFile.h"
+#include "io/Filesystem.h"
+#include <vector>
+
+namespace voxelworld {
+
+class RegionFileTest: public app::AbstractTest {
+protected:
+	core::String _path;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		const io::FilesystemPtr& filesystem = io::filesystem();
+		filesystem->createDir(filesystem->homePath());
+		_path = filesystem->writePath("regionfiletest.wrg");
+		filesystem->removeFile(_path);
+	}
+
+	void TearDown() override {
+		io::filesystem()->removeFile(_path);
+		app::AbstractTest::TearDown();
+	}
+
+	std::vector<uint8_t> data(size_t size, uint8_t start) const {
+		std::vector<uint8_t> buf(size);
+		for (size_t i = 0; i < size; ++i) {
+			buf[i] = (uint8_t)(start + i);
+		}
+		return buf;
+	}
+};
+
+TEST_F(RegionFileTest, testRegionPos) {
+	EXPECT_EQ(glm::ivec3(0, 0, 0), RegionFile::regionPos(glm::ivec3(RegionFile::RegionSize - 1, 0, 0)));
+	EXPECT_EQ(glm::ivec3(1, 0, 0), RegionFile::regionPos(glm::ivec3(RegionFile::RegionSize, 0, 0)));
+	EXPECT_EQ(glm::ivec3(-1, 0, -1), RegionFile::regionPos(glm::ivec3(-1, 0, -RegionFile::RegionSize)));
+}
+
+TEST_F(RegionFileTest, testWriteRead) {
+	RegionFile regionFile;
+	ASSERT_TRUE(regionFile.open(_path));
+	const std::vector<uint8_t>& a = data(100, 1);
+	const std::vector<uint8_t>& b = data(RegionFile::SectorSize * 2 + 1, 7);
+	EXPECT_FALSE(regionFile.contains(glm::ivec3(1, 0, 2)));
+	ASSERT_TRUE(regionFile.write(glm::ivec3(1, 0, 2), a.data(), a.size()));
+	ASSERT_TRUE(regionFile.write(glm::ivec3(-1, 0, -1), b.data(), b.size()));
+	EXPECT_TRUE(regionFile.contains(glm::ivec3(1, 0, 2)));
+	std::vector<uint8_t> out;
+	ASSERT_TRUE(regionFile.read(glm::ivec3(1, 0, 2), out));
+	EXPECT_EQ(a, out);
+	ASSERT_TRUE(regionFile.read(glm::ivec3(-1, 0, -1), out));
+	EXPECT_EQ(b, out);
+	EXPECT_FALSE(regionFile.read(glm::ivec3(2, 0, 2), out));
+}
+
+TEST_F(RegionFileTest, testReopen) {
+	const std::vector<uint8_t>& a = data(100, 1);
+	const std::vector<uint8_t>& b = data(3000, 2);
+	const std::vector<uint8_t>& c = data(10, 3);
+	{
+		RegionFile regionFile;
+		ASSERT_TRUE(regionFile.open(_path));
+		ASSERT_TRUE(regionFile.write(glm::ivec3(0, 0, 0), a.data(), a.size()));
+		ASSERT_TRUE(regionFile.write(glm::ivec3(1, 1, 1), b.data(), b.size()));
+		// replaces the data of the first chunk
+		ASSERT_TRUE(regionFile.write(glm::ivec3(0, 0, 0), c.data(), c.size()));
+	}
+	RegionFile regionFile;
+	ASSERT_TRUE(regionFile.open(_path));
+	std::vector<uint8_t> out;
+	ASSERT_TRUE(regionFile.read(glm::ivec3(0, 0, 0), out));
+	EXPECT_EQ(c, out);
+	ASSERT_TRUE(regionFile.read(glm::ivec3(1, 1, 1), out));
+	EXPECT_EQ(b, out);
+	// appending after reopening must not overwrite existing data
+	ASSERT_TRUE(regionFile.write(glm::ivec3(2, 2, 2), a.data(), a.size()));
+	ASSERT_TRUE(regionFile.read(glm::ivec3(1, 1, 1), out));
+	EXPECT_EQ(b, out);
+	EXPECT_EQ(0, (int)(io::filesystem()->open(_path, io::FileMode::SysRead)->length() % RegionFile::SectorSize));
+}
+
+TEST_F(RegionFileTest, testErase) {
+	RegionFile regionFile;
+	ASSERT_TRUE(regionFile.open(_path));
+	const std::vector<uint8_t>& a = data(100, 1);
+	ASSERT_TRUE(regionFile.write(glm::ivec3(3, 0, 3), a.data(), a.size()));
+	ASSERT_TRUE(regionFile.erase(glm::ivec3(3, 0, 3)));
+	EXPECT_FALSE(regionFile.contains(glm::ivec3(3, 0, 3)));
+	regionFile.close();
+	ASSERT_TRUE(regionFile.open(_path));
+	EXPECT_FALSE(regionFile.contains(glm::ivec3(3, 0, 3)));
+}
+
+TEST_F(RegionFileTest, testReuseSectors) {
+	RegionFile regionFile;
+	ASSERT_TRUE(regionFile.open(_path));
+	const std::vector<uint8_t>& a = data(RegionFile::SectorSize * 3, 1);
+	const std::vector<uint8_t>& b = data(RegionFile::SectorSize, 2);
+	ASSERT_TRUE(regionFile.write(glm::ivec3(0, 0, 0), a.data(), a.size()));
+	ASSERT_TRUE(regionFile.write(glm::ivec3(1, 0, 0), b.data(), b.size()));
+	const uint32_t sectors = regionFile.sectors();
+	// rewriting the chunks again and again doesn't let the file grow
+	for (int i = 0; i < 10; ++i) {
+		const std::vector<uint8_t>& c = data(RegionFile::SectorSize * (1 + i % 3), (uint8_t)i);
+		ASSERT_TRUE(regionFile.write(glm::ivec3(0, 0, 0), c.data(), c.size()));
+		std::vector<uint8_t> out;
+		ASSERT_TRUE(regionFile.read(glm::ivec3(0, 0, 0), out));
+		EXPECT_EQ(c, out);
+		ASSERT_TRUE(regionFile.read(glm::ivec3(1, 0, 0), out));
+		EXPECT_EQ(b, out);
+	}
+	EXPECT_LE(regionFile.sectors(), sectors + 3u);
+}
+
+TEST_F(RegionFileTest, testTruncateOnClose) {
+	const std::vector<uint8_t>& a = data(100, 1);
+	const std::vector<uint8_t>& b = data(RegionFile::SectorSize * 4, 2);
+	uint32_t sectors;
+	{
+		RegionFile regionFile;
+		ASSERT_TRUE(regionFile.open(_path));
+		ASSERT_TRUE(regionFile.write(glm::ivec3(0, 0, 0), a.data(), a.size()));
+		sectors = regionFile.sectors();
+		ASSERT_TRUE(regionFile.write(glm::ivec3(1, 0, 0), b.data(), b.size()));
+		ASSERT_TRUE(regionFile.erase(glm::ivec3(1, 0, 0)));
+	}
+	EXPECT_EQ((int64_t)sectors * RegionFile::SectorSize, (int64_t)io::filesystem()->open(_path, io::FileMode::SysRead)->length());
+	RegionFile regionFile;
+	ASSERT_TRUE(regionFile.open(_path));
+	EXPECT_EQ(sectors, regionFile.sectors());
+	std::vector<uint8_t> out;
+	ASSERT_TRUE(regionFile.read(glm::ivec3(0, 0, 0), out));
+	EXPECT_EQ(a, out);
+	EXPECT_FALSE(regionFile.contains(glm::ivec3(1, 0, 0)));
+}
+
+TEST_F(RegionFileTest, testInvalidFile) {
+	ASSERT_TRUE(io::filesystem()->syswrite(_path, "no region file"));
+	RegionFile regionFile;
+	EXPECT_FALSE(regionFile.open(_path));
+}
+
+}
@@ -0,0 +1,176 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/WorldHeightmap.h"
+#include "voxelutil/FloorTrace.h"
+#include "voxel/Constants.h"
+#include "core/ArrayLength.h"
+
+namespace voxelworld {
+
+class WorldHeightmapTest: public app::AbstractTest {
+protected:
+	// the heightmap is only built for chunks that span the whole world height
+	static constexpr int ChunkSize = 256;
+
+	/**
+	 * Hilly terrain with a cave below x in [20, 30], a column with too many runs at x = 50 and
+	 * columns at x = 60 that are enterable at the bottom of the world.
+	 */
+	class TerrainPager: public voxel::PagedVolume::Pager {
+	public:
+		static int height(int x, int z) {
+			return 10 + (x + z) % 5;
+		}
+
+		static bool solid(int x, int y, int z) {
+			if (y > height(x, z)) {
+				return false;
+			}
+			if (x >= 20 && x <= 30 && y >= 3 && y <= 5) {
+				return false;
+			}
+			if (x == 50) {
+				return y % 2 == 0;
+			}
+			if (x == 60) {
+				return y > 2;
+			}
+			return true;
+		}
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& mins = ctx.region.getLowerCorner();
+			const glm::ivec3& dims = ctx.region.getDimensionsInVoxels();
+			for (int z = 0; z < dims.z; ++z) {
+				for (int x = 0; x < dims.x; ++x) {
+					for (int y = 0; y < dims.y && mins.y + y <= 20; ++y) {
+						if (solid(mins.x + x, mins.y + y, mins.z + z)) {
+							ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Grass, 1));
+						} else if (mins.y + y <= 1) {
+							ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Water, 1));
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	TerrainPager _pager;
+	voxel::PagedVolume *_volume = nullptr;
+	WorldHeightmap _heightmap;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_volume = new voxel::PagedVolume(&_pager, 512 * 1024 * 1024, ChunkSize);
+		ASSERT_TRUE(_heightmap.init(_volume));
+		// page in the chunk
+		_volume->voxel(0, 0, 0);
+	}
+
+	void TearDown() override {
+		_heightmap.shutdown();
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractTest::TearDown();
+	}
+
+	/**
+	 * @brief Compares the cached floor levels of the column with the results of tracing the volume
+	 */
+	void validateColumn(int x, int z) {
+		for (int maxDistanceUpwards : {0, 1, 5, voxel::MAX_HEIGHT}) {
+			for (int y = 0; y <= voxel::MAX_HEIGHT; ++y) {
+				const glm::ivec3 pos(x, y, z);
+				voxelutil::FloorTraceResult result;
+				ASSERT_TRUE(_heightmap.findWalkableFloor(pos, maxDistanceUpwards, result)) << x << ":" << y << ":" << z;
+				const voxelutil::FloorTraceResult& expected = voxelutil::findWalkableFloor(_volume, pos, maxDistanceUpwards);
+				ASSERT_EQ(expected.heightLevel, result.heightLevel) << x << ":" << y << ":" << z << " distance " << maxDistanceUpwards;
+				ASSERT_TRUE(expected.voxel.isIdentical(result.voxel)) << x << ":" << y << ":" << z << " distance " << maxDistanceUpwards;
+			}
+		}
+	}
+};
+
+TEST_F(WorldHeightmapTest, testBuildOnPageIn) {
+	EXPECT_EQ(1, _heightmap.cachedChunks());
+	EXPECT_EQ(1, _heightmap.statistics().builds);
+	for (int x : {0, 1, 19, 20, 25, 30, 31, 60}) {
+		for (int z : {0, 3, 100}) {
+			validateColumn(x, z);
+		}
+	}
+}
+
+TEST_F(WorldHeightmapTest, testCaves) {
+	WorldHeightmap::Column column;
+	ASSERT_TRUE(_heightmap.column(25, 0, column));
+	ASSERT_EQ(2, column.runs);
+	EXPECT_EQ(3, column.start[0]);
+	EXPECT_EQ(5, column.end[0]);
+	EXPECT_EQ(TerrainPager::height(25, 0) + 1, column.start[1]);
+	EXPECT_EQ(voxel::MAX_HEIGHT, column.end[1]);
+
+	// the floor of the cave is found from inside the cave - the surface from above it
+	voxelutil::FloorTraceResult result;
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(25, 5, 0), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(3, result.heightLevel);
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(25, 100, 0), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(TerrainPager::height(25, 0) + 1, result.heightLevel);
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(25, 6, 0), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(TerrainPager::height(25, 0) + 1, result.heightLevel);
+}
+
+TEST_F(WorldHeightmapTest, testTooManyRuns) {
+	WorldHeightmap::Column column;
+	EXPECT_FALSE(_heightmap.column(50, 0, column));
+	voxelutil::FloorTraceResult result;
+	EXPECT_FALSE(_heightmap.findWalkableFloor(glm::ivec3(50, 100, 0), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(1, _heightmap.statistics().misses);
+}
+
+TEST_F(WorldHeightmapTest, testModification) {
+	const int x = 40;
+	const int z = 7;
+	const int surface = TerrainPager::height(x, z) + 1;
+	// a floating platform
+	_volume->setVoxel(x, 100, z, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	voxelutil::FloorTraceResult result;
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(x, 150, z), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(101, result.heightLevel);
+	EXPECT_EQ(voxel::VoxelType::Rock, result.voxel.getMaterial());
+	validateColumn(x, z);
+
+	// dig a hole into the surface
+	const voxel::Voxel voxels[3] = {voxel::createVoxel(voxel::VoxelType::Air, 0), voxel::createVoxel(voxel::VoxelType::Air, 0), voxel::createVoxel(voxel::VoxelType::Air, 0)};
+	_volume->setVoxels(x, surface - 3, z, 1, 1, voxels, lengthof(voxels));
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(x, 50, z), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(surface - 3, result.heightLevel);
+	validateColumn(x, z);
+
+	// the neighbours are not affected
+	ASSERT_TRUE(_heightmap.findWalkableFloor(glm::ivec3(x + 1, 50, z), voxel::MAX_HEIGHT, result));
+	EXPECT_EQ(TerrainPager::height(x + 1, z) + 1, result.heightLevel);
+	EXPECT_EQ(1, _heightmap.statistics().builds);
+}
+
+TEST_F(WorldHeightmapTest, testEviction) {
+	ASSERT_EQ(1, _heightmap.cachedChunks());
+	_volume->flushAll();
+	EXPECT_EQ(0, _heightmap.cachedChunks());
+	voxelutil::FloorTraceResult result;
+	EXPECT_FALSE(_heightmap.findWalkableFloor(glm::ivec3(0, 50, 0), voxel::MAX_HEIGHT, result));
+
+	_volume->voxel(0, 0, 0);
+	EXPECT_EQ(1, _heightmap.cachedChunks());
+	EXPECT_EQ(2, _heightmap.statistics().builds);
+	validateColumn(0, 0);
+}
+
+}
@@ -0,0 +1,213 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/WorldPathfinder.h"
+#include <future>
+#include <vector>
+
+namespace voxelworld {
+
+class WorldPathfinderTest: public app::AbstractTest {
+protected:
+	static constexpr int ChunkSize = 64;
+	static constexpr int Ground = 10;
+	// the first walkable height level
+	static constexpr int Floor = Ground + 1;
+
+	/**
+	 * Flat terrain with a wall at x = 40 that has a gap at z >= 60
+	 */
+	class TerrainPager: public voxel::PagedVolume::Pager {
+	public:
+		static bool wall(int x, int z) {
+			return x == 40 && z < 60;
+		}
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& mins = ctx.region.getLowerCorner();
+			const glm::ivec3& dims = ctx.region.getDimensionsInVoxels();
+			for (int z = 0; z < dims.z; ++z) {
+				for (int x = 0; x < dims.x; ++x) {
+					const int h = wall(mins.x + x, mins.z + z) ? Ground + 20 : Ground;
+					for (int y = 0; y < dims.y && mins.y + y <= h; ++y) {
+						ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Grass, 1));
+					}
+				}
+			}
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	TerrainPager _pager;
+	voxel::PagedVolume *_volume = nullptr;
+	WorldPathfinder _pathfinder;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_volume = new voxel::PagedVolume(&_pager, 128 * 1024 * 1024, ChunkSize);
+		ASSERT_TRUE(_pathfinder.init(_volume, 2));
+	}
+
+	void TearDown() override {
+		_pathfinder.shutdown();
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractTest::TearDown();
+	}
+
+	void validatePath(const WorldPathfinder::Path& path, const glm::ivec3& start, const glm::ivec3& end) const {
+		ASSERT_FALSE(path.empty());
+		EXPECT_EQ(start, path.front());
+		EXPECT_EQ(end, path.back());
+		for (size_t i = 0; i < path.size(); ++i) {
+			const glm::ivec3& pos = path[i];
+			ASSERT_TRUE(voxel::isEnterable(_volume->voxel(pos).getMaterial())) << "step " << i;
+			ASSERT_TRUE(voxel::isEnterable(_volume->voxel(pos + glm::ivec3(0, 1, 0)).getMaterial())) << "step " << i;
+			ASSERT_FALSE(voxel::isEnterable(_volume->voxel(pos - glm::ivec3(0, 1, 0)).getMaterial())) << "step " << i;
+			if (i == 0) {
+				continue;
+			}
+			const glm::ivec3& delta = glm::abs(pos - path[i - 1]);
+			ASSERT_LE(delta.x, 1) << "step " << i;
+			ASSERT_LE(delta.y, 1) << "step " << i;
+			ASSERT_LE(delta.z, 1) << "step " << i;
+			ASSERT_NE(0, delta.x + delta.z) << "step " << i;
+		}
+	}
+};
+
+TEST_F(WorldPathfinderTest, testPathInsideCluster) {
+	const glm::ivec3 start(1, Floor, 1);
+	const glm::ivec3 end(20, Floor, 7);
+	const WorldPathfinder::PathPtr& path = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(path);
+	validatePath(*path, start, end);
+	// diagonal steps on flat terrain
+	EXPECT_EQ(20u, path->size());
+}
+
+TEST_F(WorldPathfinderTest, testPathAroundWall) {
+	// the start position is snapped to the floor
+	const glm::ivec3 start(-20, Floor + 5, 10);
+	const glm::ivec3 end(100, Floor, -10);
+	const WorldPathfinder::PathPtr& path = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(path);
+	validatePath(*path, glm::ivec3(-20, Floor, 10), end);
+	bool gap = false;
+	for (const glm::ivec3& pos : *path) {
+		if (pos.x == 40) {
+			EXPECT_GE(pos.z, 60);
+			gap = true;
+		}
+	}
+	EXPECT_TRUE(gap);
+}
+
+TEST_F(WorldPathfinderTest, testNoPath) {
+	// a pit that can't be left
+	const glm::ivec3 end(16, Floor, 16);
+	for (int z = -2; z <= 2; ++z) {
+		for (int x = -2; x <= 2; ++x) {
+			if (glm::abs(x) == 2 || glm::abs(z) == 2) {
+				for (int y = Floor; y < Floor + 3; ++y) {
+					_volume->setVoxel(end.x + x, y, end.z + z, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+				}
+			}
+		}
+	}
+	const glm::ivec3 start(0, Floor, 0);
+	EXPECT_FALSE(_pathfinder.findPath(start, end));
+	// the missing path is cached, too
+	EXPECT_EQ(1, _pathfinder.cachedPaths());
+	EXPECT_FALSE(_pathfinder.findPath(start, end));
+	EXPECT_EQ(1, _pathfinder.statistics().pathCacheHits);
+
+	// open the pit
+	for (int y = Floor; y < Floor + 3; ++y) {
+		_volume->setVoxel(end.x - 2, y, end.z, voxel::createVoxel(voxel::VoxelType::Air, 0));
+	}
+	EXPECT_EQ(0, _pathfinder.cachedPaths());
+	const WorldPathfinder::PathPtr& path = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(path);
+	validatePath(*path, start, end);
+}
+
+TEST_F(WorldPathfinderTest, testCacheInvalidation) {
+	const glm::ivec3 start(1, Floor, 1);
+	const glm::ivec3 end(70, Floor, 70);
+	const WorldPathfinder::PathPtr path = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(path);
+	EXPECT_EQ(path, _pathfinder.findPath(start, end));
+	EXPECT_EQ(1, _pathfinder.statistics().pathCacheHits);
+	EXPECT_EQ(1, _pathfinder.cachedPaths());
+	const int clusters = _pathfinder.cachedClusters();
+	EXPECT_GT(clusters, 0);
+
+	// block the path
+	const glm::ivec3 blocked = (*path)[path->size() / 2];
+	_volume->setVoxel(blocked, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	_volume->setVoxel(blocked + glm::ivec3(0, 1, 0), voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	EXPECT_EQ(0, _pathfinder.cachedPaths());
+	EXPECT_LT(_pathfinder.cachedClusters(), clusters);
+
+	const WorldPathfinder::PathPtr& newPath = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(newPath);
+	EXPECT_NE(path, newPath);
+	validatePath(*newPath, start, end);
+	for (const glm::ivec3& pos : *newPath) {
+		ASSERT_NE(blocked, pos);
+	}
+}
+
+TEST_F(WorldPathfinderTest, testInvalidationKeepsUnrelatedPaths) {
+	const glm::ivec3 start(1, Floor, 1);
+	const glm::ivec3 end(20, Floor, 7);
+	const WorldPathfinder::PathPtr path = _pathfinder.findPath(start, end);
+	ASSERT_TRUE(path);
+	const glm::ivec3 farStart(-200, Floor, -200);
+	const glm::ivec3 farEnd(-180, Floor, -190);
+	ASSERT_TRUE(_pathfinder.findPath(farStart, farEnd));
+	EXPECT_EQ(2, _pathfinder.cachedPaths());
+
+	const int generation = _pathfinder.generation();
+	{
+		// one notification for the whole batch
+		voxel::PagedVolume::ModificationBatch batch(_volume);
+		for (int x = 0; x < 4; ++x) {
+			_volume->setVoxel(farStart.x + 10 + x, Floor, farStart.z + 5, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+		}
+	}
+	EXPECT_EQ(generation + 1, _pathfinder.generation());
+	EXPECT_EQ(1, _pathfinder.cachedPaths());
+	EXPECT_EQ(path, _pathfinder.findPath(start, end));
+	EXPECT_FALSE(_pathfinder.pathModified(*path, 0u, generation));
+
+	// modify a voxel next to the path
+	const glm::ivec3& step = path->back();
+	_volume->setVoxel(step + glm::ivec3(0, 2, 0), voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	EXPECT_TRUE(_pathfinder.pathModified(*path, 0u, generation));
+	EXPECT_FALSE(_pathfinder.pathModified(*path, 0u, _pathfinder.generation()));
+}
+
+TEST_F(WorldPathfinderTest, testAsync) {
+	std::vector<std::future<WorldPathfinder::PathPtr>> futures;
+	for (int i = 0; i < 32; ++i) {
+		// every path is requested twice
+		const glm::ivec3 end(-50 + (i / 2) * 7, Floor, 90 - (i / 2) * 5);
+		futures.push_back(_pathfinder.findPathAsync(glm::ivec3(0, Floor, 0), end));
+	}
+	for (int i = 0; i < 32; ++i) {
+		const WorldPathfinder::PathPtr& path = futures[i].get();
+		ASSERT_TRUE(path) << "request " << i;
+		validatePath(*path, glm::ivec3(0, Floor, 0), glm::ivec3(-50 + (i / 2) * 7, Floor, 90 - (i / 2) * 5));
+	}
+	EXPECT_EQ(16, _pathfinder.statistics().pathSearches);
+	EXPECT_GT(_pathfinder.statistics().batches, 0);
+}
+
+}
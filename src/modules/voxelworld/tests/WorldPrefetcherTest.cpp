@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworld/WorldPrefetcher.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include <chrono>
+#include <thread>
+
+namespace voxelworld {
+
+class WorldPrefetcherTest: public app::AbstractTest {
+protected:
+	static constexpr int ChunkSize = 32;
+
+	class Pager: public voxel::PagedVolume::Pager {
+	public:
+		core::AtomicInt pageIns { 0 };
+		core::AtomicInt originPageIns { 0 };
+		int delayMillis = 0;
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			if (delayMillis > 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(delayMillis));
+			}
+			++pageIns;
+			if (ctx.chunk->chunkPos() == glm::ivec3(0)) {
+				++originPageIns;
+			}
+			ctx.chunk->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Dirt, 1));
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	void waitForPrefetcher(const WorldPrefetcher& prefetcher) const {
+		for (int i = 0; i < 1000 && prefetcher.pending() > 0; ++i) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		ASSERT_EQ(0, prefetcher.pending());
+	}
+};
+
+TEST_F(WorldPrefetcherTest, testPrefetchAroundPosition) {
+	Pager pager;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, ChunkSize);
+	WorldPrefetcher prefetcher;
+	ASSERT_TRUE(prefetcher.init(&volume, 2));
+	EXPECT_EQ(9, prefetcher.prefetch(glm::vec3(1.0f), glm::vec3(0.0f), 1));
+	waitForPrefetcher(prefetcher);
+	EXPECT_EQ(9, (int)pager.pageIns);
+	EXPECT_EQ(9, prefetcher.prefetched());
+	EXPECT_TRUE(volume.hasChunk(glm::ivec3(-1, 0, -1)));
+	EXPECT_TRUE(volume.hasChunk(glm::ivec3(1, 0, 1)));
+	EXPECT_FALSE(volume.hasChunk(glm::ivec3(2, 0, 0)));
+	// the chunks are resident now
+	EXPECT_EQ(0, prefetcher.prefetch(glm::vec3(1.0f), glm::vec3(0.0f), 1));
+	EXPECT_EQ(voxel::VoxelType::Dirt, volume.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(9, (int)pager.pageIns);
+	prefetcher.shutdown();
+}
+
+TEST_F(WorldPrefetcherTest, testPrefetchMovement) {
+	Pager pager;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, ChunkSize);
+	WorldPrefetcher prefetcher;
+	ASSERT_TRUE(prefetcher.init(&volume, 2));
+	prefetcher.setLookAhead(2.0f);
+	// one chunk per second - the predicted position is two chunks away on the x axis, the chunks in between
+	// are requested, too
+	EXPECT_EQ(15, prefetcher.prefetch(glm::vec3(1.0f), glm::vec3(ChunkSize, 0.0f, 0.0f), 1));
+	waitForPrefetcher(prefetcher);
+	EXPECT_TRUE(volume.hasChunk(glm::ivec3(3, 0, 0)));
+	EXPECT_FALSE(volume.hasChunk(glm::ivec3(-2, 0, 0)));
+	prefetcher.shutdown();
+}
+
+TEST_F(WorldPrefetcherTest, testChunkInFlight) {
+	Pager pager;
+	pager.delayMillis = 50;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, ChunkSize);
+	WorldPrefetcher prefetcher;
+	ASSERT_TRUE(prefetcher.init(&volume, 1));
+	ASSERT_EQ(1, prefetcher.prefetch(glm::vec3(1.0f), glm::vec3(0.0f), 0));
+	// wait until the prefetcher has published the chunk
+	for (int i = 0; i < 1000 && !volume.hasChunk(glm::ivec3(0)); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	// this waits for the chunk that is paged in by the prefetcher
+	EXPECT_EQ(voxel::VoxelType::Dirt, volume.voxel(0, 0, 0).getMaterial());
+	waitForPrefetcher(prefetcher);
+	EXPECT_EQ(1, (int)pager.originPageIns);
+	prefetcher.shutdown();
+}
+
+}
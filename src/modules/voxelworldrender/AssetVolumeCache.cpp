@@ -35,9 +35,9 @@ void AssetVolumeCache::shutdown() {
 	_volumeCache = voxelformat::VolumeCachePtr();
 }
 
-voxel::RawVolume* AssetVolumeCache::loadPlant(const glm::ivec3& pos) {
+voxelformat::RawVolumePtr AssetVolumeCache::loadPlant(const glm::ivec3& pos) {
 	if (_plantCount <= 0) {
-		return nullptr;
+		return voxelformat::RawVolumePtr();
 	}
 	const int index = 1 + (glm::abs(pos.x + pos.z) % _plantCount);
 	const core::String &filename = core::string::format("models/plants/%i", index);
@@ -0,0 +1,162 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/WorldMeshExtractor.h"
+#include "voxel/MaterialColor.h"
+#include "core/GameConfig.h"
+
+namespace voxelworldrender {
+
+class WorldMeshExtractorTest: public app::AbstractTest {
+protected:
+	static constexpr int MeshSize = 32;
+
+	class TerrainPager: public voxel::PagedVolume::Pager {
+	public:
+		static int height(int x, int z) {
+			return 20 + (x & 7) + (z & 3);
+		}
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& mins = ctx.region.getLowerCorner();
+			const glm::ivec3& dims = ctx.region.getDimensionsInVoxels();
+			for (int z = 0; z < dims.z; ++z) {
+				for (int x = 0; x < dims.x; ++x) {
+					const int h = height(mins.x + x, mins.z + z);
+					for (int y = 0; y < dims.y && mins.y + y <= h; ++y) {
+						ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Grass, 1));
+					}
+				}
+			}
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	TerrainPager _pager;
+	voxel::PagedVolume *_volume = nullptr;
+	WorldMeshExtractor _extractor;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		core::Var::get(cfg::VoxelMeshSize, "32", core::CV_READONLY);
+		core::Var::get(cfg::VoxelLodDistance, "128")->setVal(128);
+		ASSERT_TRUE(voxel::initDefaultMaterialColors());
+		_volume = new voxel::PagedVolume(&_pager, 64 * 1024 * 1024, 64);
+		ASSERT_TRUE(_extractor.init(_volume));
+	}
+
+	void TearDown() override {
+		_extractor.shutdown();
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractTest::TearDown();
+	}
+
+	bool extract(const glm::ivec3& pos, int lod, ExtractedMesh& extracted) {
+		if (!_extractor.scheduleMeshExtraction(pos, lod)) {
+			return false;
+		}
+		_extractor.extractScheduledMesh();
+		return _extractor.pop(extracted);
+	}
+};
+
+TEST_F(WorldMeshExtractorTest, testLodMeshes) {
+	const glm::ivec3 pos(MeshSize, 0, -MeshSize);
+	ExtractedMesh full;
+	ASSERT_TRUE(extract(pos, 0, full));
+	EXPECT_EQ(0, full.lod);
+	ASSERT_FALSE(full.mesh.isEmpty());
+	size_t previousVertices = full.mesh.getNoOfVertices();
+	for (int lod = 1; lod <= WorldMeshExtractor::MaxLod; ++lod) {
+		ExtractedMesh extracted;
+		ASSERT_TRUE(extract(pos, lod, extracted)) << "lod " << lod;
+		EXPECT_EQ(lod, extracted.lod);
+		EXPECT_EQ(lod, _extractor.scheduledLod(pos));
+		EXPECT_EQ(pos, extracted.mesh.getOffset());
+		ASSERT_FALSE(extracted.mesh.isEmpty()) << "lod " << lod;
+		EXPECT_LT(extracted.mesh.getNoOfVertices(), previousVertices) << "lod " << lod;
+		previousVertices = extracted.mesh.getNoOfVertices();
+		const int scale = 1 << lod;
+		for (const voxel::VoxelVertex& vertex : extracted.mesh.getVertexVector()) {
+			// the vertices are in world space and on the grid of the level of detail
+			ASSERT_GE(vertex.position.x, pos.x);
+			ASSERT_LE(vertex.position.x, pos.x + MeshSize);
+			ASSERT_GE(vertex.position.z, pos.z);
+			ASSERT_LE(vertex.position.z, pos.z + MeshSize);
+			ASSERT_EQ(0, (vertex.position.x - pos.x) % scale);
+			ASSERT_EQ(0, (vertex.position.z - pos.z) % scale);
+		}
+	}
+	// scheduling the same level of detail again is rejected until re-extraction is allowed
+	EXPECT_FALSE(_extractor.scheduleMeshExtraction(pos, WorldMeshExtractor::MaxLod));
+	EXPECT_TRUE(_extractor.allowReExtraction(pos));
+	EXPECT_EQ(-1, _extractor.scheduledLod(pos));
+}
+
+TEST_F(WorldMeshExtractorTest, testEmptyMeshReplacesLod) {
+	const glm::ivec3 pos(MeshSize, 0, MeshSize);
+	ExtractedMesh coarse;
+	ASSERT_TRUE(extract(pos, 1, coarse));
+	ASSERT_FALSE(coarse.mesh.isEmpty());
+	// remove the terrain of the mesh tile and everything around it - the full resolution mesh is empty now
+	for (int z = pos.z - 1; z <= pos.z + MeshSize; ++z) {
+		for (int x = pos.x - 1; x <= pos.x + MeshSize; ++x) {
+			for (int y = -1; y <= TerrainPager::height(x, z); ++y) {
+				_volume->setVoxel(x, y, z, voxel::Voxel());
+			}
+		}
+	}
+	ExtractedMesh full;
+	ASSERT_TRUE(extract(pos, 0, full)) << "The empty mesh must replace the coarse mesh";
+	EXPECT_EQ(0, full.lod);
+	EXPECT_TRUE(full.mesh.isEmpty());
+	EXPECT_EQ(pos, full.mesh.getOffset());
+
+	// there is nothing to replace for a new extraction
+	EXPECT_TRUE(_extractor.allowReExtraction(pos));
+	ExtractedMesh fresh;
+	EXPECT_FALSE(extract(pos, 0, fresh));
+}
+
+TEST_F(WorldMeshExtractorTest, testLodSeams) {
+	// the border columns of the coarse mesh must reach the full resolution surface of the neighbours
+	const glm::ivec3 pos(0, 0, 0);
+	ExtractedMesh extracted;
+	ASSERT_TRUE(extract(pos, 2, extracted));
+	int top = 0;
+	for (const voxel::VoxelVertex& vertex : extracted.mesh.getVertexVector()) {
+		if (vertex.position.x == pos.x) {
+			top = core_max(top, (int)vertex.position.y);
+		}
+	}
+	int expected = 0;
+	for (int z = pos.z; z < pos.z + MeshSize; ++z) {
+		expected = core_max(expected, TerrainPager::height(pos.x - 1, z) + 1);
+	}
+	EXPECT_GE(top, expected);
+}
+
+TEST_F(WorldMeshExtractorTest, testLodForDistance) {
+	EXPECT_EQ(0, _extractor.lodForDistance(0.0f));
+	EXPECT_EQ(0, _extractor.lodForDistance(127.0f));
+	EXPECT_EQ(1, _extractor.lodForDistance(128.0f));
+	EXPECT_EQ(2, _extractor.lodForDistance(256.0f));
+	EXPECT_EQ(3, _extractor.lodForDistance(512.0f));
+	EXPECT_EQ(WorldMeshExtractor::MaxLod, _extractor.lodForDistance(100000.0f));
+
+	// the current level is kept close to the boundary
+	EXPECT_EQ(1, _extractor.lodForDistance(260.0f, 1));
+	EXPECT_EQ(2, _extractor.lodForDistance(250.0f, 2));
+	EXPECT_EQ(2, _extractor.lodForDistance(300.0f, 1));
+
+	core::Var::getSafe(cfg::VoxelLodDistance)->setVal(0);
+	EXPECT_EQ(0, _extractor.lodForDistance(100000.0f));
+}
+
+}
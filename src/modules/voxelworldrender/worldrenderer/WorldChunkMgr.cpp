@@ -49,24 +49,55 @@ void WorldChunkMgr::reset() {
 	_octree.clear();
 }
 
+WorldChunkMgr::ChunkBuffer* WorldChunkMgr::findChunkBuffer(const glm::ivec3& mins) {
+	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
+		if (chunkBuffer.inuse && chunkBuffer.aabb().mins() == mins) {
+			return &chunkBuffer;
+		}
+	}
+	return nullptr;
+}
+
+void WorldChunkMgr::removeChunkBuffer(ChunkBuffer* chunkBuffer) {
+	_octree.remove(chunkBuffer);
+	chunkBuffer->reset();
+}
+
 void WorldChunkMgr::handleMeshQueue() {
-	voxel::Mesh mesh;
-	if (!_meshExtractor.pop(mesh)) {
-		return;
+	ExtractedMesh extracted;
+	while (_meshExtractor.pop(extracted)) {
+		const glm::ivec3& pos = extracted.mesh.getOffset();
+		if (_meshExtractor.scheduledLod(pos) != extracted.lod) {
+			// the mesh tile was scheduled with another level of detail in the meantime or isn't needed anymore
+			continue;
+		}
+		if (extracted.mesh.isEmpty()) {
+			ChunkBuffer* chunkBuffer = findChunkBuffer(pos);
+			if (chunkBuffer != nullptr) {
+				removeChunkBuffer(chunkBuffer);
+			}
+			continue;
+		}
+		uploadMesh(extracted.mesh);
+		break;
 	}
+}
 
+void WorldChunkMgr::uploadMesh(const voxel::Mesh& mesh) {
 	// Now add the mesh to the list of meshes to render.
 	core_trace_scoped(WorldRendererHandleMeshQueue);
 
-	ChunkBuffer* freeChunkBuffer = nullptr;
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (freeChunkBuffer == nullptr && !chunkBuffer.inuse) {
-			freeChunkBuffer = &chunkBuffer;
-		}
-		// check whether we update an existing one
-		if (chunkBuffer.aabb().mins() == mesh.getOffset()) {
-			freeChunkBuffer = &chunkBuffer;
-			break;
+	// check whether we update an existing one - e.g. if the level of detail changed
+	ChunkBuffer* freeChunkBuffer = findChunkBuffer(mesh.getOffset());
+	const bool replace = freeChunkBuffer != nullptr;
+	if (replace) {
+		removeChunkBuffer(freeChunkBuffer);
+	} else {
+		for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
+			if (!chunkBuffer.inuse) {
+				freeChunkBuffer = &chunkBuffer;
+				break;
+			}
 		}
 	}
 
@@ -113,10 +144,13 @@ void WorldChunkMgr::handleMeshQueue() {
 		Log::warn("Failed to insert into octree");
 	}
 	freeChunkBuffer->inuse = true;
-	freeChunkBuffer->scaleSeconds = ScaleDuration;
+	if (!replace) {
+		freeChunkBuffer->scaleSeconds = ScaleDuration;
+	}
 }
 
 void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos) {
+	_focusPos = focusPos;
 	handleMeshQueue();
 
 	_meshExtractor.updateExtractionOrder(focusPos);
@@ -128,11 +162,12 @@ void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera
 		const glm::ivec3& pos = chunkBuffer.aabb().mins();
 		const int distance = distance2(pos, focusPos);
 		if (distance < _maxAllowedDistance) {
+			// the buffer keeps the current mesh until the mesh with the new level of detail is extracted
+			_meshExtractor.scheduleMeshExtraction(pos, lod(pos, _meshExtractor.scheduledLod(pos)));
 			continue;
 		}
 		core_assert_always(_meshExtractor.allowReExtraction(pos));
-		chunkBuffer.reset();
-		_octree.remove(&chunkBuffer);
+		removeChunkBuffer(&chunkBuffer);
 		Log::trace("Remove mesh from %i:%i", pos.x, pos.z);
 	}
 
@@ -169,6 +204,13 @@ int WorldChunkMgr::distance2(const glm::ivec3& pos, const glm::ivec3& pos2) cons
 	return distance;
 }
 
+int WorldChunkMgr::lod(const glm::ivec3& pos, int currentLod) const {
+	const glm::ivec3& size = _meshExtractor.meshSize();
+	const glm::vec2 center(pos.x + size.x / 2, pos.z + size.z / 2);
+	const float distance = glm::distance(center, glm::vec2(_focusPos.x, _focusPos.z));
+	return _meshExtractor.lodForDistance(distance, currentLod);
+}
+
 void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	core_trace_scoped(WorldRendererExtractMeshes);
 
@@ -185,12 +227,12 @@ void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	maxs.z += farplane;
 
 	_octree.visit(mins, maxs, [&] (const glm::ivec3& mins, const glm::ivec3& maxs) {
-		return !_meshExtractor.scheduleMeshExtraction(mins);
+		return !_meshExtractor.scheduleMeshExtraction(mins, lod(mins, _meshExtractor.scheduledLod(mins)));
 	}, glm::vec3(_meshExtractor.meshSize()));
 }
 
 void WorldChunkMgr::extractMesh(const glm::ivec3& pos) {
-	_meshExtractor.scheduleMeshExtraction(pos);
+	_meshExtractor.scheduleMeshExtraction(pos, lod(pos, _meshExtractor.scheduledLod(pos)));
 }
 
 int WorldChunkMgr::renderTerrain() {
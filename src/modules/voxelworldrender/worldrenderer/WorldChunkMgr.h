@@ -53,6 +53,7 @@ protected:
 	static constexpr int MAX_CHUNKBUFFERS = 2048;
 	ChunkBuffer _chunkBuffers[MAX_CHUNKBUFFERS];
 	int _maxAllowedDistance = -1;
+	glm::ivec3 _focusPos { 0 };
 
 	struct VisibleBuffers {
 		int size = 0;
@@ -66,9 +67,16 @@ protected:
 	core::ThreadPool &_threadPool;
 
 	int distance2(const glm::ivec3 &pos, const glm::ivec3 &pos2) const;
+	/**
+	 * @brief The level of detail for the mesh tile at the given position based on the distance to the focus position
+	 */
+	int lod(const glm::ivec3 &pos, int currentLod = -1) const;
+	ChunkBuffer* findChunkBuffer(const glm::ivec3 &mins);
+	void removeChunkBuffer(ChunkBuffer* chunkBuffer);
 
 	void cull(const video::Camera &camera);
 	void handleMeshQueue();
+	void uploadMesh(const voxel::Mesh &mesh);
 public:
 	WorldChunkMgr(core::ThreadPool& threadPool);
 
@@ -7,6 +7,10 @@
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Constants.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRescaler.h"
+#include "core/GameConfig.h"
+#include <memory>
 
 namespace voxelworldrender {
 
@@ -16,6 +20,7 @@ WorldMeshExtractor::WorldMeshExtractor() {
 bool WorldMeshExtractor::init(voxel::PagedVolume *volume) {
 	_volume = volume;
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_lodDistance = core::Var::get(cfg::VoxelLodDistance, "128");
 	return true;
 }
 
@@ -38,7 +43,7 @@ void WorldMeshExtractor::reset() {
 	_pendingExtraction.clear();
 }
 
-bool WorldMeshExtractor::pop(voxel::Mesh& item) {
+bool WorldMeshExtractor::pop(ExtractedMesh& item) {
 	core_trace_value_scoped(QueryNewMesh, _positionsExtracted.size());
 	return _extracted.pop(item);
 }
@@ -72,39 +77,181 @@ bool WorldMeshExtractor::allowReExtraction(const glm::ivec3& pos) {
 	return _positionsExtracted.erase(gridPos) != 0;
 }
 
+int WorldMeshExtractor::scheduledLod(const glm::ivec3& pos) const {
+	auto i = _positionsExtracted.find(meshPos(pos));
+	if (i == _positionsExtracted.end()) {
+		return -1;
+	}
+	return i->second;
+}
+
+int WorldMeshExtractor::lodForDistance(float distance, int currentLod) const {
+	const float lodDistance = (float)_lodDistance->intVal();
+	if (lodDistance <= 0.0f) {
+		return 0;
+	}
+	auto lod = [lodDistance] (float d) {
+		if (d < lodDistance) {
+			return 0;
+		}
+		return core_min(MaxLod, 1 + (int)glm::log2(d / lodDistance));
+	};
+	if (currentLod >= 0) {
+		const float margin = 0.1f;
+		if (currentLod >= lod(distance * (1.0f - margin)) && currentLod <= lod(distance * (1.0f + margin))) {
+			return currentLod;
+		}
+	}
+	return lod(distance);
+}
+
 // Extract the surface for the specified region of the volume.
 // The surface extractor outputs the mesh in an efficient compressed format which
 // is not directly suitable for rendering.
-bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p) {
+bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p, int lod) {
 	const glm::ivec3& pos = meshPos(p);
-	auto i = _positionsExtracted.insert(pos);
+	lod = glm::clamp(lod, 0, MaxLod);
+	auto i = _positionsExtracted.insert(std::make_pair(pos, lod));
 	if (!i.second) {
-		return false;
+		if (i.first->second == lod) {
+			return false;
+		}
+		// a request with the previous level of detail that is still pending is extracted anyway - but the
+		// result is thrown away because it doesn't match the scheduled level of detail anymore
+		i.first->second = lod;
 	}
-	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i)",
-			p.x, p.y, p.z, pos.x, pos.y, pos.z);
-	_pendingExtraction.push(pos);
+	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i) with lod %i",
+			p.x, p.y, p.z, pos.x, pos.y, pos.z, lod);
+	ExtractionRequest request;
+	request.pos = pos;
+	request.lod = lod;
+	request.replace = !i.second;
+	_pendingExtraction.push(request);
 	return true;
 }
 
+/**
+ * The chunk is copied into a raw volume and downsampled with @c voxel::rescaleVolume() - each step halves
+ * the resolution. The rescaler only keeps cells that are (nearly) completely solid, so the coarse meshes
+ * shrink away from the full resolution surface. To hide the cracks at the borders to finer neighbours, the
+ * border columns of the downsampled chunk are raised to the highest solid voxel of the full resolution
+ * columns they cover (including the adjacent column of the neighbour) and everything outside of the chunk
+ * is treated as air. This closes the chunk with walls that cover the gap to the finer neighbour.
+ */
+void WorldMeshExtractor::extractLodMesh(const voxel::Region& region, int lod, voxel::Mesh* mesh) const {
+	core_trace_scoped(LodMeshExtraction);
+	const glm::ivec3& mins = region.getLowerCorner();
+	const int scale = 1 << lod;
+
+	// copy the chunk and the adjacent columns of the neighbours - sampling the paged volume is much
+	// slower than sampling a raw volume
+	const voxel::Region copyRegion(mins - glm::ivec3(1, 0, 1), region.getUpperCorner() + glm::ivec3(1, 0, 1));
+	voxel::RawVolume copy(copyRegion);
+	{
+		core_trace_scoped(LodMeshCopy);
+		voxel::PagedVolume::Sampler sampler(_volume);
+		for (int z = copyRegion.getLowerZ(); z <= copyRegion.getUpperZ(); ++z) {
+			for (int x = copyRegion.getLowerX(); x <= copyRegion.getUpperX(); ++x) {
+				sampler.setPosition(x, mins.y, z);
+				for (int y = mins.y; y <= copyRegion.getUpperY(); ++y) {
+					const voxel::Voxel& v = sampler.voxel();
+					if (!voxel::isAir(v.getMaterial())) {
+						copy.setVoxel(x, y, z, v);
+					}
+					sampler.movePositiveY();
+				}
+			}
+		}
+	}
+
+	std::unique_ptr<voxel::RawVolume> lodVolume;
+	for (int i = 0; i < lod; ++i) {
+		const voxel::RawVolume& src = lodVolume ? *lodVolume : copy;
+		const voxel::Region& srcRegion = lodVolume ? lodVolume->region() : region;
+		const glm::ivec3 dims((srcRegion.getDimensionsInVoxels() + 1) / 2);
+		const voxel::Region dstRegion(glm::ivec3(0), dims - 1);
+		voxel::RawVolume* dst = new voxel::RawVolume(dstRegion);
+		voxel::rescaleVolume(src, srcRegion, *dst, dstRegion);
+		lodVolume.reset(dst);
+	}
+
+	const voxel::Region& lodRegion = lodVolume->region();
+	const glm::ivec3& lodDims = lodRegion.getDimensionsInVoxels();
+	for (int z = 0; z < lodDims.z; ++z) {
+		const bool borderZ = z == 0 || z == lodDims.z - 1;
+		for (int x = 0; x < lodDims.x; ++x) {
+			if (!borderZ && x != 0 && x != lodDims.x - 1) {
+				continue;
+			}
+			const int srcMinsX = mins.x + x * scale - (x == 0 ? 1 : 0);
+			const int srcMaxsX = core_min(mins.x + (x + 1) * scale, region.getUpperX() + 1) - 1 + (x == lodDims.x - 1 ? 1 : 0);
+			const int srcMinsZ = mins.z + z * scale - (z == 0 ? 1 : 0);
+			const int srcMaxsZ = core_min(mins.z + (z + 1) * scale, region.getUpperZ() + 1) - 1 + (z == lodDims.z - 1 ? 1 : 0);
+			int top = -1;
+			voxel::Voxel topVoxel;
+			for (int sz = srcMinsZ; sz <= srcMaxsZ; ++sz) {
+				for (int sx = srcMinsX; sx <= srcMaxsX; ++sx) {
+					// only look above the highest solid voxel that was found so far
+					for (int sy = region.getUpperY(); sy > mins.y + top; --sy) {
+						const voxel::Voxel& v = copy.voxel(sx, sy, sz);
+						if (voxel::isBlocked(v.getMaterial())) {
+							top = sy - mins.y;
+							topVoxel = v;
+							break;
+						}
+					}
+				}
+			}
+			if (top < 0) {
+				continue;
+			}
+			const voxel::Voxel fill = voxel::createVoxel(voxel::VoxelType::Generic, topVoxel.getColor());
+			for (int y = top / scale; y >= 0; --y) {
+				if (!voxel::isAir(lodVolume->voxel(x, y, z).getMaterial())) {
+					continue;
+				}
+				lodVolume->setVoxel(x, y, z, fill);
+			}
+		}
+	}
+
+	voxel::extractCubicMesh(lodVolume.get(), lodRegion, mesh, voxel::IsQuadNeeded(), glm::ivec3(0));
+	// transform the vertices back into the world space of the chunk
+	voxel::VertexArray& vertices = mesh->getVertexVector();
+	for (voxel::VoxelVertex& vertex : vertices) {
+		vertex.position = glm::i16vec3(glm::ivec3(vertex.position) * scale + mins);
+	}
+	mesh->setOffset(mins);
+}
+
 void WorldMeshExtractor::extractScheduledMesh() {
-	decltype(_pendingExtraction)::Key pos;
-	if (!_pendingExtraction.waitAndPop(pos)) {
+	ExtractionRequest request;
+	if (!_pendingExtraction.waitAndPop(request)) {
 		return;
 	}
 	core_trace_scoped(MeshExtraction);
 	const glm::ivec3& size = meshSize();
-	const glm::ivec3 mins(pos);
-	const glm::ivec3 maxs(pos.x + size.x - 1, pos.y + size.y - 2, pos.z + size.z - 1);
+	const glm::ivec3 mins(request.pos);
+	const glm::ivec3 maxs(mins.x + size.x - 1, mins.y + size.y - 2, mins.z + size.z - 1);
 	const voxel::Region region(mins, maxs);
 	// these numbers are made up mostly by try-and-error - we need to revisit them from time to time to prevent extra mem allocs
 	// they also heavily depend on the size of the mesh region we extract
 	const int factor = 64;
-	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
-	voxel::Mesh mesh(vertices, vertices);
-	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
-	if (!mesh.isEmpty()) {
-		_extracted.push(std::move(mesh));
+	const int scale = 1 << request.lod;
+	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor / (scale * scale);
+	ExtractedMesh extracted;
+	extracted.lod = request.lod;
+	extracted.mesh = voxel::Mesh(vertices, vertices);
+	if (request.lod > 0) {
+		extractLodMesh(region, request.lod, &extracted.mesh);
+	} else {
+		voxel::extractCubicMesh(_volume, region, &extracted.mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	}
+	// empty meshes of a re-extraction are still needed to replace the previous level of detail - no matter
+	// which level of detail the new mesh has
+	if (!extracted.mesh.isEmpty() || request.replace) {
+		extracted.mesh.setOffset(mins);
+		_extracted.push(std::move(extracted));
 	}
 }
 
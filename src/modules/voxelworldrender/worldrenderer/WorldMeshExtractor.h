@@ -11,19 +11,42 @@
 #include "voxel/PagedVolume.h"
 #include "core/concurrent/Atomic.h"
 
-#include <unordered_set>
+#include <unordered_map>
 #include <glm/vec3.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
+namespace voxel {
+class Region;
+}
+
 namespace voxelworldrender {
 
-typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
+// maps the mesh tile positions to the level of detail they are extracted with
+typedef std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > PositionLodMap;
+
+/**
+ * @brief A mesh of a mesh tile together with the level of detail it was extracted with
+ */
+struct ExtractedMesh {
+	voxel::Mesh mesh;
+	int lod = 0;
+
+	inline bool operator<(const ExtractedMesh& rhs) const {
+		return mesh < rhs.mesh;
+	}
+};
 
 class WorldMeshExtractor {
 private:
-	core::ConcurrentPriorityQueue<voxel::Mesh> _extracted;
+	core::ConcurrentPriorityQueue<ExtractedMesh> _extracted;
 	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
+	struct ExtractionRequest {
+		glm::ivec3 pos { 0, 0, 0 };
+		int lod = 0;
+		// the mesh tile was extracted before - an empty result must replace the previous mesh
+		bool replace = false;
+	};
 	struct CloseToPoint {
 		glm::ivec2 _refPoint;
 		CloseToPoint(const glm::ivec3& refPoint) : _refPoint(refPoint.x, refPoint.z) {
@@ -32,18 +55,26 @@ private:
 			const glm::ivec2 d(_refPoint.x - pos.x, _refPoint.y - pos.z);
 			return d.x * d.x + d.y * d.y;
 		}
-		inline bool operator()(const glm::ivec3& lhs, const glm::ivec3& rhs) const {
-			return distanceToSortPos(lhs) > distanceToSortPos(rhs);
+		inline bool operator()(const ExtractionRequest& lhs, const ExtractionRequest& rhs) const {
+			return distanceToSortPos(lhs.pos) > distanceToSortPos(rhs.pos);
 		}
 	};
 
-	core::ConcurrentPriorityQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
-	// fast lookup for positions that are already extracted
-	PositionSet _positionsExtracted;
+	core::ConcurrentPriorityQueue<ExtractionRequest, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
+	// fast lookup for positions that are already extracted and the level of detail they were scheduled with
+	PositionLodMap _positionsExtracted;
 	core::VarPtr _meshSize;
+	core::VarPtr _lodDistance;
 	voxel::PagedVolume *_volume = nullptr;
 
+	void extractLodMesh(const voxel::Region& region, int lod, voxel::Mesh* mesh) const;
+
 public:
+	/**
+	 * @brief The coarsest level of detail - a mesh of this level is extracted with 1/(2^MaxLod) of the resolution
+	 */
+	static constexpr int MaxLod = 3;
+
 	WorldMeshExtractor();
 
 	void extractScheduledMesh();
@@ -51,8 +82,10 @@ public:
 	/**
 	 * @brief We need to pop the mesh extractor queue to find out if there are new and ready to use meshes for us
 	 * @return @c false if this isn't the case, @c true if the given reference was filled with valid data.
+	 * @note The mesh might be empty if a mesh tile was re-extracted with a different level of detail and there
+	 * is nothing left at that level.
 	 */
-	bool pop(voxel::Mesh& item);
+	bool pop(ExtractedMesh& item);
 
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
@@ -70,9 +103,25 @@ public:
 	 * @brief Performs async mesh extraction. You need to call @c pop in order to see if some extraction is ready.
 	 *
 	 * @param[in] pos A world vector that is automatically converted into a mesh tile vector
-	 * @note This will not allow to reschedule an extraction for the same area until @c allowReExtraction was called.
+	 * @param[in] lod The level of detail in the range [0, MaxLod] - @c 0 is the full resolution
+	 * @note This will not allow to reschedule an extraction for the same area and level of detail until
+	 * @c allowReExtraction was called. Scheduling the area with a different level of detail replaces the
+	 * previous request.
+	 */
+	bool scheduleMeshExtraction(const glm::ivec3& pos, int lod = 0);
+
+	/**
+	 * @return The level of detail the given position was scheduled with, or @c -1 if it isn't scheduled
+	 */
+	int scheduledLod(const glm::ivec3& pos) const;
+
+	/**
+	 * @brief The level of detail for a mesh tile that has the given distance to the focus position
+	 * @param[in] distance The distance in voxels on the xz plane
+	 * @param[in] currentLod The level of detail the mesh tile is currently rendered with or @c -1. A level
+	 * is kept until the distance leaves it by a margin to prevent re-extracting tiles at the level boundaries.
 	 */
-	bool scheduleMeshExtraction(const glm::ivec3& pos);
+	int lodForDistance(float distance, int currentLod = -1) const;
 
 	void reset();
 